@@ -0,0 +1,123 @@
+/**
+ * @file    bf30a2_convert.h
+ * @brief   BF30A2 pixel conversion for applications
+ *
+ * The kernels the capture path converts lines with, applied to rectangles
+ * of images with any row stride, so an application converting a stored
+ * frame or redrawing part of one runs the same code instead of a copy of
+ * its own. Sources are YUV422 as the sensor sends it (Y0 Cb Y1 Cr), or
+ * RGB565 and Y8 for plain copies; RGB565 is little-endian.
+ *
+ * Rows are stride bytes apart; a negative stride walks them bottom up, so
+ * pointing data at the last row flips the image vertically. YUV422 is
+ * handled in whole pixel pairs: its x and width must be even.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_CONVERT_H__
+#define __BF30A2_CONVERT_H__
+
+#include <rtthread.h>
+#include "drv_bf30a2.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief An image in memory
+ */
+typedef struct bf30a2_image
+{
+    rt_uint8_t *data;               /**< Pixel 0, 0 */
+    rt_int32_t stride;              /**< Bytes from one row to the next, negative = bottom up */
+    rt_uint16_t width;              /**< Pixels per row */
+    rt_uint16_t height;             /**< Rows */
+    bf30a2_format_t format;         /**< Pixel format */
+} bf30a2_image_t;
+
+/**
+ * @brief A rectangle of an image, in pixels
+ */
+typedef struct bf30a2_rect
+{
+    rt_uint16_t x;                  /**< Left column */
+    rt_uint16_t y;                  /**< Top row */
+    rt_uint16_t width;              /**< Columns */
+    rt_uint16_t height;             /**< Rows */
+} bf30a2_rect_t;
+
+/*
+ * Strided kernels, unchecked. width and height are of the source; the
+ * _half variants write width / 2 x height / 2 pixels, taking the first
+ * luma sample of each pair and the even rows, as the half output levels.
+ */
+void bf30a2_convert_yuv422_to_rgb565(const rt_uint8_t *src, rt_int32_t src_stride,
+                                     rt_uint8_t *dst, rt_int32_t dst_stride,
+                                     int width, int height);
+void bf30a2_convert_yuv422_to_y8(const rt_uint8_t *src, rt_int32_t src_stride,
+                                 rt_uint8_t *dst, rt_int32_t dst_stride,
+                                 int width, int height);
+void bf30a2_convert_yuv422_to_rgb565_half(const rt_uint8_t *src, rt_int32_t src_stride,
+                                          rt_uint8_t *dst, rt_int32_t dst_stride,
+                                          int width, int height);
+void bf30a2_convert_yuv422_to_y8_half(const rt_uint8_t *src, rt_int32_t src_stride,
+                                      rt_uint8_t *dst, rt_int32_t dst_stride,
+                                      int width, int height);
+
+/**
+ * @brief Copy row_bytes of each of height rows
+ */
+void bf30a2_convert_copy(const rt_uint8_t *src, rt_int32_t src_stride,
+                         rt_uint8_t *dst, rt_int32_t dst_stride,
+                         rt_uint32_t row_bytes, int height);
+
+/**
+ * @brief Convert a rectangle of src into dst, 1:1 or halved
+ *
+ * dst describes where the result goes: its data is the output's pixel
+ * 0, 0 and its width and height are those of the rectangle, or half of
+ * them to halve it. YUV422 converts to RGB565, Y8 or (1:1) YUV422;
+ * RGB565 and Y8 only copy (1:1).
+ *
+ * @param rect  Rectangle of src, RT_NULL for all of it
+ *
+ * @return -RT_EINVAL for a rectangle outside src, odd YUV422 columns, a
+ *         dst size that is neither 1:1 nor halved, or formats without a
+ *         conversion
+ */
+rt_err_t bf30a2_convert(const bf30a2_image_t *src, const bf30a2_rect_t *rect,
+                        const bf30a2_image_t *dst);
+
+/**
+ * @brief Box-filter a YUV422 rectangle of src down 2, 4 or 8 times into dst
+ *
+ * The thumbnail kernel: each output pixel is the average of a scale x
+ * scale block, the scale given by the rectangle width over dst's. dst is
+ * RGB565 or Y8; rows and columns past the last whole block are left out.
+ *
+ * @return -RT_EINVAL as bf30a2_convert(), or for an unsupported scale
+ */
+rt_err_t bf30a2_convert_box(const bf30a2_image_t *src, const bf30a2_rect_t *rect,
+                            const bf30a2_image_t *dst);
+
+/**
+ * @brief Build a 256-entry tone curve for bf30a2_tone_cfg_t
+ *
+ * Each value v becomes (v - 128) * contrast / 100 + 128 + brightness,
+ * clamped, then 255 * (v / 255) ^ (100 / gamma): gamma above 100 lifts
+ * the mid tones, below darkens them. Integer arithmetic only.
+ *
+ * @param brightness  Added, -255 .. 255; 0 = unchanged
+ * @param contrast    Percent, 100 = unchanged
+ * @param gamma       Gamma x 100, 100 (or 0 and below) = linear
+ */
+void bf30a2_tone_curve(rt_uint8_t lut[256], int brightness, int contrast, int gamma);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BF30A2_CONVERT_H__ */
@@ -0,0 +1,88 @@
+/**
+ * @file    bf30a2_lvgl.h
+ * @brief   BF30A2 zero-copy LVGL image source
+ *
+ * Shows the camera frames in an LVGL 9 image object without copying them:
+ * the image descriptor points straight at a frame leased from the driver
+ * (BF30A2_CMD_LEASE_FRAME), in the driver's output format, which is the
+ * display's native RGB565 (or L8 at the Y8 governor level). An LVGL timer
+ * polls for a new frame and swaps it in, which costs one invalidate of
+ * the image per frame. The replaced frame is released when the display
+ * reports its next render finished (LV_EVENT_RENDER_READY), so a frame
+ * is never returned to the driver while LVGL may still read it.
+ *
+ * The preview holds one lease for the frame shown and, between a swap and
+ * the next render, one for the frame replaced; no new frame is taken
+ * while the replaced one is outstanding. Configure three frame buffers
+ * (BF30A2_FRAME_BUFFERS) so capture always has one to fill.
+ *
+ * All functions must be called from the LVGL thread, with the LVGL lock
+ * held if the application uses one.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_LVGL_H__
+#define __BF30A2_LVGL_H__
+
+#include <rtthread.h>
+#include "drv_bf30a2.h"
+
+#ifdef BF30A2_USING_LVGL
+
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Default frame poll period (ms) */
+#define BF30A2_LV_PERIOD_MS         10
+
+/**
+ * @brief Image source state, owned by the caller
+ */
+typedef struct bf30a2_lv_src
+{
+    rt_device_t dev;                /**< Camera device */
+    lv_obj_t *img;                  /**< Image object showing the frames */
+    lv_display_t *disp;             /**< Display the image is rendered on */
+    lv_timer_t *timer;              /**< Frame poll timer */
+    lv_image_dsc_t dsc;             /**< Descriptor of the frame shown */
+    bf30a2_buffer_t shown;          /**< Leased frame the image points at */
+    bf30a2_buffer_t retired;        /**< Leased frame replaced, not yet released */
+    rt_uint32_t frames;             /**< Frames swapped in */
+    rt_uint32_t deferred;           /**< Polls that waited for a render to finish */
+} bf30a2_lv_src_t;
+
+/**
+ * @brief Start showing camera frames in an image object
+ *
+ * The capture itself is started and stopped by the application as usual.
+ *
+ * @param src       State, zeroed by this call
+ * @param dev       Opened camera device
+ * @param img       Image object, e.g. from lv_image_create()
+ * @param period_ms Frame poll period, 0 for BF30A2_LV_PERIOD_MS
+ *
+ * @return RT_EOK, -RT_EINVAL for a missing argument or an image that is
+ *         not on a display, -RT_ENOMEM if the timer cannot be created
+ */
+rt_err_t bf30a2_lv_src_attach(bf30a2_lv_src_t *src, rt_device_t dev, lv_obj_t *img,
+                              rt_uint32_t period_ms);
+
+/**
+ * @brief Stop updating the image and release every lease
+ *
+ * The image source is cleared first, so the image object may be kept.
+ */
+void bf30a2_lv_src_detach(bf30a2_lv_src_t *src);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BF30A2_USING_LVGL */
+
+#endif /* __BF30A2_LVGL_H__ */
@@ -56,6 +56,35 @@ enum bf30a2_cmd
     BF30A2_CMD_WAIT_FRAME,          /**< Wait for next frame */
     BF30A2_CMD_EXPORT_UART,         /**< Export frame via UART */
     BF30A2_CMD_RESET_STATS,         /**< Reset statistics */
+    BF30A2_CMD_GET_TRACE,           /**< Copy trace ring events */
+    BF30A2_CMD_EXPORT_TRACE,        /**< Export trace ring via UART */
+    BF30A2_CMD_RAWCAP_START,        /**< Start raw SPI stream capture */
+    BF30A2_CMD_RAWCAP_STOP,         /**< Stop raw SPI stream capture */
+    BF30A2_CMD_RAWCAP_GET_STATUS,   /**< Get raw capture status */
+    BF30A2_CMD_RAWCAP_EXPORT_UART,  /**< Export captured stream via UART */
+    BF30A2_CMD_RAWCAP_SAVE,         /**< Save captured stream to a file */
+    BF30A2_CMD_RAWCAP_RELEASE,      /**< Free the driver-allocated capture buffer */
+    BF30A2_CMD_GET_LATENCY,         /**< Get frame latency percentiles */
+    BF30A2_CMD_RESET_LATENCY,       /**< Clear frame latency histograms */
+    BF30A2_CMD_GET_GOVERNOR,        /**< Get load governor level and statistics */
+    BF30A2_CMD_SET_GOVERNOR,        /**< Configure the load governor */
+    BF30A2_CMD_LEASE_FRAME,         /**< Wait for and lease the latest frame */
+    BF30A2_CMD_RELEASE_FRAME,       /**< Return a leased frame */
+    BF30A2_CMD_SET_VIEWFINDER,      /**< Stream lines to an LCD instead of frame buffers */
+    BF30A2_CMD_GET_VIEWFINDER,      /**< Get viewfinder panel rate and latency */
+    BF30A2_CMD_SUBSCRIBE,           /**< Add a frame subscriber */
+    BF30A2_CMD_UNSUBSCRIBE,         /**< Remove a frame subscriber */
+    BF30A2_CMD_SUB_RECEIVE,         /**< Take a frame from a queue subscriber */
+    BF30A2_CMD_GET_SUBSCRIBER,      /**< Get a subscriber's statistics */
+    BF30A2_CMD_SET_THUMBNAIL,       /**< Configure the thumbnail produced with every frame */
+    BF30A2_CMD_GET_THUMBNAIL,       /**< Get the thumbnail of a leased frame */
+    BF30A2_CMD_SET_WINDOW,          /**< Set the sensor output window and subsampling */
+    BF30A2_CMD_GET_WINDOW,          /**< Get the window and the SPI bytes it saves */
+    BF30A2_CMD_SET_PIPELINE,        /**< Set the frame output crop, rotation and statistics */
+    BF30A2_CMD_GET_FRAME_STATS,     /**< Get the luma statistics of the last frame */
+    BF30A2_CMD_SET_TONE,            /**< Set the tone curve of the frame output */
+    BF30A2_CMD_SET_CHANGE,          /**< Configure change detection between frames */
+    BF30A2_CMD_GET_CHANGE,          /**< Get the change detection result and counters */
 };
 
 /*===========================================================================*/
@@ -79,6 +108,7 @@ typedef enum
 {
     BF30A2_FORMAT_RGB565 = 0,       /**< RGB565 format (default) */
     BF30A2_FORMAT_YUV422,           /**< YUV422 format */
+    BF30A2_FORMAT_Y8,               /**< 8-bit luma only */
 } bf30a2_format_t;
 
 /**
@@ -86,10 +116,10 @@ typedef enum
  */
 typedef struct bf30a2_info
 {
-    rt_uint16_t width;              /**< Image width in pixels */
-    rt_uint16_t height;             /**< Image height in pixels */
-    rt_uint32_t frame_size;         /**< Frame buffer size in bytes */
-    bf30a2_format_t format;         /**< Output format */
+    rt_uint16_t width;              /**< Image width of the last published frame */
+    rt_uint16_t height;             /**< Image height of the last published frame */
+    rt_uint32_t frame_size;         /**< Bytes of the last published frame */
+    bf30a2_format_t format;         /**< Format of the last published frame */
     rt_uint16_t chip_id;            /**< Sensor chip ID */
 } bf30a2_info_t;
 
@@ -102,8 +132,22 @@ typedef struct bf30a2_status
     rt_uint32_t frame_count;        /**< Total frames captured */
     rt_uint32_t complete_frames;    /**< Successfully completed frames */
     rt_uint32_t error_count;        /**< Error count */
-    float fps;                      /**< Current frame rate */
+    float fps;                      /**< Current frame rate (fps_milli / 1000) */
     rt_uint8_t frame_ready;         /**< Frame ready flag */
+
+    /* Frame intervals between published frames, integer microseconds */
+    rt_uint32_t fps_milli;          /**< Frame rate x 1000 from the average interval */
+    rt_uint32_t interval_us;        /**< Last interval */
+    rt_uint32_t interval_avg_us;    /**< Moving average of on-time intervals */
+    rt_uint32_t interval_min_us;    /**< Shortest interval */
+    rt_uint32_t interval_max_us;    /**< Longest interval */
+    rt_uint32_t interval_stddev_us; /**< Standard deviation of all intervals */
+    rt_uint32_t late_intervals;     /**< Intervals over 1.5 x average (frames dropped) */
+    rt_uint32_t seq_gaps;           /**< Frames started but never published */
+    rt_uint32_t bp_dropped;         /**< Frames dropped for want of a free buffer (leases) */
+    rt_uint32_t geometry_changes;   /**< Frame headers that changed the sensor geometry */
+    rt_uint32_t buffer_bytes;       /**< DMA ring, frame buffers and planes held now */
+    rt_uint32_t converted_frames;   /**< Frames converted, on first read with lazy conversion */
 } bf30a2_status_info_t;
 
 /**
@@ -111,8 +155,8 @@ typedef struct bf30a2_status
  *
  * @param dev       Device handle
  * @param frame_num Frame sequence number
- * @param buffer    Pointer to frame data (RGB565 format)
- * @param size      Frame data size in bytes
+ * @param buffer    Pointer to frame data (RGB565, or as set by the governor level)
+ * @param size      Frame data size in bytes, see BF30A2_CMD_GET_INFO for the geometry
  * @param user_data User-provided context pointer
  */
 typedef void (*bf30a2_frame_callback_t)(rt_device_t dev,
@@ -139,10 +183,20 @@ typedef struct bf30a2_buffer
     rt_uint32_t size;               /**< Buffer size in bytes */
     rt_uint32_t frame_num;          /**< Frame sequence number */
     rt_uint32_t timestamp;          /**< Capture timestamp (tick) */
+    rt_uint16_t width;              /**< Frame width in pixels */
+    rt_uint16_t height;             /**< Frame height in pixels */
+    bf30a2_format_t format;         /**< Frame format */
+    rt_uint8_t unchanged;           /**< Found unchanged by change detection */
 } bf30a2_buffer_t;
 
 /**
  * @brief Wait frame configuration structure
+ *
+ * For BF30A2_CMD_LEASE_FRAME the buffer is required and receives the
+ * leased frame, which stays intact until BF30A2_CMD_RELEASE_FRAME; a
+ * timeout of 0 returns -RT_ETIMEOUT at once when no new frame is ready.
+ * The pointer returned by GET_BUFFER and WAIT_FRAME is not leased and
+ * may be reused for a later frame at any time.
  */
 typedef struct bf30a2_wait_cfg
 {
@@ -150,6 +204,593 @@ typedef struct bf30a2_wait_cfg
     bf30a2_buffer_t *buffer;        /**< Output buffer info (optional) */
 } bf30a2_wait_cfg_t;
 
+/*===========================================================================*/
+/* Event Trace                                                               */
+/*===========================================================================*/
+
+/**
+ * @brief Trace event identifiers
+ *
+ * Values are part of the dump format decoded on the host, append only.
+ */
+typedef enum
+{
+    BF30A2_TRACE_NONE = 0,          /**< Unused slot */
+    BF30A2_TRACE_CAPTURE_START,     /**< Capture started */
+    BF30A2_TRACE_CAPTURE_STOP,      /**< Capture stopped */
+    BF30A2_TRACE_DMA_WAKEUP,        /**< Thread woke up: arg16 = new bytes, arg8 = event received */
+    BF30A2_TRACE_FRAME_HEADER,      /**< Frame header parsed: arg16 = width */
+    BF30A2_TRACE_FRAME_START,       /**< Frame accepted: arg16 = height */
+    BF30A2_TRACE_GEOMETRY_REJECT,   /**< Frame rejected: arg16 = height */
+    BF30A2_TRACE_FRAME_END,         /**< Frame end: arg8 = published, arg16 = lines received */
+    BF30A2_TRACE_LINE,              /**< Line complete: arg16 = line number */
+    BF30A2_TRACE_LINE_REJECT,       /**< Line out of range: arg16 = line number */
+    BF30A2_TRACE_SYNC_LOSS,         /**< Resync: arg8 = parse state, arg16 = offending byte */
+    BF30A2_TRACE_SIZE_MISMATCH,     /**< Data header rejected: arg16 = data_size */
+    BF30A2_TRACE_CB_ENTER,          /**< Frame callback entry: arg16 = frame number */
+    BF30A2_TRACE_CB_EXIT,           /**< Frame callback exit: arg16 = frame number */
+    BF30A2_TRACE_FRAME_DROP,        /**< No free buffer at frame header: arg16 = frame start count */
+} bf30a2_trace_id_t;
+
+/**
+ * @brief Trace event record (8 bytes, little endian in dumps)
+ */
+typedef struct bf30a2_trace_event
+{
+    rt_uint32_t timestamp;          /**< Core cycle counter at emission */
+    rt_uint8_t id;                  /**< Event identifier (bf30a2_trace_id_t) */
+    rt_uint8_t arg8;                /**< 8-bit argument */
+    rt_uint16_t arg16;              /**< 16-bit argument */
+} bf30a2_trace_event_t;
+
+/**
+ * @brief Trace snapshot request for BF30A2_CMD_GET_TRACE
+ */
+typedef struct bf30a2_trace_dump
+{
+    bf30a2_trace_event_t *events;   /**< Destination array */
+    rt_uint32_t max_events;         /**< Capacity of events[] */
+    rt_uint32_t count;              /**< [out] Events copied, oldest first */
+    rt_uint32_t total;              /**< [out] Events emitted since last clear */
+    rt_uint32_t clock_hz;           /**< [out] Timestamp clock frequency in Hz */
+} bf30a2_trace_dump_t;
+
+/*===========================================================================*/
+/* Raw Stream Capture                                                        */
+/*===========================================================================*/
+
+/** @brief Capture file magic ("BFRC") */
+#define BF30A2_RAWCAP_MAGIC         0x43524642
+
+/** @brief Capture record magic ("WAKE") */
+#define BF30A2_RAWCAP_REC_MAGIC     0x454B4157
+
+/** @brief Capture format version */
+#define BF30A2_RAWCAP_VERSION       1
+
+/**
+ * @brief Capture file header, followed by records (all little endian)
+ */
+typedef struct bf30a2_rawcap_header
+{
+    rt_uint32_t magic;              /**< BF30A2_RAWCAP_MAGIC */
+    rt_uint16_t version;            /**< BF30A2_RAWCAP_VERSION */
+    rt_uint16_t header_size;        /**< sizeof(bf30a2_rawcap_header_t) */
+    rt_uint32_t dma_size;           /**< DMA ring size in bytes */
+    rt_uint32_t clock_hz;           /**< Record timestamp clock in Hz */
+} bf30a2_rawcap_header_t;
+
+/**
+ * @brief One capture thread wakeup, followed by len undecoded ring bytes
+ */
+typedef struct bf30a2_rawcap_record
+{
+    rt_uint32_t magic;              /**< BF30A2_RAWCAP_REC_MAGIC */
+    rt_uint32_t seq;                /**< Wakeup sequence number */
+    rt_uint32_t timestamp;          /**< Cycle counter at wakeup */
+    rt_uint32_t rx_count;           /**< DMA half/full interrupts so far */
+    rt_uint16_t rd_pos;             /**< Ring offset of the first byte */
+    rt_uint16_t wr_pos;             /**< DMA write position from CNDTR */
+    rt_uint32_t len;                /**< Payload length in bytes */
+} bf30a2_rawcap_record_t;
+
+/**
+ * @brief Raw capture sink
+ */
+typedef enum
+{
+    BF30A2_RAWCAP_SINK_MEMORY = 0,  /**< Append to a RAM/PSRAM buffer */
+    BF30A2_RAWCAP_SINK_FILE,        /**< Append to a DFS file */
+} bf30a2_rawcap_sink_t;
+
+/**
+ * @brief Raw capture configuration for BF30A2_CMD_RAWCAP_START
+ */
+typedef struct bf30a2_rawcap_cfg
+{
+    bf30a2_rawcap_sink_t sink;      /**< Capture sink */
+    rt_uint8_t *buffer;             /**< Memory sink storage, RT_NULL = allocate */
+    rt_uint32_t size;               /**< Memory sink size in bytes */
+    const char *path;               /**< File sink path */
+    rt_uint8_t no_decode;           /**< Skip the parser while capturing */
+} bf30a2_rawcap_cfg_t;
+
+/**
+ * @brief Raw capture status
+ */
+typedef struct bf30a2_rawcap_status
+{
+    rt_uint8_t active;              /**< Capture in progress */
+    bf30a2_rawcap_sink_t sink;      /**< Current or last sink */
+    rt_uint32_t records;            /**< Wakeup records written */
+    rt_uint32_t bytes;              /**< Stream bytes captured */
+    rt_uint32_t used;               /**< Capture size including headers */
+    rt_uint32_t dropped;            /**< Stream bytes lost to a full sink */
+} bf30a2_rawcap_status_t;
+
+/*===========================================================================*/
+/* Frame Latency                                                             */
+/*===========================================================================*/
+
+/**
+ * @brief Latency measurement points
+ *
+ * Every point is measured from the DMA wakeup at which the frame header
+ * was parsed, i.e. the earliest moment the driver saw the frame.
+ */
+typedef enum
+{
+    BF30A2_LAT_ASSEMBLED = 0,       /**< Last line converted */
+    BF30A2_LAT_CALLBACK,            /**< Frame callback entered */
+    BF30A2_LAT_WAIT,                /**< BF30A2_CMD_WAIT_FRAME returned */
+    BF30A2_LAT_READ,                /**< rt_device_read() finished copying */
+    BF30A2_LAT_LEASE,               /**< BF30A2_CMD_LEASE_FRAME returned */
+    BF30A2_LAT_PANEL,               /**< Viewfinder: last strip on the panel */
+    BF30A2_LAT_POINTS,
+} bf30a2_lat_point_t;
+
+/**
+ * @brief Latency summary of one measurement point, in microseconds
+ *
+ * Percentiles come from a log-linear histogram (four buckets per octave)
+ * and are accurate to about 12 %; min and max are exact.
+ */
+typedef struct bf30a2_lat_stats
+{
+    rt_uint32_t count;              /**< Frames measured */
+    rt_uint32_t min_us;             /**< Smallest latency */
+    rt_uint32_t p50_us;             /**< Median */
+    rt_uint32_t p90_us;             /**< 90th percentile */
+    rt_uint32_t p99_us;             /**< 99th percentile */
+    rt_uint32_t max_us;             /**< Largest latency */
+} bf30a2_lat_stats_t;
+
+/**
+ * @brief Latency summary for BF30A2_CMD_GET_LATENCY
+ */
+typedef struct bf30a2_latency
+{
+    bf30a2_lat_stats_t point[BF30A2_LAT_POINTS];    /**< Indexed by bf30a2_lat_point_t */
+} bf30a2_latency_t;
+
+/*===========================================================================*/
+/* Load Governor                                                             */
+/*===========================================================================*/
+
+/**
+ * @brief Output degradation levels, each including the previous ones
+ *
+ * The level is latched at every frame header, so a frame is never
+ * assembled in a mix of levels.
+ */
+typedef enum
+{
+    BF30A2_LEVEL_FULL = 0,          /**< Every frame, full resolution RGB565 */
+    BF30A2_LEVEL_SKIP,              /**< Every second frame parsed but not converted */
+    BF30A2_LEVEL_HALF,              /**< Half width and height RGB565 */
+    BF30A2_LEVEL_Y8,                /**< Half width and height, luma only */
+    BF30A2_LEVELS,
+} bf30a2_level_t;
+
+/**
+ * @brief Load governor configuration for BF30A2_CMD_SET_GOVERNOR
+ */
+typedef struct bf30a2_gov_cfg
+{
+    rt_uint8_t enable;              /**< Select the level automatically */
+    rt_uint8_t level;               /**< Fixed level while enable is 0 */
+    rt_uint8_t max_level;           /**< Deepest level the governor may select */
+    rt_uint8_t cpu_budget;          /**< Capture thread CPU budget, percent */
+    rt_uint8_t ring_budget;         /**< DMA ring backlog budget, percent of the ring */
+    rt_uint16_t window_ms;          /**< Evaluation window, 50 to 2000 ms */
+} bf30a2_gov_cfg_t;
+
+/**
+ * @brief Load governor state for BF30A2_CMD_GET_GOVERNOR
+ */
+typedef struct bf30a2_gov_status
+{
+    bf30a2_gov_cfg_t cfg;           /**< Current configuration */
+    bf30a2_level_t level;           /**< Level applied to new frames */
+    rt_uint32_t cpu_pct;            /**< Capture thread CPU in the last window */
+    rt_uint32_t ring_pct;           /**< Average ring backlog in the last window */
+    rt_uint32_t ring_peak_pct;      /**< Peak ring backlog in the last window, over 100 = overrun */
+    rt_uint32_t step_downs;         /**< Level increases */
+    rt_uint32_t step_ups;           /**< Level decreases */
+    rt_uint32_t skipped_frames;     /**< Frames parsed without conversion */
+} bf30a2_gov_status_t;
+
+/*===========================================================================*/
+/* Viewfinder                                                                */
+/*===========================================================================*/
+
+/**
+ * @brief Viewfinder configuration for BF30A2_CMD_SET_VIEWFINDER
+ *
+ * With a panel set, the next BF30A2_CMD_START converts every line straight
+ * into a small strip buffer that is drawn on the panel while the next
+ * strip is converted; no frame buffer is filled, so the frame callback,
+ * BF30A2_CMD_WAIT_FRAME, BF30A2_CMD_LEASE_FRAME and reads get no frames.
+ * The load governor stops at BF30A2_LEVEL_HALF in this mode, since the
+ * panel takes RGB565 only. Only accepted while stopped.
+ */
+typedef struct bf30a2_vf_cfg
+{
+    const char *lcd_name;           /**< RGB565 graphic device, RT_NULL to switch off */
+    rt_uint16_t x;                  /**< Panel column of the image */
+    rt_uint16_t y;                  /**< Panel row of the image */
+} bf30a2_vf_cfg_t;
+
+/**
+ * @brief Viewfinder state for BF30A2_CMD_GET_VIEWFINDER
+ */
+typedef struct bf30a2_vf_status
+{
+    rt_uint8_t enabled;             /**< A panel is set */
+    rt_uint32_t frames;             /**< Frames completed on the panel */
+    rt_uint32_t fps_milli;          /**< Panel frame rate x 1000 */
+    rt_uint32_t latency_us;         /**< Last frame, header wakeup to its last strip drawn */
+    rt_uint32_t latency_max_us;     /**< Largest frame latency */
+    rt_uint32_t strips;             /**< Strips sent */
+    rt_uint32_t stalls;             /**< Strips that waited for the panel */
+    rt_uint32_t timeouts;           /**< Panel completions that never came */
+} bf30a2_vf_status_t;
+
+/*===========================================================================*/
+/* Frame Subscribers                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief Output a subscriber receives
+ */
+typedef enum
+{
+    BF30A2_SUB_RGB565 = 0,          /**< The frame buffer, at the governor's output level */
+    BF30A2_SUB_Y8,                  /**< 240x320 luma, 1 byte per pixel */
+    BF30A2_SUB_RGB565_HALF,         /**< 120x160 RGB565 */
+    BF30A2_SUB_THUMB,               /**< The thumbnail set with BF30A2_CMD_SET_THUMBNAIL */
+    BF30A2_SUB_FORMATS,
+} bf30a2_sub_format_t;
+
+/**
+ * @brief How a subscriber receives its frames
+ */
+typedef enum
+{
+    BF30A2_SUB_CALLBACK = 0,        /**< Called in the capture thread, frame valid during the call */
+    BF30A2_SUB_QUEUE,               /**< Leased into a queue, taken with BF30A2_CMD_SUB_RECEIVE */
+} bf30a2_sub_mode_t;
+
+/**
+ * @brief Subscriber callback, from the capture thread
+ */
+typedef void (*bf30a2_sub_callback_t)(rt_device_t dev, const bf30a2_buffer_t *frame,
+                                      void *user_data);
+
+/**
+ * @brief Subscription request for BF30A2_CMD_SUBSCRIBE
+ *
+ * Each output format needed by a due subscriber is converted once per
+ * frame, from the same pass over the YUV line as the frame buffer.
+ * Queued frames are leases: return each with BF30A2_CMD_RELEASE_FRAME.
+ */
+typedef struct bf30a2_sub_cfg
+{
+    rt_uint8_t divisor;             /**< Every n-th published frame, 0 or 1 = every frame */
+    rt_uint8_t format;              /**< bf30a2_sub_format_t */
+    rt_uint8_t mode;                /**< bf30a2_sub_mode_t */
+    bf30a2_sub_callback_t callback; /**< BF30A2_SUB_CALLBACK only */
+    void *user_data;                /**< Passed to the callback */
+    int handle;                     /**< Returned subscriber handle */
+} bf30a2_sub_cfg_t;
+
+/**
+ * @brief Queue receive request for BF30A2_CMD_SUB_RECEIVE
+ */
+typedef struct bf30a2_sub_wait
+{
+    int handle;                     /**< Queue subscriber */
+    rt_uint32_t timeout_ms;         /**< 0 = do not wait */
+    bf30a2_buffer_t *buffer;        /**< Receives the leased frame */
+} bf30a2_sub_wait_t;
+
+/**
+ * @brief Subscriber statistics for BF30A2_CMD_GET_SUBSCRIBER
+ */
+typedef struct bf30a2_sub_status
+{
+    int handle;                     /**< Subscriber to report, set by the caller */
+    bf30a2_sub_cfg_t cfg;           /**< Its configuration */
+    rt_uint32_t delivered;          /**< Frames called back or queued */
+    rt_uint32_t dropped;            /**< Queued frames given back untaken for newer ones */
+    rt_uint32_t queued;             /**< Frames waiting in the queue */
+} bf30a2_sub_status_t;
+
+/*===========================================================================*/
+/* Thumbnail                                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief Thumbnail configuration for BF30A2_CMD_SET_THUMBNAIL
+ *
+ * Each thumbnail pixel is the average of a scale x scale block of the
+ * sensor image, summed from the YUV lines as they are converted, so it
+ * comes with every published frame at no second pass over the frame.
+ */
+typedef struct bf30a2_thumb_cfg
+{
+    rt_uint8_t scale;               /**< 2, 4 or 8 (120x160 .. 30x40), 0 = off */
+    bf30a2_format_t format;         /**< BF30A2_FORMAT_RGB565 or BF30A2_FORMAT_Y8 */
+} bf30a2_thumb_cfg_t;
+
+/**
+ * @brief Thumbnail request for BF30A2_CMD_GET_THUMBNAIL
+ *
+ * The thumbnail shares the frame's lease: release the frame once, by
+ * either address, when done with both.
+ */
+typedef struct bf30a2_thumb
+{
+    const bf30a2_buffer_t *frame;   /**< Frame from LEASE_FRAME or SUB_RECEIVE */
+    bf30a2_buffer_t *thumb;         /**< Receives the thumbnail of that frame */
+} bf30a2_thumb_t;
+
+/*===========================================================================*/
+/* Sensor Window                                                             */
+/*===========================================================================*/
+
+/**
+ * @brief Sensor output window for BF30A2_CMD_SET_WINDOW
+ *
+ * The sensor crops its 240x320 array to the window and can then keep
+ * every other pixel and line, so only the output is clocked over SPI.
+ * Origin and size are multiples of 2, of 4 when subsampled; the output
+ * must fit BF30A2_MAX_WIDTH x BF30A2_MAX_HEIGHT. The driver follows the
+ * new size from the next frame header.
+ */
+typedef struct bf30a2_window
+{
+    rt_uint16_t x;                  /**< First column of the window */
+    rt_uint16_t y;                  /**< First row of the window */
+    rt_uint16_t width;              /**< Window width, 0 = the whole array */
+    rt_uint16_t height;             /**< Window height */
+    rt_uint8_t subsample;           /**< 1 = every pixel, 2 = every other pixel and line */
+} bf30a2_window_t;
+
+/**
+ * @brief Window report for BF30A2_CMD_GET_WINDOW
+ */
+typedef struct bf30a2_window_status
+{
+    bf30a2_window_t window;         /**< Window set, the whole array if none */
+    rt_uint16_t out_width;          /**< Sensor output of that window */
+    rt_uint16_t out_height;         /**< Sensor output of that window */
+    rt_uint16_t width;              /**< Geometry of the last frame header accepted */
+    rt_uint16_t height;             /**< Geometry of the last frame header accepted */
+    rt_uint32_t frame_bytes;        /**< SPI bytes of one frame of that geometry */
+    rt_uint32_t saved_bytes;        /**< SPI bytes per frame saved against the whole array */
+} bf30a2_window_status_t;
+
+/*===========================================================================*/
+/* Frame Output Pipeline                                                     */
+/*===========================================================================*/
+
+/**
+ * @brief Rotation of the frame output, clockwise
+ */
+typedef enum
+{
+    BF30A2_ROTATE_0 = 0,
+    BF30A2_ROTATE_90,
+    BF30A2_ROTATE_180,
+    BF30A2_ROTATE_270,
+} bf30a2_rotate_t;
+
+/**
+ * @brief Frame output pipeline for BF30A2_CMD_SET_PIPELINE
+ *
+ * Each line is cropped, decimated by the output level, converted,
+ * mirrored and rotated into its place in the frame and counted into the
+ * statistics in a single pass while it is still in cache. Crop values are
+ * in sensor pixels and even; a crop past the frame is clipped to it. The
+ * secondary planes and the viewfinder keep the whole, unrotated image;
+ * the statistics cover the crop in either case.
+ */
+typedef struct bf30a2_pipeline
+{
+    rt_uint16_t crop_x;             /**< First column of the frame output */
+    rt_uint16_t crop_y;             /**< First line of the frame output */
+    rt_uint16_t crop_width;         /**< Columns, 0 = to the right edge */
+    rt_uint16_t crop_height;        /**< Lines, 0 = to the bottom edge */
+    rt_uint8_t rotate;              /**< bf30a2_rotate_t */
+    rt_uint8_t mirror;              /**< Mirror left to right, before rotating */
+    rt_uint8_t stats;               /**< Accumulate bf30a2_frame_stats_t */
+} bf30a2_pipeline_t;
+
+/* Luma histogram bins of bf30a2_frame_stats_t, 16 levels each */
+#define BF30A2_STATS_BINS           16
+
+/**
+ * @brief Luma statistics for BF30A2_CMD_GET_FRAME_STATS
+ *
+ * Of the luma samples the frame output is made from: the crop, every
+ * other pixel and line at the half levels, before any tone curve.
+ */
+typedef struct bf30a2_frame_stats
+{
+    rt_uint32_t frame_num;          /**< Frame the statistics are of */
+    rt_uint32_t pixels;             /**< Luma samples */
+    rt_uint32_t luma_sum;           /**< Sum of the samples */
+    rt_uint8_t luma_min;            /**< Darkest sample */
+    rt_uint8_t luma_max;            /**< Brightest sample */
+    rt_uint32_t hist[BF30A2_STATS_BINS];    /**< Samples per bin */
+} bf30a2_frame_stats_t;
+
+/**
+ * @brief Tone curve for BF30A2_CMD_SET_TONE
+ *
+ * 256-entry tables applied inside the frame output conversion, so a
+ * brightness, contrast or gamma change costs no pass of its own: y maps
+ * the luma before it is converted, r, g and b then map the channels of
+ * RGB565 output as 8-bit values. RT_NULL leaves that one unchanged. The
+ * tables are copied; the curve takes effect whole at the next frame
+ * start. The secondary planes and the thumbnail are not toned.
+ */
+typedef struct bf30a2_tone_cfg
+{
+    const rt_uint8_t *y;            /**< Luma curve, RT_NULL = identity */
+    const rt_uint8_t *r;            /**< Red curve, RT_NULL = identity */
+    const rt_uint8_t *g;            /**< Green curve, RT_NULL = identity */
+    const rt_uint8_t *b;            /**< Blue curve, RT_NULL = identity */
+} bf30a2_tone_cfg_t;
+
+/*===========================================================================*/
+/* Change Detection                                                          */
+/*===========================================================================*/
+
+/* Fingerprint blocks across and down the frame */
+#define BF30A2_CHANGE_GRID          8
+
+/**
+ * @brief What change detection does with an unchanged frame
+ */
+typedef enum
+{
+    BF30A2_CHANGE_OFF = 0,          /**< No fingerprint */
+    BF30A2_CHANGE_MARK,             /**< Deliver it with bf30a2_buffer_t.unchanged set */
+    BF30A2_CHANGE_SUPPRESS,         /**< Do not publish it */
+} bf30a2_change_mode_t;
+
+/**
+ * @brief Change detection for BF30A2_CMD_SET_CHANGE
+ *
+ * Each frame's fingerprint is the mean luma of a grid of blocks, sampled
+ * every fourth pixel of every fourth line while the lines are converted.
+ * A frame is unchanged when no more than blocks of them moved more than
+ * threshold luma levels from the last frame found changed, and its output
+ * level, geometry and tone curve are the same.
+ */
+typedef struct bf30a2_change_cfg
+{
+    rt_uint8_t mode;                /**< bf30a2_change_mode_t */
+    rt_uint8_t threshold;           /**< Block mean luma change that counts, levels */
+    rt_uint8_t blocks;              /**< Changed blocks an unchanged frame may have */
+} bf30a2_change_cfg_t;
+
+/**
+ * @brief Change detection result for BF30A2_CMD_GET_CHANGE
+ */
+typedef struct bf30a2_change_info
+{
+    rt_uint32_t frames;             /**< Frames compared */
+    rt_uint32_t unchanged;          /**< Of those, found unchanged */
+    rt_uint32_t suppressed;         /**< Of those, not published */
+    rt_uint8_t last_unchanged;      /**< The last frame compared was unchanged */
+    rt_uint8_t last_blocks;         /**< Its blocks over the threshold */
+    rt_uint8_t last_delta;          /**< Its largest block mean luma change, levels */
+} bf30a2_change_info_t;
+
+/*===========================================================================*/
+/* Sensor Descriptor                                                         */
+/*===========================================================================*/
+
+/** @brief End of a register list */
+#define BF30A2_REGLIST_TAIL         0xFFFE
+
+/** @brief Register list entry that waits val milliseconds */
+#define BF30A2_REG_DLY              0xFFFF
+
+/**
+ * @brief Register address-value pair
+ */
+typedef struct bf30a2_reg
+{
+    rt_uint16_t reg;                /**< Register, or BF30A2_REG_DLY / BF30A2_REGLIST_TAIL */
+    rt_uint8_t val;                 /**< Value, or the delay in ms */
+} bf30a2_reg_t;
+
+/**
+ * @brief Packet type codes of the SPI stream protocol
+ *
+ * Every packet starts with three 0xFF bytes and a type code; the frame
+ * header, line header and data header layouts are common to the sensors
+ * of this family, the codes are not.
+ */
+typedef struct bf30a2_proto
+{
+    rt_uint8_t frame_start;         /**< Frame header, followed by format, width and height */
+    rt_uint8_t line_start;          /**< Line header, followed by the line number */
+    rt_uint8_t frame_end;           /**< Frame end */
+    rt_uint8_t data_type;           /**< Data header type of a YUV422 line */
+} bf30a2_proto_t;
+
+/**
+ * @brief Register access handed to a sensor's post_init hook
+ */
+typedef struct bf30a2_sensor_io
+{
+    void *ctx;                                              /**< Driver context */
+    rt_err_t (*read)(void *ctx, rt_uint8_t reg, rt_uint8_t *val);   /**< Read a register */
+    rt_err_t (*write)(void *ctx, rt_uint8_t reg, rt_uint8_t val);   /**< Write a register */
+} bf30a2_sensor_io_t;
+
+/**
+ * @brief Everything the capture engine needs to know about one SPI sensor
+ *
+ * The engine (power sequence, MCLK, SPI DMA ring, parser, conversion,
+ * buffering, statistics and shell commands) takes the sensor specifics
+ * from this descriptor only, so another sensor of the same SPI protocol
+ * family is supported by a descriptor in bf30a2_hw_cfg_t.sensor.
+ */
+typedef struct bf30a2_sensor_desc
+{
+    const char *name;               /**< Sensor name for logs */
+    rt_uint8_t i2c_addr;            /**< 7-bit address, used when the hw_cfg one is 0 */
+    rt_uint8_t id_reg_h;            /**< Chip ID high byte register */
+    rt_uint8_t id_reg_l;            /**< Chip ID low byte register */
+    rt_uint16_t chip_id;            /**< Expected chip ID */
+    const bf30a2_reg_t *init_regs;  /**< Init sequence, BF30A2_REGLIST_TAIL terminated */
+    rt_err_t (*post_init)(const bf30a2_sensor_io_t *io);   /**< After init_regs, optional */
+
+    /* Geometry */
+    rt_uint16_t array_width;        /**< Output of the whole array, pixels */
+    rt_uint16_t array_height;       /**< Output of the whole array, lines */
+
+    /* Output window, see bf30a2_window_t */
+    rt_uint8_t win_unit;            /**< Pixels per window register step, 0 = no window */
+    rt_uint8_t win_hstart;          /**< First column register */
+    rt_uint8_t win_hstop;           /**< Column register past the window */
+    rt_uint8_t win_vstart;          /**< First row register */
+    rt_uint8_t win_vstop;           /**< Row register past the window */
+    rt_uint8_t win_subsample;       /**< Subsampling register */
+    rt_uint8_t win_subsample_2;     /**< Its value for 1/2 subsampling */
+
+    bf30a2_proto_t proto;           /**< Stream protocol variant */
+} bf30a2_sensor_desc_t;
+
+/** @brief BF30A2 (chip ID 0x3B02), the default sensor */
+extern const bf30a2_sensor_desc_t bf30a2_sensor_bf30a2;
+
 /*===========================================================================*/
 /* Hardware Configuration Structure                                          */
 /*===========================================================================*/
@@ -176,9 +817,10 @@ typedef struct bf30a2_hw_cfg
     const char *spi_bus_name;       /**< SPI bus device name */
     const char *i2c_bus_name;       /**< I2C bus device name */
     const char *pwm_dev_name;       /**< PWM device name */
-    rt_uint8_t i2c_addr;            /**< I2C slave address */
+    rt_uint8_t i2c_addr;            /**< I2C slave address, 0 = the sensor's */
     rt_uint8_t pwm_channel;         /**< PWM channel number */
     bf30a2_pin_cfg_t pins;          /**< Pin configuration */
+    const bf30a2_sensor_desc_t *sensor;     /**< Sensor, RT_NULL = bf30a2_sensor_bf30a2 */
 } bf30a2_hw_cfg_t;
 
 /*===========================================================================*/
@@ -0,0 +1,442 @@
+/**
+ * @file    bf30a2_bench.c
+ * @brief   BF30A2 capture pipeline micro-benchmarks
+ *
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <rtthread.h>
+#include <string.h>
+
+#include "bf30a2_bench.h"
+
+#ifdef BF30A2_USING_BENCH
+
+#include "bf30a2_convert.h"
+#include "bf30a2_core.h"
+#include "bf30a2_port.h"
+
+/* Stream bytes of one synthetic frame: header, lines, end marker */
+#define BENCH_FRAME_STREAM          FRAME_STREAM_SIZE(IMG_WIDTH, IMG_HEIGHT)
+
+typedef struct
+{
+    bf30a2_core_t core;
+    rt_uint8_t *frame;                  /* Core RGB565 output */
+    rt_uint8_t *copy;                   /* Reader buffer for publish.copy */
+    rt_uint8_t line[ONE_LINE_TOTAL];    /* Line packet, number patched per line */
+    char hex[BF30A2_EXPORT_HEX_PER_LINE * 2 + 1];
+    volatile rt_uint32_t published;
+    volatile rt_uint32_t sink;          /* Result of the reference loop */
+} bench_ctx_t;
+
+typedef struct
+{
+    const char *name;
+    const char *unit;
+    rt_uint32_t iters;                  /* Iterations per repetition at scale 1 */
+    rt_uint32_t units;                  /* Units per iteration */
+    void (*run)(bench_ctx_t *ctx, rt_uint32_t iters);
+} bench_case_t;
+
+static const rt_uint8_t frame_header[FRAME_HEADER_SIZE] =
+{
+    0xFF, 0xFF, 0xFF, 0x01, 0x00,
+    (IMG_WIDTH >> 8) & 0xFF, IMG_WIDTH & 0xFF,
+    (IMG_HEIGHT >> 8) & 0xFF, IMG_HEIGHT & 0xFF,
+};
+
+static const rt_uint8_t frame_end[4] = { 0xFF, 0xFF, 0xFF, 0x00 };
+
+/*============================================================================*/
+/*                     SYNTHETIC STREAM                                       */
+/*============================================================================*/
+
+static void bench_line_init(bench_ctx_t *ctx)
+{
+    rt_uint8_t *p = ctx->line;
+    int i;
+
+    *p++ = 0xFF; *p++ = 0xFF; *p++ = 0xFF; *p++ = 0x02;
+    *p++ = 0x00; *p++ = 0x00;
+    *p++ = 0xFF; *p++ = 0xFF; *p++ = 0xFF; *p++ = 0x40;
+    *p++ = (BYTES_PER_LINE >> 8) & 0xFF;
+    *p++ = BYTES_PER_LINE & 0xFF;
+
+    /* Luma ramp with varying chroma, so every conversion branch is taken */
+    for (i = 0; i < BYTES_PER_LINE; i += 4)
+    {
+        p[i + 0] = (rt_uint8_t)(i / 2);
+        p[i + 1] = (rt_uint8_t)(64 + i / 4);
+        p[i + 2] = (rt_uint8_t)(i / 2 + 1);
+        p[i + 3] = (rt_uint8_t)(192 - i / 4);
+    }
+}
+
+static void bench_feed_frame(bench_ctx_t *ctx)
+{
+    rt_uint16_t line;
+
+    bf30a2_core_feed(&ctx->core, frame_header, sizeof(frame_header));
+    for (line = 0; line < IMG_HEIGHT; line++)
+    {
+        ctx->line[4] = line >> 8;
+        ctx->line[5] = line & 0xFF;
+        bf30a2_core_feed(&ctx->core, ctx->line, ONE_LINE_TOTAL);
+    }
+    bf30a2_core_feed(&ctx->core, frame_end, sizeof(frame_end));
+}
+
+static void bench_frame_hook(bf30a2_core_t *core, void *ctx)
+{
+    ((bench_ctx_t *)ctx)->published++;
+}
+
+/*============================================================================*/
+/*                     CASES                                                  */
+/*============================================================================*/
+
+/* Framing and line assembly only: without an output buffer lines are dropped */
+static void run_parse(bench_ctx_t *ctx, rt_uint32_t iters)
+{
+    ctx->core.frame_rgb565 = RT_NULL;
+    while (iters--)
+    {
+        bench_feed_frame(ctx);
+    }
+    ctx->core.frame_rgb565 = ctx->frame;
+}
+
+/* Parser plus per-line conversion, the capture thread's hot path */
+static void run_decode(bench_ctx_t *ctx, rt_uint32_t iters)
+{
+    while (iters--)
+    {
+        bench_feed_frame(ctx);
+    }
+}
+
+/* The same, lines stored as received for lazy conversion */
+static void run_decode_raw(bench_ctx_t *ctx, rt_uint32_t iters)
+{
+    ctx->core.keep_raw = 1;
+    while (iters--)
+    {
+        bench_feed_frame(ctx);
+    }
+    ctx->core.keep_raw = 0;
+}
+
+/* The same through the generic pipeline walk: rotated, with statistics */
+static void run_decode_rot90(bench_ctx_t *ctx, rt_uint32_t iters)
+{
+    static const bf30a2_pipeline_t rot90 = { 0, 0, 0, 0, BF30A2_ROTATE_90, 0, 1 };
+
+    ctx->core.pipeline = rot90;
+    while (iters--)
+    {
+        bench_feed_frame(ctx);
+    }
+    rt_memset(&ctx->core.pipeline, 0, sizeof(ctx->core.pipeline));
+}
+
+static void run_decode_tone(bench_ctx_t *ctx, rt_uint32_t iters)
+{
+    static bf30a2_tone_t tone;
+
+    /* Luma and channel curves: the most a toned line does */
+    bf30a2_tone_curve(tone.y, 10, 120, 180);
+    bf30a2_tone_curve(tone.rgb[0], 0, 100, 120);
+    rt_memcpy(tone.rgb[1], tone.rgb[0], sizeof(tone.rgb[0]));
+    rt_memcpy(tone.rgb[2], tone.rgb[0], sizeof(tone.rgb[0]));
+    tone.has_rgb = 1;
+
+    ctx->core.tone = &tone;
+    while (iters--)
+    {
+        bench_feed_frame(ctx);
+    }
+    ctx->core.tone = RT_NULL;
+}
+
+static void run_decode_change(bench_ctx_t *ctx, rt_uint32_t iters)
+{
+    /* Marked, not suppressed: every frame still converted and published */
+    ctx->core.change.cfg.mode = BF30A2_CHANGE_MARK;
+    while (iters--)
+    {
+        bench_feed_frame(ctx);
+    }
+
+    /* The latched mode too: the publish case ends frames it never starts */
+    ctx->core.change.cfg.mode = BF30A2_CHANGE_OFF;
+    ctx->core.change.mode = BF30A2_CHANGE_OFF;
+}
+
+static void run_convert(bench_ctx_t *ctx, rt_uint32_t iters)
+{
+    const rt_uint8_t *yuv = ctx->line + LINE_HEADER_SIZE + DATA_HEADER_SIZE;
+    rt_uint32_t line = 0;
+
+    while (iters--)
+    {
+        bf30a2_yuv_line_to_rgb565(yuv, ctx->frame + line * BYTES_PER_LINE, IMG_WIDTH);
+        line = (line + 1 == IMG_HEIGHT) ? 0 : line + 1;
+    }
+}
+
+static void run_convert_half(bench_ctx_t *ctx, rt_uint32_t iters)
+{
+    const rt_uint8_t *yuv = ctx->line + LINE_HEADER_SIZE + DATA_HEADER_SIZE;
+    rt_uint32_t line = 0;
+
+    while (iters--)
+    {
+        bf30a2_yuv_line_to_rgb565_half(yuv, ctx->frame + line * (BYTES_PER_LINE / 2), IMG_WIDTH);
+        line = (line + 1 == IMG_HEIGHT / 2) ? 0 : line + 1;
+    }
+}
+
+static void run_convert_y8(bench_ctx_t *ctx, rt_uint32_t iters)
+{
+    const rt_uint8_t *yuv = ctx->line + LINE_HEADER_SIZE + DATA_HEADER_SIZE;
+    rt_uint32_t line = 0;
+
+    while (iters--)
+    {
+        bf30a2_yuv_line_to_y8_half(yuv, ctx->frame + line * (IMG_WIDTH / 2), IMG_WIDTH);
+        line = (line + 1 == IMG_HEIGHT / 2) ? 0 : line + 1;
+    }
+}
+
+/* Full resolution RGB565 and luma plane in one pass */
+static void run_convert_rgb565_y8(bench_ctx_t *ctx, rt_uint32_t iters)
+{
+    const rt_uint8_t *yuv = ctx->line + LINE_HEADER_SIZE + DATA_HEADER_SIZE;
+    rt_uint32_t line = 0;
+
+    while (iters--)
+    {
+        bf30a2_yuv_line_to_rgb565_y8(yuv, ctx->frame + line * BYTES_PER_LINE,
+                                     ctx->copy + line * IMG_WIDTH, IMG_WIDTH);
+        line = (line + 1 == IMG_HEIGHT) ? 0 : line + 1;
+    }
+}
+
+/* Quarter size Y8 thumbnail: every line summed, every fourth written */
+static void run_thumb_y8(bench_ctx_t *ctx, rt_uint32_t iters)
+{
+    const rt_uint8_t *yuv = ctx->line + LINE_HEADER_SIZE + DATA_HEADER_SIZE;
+    rt_uint32_t line = 0;
+
+    while (iters--)
+    {
+        bf30a2_thumb_accumulate(yuv, ctx->core.thumb_acc, IMG_WIDTH, 4, 0, (line & 3) == 0);
+        if ((line & 3) == 3)
+        {
+            bf30a2_thumb_emit(ctx->core.thumb_acc, ctx->copy + (line / 4) * (IMG_WIDTH / 4),
+                              IMG_WIDTH / 4, 4, 4, BF30A2_FORMAT_Y8);
+        }
+        line = (line + 1 == IMG_HEIGHT) ? 0 : line + 1;
+    }
+}
+
+/* Dual-lane capture back to the byte stream, per stream byte */
+static void run_lanes(bench_ctx_t *ctx, rt_uint32_t iters)
+{
+    while (iters--)
+    {
+        bf30a2_lanes_deinterleave(ctx->frame, ctx->frame + ONE_FRAME_SIZE / 2, ctx->copy,
+                                  ONE_FRAME_SIZE / 2);
+    }
+}
+
+/* Frame end marker through publication to the frame hook */
+static void run_publish(bench_ctx_t *ctx, rt_uint32_t iters)
+{
+    while (iters--)
+    {
+        ctx->core.in_frame = 1;
+        ctx->core.lines_received = IMG_HEIGHT;
+        bf30a2_core_feed(&ctx->core, frame_end, sizeof(frame_end));
+    }
+}
+
+/* Reader copy-out, as done by rt_device_read() */
+static void run_publish_copy(bench_ctx_t *ctx, rt_uint32_t iters)
+{
+    while (iters--)
+    {
+        rt_memcpy(ctx->copy, ctx->frame, ONE_FRAME_SIZE);
+    }
+}
+
+/* UART frame export formatting, without the UART */
+static void run_export(bench_ctx_t *ctx, rt_uint32_t iters)
+{
+    rt_uint32_t i, n;
+
+    while (iters--)
+    {
+        for (i = 0; i < ONE_FRAME_SIZE; i += BF30A2_EXPORT_HEX_PER_LINE)
+        {
+            n = ONE_FRAME_SIZE - i;
+            if (n > BF30A2_EXPORT_HEX_PER_LINE)
+            {
+                n = BF30A2_EXPORT_HEX_PER_LINE;
+            }
+            bf30a2_hex_encode(ctx->frame + i, n, ctx->hex);
+        }
+    }
+}
+
+/*
+ * Reference: a serial byte loop over the frame that no driver change
+ * touches. The baseline checker scales every case by it, so one baseline
+ * holds on faster or slower machines of the same kind.
+ */
+static void run_ref(bench_ctx_t *ctx, rt_uint32_t iters)
+{
+    rt_uint32_t sum = 0;
+    rt_uint32_t i;
+
+    while (iters--)
+    {
+        for (i = 0; i < ONE_FRAME_SIZE; i++)
+        {
+            sum = (sum << 1) + (sum >> 31) + ctx->frame[i];
+        }
+    }
+    ctx->sink = sum;
+}
+
+static const bench_case_t bench_cases[] =
+{
+    { "ref.loop",               "ns/byte",  2,    ONE_FRAME_SIZE,     run_ref },
+    { "parse",                  "ns/byte",  2,    BENCH_FRAME_STREAM, run_parse },
+    { "decode",                 "ns/byte",  2,    BENCH_FRAME_STREAM, run_decode },
+    { "decode.raw",             "ns/byte",  2,    BENCH_FRAME_STREAM, run_decode_raw },
+    { "decode.rot90_stats",     "ns/byte",  2,    BENCH_FRAME_STREAM, run_decode_rot90 },
+    { "decode.tone",            "ns/byte",  2,    BENCH_FRAME_STREAM, run_decode_tone },
+    { "decode.change",          "ns/byte",  2,    BENCH_FRAME_STREAM, run_decode_change },
+    { "convert.yuv422_rgb565",  "ns/line",  IMG_HEIGHT, 1,            run_convert },
+    { "convert.rgb565_half",    "ns/line",  IMG_HEIGHT, 1,            run_convert_half },
+    { "convert.y8_half",        "ns/line",  IMG_HEIGHT, 1,            run_convert_y8 },
+    { "convert.rgb565_y8",      "ns/line",  IMG_HEIGHT, 1,            run_convert_rgb565_y8 },
+    { "convert.thumb_y8_q4",    "ns/line",  IMG_HEIGHT, 1,            run_thumb_y8 },
+    { "lanes.deinterleave",     "ns/byte",  2,    ONE_FRAME_SIZE,     run_lanes },
+    { "publish",                "ns/frame", 1000, 1,                  run_publish },
+    { "publish.copy",           "ns/byte",  4,    ONE_FRAME_SIZE,     run_publish_copy },
+    { "export.hex",             "ns/byte",  2,    ONE_FRAME_SIZE,     run_export },
+};
+
+/*============================================================================*/
+/*                     RUNNER                                                 */
+/*============================================================================*/
+
+/**
+ * @brief Cycles for a number of units to ns x 1000 per unit
+ *
+ * Each repetition is kept well below the counter wrap, so a 32-bit cycle
+ * delta is enough.
+ */
+static rt_uint32_t bench_milli_ns(rt_uint32_t cycles, rt_uint64_t units)
+{
+    rt_uint64_t ps = (rt_uint64_t)cycles * 1000000000ULL / (bf30a2_port_cycles_hz() / 1000);
+    rt_uint64_t v = ps / units;
+
+    return (v > 0xFFFFFFFFULL) ? 0xFFFFFFFFUL : (rt_uint32_t)v;
+}
+
+int bf30a2_bench_run(rt_uint32_t scale, bf30a2_bench_result_t *results, int max)
+{
+    bench_ctx_t *ctx;
+    rt_uint32_t iters, t0, dt, best;
+    int count = 0;
+    int i, rep;
+
+    if ((results == RT_NULL) || (max <= 0))
+    {
+        return -RT_EINVAL;
+    }
+    if (scale == 0)
+    {
+        scale = 1;
+    }
+
+    ctx = rt_malloc(sizeof(*ctx));
+    if (ctx == RT_NULL)
+    {
+        return -RT_ENOMEM;
+    }
+    rt_memset(ctx, 0, sizeof(*ctx));
+    ctx->frame = rt_malloc(ONE_FRAME_SIZE);
+    ctx->copy = rt_malloc(ONE_FRAME_SIZE);
+    if ((ctx->frame == RT_NULL) || (ctx->copy == RT_NULL))
+    {
+        rt_free(ctx->frame);
+        rt_free(ctx->copy);
+        rt_free(ctx);
+        return -RT_ENOMEM;
+    }
+
+    bf30a2_port_cycles_init();
+    bench_line_init(ctx);
+    bf30a2_core_reset(&ctx->core);
+    ctx->core.frame_rgb565 = ctx->frame;
+    ctx->core.on_frame = bench_frame_hook;
+    ctx->core.hook_ctx = ctx;
+
+    /* Warm the caches and fill the frame buffer with converted data */
+    bench_feed_frame(ctx);
+
+    for (i = 0; (i < (int)(sizeof(bench_cases) / sizeof(bench_cases[0]))) && (count < max); i++)
+    {
+        const bench_case_t *c = &bench_cases[i];
+
+        iters = c->iters * scale;
+        best = 0xFFFFFFFFUL;
+        for (rep = 0; rep < BF30A2_BENCH_REPS; rep++)
+        {
+            t0 = bf30a2_port_cycles();
+            c->run(ctx, iters);
+            dt = bf30a2_port_cycles() - t0;
+            if (dt < best)
+            {
+                best = dt;
+            }
+        }
+
+        results[count].name = c->name;
+        results[count].unit = c->unit;
+        results[count].iters = iters * c->units;
+        results[count].value_milli = bench_milli_ns(best, (rt_uint64_t)iters * c->units);
+        count++;
+    }
+
+    rt_free(ctx->copy);
+    rt_free(ctx->frame);
+    rt_free(ctx);
+
+    return count;
+}
+
+void bf30a2_bench_print(const char *platform, const bf30a2_bench_result_t *results,
+                        int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        rt_kprintf("{\"bench\":\"%s\",\"unit\":\"%s\",\"value\":%u.%03u,\"iters\":%u,"
+                   "\"platform\":\"%s\"}\n",
+                   results[i].name, results[i].unit,
+                   (unsigned int)(results[i].value_milli / 1000),
+                   (unsigned int)(results[i].value_milli % 1000),
+                   (unsigned int)results[i].iters, platform);
+    }
+}
+
+#endif /* BF30A2_USING_BENCH */
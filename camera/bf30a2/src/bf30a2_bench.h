@@ -0,0 +1,65 @@
+/**
+ * @file    bf30a2_bench.h
+ * @brief   BF30A2 capture pipeline micro-benchmarks (internal)
+ *
+ * Runs the parser, the conversion kernels, frame publication and the
+ * export encoder on a private core instance and a synthetic stream, so
+ * the same cases run from the bf30a2_bench shell command on the target
+ * and from tools/host/bf30a2_bench. Results are printed as JSON lines
+ * and compared against a baseline by tools/bf30a2_bench_check.py.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_BENCH_H__
+#define __BF30A2_BENCH_H__
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef BF30A2_USING_BENCH
+
+#define BF30A2_BENCH_MAX_RESULTS    20
+
+/* Repetitions per case, the fastest one is reported */
+#define BF30A2_BENCH_REPS           5
+
+/**
+ * @brief One benchmark result, lower is better for every case
+ */
+typedef struct bf30a2_bench_result
+{
+    const char *name;                   /**< Case name, e.g. "parse" */
+    const char *unit;                   /**< "ns/byte", "ns/line", "ns/frame" */
+    rt_uint32_t iters;                  /**< Units timed per repetition */
+    rt_uint32_t value_milli;            /**< Fastest repetition, unit x 1000 */
+} bf30a2_bench_result_t;
+
+/**
+ * @brief Run all cases
+ *
+ * @param scale   Iteration multiplier, 1 keeps each case short on target
+ * @param results Output array
+ * @param max     Capacity of results
+ *
+ * @return Number of results, or a negative error code
+ */
+int bf30a2_bench_run(rt_uint32_t scale, bf30a2_bench_result_t *results, int max);
+
+/**
+ * @brief Print results as JSON lines tagged with a platform name
+ */
+void bf30a2_bench_print(const char *platform, const bf30a2_bench_result_t *results,
+                        int count);
+
+#endif /* BF30A2_USING_BENCH */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BF30A2_BENCH_H__ */
@@ -0,0 +1,317 @@
+/**
+ * @file    bf30a2_convert.c
+ * @brief   BF30A2 pixel conversion for applications
+ *
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <rtthread.h>
+#include <string.h>
+
+#include "bf30a2_convert.h"
+#include "bf30a2_core.h"
+
+/*============================================================================*/
+/*                     STRIDED KERNELS                                        */
+/*============================================================================*/
+
+void bf30a2_convert_yuv422_to_rgb565(const rt_uint8_t *src, rt_int32_t src_stride,
+                                     rt_uint8_t *dst, rt_int32_t dst_stride,
+                                     int width, int height)
+{
+    for (; height > 0; height--, src += src_stride, dst += dst_stride)
+    {
+        bf30a2_yuv_line_to_rgb565(src, dst, width);
+    }
+}
+
+void bf30a2_convert_yuv422_to_y8(const rt_uint8_t *src, rt_int32_t src_stride,
+                                 rt_uint8_t *dst, rt_int32_t dst_stride,
+                                 int width, int height)
+{
+    for (; height > 0; height--, src += src_stride, dst += dst_stride)
+    {
+        bf30a2_yuv_line_to_y8(src, dst, width);
+    }
+}
+
+void bf30a2_convert_yuv422_to_rgb565_half(const rt_uint8_t *src, rt_int32_t src_stride,
+                                          rt_uint8_t *dst, rt_int32_t dst_stride,
+                                          int width, int height)
+{
+    for (height /= 2; height > 0; height--, src += 2 * src_stride, dst += dst_stride)
+    {
+        bf30a2_yuv_line_to_rgb565_half(src, dst, width);
+    }
+}
+
+void bf30a2_convert_yuv422_to_y8_half(const rt_uint8_t *src, rt_int32_t src_stride,
+                                      rt_uint8_t *dst, rt_int32_t dst_stride,
+                                      int width, int height)
+{
+    for (height /= 2; height > 0; height--, src += 2 * src_stride, dst += dst_stride)
+    {
+        bf30a2_yuv_line_to_y8_half(src, dst, width);
+    }
+}
+
+void bf30a2_convert_copy(const rt_uint8_t *src, rt_int32_t src_stride,
+                         rt_uint8_t *dst, rt_int32_t dst_stride,
+                         rt_uint32_t row_bytes, int height)
+{
+    /* Both packed and running the same way: one copy */
+    if ((src_stride == dst_stride) && ((rt_uint32_t)src_stride == row_bytes))
+    {
+        rt_memcpy(dst, src, row_bytes * height);
+        return;
+    }
+
+    for (; height > 0; height--, src += src_stride, dst += dst_stride)
+    {
+        rt_memcpy(dst, src, row_bytes);
+    }
+}
+
+/*============================================================================*/
+/*                     CHECKED CONVERSION                                     */
+/*============================================================================*/
+
+static int convert_bpp(bf30a2_format_t format)
+{
+    return (format == BF30A2_FORMAT_Y8) ? 1 : 2;
+}
+
+/**
+ * @brief Resolve the rectangle of src and the address of its first pixel
+ */
+static const rt_uint8_t *convert_origin(const bf30a2_image_t *src, const bf30a2_rect_t *rect,
+                                        bf30a2_rect_t *r)
+{
+    if (rect == RT_NULL)
+    {
+        r->x = 0;
+        r->y = 0;
+        r->width = src->width;
+        r->height = src->height;
+    }
+    else
+    {
+        *r = *rect;
+    }
+
+    if ((src->data == RT_NULL) || (r->width == 0) || (r->height == 0) ||
+        ((rt_uint32_t)r->x + r->width > src->width) ||
+        ((rt_uint32_t)r->y + r->height > src->height) ||
+        ((src->format == BF30A2_FORMAT_YUV422) && ((r->x & 1) || (r->width & 1))))
+    {
+        return RT_NULL;
+    }
+
+    return src->data + (rt_int32_t)r->y * src->stride + r->x * convert_bpp(src->format);
+}
+
+rt_err_t bf30a2_convert(const bf30a2_image_t *src, const bf30a2_rect_t *rect,
+                        const bf30a2_image_t *dst)
+{
+    const rt_uint8_t *in;
+    bf30a2_rect_t r;
+    int half;
+
+    if ((src == RT_NULL) || (dst == RT_NULL) || (dst->data == RT_NULL))
+    {
+        return -RT_EINVAL;
+    }
+    in = convert_origin(src, rect, &r);
+    if (in == RT_NULL)
+    {
+        return -RT_EINVAL;
+    }
+
+    if ((dst->width == r.width) && (dst->height == r.height))
+    {
+        half = 0;
+    }
+    else if ((dst->width == r.width / 2) && (dst->height == r.height / 2))
+    {
+        half = 1;
+    }
+    else
+    {
+        return -RT_EINVAL;
+    }
+
+    if (src->format == BF30A2_FORMAT_YUV422)
+    {
+        switch (dst->format)
+        {
+        case BF30A2_FORMAT_RGB565:
+            if (half)
+            {
+                bf30a2_convert_yuv422_to_rgb565_half(in, src->stride, dst->data, dst->stride,
+                                                     r.width, r.height);
+            }
+            else
+            {
+                bf30a2_convert_yuv422_to_rgb565(in, src->stride, dst->data, dst->stride,
+                                                r.width, r.height);
+            }
+            return RT_EOK;
+
+        case BF30A2_FORMAT_Y8:
+            if (half)
+            {
+                bf30a2_convert_yuv422_to_y8_half(in, src->stride, dst->data, dst->stride,
+                                                 r.width, r.height);
+            }
+            else
+            {
+                bf30a2_convert_yuv422_to_y8(in, src->stride, dst->data, dst->stride,
+                                            r.width, r.height);
+            }
+            return RT_EOK;
+
+        default:
+            break;
+        }
+    }
+
+    /* Same format, same size: a copy */
+    if ((dst->format != src->format) || half)
+    {
+        return -RT_EINVAL;
+    }
+    bf30a2_convert_copy(in, src->stride, dst->data, dst->stride,
+                        (rt_uint32_t)r.width * convert_bpp(src->format), r.height);
+
+    return RT_EOK;
+}
+
+rt_err_t bf30a2_convert_box(const bf30a2_image_t *src, const bf30a2_rect_t *rect,
+                            const bf30a2_image_t *dst)
+{
+    rt_uint16_t acc[3][IMG_WIDTH / 2];
+    const rt_uint8_t *in;
+    rt_uint8_t *out;
+    bf30a2_rect_t r;
+    int scale, bpp, row, col, cols, i;
+
+    if ((src == RT_NULL) || (dst == RT_NULL) || (dst->data == RT_NULL) ||
+        (src->format != BF30A2_FORMAT_YUV422) || (dst->format == BF30A2_FORMAT_YUV422) ||
+        (dst->width == 0))
+    {
+        return -RT_EINVAL;
+    }
+    in = convert_origin(src, rect, &r);
+    if (in == RT_NULL)
+    {
+        return -RT_EINVAL;
+    }
+
+    scale = r.width / dst->width;
+    if (((scale != 2) && (scale != 4) && (scale != 8)) ||
+        (dst->width != r.width / scale) || (dst->height != r.height / scale))
+    {
+        return -RT_EINVAL;
+    }
+    bpp = convert_bpp(dst->format);
+
+    for (row = 0; row < dst->height; row++)
+    {
+        out = dst->data + (rt_int32_t)row * dst->stride;
+
+        /* The column sums hold IMG_WIDTH / 2 output pixels: wider rows go in parts */
+        for (col = 0; col < dst->width; col += cols)
+        {
+            cols = dst->width - col;
+            if (cols > IMG_WIDTH / 2)
+            {
+                cols = IMG_WIDTH / 2;
+            }
+            for (i = 0; i < scale; i++)
+            {
+                bf30a2_thumb_accumulate(in + (rt_int32_t)(row * scale + i) * src->stride +
+                                        col * scale * 2, acc, cols * scale, scale, bpp == 2,
+                                        i == 0);
+            }
+            bf30a2_thumb_emit(acc, out + col * bpp, cols, scale, scale, dst->format);
+        }
+    }
+
+    return RT_EOK;
+}
+
+/*============================================================================*/
+/*                     TONE CURVES                                            */
+/*============================================================================*/
+
+/**
+ * @brief log2(v) of v >= 1, 16 fractional bits
+ */
+static rt_int32_t tone_log2(rt_uint32_t v)
+{
+    rt_int32_t n = 0;
+    rt_uint64_t x;
+    int i;
+
+    while ((v >> n) > 1)
+    {
+        n++;
+    }
+
+    /* v / 2^n in [1, 2); each squaring yields one more bit of the fraction */
+    x = ((rt_uint64_t)v << 16) >> n;
+    n <<= 16;
+    for (i = 15; i >= 0; i--)
+    {
+        x = (x * x) >> 16;
+        if (x >= (2U << 16))
+        {
+            x >>= 1;
+            n += 1 << i;
+        }
+    }
+
+    return n;
+}
+
+/**
+ * @brief 2^e of e <= 0, both with 16 fractional bits
+ */
+static rt_uint32_t tone_exp2(rt_int32_t e)
+{
+    rt_int32_t whole = -((-e + 0xFFFF) >> 16);
+    rt_uint64_t f = (rt_uint32_t)(e - whole * 65536);
+    rt_uint64_t p;
+
+    if (whole <= -16)
+    {
+        return 0;
+    }
+
+    /* 2^f on [0, 1) by a cubic, within 2e-4 */
+    p = 65536 + ((f * (45608 + ((f * (14742 + ((f * 5186) >> 16))) >> 16))) >> 16);
+
+    return (rt_uint32_t)(p >> -whole);
+}
+
+void bf30a2_tone_curve(rt_uint8_t lut[256], int brightness, int contrast, int gamma)
+{
+    rt_int32_t top = tone_log2(255);
+    rt_int64_t e;
+    int v, x;
+
+    for (v = 0; v < 256; v++)
+    {
+        x = (v - 128) * contrast / 100 + 128 + brightness;
+        x = (x < 0) ? 0 : ((x > 255) ? 255 : x);
+
+        if ((gamma > 0) && (gamma != 100) && (x != 0))
+        {
+            e = (rt_int64_t)(tone_log2(x) - top) * 100 / gamma;
+            x = (int)((255U * tone_exp2((rt_int32_t)e) + 32768) >> 16);
+        }
+        lut[v] = (rt_uint8_t)x;
+    }
+}
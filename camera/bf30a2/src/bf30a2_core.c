@@ -0,0 +1,1544 @@
+/**
+ * @file    bf30a2_core.c
+ * @brief   BF30A2 SPI protocol parser and pixel conversion core
+ *
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*============================================================================*/
+/*                              INCLUDES                                      */
+/*============================================================================*/
+
+#include <rtthread.h>
+#include <string.h>
+
+#include "bf30a2_core.h"
+#include "bf30a2_convert.h"
+#include "bf30a2_port.h"
+#include "bf30a2_trace.h"
+
+/*============================================================================*/
+/*                     COLOR CONVERSION                                       */
+/*============================================================================*/
+
+/**
+ * @brief Clamp integer value to 8-bit range
+ */
+static inline rt_uint8_t clamp8(int v)
+{
+    if (v < 0) return 0;
+    if (v > 255) return 255;
+    return (rt_uint8_t)v;
+}
+
+/**
+ * @brief Convert YUV422 line to RGB565 format
+ */
+void bf30a2_yuv_line_to_rgb565(const rt_uint8_t *yuv, rt_uint8_t *rgb, int width)
+{
+    int x;
+    int y0, cb, y1, cr;
+    int cb_off, cr_off;
+    int r0, g0, b0, r1, g1, b1;
+    rt_uint16_t p0, p1;
+
+    for (x = 0; x < width; x += 2)
+    {
+        y0 = yuv[0];
+        cb = yuv[1];
+        y1 = yuv[2];
+        cr = yuv[3];
+        yuv += 4;
+
+        cb_off = cb - 128;
+        cr_off = cr - 128;
+
+        r0 = clamp8(y0 + ((359 * cr_off) >> 8));
+        g0 = clamp8(y0 - ((88 * cb_off + 183 * cr_off) >> 8));
+        b0 = clamp8(y0 + ((454 * cb_off) >> 8));
+
+        r1 = clamp8(y1 + ((359 * cr_off) >> 8));
+        g1 = clamp8(y1 - ((88 * cb_off + 183 * cr_off) >> 8));
+        b1 = clamp8(y1 + ((454 * cb_off) >> 8));
+
+        p0 = ((r0 & 0xF8) << 8) | ((g0 & 0xFC) << 3) | (b0 >> 3);
+        p1 = ((r1 & 0xF8) << 8) | ((g1 & 0xFC) << 3) | (b1 >> 3);
+
+        *rgb++ = p0 & 0xFF;
+        *rgb++ = p0 >> 8;
+        *rgb++ = p1 & 0xFF;
+        *rgb++ = p1 >> 8;
+    }
+}
+
+void bf30a2_yuv_line_to_rgb565_y8(const rt_uint8_t *yuv, rt_uint8_t *rgb, rt_uint8_t *y8,
+                                  int width)
+{
+    int x;
+    int y0, cb, y1, cr;
+    int cb_off, cr_off;
+    int r0, g0, b0, r1, g1, b1;
+    rt_uint16_t p0, p1;
+
+    for (x = 0; x < width; x += 2)
+    {
+        y0 = yuv[0];
+        cb = yuv[1];
+        y1 = yuv[2];
+        cr = yuv[3];
+        yuv += 4;
+
+        *y8++ = (rt_uint8_t)y0;
+        *y8++ = (rt_uint8_t)y1;
+
+        cb_off = cb - 128;
+        cr_off = cr - 128;
+
+        r0 = clamp8(y0 + ((359 * cr_off) >> 8));
+        g0 = clamp8(y0 - ((88 * cb_off + 183 * cr_off) >> 8));
+        b0 = clamp8(y0 + ((454 * cb_off) >> 8));
+
+        r1 = clamp8(y1 + ((359 * cr_off) >> 8));
+        g1 = clamp8(y1 - ((88 * cb_off + 183 * cr_off) >> 8));
+        b1 = clamp8(y1 + ((454 * cb_off) >> 8));
+
+        p0 = ((r0 & 0xF8) << 8) | ((g0 & 0xFC) << 3) | (b0 >> 3);
+        p1 = ((r1 & 0xF8) << 8) | ((g1 & 0xFC) << 3) | (b1 >> 3);
+
+        *rgb++ = p0 & 0xFF;
+        *rgb++ = p0 >> 8;
+        *rgb++ = p1 & 0xFF;
+        *rgb++ = p1 >> 8;
+    }
+}
+
+void bf30a2_yuv_line_to_rgb565_half(const rt_uint8_t *yuv, rt_uint8_t *rgb, int width)
+{
+    int x;
+    int y0, cb_off, cr_off;
+    int r, g, b;
+    rt_uint16_t p;
+
+    for (x = 0; x < width; x += 2)
+    {
+        y0 = yuv[0];
+        cb_off = yuv[1] - 128;
+        cr_off = yuv[3] - 128;
+        yuv += 4;
+
+        r = clamp8(y0 + ((359 * cr_off) >> 8));
+        g = clamp8(y0 - ((88 * cb_off + 183 * cr_off) >> 8));
+        b = clamp8(y0 + ((454 * cb_off) >> 8));
+
+        p = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+        *rgb++ = p & 0xFF;
+        *rgb++ = p >> 8;
+    }
+}
+
+void bf30a2_yuv_line_to_y8(const rt_uint8_t *yuv, rt_uint8_t *y8, int width)
+{
+    int x;
+
+    for (x = 0; x < width; x++)
+    {
+        *y8++ = yuv[0];
+        yuv += 2;
+    }
+}
+
+void bf30a2_yuv_line_to_y8_half(const rt_uint8_t *yuv, rt_uint8_t *y8, int width)
+{
+    int x;
+
+    for (x = 0; x < width; x += 2)
+    {
+        *y8++ = yuv[0];
+        yuv += 4;
+    }
+}
+
+void bf30a2_thumb_accumulate(const rt_uint8_t *yuv, rt_uint16_t acc[3][IMG_WIDTH / 2],
+                             int width, int scale, int chroma, int first)
+{
+    int cols = width / scale;
+    int x, i;
+    rt_uint16_t sy, scb, scr;
+
+    for (x = 0; x < cols; x++)
+    {
+        sy = 0;
+        scb = 0;
+        scr = 0;
+        for (i = 0; i < scale; i += 2)
+        {
+            sy += yuv[0] + yuv[2];
+            scb += yuv[1];
+            scr += yuv[3];
+            yuv += 4;
+        }
+
+        acc[0][x] = first ? sy : (rt_uint16_t)(acc[0][x] + sy);
+        if (chroma)
+        {
+            acc[1][x] = first ? scb : (rt_uint16_t)(acc[1][x] + scb);
+            acc[2][x] = first ? scr : (rt_uint16_t)(acc[2][x] + scr);
+        }
+    }
+}
+
+void bf30a2_thumb_emit(const rt_uint16_t acc[3][IMG_WIDTH / 2], rt_uint8_t *dst, int cols,
+                       int scale, int rows, rt_uint8_t format)
+{
+    int n_y = scale * rows;
+    int n_c = n_y / 2;
+    int x, y, cb_off, cr_off, r, g, b;
+    rt_uint16_t p;
+
+    for (x = 0; x < cols; x++)
+    {
+        y = (acc[0][x] + n_y / 2) / n_y;
+        if (format == BF30A2_FORMAT_Y8)
+        {
+            *dst++ = (rt_uint8_t)y;
+            continue;
+        }
+
+        cb_off = (acc[1][x] + n_c / 2) / n_c - 128;
+        cr_off = (acc[2][x] + n_c / 2) / n_c - 128;
+        r = clamp8(y + ((359 * cr_off) >> 8));
+        g = clamp8(y - ((88 * cb_off + 183 * cr_off) >> 8));
+        b = clamp8(y + ((454 * cb_off) >> 8));
+
+        p = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+        *dst++ = p & 0xFF;
+        *dst++ = p >> 8;
+    }
+}
+
+void bf30a2_yuv_frame_to_plane(const rt_uint8_t *yuv, rt_uint8_t plane, rt_uint16_t width,
+                               rt_uint16_t height, rt_uint8_t *dst)
+{
+    if (plane == BF30A2_PLANE_HALF)
+    {
+        bf30a2_yuv_frame_to_level(RT_NULL, RT_NULL, yuv, BF30A2_LEVEL_HALF, width, height, dst);
+        return;
+    }
+    bf30a2_convert_yuv422_to_y8(yuv, (rt_int32_t)width * 2, dst, width, width, height);
+}
+
+void bf30a2_hex_encode(const rt_uint8_t *src, rt_uint32_t len, char *dst)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    rt_uint32_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        *dst++ = hex[src[i] >> 4];
+        *dst++ = hex[src[i] & 0x0F];
+    }
+    *dst = '\0';
+}
+
+/*============================================================================*/
+/*                     FRAME OUTPUT PIPELINE                                  */
+/*============================================================================*/
+
+/* Output kinds of the pipeline kernels, by level */
+#define PIPE_RGB565                 0
+#define PIPE_RGB565_HALF            1
+#define PIPE_Y8_HALF                2
+#define PIPE_KINDS                  3
+
+#define PIPE_BPP(kind)              (((kind) == PIPE_Y8_HALF) ? 1 : 2)
+
+static inline void pipe_put_rgb565(rt_uint8_t *dst, int y, int cb_off, int cr_off,
+                                   const bf30a2_tone_t *rgb)
+{
+    int r = clamp8(y + ((359 * cr_off) >> 8));
+    int g = clamp8(y - ((88 * cb_off + 183 * cr_off) >> 8));
+    int b = clamp8(y + ((454 * cb_off) >> 8));
+    rt_uint16_t p;
+
+    if (rgb != RT_NULL)
+    {
+        r = rgb->rgb[0][r];
+        g = rgb->rgb[1][g];
+        b = rgb->rgb[2][b];
+    }
+    p = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+
+    dst[0] = p & 0xFF;
+    dst[1] = p >> 8;
+}
+
+static inline void pipe_sample(bf30a2_frame_stats_t *stats, int y)
+{
+    stats->hist[y >> 4]++;
+    if (y < stats->luma_min)
+    {
+        stats->luma_min = (rt_uint8_t)y;
+    }
+    if (y > stats->luma_max)
+    {
+        stats->luma_max = (rt_uint8_t)y;
+    }
+}
+
+/*
+ * Every kernel is compiled from this one body with its output kind, walk
+ * (forward: step is the pixel size, known here), statistics and tone
+ * curve as constants, so each loop carries only the work its case needs.
+ * The tone kernels are rarer and take the walk and statistics at run time.
+ */
+#define PIPE_KERNEL(name, kind, forward, with_stats, with_tone)                             \
+static void name(const rt_uint8_t *yuv, rt_uint8_t *dst, rt_int32_t step, int width,       \
+                 bf30a2_frame_stats_t *stats, const bf30a2_tone_t *tone)                    \
+{                                                                                           \
+    const bf30a2_tone_t *rgb = (with_tone && tone->has_rgb) ? tone : RT_NULL;               \
+    rt_uint32_t sum = 0;                                                                    \
+    int x, y0, y1, cb_off, cr_off;                                                          \
+                                                                                            \
+    if (forward)                                                                            \
+    {                                                                                       \
+        step = PIPE_BPP(kind);                                                              \
+    }                                                                                       \
+    for (x = 0; x < width; x += 2)                                                          \
+    {                                                                                       \
+        y0 = yuv[0];                                                                        \
+        y1 = yuv[2];                                                                        \
+        cb_off = yuv[1] - 128;                                                              \
+        cr_off = yuv[3] - 128;                                                              \
+        yuv += 4;                                                                           \
+                                                                                            \
+        if (with_stats)                                                                     \
+        {                                                                                   \
+            sum += y0;                                                                      \
+            pipe_sample(stats, y0);                                                         \
+            if (kind == PIPE_RGB565)                                                        \
+            {                                                                               \
+                sum += y1;                                                                  \
+                pipe_sample(stats, y1);                                                     \
+            }                                                                               \
+        }                                                                                   \
+        if (with_tone)                                                                      \
+        {                                                                                   \
+            y0 = tone->y[y0];                                                               \
+            y1 = tone->y[y1];                                                               \
+        }                                                                                   \
+                                                                                            \
+        if (kind == PIPE_Y8_HALF)                                                           \
+        {                                                                                   \
+            *dst = (rt_uint8_t)y0;                                                          \
+        }                                                                                   \
+        else                                                                                \
+        {                                                                                   \
+            pipe_put_rgb565(dst, y0, cb_off, cr_off, rgb);                                  \
+        }                                                                                   \
+        dst += step;                                                                        \
+        if (kind == PIPE_RGB565)                                                            \
+        {                                                                                   \
+            pipe_put_rgb565(dst, y1, cb_off, cr_off, rgb);                                  \
+            dst += step;                                                                    \
+        }                                                                                   \
+    }                                                                                       \
+                                                                                            \
+    if (with_stats)                                                                         \
+    {                                                                                       \
+        stats->luma_sum += sum;                                                             \
+        stats->pixels += (kind == PIPE_RGB565) ? width : width / 2;                         \
+    }                                                                                       \
+}
+
+PIPE_KERNEL(pipe_rgb565_any,            PIPE_RGB565,        0, 0, 0)
+PIPE_KERNEL(pipe_rgb565_any_stats,      PIPE_RGB565,        0, 1, 0)
+PIPE_KERNEL(pipe_rgb565_fwd,            PIPE_RGB565,        1, 0, 0)
+PIPE_KERNEL(pipe_rgb565_fwd_stats,      PIPE_RGB565,        1, 1, 0)
+PIPE_KERNEL(pipe_rgb565_half_any,       PIPE_RGB565_HALF,   0, 0, 0)
+PIPE_KERNEL(pipe_rgb565_half_any_stats, PIPE_RGB565_HALF,   0, 1, 0)
+PIPE_KERNEL(pipe_rgb565_half_fwd,       PIPE_RGB565_HALF,   1, 0, 0)
+PIPE_KERNEL(pipe_rgb565_half_fwd_stats, PIPE_RGB565_HALF,   1, 1, 0)
+PIPE_KERNEL(pipe_y8_half_any,           PIPE_Y8_HALF,       0, 0, 0)
+PIPE_KERNEL(pipe_y8_half_any_stats,     PIPE_Y8_HALF,       0, 1, 0)
+PIPE_KERNEL(pipe_y8_half_fwd,           PIPE_Y8_HALF,       1, 0, 0)
+PIPE_KERNEL(pipe_y8_half_fwd_stats,     PIPE_Y8_HALF,       1, 1, 0)
+PIPE_KERNEL(pipe_rgb565_tone,           PIPE_RGB565,        0, stats != RT_NULL, 1)
+PIPE_KERNEL(pipe_rgb565_half_tone,      PIPE_RGB565_HALF,   0, stats != RT_NULL, 1)
+PIPE_KERNEL(pipe_y8_half_tone,          PIPE_Y8_HALF,       0, stats != RT_NULL, 1)
+
+/* By kind, forward walk, statistics */
+static const bf30a2_pipe_kernel_t pipe_kernels[PIPE_KINDS][2][2] =
+{
+    { { pipe_rgb565_any, pipe_rgb565_any_stats },
+      { pipe_rgb565_fwd, pipe_rgb565_fwd_stats } },
+    { { pipe_rgb565_half_any, pipe_rgb565_half_any_stats },
+      { pipe_rgb565_half_fwd, pipe_rgb565_half_fwd_stats } },
+    { { pipe_y8_half_any, pipe_y8_half_any_stats },
+      { pipe_y8_half_fwd, pipe_y8_half_fwd_stats } },
+};
+
+/* By kind, with a tone curve */
+static const bf30a2_pipe_kernel_t pipe_tone_kernels[PIPE_KINDS] =
+{
+    pipe_rgb565_tone, pipe_rgb565_half_tone, pipe_y8_half_tone,
+};
+
+/**
+ * @brief Statistics of a line whose frame output is not converted here
+ */
+static void pipe_stats_line(const rt_uint8_t *yuv, int width, int half,
+                            bf30a2_frame_stats_t *stats)
+{
+    rt_uint32_t sum = 0;
+    int x;
+
+    for (x = 0; x < width; x += 2, yuv += 4)
+    {
+        sum += yuv[0];
+        pipe_sample(stats, yuv[0]);
+        if (!half)
+        {
+            sum += yuv[2];
+            pipe_sample(stats, yuv[2]);
+        }
+    }
+    stats->luma_sum += sum;
+    stats->pixels += half ? width / 2 : width;
+}
+
+/**
+ * @brief Byte offset in the frame output of pixel x, y of the cropped image
+ *
+ * w x h is the cropped image after decimation, before mirror and rotation.
+ */
+static rt_int32_t pipe_offset(const bf30a2_pipeline_t *cfg, int w, int h, int bpp, int x, int y)
+{
+    int ox, oy, ow;
+
+    if (cfg->mirror)
+    {
+        x = w - 1 - x;
+    }
+
+    switch (cfg->rotate)
+    {
+    case BF30A2_ROTATE_90:
+        ox = h - 1 - y;
+        oy = x;
+        ow = h;
+        break;
+
+    case BF30A2_ROTATE_180:
+        ox = w - 1 - x;
+        oy = h - 1 - y;
+        ow = w;
+        break;
+
+    case BF30A2_ROTATE_270:
+        ox = y;
+        oy = w - 1 - x;
+        ow = h;
+        break;
+
+    default:
+        ox = x;
+        oy = y;
+        ow = w;
+        break;
+    }
+
+    return ((rt_int32_t)oy * ow + ox) * bpp;
+}
+
+void bf30a2_core_pipe_resolve(const bf30a2_pipeline_t *pipeline, const bf30a2_tone_t *tone,
+                              rt_uint8_t level, rt_uint16_t width, rt_uint16_t height,
+                              bf30a2_core_pipe_t *pipe, bf30a2_info_t *info)
+{
+    static const bf30a2_pipeline_t none = { 0 };
+    const bf30a2_pipeline_t *cfg = (pipeline != RT_NULL) ? pipeline : &none;
+    rt_uint16_t w, h;
+    int kind, bpp;
+
+    /* A crop past a smaller frame is clipped, one wholly outside it dropped */
+    if ((cfg->crop_x >= width) || (cfg->crop_y >= height))
+    {
+        pipe->x0 = 0;
+        pipe->y0 = 0;
+    }
+    else
+    {
+        pipe->x0 = cfg->crop_x;
+        pipe->y0 = cfg->crop_y;
+    }
+    pipe->cols = width - pipe->x0;
+    if ((cfg->crop_width != 0) && (cfg->crop_width < pipe->cols) && (pipe->x0 == cfg->crop_x))
+    {
+        pipe->cols = cfg->crop_width;
+    }
+    pipe->rows = height - pipe->y0;
+    if ((cfg->crop_height != 0) && (cfg->crop_height < pipe->rows) && (pipe->y0 == cfg->crop_y))
+    {
+        pipe->rows = cfg->crop_height;
+    }
+
+    switch (level)
+    {
+    case BF30A2_LEVEL_HALF:
+        kind = PIPE_RGB565_HALF;
+        break;
+
+    case BF30A2_LEVEL_Y8:
+        kind = PIPE_Y8_HALF;
+        break;
+
+    default:
+        kind = PIPE_RGB565;
+        break;
+    }
+    pipe->half = (kind != PIPE_RGB565);
+    bpp = PIPE_BPP(kind);
+
+    bf30a2_core_level_geometry(level, pipe->cols, pipe->rows, info);
+    w = info->width;
+    h = info->height;
+    if ((cfg->rotate == BF30A2_ROTATE_90) || (cfg->rotate == BF30A2_ROTATE_270))
+    {
+        info->width = h;
+        info->height = w;
+    }
+
+    pipe->origin = pipe_offset(cfg, w, h, bpp, 0, 0);
+    pipe->step = pipe_offset(cfg, w, h, bpp, 1, 0) - pipe->origin;
+    pipe->pitch = pipe_offset(cfg, w, h, bpp, 0, 1) - pipe->origin;
+    if (tone != RT_NULL)
+    {
+        pipe->kernel = pipe_tone_kernels[kind];
+    }
+    else
+    {
+        pipe->kernel = pipe_kernels[kind][pipe->step == bpp][cfg->stats != 0];
+    }
+    pipe->plain = (pipe->cols == width) && (pipe->rows == height) && (tone == RT_NULL) &&
+                  (pipe->step == bpp) && (pipe->pitch == (rt_int32_t)w * bpp);
+}
+
+void bf30a2_core_output_geometry(const bf30a2_pipeline_t *pipeline, rt_uint8_t level,
+                                 rt_uint16_t width, rt_uint16_t height, bf30a2_info_t *info)
+{
+    bf30a2_core_pipe_t pipe;
+
+    bf30a2_core_pipe_resolve(pipeline, RT_NULL, level, width, height, &pipe, info);
+}
+
+void bf30a2_yuv_frame_to_level(const bf30a2_pipeline_t *pipeline, const bf30a2_tone_t *tone,
+                               const rt_uint8_t *yuv, rt_uint8_t level, rt_uint16_t width,
+                               rt_uint16_t height, rt_uint8_t *dst)
+{
+    rt_int32_t pitch = (rt_int32_t)width * 2;
+    bf30a2_pipeline_t cfg;
+    bf30a2_core_pipe_t pipe;
+    bf30a2_info_t geo;
+    int line;
+
+    /* Statistics were taken while capturing */
+    if (pipeline != RT_NULL)
+    {
+        cfg = *pipeline;
+        cfg.stats = 0;
+        pipeline = &cfg;
+    }
+
+    bf30a2_core_pipe_resolve(pipeline, tone, level, width, height, &pipe, &geo);
+    if (!pipe.plain)
+    {
+        for (line = pipe.y0; line < pipe.y0 + pipe.rows; line += 1 + pipe.half)
+        {
+            pipe.kernel(yuv + line * pitch + pipe.x0 * 2,
+                        dst + pipe.origin + ((line - pipe.y0) >> pipe.half) * pipe.pitch,
+                        pipe.step, pipe.cols, RT_NULL, tone);
+        }
+        return;
+    }
+
+    if (level == BF30A2_LEVEL_Y8)
+    {
+        bf30a2_convert_yuv422_to_y8_half(yuv, pitch, dst, width / 2, width, height);
+    }
+    else if (level >= BF30A2_LEVEL_HALF)
+    {
+        bf30a2_convert_yuv422_to_rgb565_half(yuv, pitch, dst, pitch / 2, width, height);
+    }
+    else
+    {
+        bf30a2_convert_yuv422_to_rgb565(yuv, pitch, dst, pitch, width, height);
+    }
+}
+
+/*============================================================================*/
+/*                     CHANGE DETECTION                                       */
+/*============================================================================*/
+
+/**
+ * @brief Sum the luma samples of a line into its row of blocks
+ */
+static void change_line(bf30a2_core_t *core, rt_uint16_t line)
+{
+    bf30a2_core_change_t *ch = &core->change;
+    const rt_uint8_t *yuv = core->line_yuv;
+    int row, b, x, end, n;
+    rt_uint32_t sum;
+
+    if (line % BF30A2_CHANGE_STEP)
+    {
+        return;
+    }
+
+    row = (line * BF30A2_CHANGE_GRID / core->height) * BF30A2_CHANGE_GRID;
+    for (b = 0, x = 0; b < BF30A2_CHANGE_GRID; b++)
+    {
+        end = (b + 1) * core->width / BF30A2_CHANGE_GRID;
+        for (sum = 0, n = 0; x < end; x += BF30A2_CHANGE_STEP, n++)
+        {
+            sum += yuv[x * 2];
+        }
+        ch->sum[row + b] += sum;
+        ch->samples[row + b] += n;
+    }
+}
+
+/**
+ * @brief Compare the frame just assembled with the reference
+ *
+ * A changed frame becomes the reference, so a scene drifting slowly is
+ * still reported once it has moved past the threshold. Blocks none of
+ * whose lines arrived keep the reference's value.
+ *
+ * @return 1 if the frame is unchanged
+ */
+static rt_uint8_t change_compare(bf30a2_core_t *core)
+{
+    bf30a2_core_change_t *ch = &core->change;
+    rt_uint8_t mean[BF30A2_CHANGE_BLOCKS];
+    rt_uint32_t tone = (core->frame_tone != RT_NULL) ? core->frame_tone->generation : 0;
+    int i, d, blocks = 0, delta = 0;
+
+    for (i = 0; i < BF30A2_CHANGE_BLOCKS; i++)
+    {
+        if (ch->samples[i] == 0)
+        {
+            mean[i] = ch->ref[i];
+            continue;
+        }
+        mean[i] = (rt_uint8_t)(ch->sum[i] / ch->samples[i]);
+        d = (mean[i] > ch->ref[i]) ? mean[i] - ch->ref[i] : ch->ref[i] - mean[i];
+        if (d > delta)
+        {
+            delta = d;
+        }
+        if (d > ch->cfg.threshold)
+        {
+            blocks++;
+        }
+    }
+
+    /* A different output is a change whatever the scene did */
+    ch->unchanged = ch->ref_valid && (blocks <= ch->cfg.blocks) &&
+                    (ch->ref_tone == tone) && (ch->ref_level == core->frame_level) &&
+                    (ch->ref_width == core->width) && (ch->ref_height == core->height);
+    ch->info.frames++;
+    ch->info.last_unchanged = ch->unchanged;
+    ch->info.last_blocks = (rt_uint8_t)blocks;
+    ch->info.last_delta = (rt_uint8_t)delta;
+
+    if (ch->unchanged)
+    {
+        ch->info.unchanged++;
+        return 1;
+    }
+
+    rt_memcpy(ch->ref, mean, sizeof(ch->ref));
+    ch->ref_tone = tone;
+    ch->ref_level = core->frame_level;
+    ch->ref_width = core->width;
+    ch->ref_height = core->height;
+    ch->ref_valid = 1;
+
+    return 0;
+}
+
+/*============================================================================*/
+/*                     DUAL LANE                                              */
+/*============================================================================*/
+
+/* Lane bytes de-interleaved per bf30a2_core_feed() call */
+#define LANE_CHUNK                  64
+
+/* Bits 3..0 of a nibble moved to bits 6, 4, 2, 0 */
+#define LANE_SPREAD(n)              (((n) & 1) | (((n) & 2) << 1) | (((n) & 4) << 2) | \
+                                     (((n) & 8) << 3))
+
+/* A lane byte's two nibbles spread into the low bits of two stream bytes */
+#define LANE_ENTRY(b)               (rt_uint16_t)(LANE_SPREAD((b) >> 4) | \
+                                                  (LANE_SPREAD((b) & 0x0F) << 8))
+#define LANE_ROW4(b)                LANE_ENTRY(b), LANE_ENTRY((b) + 1), \
+                                    LANE_ENTRY((b) + 2), LANE_ENTRY((b) + 3)
+#define LANE_ROW16(b)               LANE_ROW4(b), LANE_ROW4((b) + 4), \
+                                    LANE_ROW4((b) + 8), LANE_ROW4((b) + 12)
+#define LANE_ROW64(b)               LANE_ROW16(b), LANE_ROW16((b) + 16), \
+                                    LANE_ROW16((b) + 32), LANE_ROW16((b) + 48)
+
+/* Low byte: first stream byte, high byte: second */
+static const rt_uint16_t lane_lut[256] =
+{
+    LANE_ROW64(0), LANE_ROW64(64), LANE_ROW64(128), LANE_ROW64(192)
+};
+
+void bf30a2_lanes_deinterleave(const rt_uint8_t *lane0, const rt_uint8_t *lane1,
+                               rt_uint8_t *out, rt_uint32_t n)
+{
+    rt_uint16_t pair;
+    rt_uint32_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        pair = (rt_uint16_t)((lane_lut[lane1[i]] << 1) | lane_lut[lane0[i]]);
+        out[2 * i] = (rt_uint8_t)pair;
+        out[2 * i + 1] = (rt_uint8_t)(pair >> 8);
+    }
+}
+
+void bf30a2_core_feed_lanes(bf30a2_core_t *core, const rt_uint8_t *lane0,
+                            const rt_uint8_t *lane1, rt_uint32_t n)
+{
+    rt_uint8_t buf[2 * LANE_CHUNK];
+    rt_uint32_t len;
+
+    while (n > 0)
+    {
+        len = (n < LANE_CHUNK) ? n : LANE_CHUNK;
+        bf30a2_lanes_deinterleave(lane0, lane1, buf, len);
+        bf30a2_core_feed(core, buf, 2 * len);
+        lane0 += len;
+        lane1 += len;
+        n -= len;
+    }
+}
+
+/*============================================================================*/
+/*                     PARSE STATE MACHINE                                    */
+/*============================================================================*/
+
+const bf30a2_proto_t bf30a2_proto_default = { 0x01, 0x02, 0x00, 0x40 };
+
+void bf30a2_core_reset(bf30a2_core_t *core)
+{
+    if (core->proto == RT_NULL)
+    {
+        core->proto = &bf30a2_proto_default;
+    }
+    core->state = STATE_FIND_SYNC;
+    core->ff_count = 0;
+    core->lines_received = 0;
+    core->max_line_seen = 0;
+    core->data_pos = 0;
+    core->in_frame = 0;
+    /* A new run measures its rate afresh */
+    core->ival.have_prev = 0;
+    core->ival.avg_q4 = 0;
+    core->ival.late = 0;
+    core->ival.late_run = 0;
+    core->frame_skip = (core->on_acquire != RT_NULL) || (core->on_line_dst != RT_NULL);
+    if (core->line_bytes == 0)
+    {
+        /* Until the first frame header, expect the largest geometry */
+        core->width = IMG_WIDTH;
+        core->height = IMG_HEIGHT;
+        core->line_bytes = BYTES_PER_LINE;
+        core->pub_width = IMG_WIDTH;
+        core->pub_height = IMG_HEIGHT;
+    }
+    core->change.ref_valid = 0;
+    core->frame_ready = 0;  /* 重要：重置frame_ready标志，确保重新启动时状态正确 */
+}
+
+void bf30a2_core_reset_stats(bf30a2_core_t *core)
+{
+    core->frame_count = 0;
+    core->complete_frames = 0;
+    core->frame_start_count = 0;
+    core->frame_end_count = 0;
+    core->line_count = 0;
+    core->errors = 0;
+    rt_memset(&core->ival, 0, sizeof(core->ival));
+    core->skipped_frames = 0;
+    core->bp_dropped = 0;
+    core->geometry_changes = 0;
+    rt_memset(&core->change.info, 0, sizeof(core->change.info));
+}
+
+void bf30a2_core_level_geometry(rt_uint8_t level, rt_uint16_t width, rt_uint16_t height,
+                                bf30a2_info_t *info)
+{
+    switch (level)
+    {
+    case BF30A2_LEVEL_HALF:
+        info->width = width / 2;
+        info->height = height / 2;
+        info->format = BF30A2_FORMAT_RGB565;
+        break;
+
+    case BF30A2_LEVEL_Y8:
+        info->width = width / 2;
+        info->height = height / 2;
+        info->format = BF30A2_FORMAT_Y8;
+        break;
+
+    default:
+        info->width = width;
+        info->height = height;
+        info->format = BF30A2_FORMAT_RGB565;
+        break;
+    }
+    info->frame_size = (rt_uint32_t)info->width * info->height *
+                       ((info->format == BF30A2_FORMAT_Y8) ? 1 : 2);
+}
+
+void bf30a2_core_plane_geometry(const bf30a2_core_t *core, rt_uint8_t plane,
+                                rt_uint16_t width, rt_uint16_t height, bf30a2_info_t *info)
+{
+    rt_uint8_t scale = (core->thumb_scale != 0) ? core->thumb_scale : 2;
+
+    switch (plane)
+    {
+    case BF30A2_PLANE_Y8:
+        info->width = width;
+        info->height = height;
+        info->frame_size = (rt_uint32_t)width * height;
+        info->format = BF30A2_FORMAT_Y8;
+        break;
+
+    case BF30A2_PLANE_THUMB:
+        info->width = width / scale;
+        info->height = height / scale;
+        info->format = (core->thumb_format == BF30A2_FORMAT_Y8) ?
+                       BF30A2_FORMAT_Y8 : BF30A2_FORMAT_RGB565;
+        info->frame_size = (rt_uint32_t)info->width * info->height *
+                           ((info->format == BF30A2_FORMAT_Y8) ? 1 : 2);
+        break;
+
+    default:
+        bf30a2_core_level_geometry(BF30A2_LEVEL_HALF, width, height, info);
+        break;
+    }
+}
+
+rt_uint32_t bf30a2_core_frame_remaining(const bf30a2_core_t *core)
+{
+    rt_uint32_t lines;
+
+    if (!core->in_frame)
+    {
+        return 0;
+    }
+
+    lines = (core->max_line_seen < core->height) ? (core->height - 1 - core->max_line_seen) : 0;
+    return lines * (LINE_HEADER_SIZE + DATA_HEADER_SIZE + core->line_bytes) + 4;
+}
+
+/*============================================================================*/
+/*                     FRAME INTERVALS                                        */
+/*============================================================================*/
+
+static void update_intervals(bf30a2_core_t *core)
+{
+    bf30a2_core_interval_t *iv = &core->ival;
+    rt_uint32_t seq = core->frame_start_count;
+    rt_uint32_t us, avg;
+    rt_int64_t d;
+
+    if (!iv->have_prev)
+    {
+        iv->have_prev = 1;
+        iv->prev_stamp = core->frame_stamp;
+        iv->prev_seq = seq;
+        iv->skipped = 0;
+        return;
+    }
+
+    /* Frames skipped on purpose are neither gaps nor part of the interval */
+    us = (core->frame_stamp - iv->prev_stamp) / (bf30a2_port_cycles_hz() / 1000000UL);
+    us /= 1 + iv->skipped;
+    iv->seq_gaps += seq - iv->prev_seq - 1 - iv->skipped;
+    iv->prev_stamp = core->frame_stamp;
+    iv->prev_seq = seq;
+    iv->skipped = 0;
+
+    /* Feeders that do not stamp wakeups (host replay) get no interval statistics */
+    if (us == 0)
+    {
+        return;
+    }
+
+    iv->last_us = us;
+    if ((iv->count == 0) || (us < iv->min_us))
+    {
+        iv->min_us = us;
+    }
+    if (us > iv->max_us)
+    {
+        iv->max_us = us;
+    }
+    /* Sums of deviations from the first interval keep the variance exact in integers */
+    if (iv->count == 0)
+    {
+        iv->ref_us = us;
+    }
+    d = (rt_int64_t)us - iv->ref_us;
+    iv->count++;
+    iv->sum_d += d;
+    iv->sum_d2 += (rt_uint64_t)(d * d);
+
+    avg = iv->avg_q4 >> 4;
+    if (avg == 0)
+    {
+        iv->avg_q4 = us << 4;
+    }
+    else if (us * 2 > avg * 3)
+    {
+        iv->late++;
+        if (++iv->late_run >= BF30A2_IVAL_RESEED)
+        {
+            iv->late -= iv->late_run;
+            iv->late_run = 0;
+            iv->avg_q4 = us << 4;
+        }
+    }
+    else
+    {
+        iv->late_run = 0;
+        iv->avg_q4 = iv->avg_q4 - (iv->avg_q4 >> 3) + (us << 1);
+    }
+}
+
+static rt_uint32_t isqrt64(rt_uint64_t v)
+{
+    rt_uint64_t bit = 1ULL << 62;
+    rt_uint64_t res = 0;
+
+    while (bit > v)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (v >= res + bit)
+        {
+            v -= res + bit;
+            res = (res >> 1) + bit;
+        }
+        else
+        {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (rt_uint32_t)res;
+}
+
+void bf30a2_core_get_intervals(const bf30a2_core_t *core, bf30a2_status_info_t *status)
+{
+    const bf30a2_core_interval_t *iv = &core->ival;
+    rt_uint32_t avg = iv->avg_q4 >> 4;
+    rt_int64_t mean;
+    rt_uint64_t var;
+
+    status->fps_milli = (avg != 0) ? (rt_uint32_t)(16000000000ULL / iv->avg_q4) : 0;
+    status->fps = status->fps_milli / 1000.0f;
+    status->interval_us = iv->last_us;
+    status->interval_avg_us = avg;
+    status->interval_min_us = iv->min_us;
+    status->interval_max_us = iv->max_us;
+    status->late_intervals = iv->late;
+    status->seq_gaps = iv->seq_gaps;
+
+    status->interval_stddev_us = 0;
+    if (iv->count > 1)
+    {
+        mean = iv->sum_d / (rt_int64_t)iv->count;
+        var = iv->sum_d2 / iv->count;
+        var = (var > (rt_uint64_t)(mean * mean)) ? var - (rt_uint64_t)(mean * mean) : 0;
+        status->interval_stddev_us = isqrt64(var);
+    }
+}
+
+static void on_frame_start(bf30a2_core_t *core)
+{
+    bf30a2_info_t geo;
+
+    BF30A2_TRACE(BF30A2_TRACE_FRAME_START, 0, core->frame_height);
+    core->frame_start_count++;
+    core->frame_stamp = core->wake_stamp;
+    core->done_stamp = 0;
+    core->in_frame = 1;
+    core->lines_received = 0;
+    core->max_line_seen = 0;
+
+    core->frame_level = (core->level < BF30A2_LEVELS) ? core->level : BF30A2_LEVEL_FULL;
+    core->frame_skip = 0;
+    rt_memset(core->frame_plane, 0, sizeof(core->frame_plane));
+    core->thumb_rows = 0;
+    core->frame_tone = core->tone;
+    bf30a2_core_pipe_resolve(&core->pipeline, core->frame_tone, core->frame_level,
+                             core->width, core->height, &core->pipe, &geo);
+    rt_memset(&core->stats, 0, sizeof(core->stats));
+    core->stats.luma_min = 0xFF;
+    core->change.mode = core->change.cfg.mode;
+    core->change.unchanged = 0;
+    if (core->change.mode != BF30A2_CHANGE_OFF)
+    {
+        rt_memset(core->change.sum, 0, sizeof(core->change.sum));
+        rt_memset(core->change.samples, 0, sizeof(core->change.samples));
+    }
+    if (core->frame_level >= BF30A2_LEVEL_SKIP)
+    {
+        core->skip_phase ^= 1;
+        core->frame_skip = core->skip_phase;
+    }
+    if (core->frame_skip)
+    {
+        core->skipped_frames++;
+        core->ival.skipped++;
+    }
+    else if (core->on_acquire != RT_NULL)
+    {
+        core->frame_rgb565 = core->on_acquire(core, core->hook_ctx);
+        if (core->frame_rgb565 == RT_NULL)
+        {
+            BF30A2_TRACE(BF30A2_TRACE_FRAME_DROP, 0, core->frame_start_count);
+            core->frame_skip = 1;
+            core->bp_dropped++;
+            core->ival.skipped++;
+        }
+    }
+}
+
+static void on_frame_end(bf30a2_core_t *core)
+{
+    rt_uint8_t publish = core->in_frame && !core->frame_skip &&
+                         (core->lines_received >= (core->height * 8 / 10));
+
+    /* A streamed frame is already on the panel: it can only be marked */
+    if (publish && (core->change.mode != BF30A2_CHANGE_OFF) && change_compare(core) &&
+        (core->change.mode == BF30A2_CHANGE_SUPPRESS) && (core->on_line_dst == RT_NULL))
+    {
+        core->change.info.suppressed++;
+        core->ival.skipped++;
+        publish = 0;
+    }
+
+    BF30A2_TRACE(BF30A2_TRACE_FRAME_END, publish, core->lines_received);
+    core->frame_end_count++;
+
+    if (publish)
+    {
+        /* A frame missing its last line counts as assembled at its end marker */
+        core->pub_stamp = core->frame_stamp;
+        core->pub_done_stamp = (core->done_stamp != 0) ? core->done_stamp : bf30a2_port_cycles();
+        core->pub_level = core->frame_level;
+        core->pub_width = core->width;
+        core->pub_height = core->height;
+        core->frame_ready = 1;
+        core->complete_frames++;
+        update_intervals(core);
+        core->stats.frame_num = core->frame_count;
+        if (core->stats.pixels == 0)
+        {
+            core->stats.luma_min = 0;
+        }
+
+        if (core->on_frame != RT_NULL)
+        {
+            core->on_frame(core, core->hook_ctx);
+        }
+        core->frame_count++;
+    }
+
+    /* With a buffer or line destination hook, lines outside a frame have nowhere to go */
+    core->in_frame = 0;
+    core->frame_skip = (core->on_acquire != RT_NULL) || (core->on_line_dst != RT_NULL);
+}
+
+/**
+ * @brief Destination of a line in the frame output, RT_NULL for none
+ *
+ * The reduced levels keep even lines only, and of each pixel pair the
+ * first luma sample with the shared chroma.
+ */
+static rt_uint8_t *frame_line_dst(bf30a2_core_t *core, rt_uint16_t line)
+{
+    rt_uint8_t half = (core->frame_level >= BF30A2_LEVEL_HALF);
+
+    if (half && (line & 1))
+    {
+        return RT_NULL;
+    }
+
+    if (core->on_line_dst != RT_NULL)
+    {
+        return core->on_line_dst(core, core->hook_ctx);
+    }
+    if (core->frame_level == BF30A2_LEVEL_Y8)
+    {
+        return core->frame_rgb565 + (line / 2) * (core->width / 2);
+    }
+    return core->frame_rgb565 +
+           (half ? (line / 2) * (core->line_bytes / 2) : line * core->line_bytes);
+}
+
+/**
+ * @brief Sum a line into the thumbnail, writing each row once complete
+ *
+ * A row cut short by lost lines is averaged over the lines it got.
+ */
+static void thumb_line(bf30a2_core_t *core, rt_uint16_t line, rt_uint8_t *plane)
+{
+    int scale = core->thumb_scale;
+    int cols = core->width / scale;
+    int bpp = (core->thumb_format == BF30A2_FORMAT_Y8) ? 1 : 2;
+    rt_uint16_t row = line / scale;
+
+    if ((core->thumb_rows != 0) && (row != core->thumb_row))
+    {
+        bf30a2_thumb_emit(core->thumb_acc, plane + core->thumb_row * cols * bpp, cols,
+                          scale, core->thumb_rows, core->thumb_format);
+        core->thumb_rows = 0;
+    }
+
+    /* Lines past the last whole row have nowhere to go */
+    if (row >= core->height / scale)
+    {
+        return;
+    }
+
+    bf30a2_thumb_accumulate(core->line_yuv, core->thumb_acc, core->width, scale, bpp == 2,
+                            core->thumb_rows == 0);
+    core->thumb_row = row;
+    core->thumb_rows++;
+
+    if (((line % scale) == scale - 1) || (line == core->height - 1))
+    {
+        bf30a2_thumb_emit(core->thumb_acc, plane + row * cols * bpp, cols,
+                          scale, core->thumb_rows, core->thumb_format);
+        core->thumb_rows = 0;
+    }
+}
+
+/**
+ * @brief Convert an accepted line at the level of the current frame
+ *
+ * The secondary planes are produced from the same line while it is still
+ * in cache; full resolution RGB565 and luma share a single pass. A frame
+ * output that is cropped, transformed, toned or counted into the
+ * statistics goes through the pipeline kernel instead, which does all of
+ * it in one loop. A core keeping raw frames copies the line, and a
+ * streamed output stays whole and unrotated, though toned; only the
+ * thumbnail and the statistics, which would need a pass of their own
+ * later, are still made here, with the change detection fingerprint. The
+ * planes are never toned.
+ */
+static void convert_line(bf30a2_core_t *core, rt_uint16_t line)
+{
+    const bf30a2_core_pipe_t *pipe = &core->pipe;
+    const rt_uint8_t *src = core->line_yuv + pipe->x0 * 2;
+    rt_uint8_t *dst = RT_NULL;
+    rt_uint8_t *y8 = core->frame_plane[BF30A2_PLANE_Y8];
+    rt_uint8_t *half = core->frame_plane[BF30A2_PLANE_HALF];
+    rt_uint8_t kept = (line >= pipe->y0) && (line - pipe->y0 < pipe->rows) &&
+                      !(pipe->half && (line & 1));
+    rt_uint8_t stats = kept && core->pipeline.stats;
+    int bpp;
+
+    if (core->change.mode != BF30A2_CHANGE_OFF)
+    {
+        change_line(core, line);
+    }
+
+    if (core->keep_raw && (core->on_line_dst == RT_NULL))
+    {
+        rt_memcpy(core->frame_rgb565 + line * core->line_bytes, core->line_yuv, core->line_bytes);
+        y8 = half = RT_NULL;
+    }
+    else if ((core->on_line_dst == RT_NULL) && (!pipe->plain || core->pipeline.stats))
+    {
+        if (kept)
+        {
+            pipe->kernel(src, core->frame_rgb565 + pipe->origin +
+                         ((line - pipe->y0) >> pipe->half) * pipe->pitch,
+                         pipe->step, pipe->cols, core->pipeline.stats ? &core->stats : RT_NULL,
+                         core->frame_tone);
+        }
+        stats = 0;
+    }
+    else
+    {
+        dst = frame_line_dst(core, line);
+    }
+    if (stats)
+    {
+        pipe_stats_line(src, pipe->cols, pipe->half, &core->stats);
+    }
+    if ((dst != RT_NULL) && (core->frame_tone != RT_NULL))
+    {
+        /* The whole line, in order, through the tone kernel of the level */
+        bpp = (core->frame_level == BF30A2_LEVEL_Y8) ? 1 : 2;
+        pipe->kernel(core->line_yuv, dst, bpp, core->width, RT_NULL, core->frame_tone);
+        dst = RT_NULL;
+    }
+
+    if (y8 != RT_NULL)
+    {
+        y8 += line * core->width;
+    }
+    if (half != RT_NULL)
+    {
+        half = (line & 1) ? RT_NULL : half + (line / 2) * (core->line_bytes / 2);
+    }
+
+    if (dst != RT_NULL)
+    {
+        switch (core->frame_level)
+        {
+        case BF30A2_LEVEL_HALF:
+            bf30a2_yuv_line_to_rgb565_half(core->line_yuv, dst, core->width);
+            if (half != RT_NULL)
+            {
+                /* Same output as the frame: copy rather than convert again */
+                rt_memcpy(half, dst, core->line_bytes / 2);
+                half = RT_NULL;
+            }
+            break;
+
+        case BF30A2_LEVEL_Y8:
+            bf30a2_yuv_line_to_y8_half(core->line_yuv, dst, core->width);
+            break;
+
+        default:
+            if (y8 != RT_NULL)
+            {
+                bf30a2_yuv_line_to_rgb565_y8(core->line_yuv, dst, y8, core->width);
+                y8 = RT_NULL;
+            }
+            else
+            {
+                bf30a2_yuv_line_to_rgb565(core->line_yuv, dst, core->width);
+            }
+            break;
+        }
+    }
+
+    if (y8 != RT_NULL)
+    {
+        bf30a2_yuv_line_to_y8(core->line_yuv, y8, core->width);
+    }
+    if (half != RT_NULL)
+    {
+        bf30a2_yuv_line_to_rgb565_half(core->line_yuv, half, core->width);
+    }
+    if ((core->frame_plane[BF30A2_PLANE_THUMB] != RT_NULL) && (core->thumb_scale != 0))
+    {
+        thumb_line(core, line, core->frame_plane[BF30A2_PLANE_THUMB]);
+    }
+}
+
+static void on_line_complete(bf30a2_core_t *core)
+{
+    rt_uint16_t line = core->line_num;
+
+    core->line_count++;
+
+    /* A frame parsed header-only has no buffer, a streamed one needs none */
+    if ((line < core->height) &&
+        (core->frame_skip || (core->frame_rgb565 != RT_NULL) || (core->on_line_dst != RT_NULL)))
+    {
+        BF30A2_TRACE(BF30A2_TRACE_LINE, 0, line);
+        if (!core->frame_skip)
+        {
+            convert_line(core, line);
+        }
+        core->lines_received++;
+        if (line == core->height - 1)
+        {
+            core->done_stamp = bf30a2_port_cycles();
+        }
+        if (line > core->max_line_seen)
+        {
+            core->max_line_seen = line;
+        }
+
+        if ((core->on_line != RT_NULL) && !core->frame_skip)
+        {
+            core->on_line(core, core->hook_ctx);
+        }
+    }
+    else
+    {
+        BF30A2_TRACE(BF30A2_TRACE_LINE_REJECT, 0, line);
+        core->errors++;
+    }
+}
+
+/**
+ * @brief A header geometry the buffers can hold and the converters handle
+ *
+ * Widths are whole YUV422 pixel pairs; even heights keep the half levels
+ * exact.
+ */
+static rt_bool_t geometry_ok(rt_uint16_t width, rt_uint16_t height)
+{
+    return (width >= BF30A2_MIN_WIDTH) && (width <= IMG_WIDTH) && !(width & 1) &&
+           (height >= BF30A2_MIN_HEIGHT) && (height <= IMG_HEIGHT) && !(height & 1);
+}
+
+/**
+ * @brief Advance the state machine by one header byte
+ *
+ * STATE_PIXEL_DATA is handled in bulk by bf30a2_core_feed().
+ */
+static void parse_byte(bf30a2_core_t *core, rt_uint8_t b)
+{
+    switch (core->state)
+    {
+    case STATE_FIND_SYNC:
+        if (b == 0xFF)
+        {
+            core->ff_count++;
+            if (core->ff_count >= 3)
+            {
+                core->state = STATE_GET_TYPE;
+                core->ff_count = 0;
+            }
+        }
+        else
+        {
+            core->ff_count = 0;
+        }
+        break;
+
+    case STATE_GET_TYPE:
+        /* Type codes are the sensor's: compared in turn, not switched on */
+        if (b == core->proto->frame_start)
+        {
+            core->state = STATE_FRAME_FORMAT;
+        }
+        else if (b == core->proto->line_start)
+        {
+            core->state = STATE_LINE_NUM_H;
+        }
+        else if (b == core->proto->frame_end)
+        {
+            on_frame_end(core);
+            core->state = STATE_FIND_SYNC;
+        }
+        else if (b == 0xFF)
+        {
+            core->ff_count = 1;
+        }
+        else
+        {
+            BF30A2_TRACE(BF30A2_TRACE_SYNC_LOSS, STATE_GET_TYPE, b);
+            core->state = STATE_FIND_SYNC;
+            core->ff_count = 0;
+        }
+        break;
+
+    case STATE_FRAME_FORMAT:
+        if (b == 0x00)
+        {
+            core->state = STATE_FRAME_WIDTH_H;
+        }
+        else
+        {
+            BF30A2_TRACE(BF30A2_TRACE_SYNC_LOSS, STATE_FRAME_FORMAT, b);
+            core->state = STATE_FIND_SYNC;
+            core->ff_count = 0;
+        }
+        break;
+
+    case STATE_FRAME_WIDTH_H:
+        core->frame_width = (rt_uint16_t)b << 8;
+        core->state = STATE_FRAME_WIDTH_L;
+        break;
+
+    case STATE_FRAME_WIDTH_L:
+        core->frame_width |= b;
+        core->state = STATE_FRAME_HEIGHT_H;
+        break;
+
+    case STATE_FRAME_HEIGHT_H:
+        core->frame_height = (rt_uint16_t)b << 8;
+        core->state = STATE_FRAME_HEIGHT_L;
+        break;
+
+    case STATE_FRAME_HEIGHT_L:
+        core->frame_height |= b;
+        BF30A2_TRACE(BF30A2_TRACE_FRAME_HEADER, 0, core->frame_width);
+        if (geometry_ok(core->frame_width, core->frame_height))
+        {
+            if ((core->frame_width != core->width) || (core->frame_height != core->height))
+            {
+                core->width = core->frame_width;
+                core->height = core->frame_height;
+                core->line_bytes = core->frame_width * 2;
+                core->geometry_changes++;
+            }
+            on_frame_start(core);
+        }
+        else
+        {
+            BF30A2_TRACE(BF30A2_TRACE_GEOMETRY_REJECT, 0, core->frame_height);
+            core->errors++;
+        }
+        core->state = STATE_FIND_SYNC;
+        core->ff_count = 0;
+        break;
+
+    case STATE_LINE_NUM_H:
+        core->line_num = (rt_uint16_t)b << 8;
+        core->state = STATE_LINE_NUM_L;
+        break;
+
+    case STATE_LINE_NUM_L:
+        core->line_num |= b;
+        core->state = STATE_DATA_SYNC_1;
+        core->ff_count = 0;
+        break;
+
+    case STATE_DATA_SYNC_1:
+        if (b == 0xFF)
+        {
+            core->state = STATE_DATA_SYNC_2;
+        }
+        else
+        {
+            BF30A2_TRACE(BF30A2_TRACE_SYNC_LOSS, STATE_DATA_SYNC_1, b);
+            core->state = STATE_FIND_SYNC;
+            core->ff_count = 0;
+        }
+        break;
+
+    case STATE_DATA_SYNC_2:
+        if (b == 0xFF)
+        {
+            core->state = STATE_DATA_SYNC_3;
+        }
+        else
+        {
+            BF30A2_TRACE(BF30A2_TRACE_SYNC_LOSS, STATE_DATA_SYNC_2, b);
+            core->state = STATE_FIND_SYNC;
+            core->ff_count = 0;
+        }
+        break;
+
+    case STATE_DATA_SYNC_3:
+        if (b == 0xFF)
+        {
+            core->state = STATE_DATA_TYPE;
+        }
+        else
+        {
+            BF30A2_TRACE(BF30A2_TRACE_SYNC_LOSS, STATE_DATA_SYNC_3, b);
+            core->state = STATE_FIND_SYNC;
+            core->ff_count = 0;
+        }
+        break;
+
+    case STATE_DATA_TYPE:
+        if (b == core->proto->data_type)
+        {
+            core->state = STATE_DATA_SIZE_H;
+        }
+        else
+        {
+            BF30A2_TRACE(BF30A2_TRACE_SYNC_LOSS, STATE_DATA_TYPE, b);
+            core->state = STATE_FIND_SYNC;
+            core->ff_count = 0;
+        }
+        break;
+
+    case STATE_DATA_SIZE_H:
+        core->data_size = (rt_uint16_t)b << 8;
+        core->state = STATE_DATA_SIZE_L;
+        break;
+
+    case STATE_DATA_SIZE_L:
+        core->data_size |= b;
+        if (core->data_size == core->line_bytes)
+        {
+            core->data_pos = 0;
+            core->state = STATE_PIXEL_DATA;
+        }
+        else
+        {
+            BF30A2_TRACE(BF30A2_TRACE_SIZE_MISMATCH, 0, core->data_size);
+            core->errors++;
+            core->state = STATE_FIND_SYNC;
+            core->ff_count = 0;
+        }
+        break;
+
+    default:
+        core->state = STATE_FIND_SYNC;
+        core->ff_count = 0;
+        break;
+    }
+}
+
+void bf30a2_core_feed(bf30a2_core_t *core, const rt_uint8_t *data, rt_uint32_t len)
+{
+    const rt_uint8_t *end = data + len;
+    rt_uint32_t n;
+
+    while (data < end)
+    {
+        if (core->state != STATE_PIXEL_DATA)
+        {
+            parse_byte(core, *data++);
+            continue;
+        }
+
+        /* Pixel payload is length delimited: copy it in one go, or step over it */
+        n = core->line_bytes - core->data_pos;
+        if (n > (rt_uint32_t)(end - data))
+        {
+            n = (rt_uint32_t)(end - data);
+        }
+        if (!core->frame_skip)
+        {
+            rt_memcpy(&core->line_yuv[core->data_pos], data, n);
+        }
+        core->data_pos += n;
+        data += n;
+
+        if (core->data_pos >= core->line_bytes)
+        {
+            on_line_complete(core);
+            core->state = STATE_FIND_SYNC;
+            core->ff_count = 0;
+        }
+    }
+}
+
+rt_uint32_t bf30a2_core_feed_ring(bf30a2_core_t *core, const rt_uint8_t *ring,
+                                  rt_uint32_t size, rt_uint32_t rd, rt_uint32_t wr)
+{
+    if (wr < rd)
+    {
+        bf30a2_core_feed(core, ring + rd, size - rd);
+        rd = 0;
+    }
+    bf30a2_core_feed(core, ring + rd, wr - rd);
+
+    return wr;
+}
@@ -0,0 +1,498 @@
+/**
+ * @file    bf30a2_core.h
+ * @brief   BF30A2 SPI protocol parser and pixel conversion core (internal)
+ *
+ * Pure logic with no HAL or RTOS dependencies beyond the basic RT-Thread
+ * types, so it builds both into the driver and into the host tools under
+ * tools/host.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_CORE_H__
+#define __BF30A2_CORE_H__
+
+#include <rtthread.h>
+#include "drv_bf30a2.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Geometry limits. Each frame header carries the frame's own width and
+ * height, accepted when within these; every buffer is sized for the
+ * largest, so a windowed or subsampled sensor mode needs no rebuild.
+ */
+#ifndef BF30A2_MAX_WIDTH
+#define BF30A2_MAX_WIDTH            BF30A2_DEFAULT_WIDTH
+#endif
+#ifndef BF30A2_MAX_HEIGHT
+#define BF30A2_MAX_HEIGHT           BF30A2_DEFAULT_HEIGHT
+#endif
+#define BF30A2_MIN_WIDTH            16
+#define BF30A2_MIN_HEIGHT           16
+
+/* Image Parameters (largest frame) */
+#define IMG_WIDTH                   BF30A2_MAX_WIDTH
+#define IMG_HEIGHT                  BF30A2_MAX_HEIGHT
+#define BYTES_PER_LINE              (IMG_WIDTH * 2)
+
+/* Protocol Frame Sizes */
+#define FRAME_HEADER_SIZE           9
+#define LINE_HEADER_SIZE            6
+#define DATA_HEADER_SIZE            6
+#define ONE_LINE_TOTAL              (LINE_HEADER_SIZE + DATA_HEADER_SIZE + BYTES_PER_LINE)
+#define ONE_FRAME_SIZE              (IMG_WIDTH * IMG_HEIGHT * 2)
+
+/* SPI bytes of one w x h frame: header, lines and the 4 byte frame end */
+#define FRAME_STREAM_SIZE(w, h)     (FRAME_HEADER_SIZE + \
+                                     (h) * (LINE_HEADER_SIZE + DATA_HEADER_SIZE + (w) * 2) + 4)
+
+/* Bytes per line in the UART frame export */
+#define BF30A2_EXPORT_HEX_PER_LINE  32
+
+/* Largest thumbnail decimation (BF30A2_PLANE_THUMB) */
+#define BF30A2_THUMB_MAX_SCALE      8
+
+/* DMA Configuration */
+#define DMA_BUFFER_SIZE             (ONE_LINE_TOTAL * 16)
+
+/**
+ * @brief Parse state machine states
+ */
+typedef enum
+{
+    STATE_FIND_SYNC,
+    STATE_GET_TYPE,
+    STATE_FRAME_FORMAT,
+    STATE_FRAME_WIDTH_H,
+    STATE_FRAME_WIDTH_L,
+    STATE_FRAME_HEIGHT_H,
+    STATE_FRAME_HEIGHT_L,
+    STATE_LINE_NUM_H,
+    STATE_LINE_NUM_L,
+    STATE_DATA_SYNC_1,
+    STATE_DATA_SYNC_2,
+    STATE_DATA_SYNC_3,
+    STATE_DATA_TYPE,
+    STATE_DATA_SIZE_H,
+    STATE_DATA_SIZE_L,
+    STATE_PIXEL_DATA,
+} parse_state_t;
+
+typedef struct bf30a2_core bf30a2_core_t;
+
+/**
+ * @brief Secondary outputs converted alongside the frame buffer
+ *
+ * Unlike the frame buffer they do not follow the output level.
+ */
+typedef enum
+{
+    BF30A2_PLANE_Y8 = 0,                /**< Full resolution luma, 1 byte per pixel */
+    BF30A2_PLANE_HALF,                  /**< Half width and height RGB565 */
+    BF30A2_PLANE_THUMB,                 /**< Box-filtered thumbnail, thumb_scale / thumb_format */
+    BF30A2_PLANES,
+} bf30a2_plane_t;
+
+/* Late intervals in a row taken as a new, slower frame rate */
+#define BF30A2_IVAL_RESEED          4
+
+/**
+ * @brief Interval statistics between published frames
+ *
+ * Updated once per published frame from frame_stamp. The average is an
+ * exponential moving average (weight 1/8) over on-time intervals only,
+ * so a dropped frame does not stretch the reference it is judged by.
+ * BF30A2_IVAL_RESEED late intervals in a row are a slower rate rather
+ * than drops (longer exposure, a new window): the average restarts
+ * from the last one and the run is not counted late.
+ * An interval spanning frames skipped by the output level is divided by
+ * the number of sensor frames it spans, so the rate stays the sensor's.
+ */
+typedef struct bf30a2_core_interval
+{
+    rt_uint8_t have_prev;               /**< prev_* describe a frame of this run */
+    rt_uint32_t prev_stamp;             /**< frame_stamp of the previous published frame */
+    rt_uint32_t prev_seq;               /**< frame_start_count at the previous publish */
+    rt_uint32_t last_us;                /**< Last interval */
+    rt_uint32_t min_us;                 /**< Shortest interval */
+    rt_uint32_t max_us;                 /**< Longest interval */
+    rt_uint32_t avg_q4;                 /**< Average on-time interval, us x 16 */
+    rt_uint32_t count;                  /**< Intervals measured */
+    rt_uint32_t ref_us;                 /**< First interval, origin of the sums below */
+    rt_int64_t sum_d;                   /**< Sum of (interval - ref_us) */
+    rt_uint64_t sum_d2;                 /**< Sum of (interval - ref_us)^2 */
+    rt_uint32_t late;                   /**< Intervals over 1.5 x average */
+    rt_uint8_t late_run;                /**< Late intervals in a row */
+    rt_uint32_t seq_gaps;               /**< Started frames never published */
+    rt_uint32_t skipped;                /**< Frames skipped since the previous publish */
+} bf30a2_core_interval_t;
+
+/**
+ * @brief Frame published hook, called from the parsing context
+ *
+ * core->frame_count holds the sequence number of the published frame.
+ */
+typedef void (*bf30a2_core_frame_hook_t)(bf30a2_core_t *core, void *ctx);
+
+/**
+ * @brief Line accepted hook, called after the line has been converted
+ *
+ * core->line_num and core->line_yuv still describe the completed line.
+ * Not called for lines parsed header-only.
+ */
+typedef void (*bf30a2_core_line_hook_t)(bf30a2_core_t *core, void *ctx);
+
+/**
+ * @brief Frame buffer hook, called at each accepted frame header
+ *
+ * Returns the buffer the frame is converted into, or RT_NULL to drop the
+ * frame: its lines are then parsed header-only and it is not published.
+ * The hook may also set core->frame_plane[] for the frame; they are
+ * cleared before it is called.
+ */
+typedef rt_uint8_t *(*bf30a2_core_acquire_hook_t)(bf30a2_core_t *core, void *ctx);
+
+/**
+ * @brief Line destination hook, called before each output line is converted
+ *
+ * Returns where the line at core->line_num goes, in the geometry of
+ * core->frame_level, or RT_NULL to leave it unconverted. With this hook
+ * the frame buffer is not used (streaming output).
+ */
+typedef rt_uint8_t *(*bf30a2_core_line_dst_hook_t)(bf30a2_core_t *core, void *ctx);
+
+/**
+ * @brief Tone curve applied by the frame output conversion
+ *
+ * y maps the luma of every output pixel; rgb, when has_rgb is set, then
+ * maps the red, green and blue of RGB565 output (as 8-bit values).
+ */
+typedef struct bf30a2_tone
+{
+    rt_uint8_t y[256];                  /**< Luma curve */
+    rt_uint8_t rgb[3][256];             /**< Red, green, blue curves */
+    rt_uint8_t has_rgb;                 /**< rgb is in use */
+    rt_uint32_t generation;             /**< Install that wrote it, from 1: tells reused banks apart */
+} bf30a2_tone_t;
+
+/**
+ * @brief Line kernel of the frame output pipeline
+ *
+ * Converts width (even) YUV422 pixels from yuv, writing the output pixels
+ * step bytes apart from dst, and adds the luma samples it reads to stats
+ * (RT_NULL for none) before they go through tone (RT_NULL for none).
+ */
+typedef void (*bf30a2_pipe_kernel_t)(const rt_uint8_t *yuv, rt_uint8_t *dst, rt_int32_t step,
+                                     int width, bf30a2_frame_stats_t *stats,
+                                     const bf30a2_tone_t *tone);
+
+/**
+ * @brief Frame output pipeline resolved for one frame geometry and level
+ *
+ * Lines y0 .. y0 + rows - 1 (the even ones at the half levels) are
+ * converted from column x0, cols pixels wide. The first output pixel of
+ * kept line n goes origin + n * pitch bytes into the frame, the others of
+ * the line step bytes apart, so a crop, mirror or rotation is only where
+ * the kernel writes.
+ */
+typedef struct bf30a2_core_pipe
+{
+    bf30a2_pipe_kernel_t kernel;        /**< Line kernel */
+    rt_uint16_t x0;                     /**< First source column */
+    rt_uint16_t y0;                     /**< First source line */
+    rt_uint16_t cols;                   /**< Source columns */
+    rt_uint16_t rows;                   /**< Source lines */
+    rt_uint8_t half;                    /**< Every other pixel and line */
+    rt_uint8_t plain;                   /**< Whole frame, as received: the level's own loops */
+    rt_int32_t origin;                  /**< Output of the first pixel of the first kept line */
+    rt_int32_t step;                    /**< Bytes between output pixels of a line */
+    rt_int32_t pitch;                   /**< Bytes between the outputs of kept lines */
+} bf30a2_core_pipe_t;
+
+/* Fingerprint blocks and sampling pitch of change detection, in pixels and lines */
+#define BF30A2_CHANGE_BLOCKS        (BF30A2_CHANGE_GRID * BF30A2_CHANGE_GRID)
+#define BF30A2_CHANGE_STEP          4
+
+/**
+ * @brief Change detection state
+ *
+ * The frame being assembled is summed per block; ref holds the block
+ * means of the last frame found changed, with the output it was made at.
+ */
+typedef struct bf30a2_core_change
+{
+    bf30a2_change_cfg_t cfg;            /**< Configuration, may change while running */
+    rt_uint8_t mode;                    /**< cfg.mode latched at the frame start */
+    rt_uint32_t sum[BF30A2_CHANGE_BLOCKS];      /**< Luma sums of this frame */
+    rt_uint16_t samples[BF30A2_CHANGE_BLOCKS];  /**< Samples in sum */
+    rt_uint8_t ref[BF30A2_CHANGE_BLOCKS];       /**< Block means of the reference */
+    rt_uint32_t ref_tone;               /**< Tone curve generation of the reference, 0 = none */
+    rt_uint16_t ref_width;              /**< Sensor width of the reference */
+    rt_uint16_t ref_height;             /**< Sensor height of the reference */
+    rt_uint8_t ref_level;               /**< Output level of the reference */
+    rt_uint8_t ref_valid;               /**< ref holds a frame */
+    rt_uint8_t unchanged;               /**< Result of the last frame compared */
+    bf30a2_change_info_t info;          /**< Results and counters */
+} bf30a2_core_change_t;
+
+/**
+ * @brief Parser and frame assembly state
+ */
+struct bf30a2_core
+{
+    /* Parse state machine */
+    parse_state_t state;                /**< Current parse state */
+    rt_uint8_t ff_count;                /**< 0xFF byte count */
+    rt_uint16_t frame_width;            /**< Width field of the header being parsed */
+    rt_uint16_t frame_height;           /**< Height field of the header being parsed */
+    rt_uint16_t line_num;               /**< Current line number */
+    rt_uint16_t data_size;              /**< Data size for current line */
+    rt_uint16_t data_pos;               /**< Position in line data */
+
+    /* Frame buffers */
+    rt_uint8_t *frame_rgb565;           /**< Buffer of the frame being assembled */
+    rt_uint8_t *frame_plane[BF30A2_PLANES]; /**< Secondary outputs of this frame, RT_NULL = none */
+    rt_uint8_t line_yuv[BYTES_PER_LINE];/**< YUV line buffer */
+    rt_uint16_t lines_received;         /**< Lines received in current frame */
+    rt_uint16_t max_line_seen;          /**< Maximum line number seen */
+    rt_uint8_t frame_ready;             /**< Frame ready flag */
+    rt_uint8_t in_frame;                /**< Currently receiving frame flag */
+    rt_uint8_t keep_raw;                /**< Store lines as received, converted on demand */
+
+    /* Geometry from the last accepted frame header */
+    rt_uint16_t width;                  /**< Pixels per line */
+    rt_uint16_t height;                 /**< Lines per frame */
+    rt_uint16_t line_bytes;             /**< Payload bytes per line, width * 2 */
+    rt_uint16_t pub_width;              /**< Width of the last published frame */
+    rt_uint16_t pub_height;             /**< Height of the last published frame */
+    rt_uint32_t geometry_changes;       /**< Headers that changed the geometry */
+
+    /* Thumbnail, summed over thumb_scale lines before it is written */
+    rt_uint8_t thumb_scale;             /**< Decimation 2, 4 or 8, 0 = off; set while stopped */
+    rt_uint8_t thumb_format;            /**< BF30A2_FORMAT_RGB565 or BF30A2_FORMAT_Y8 */
+    rt_uint8_t thumb_rows;              /**< Lines summed into thumb_acc */
+    rt_uint16_t thumb_row;              /**< Thumbnail row being summed */
+    rt_uint16_t thumb_acc[3][IMG_WIDTH / 2];    /**< Y, Cb, Cr sums per thumbnail column */
+
+    /* Frame output pipeline */
+    bf30a2_pipeline_t pipeline;         /**< Crop, transform and statistics; set while stopped */
+    bf30a2_core_pipe_t pipe;            /**< pipeline resolved at the frame start */
+    bf30a2_frame_stats_t stats;         /**< Statistics of the frame, complete at on_frame */
+    const bf30a2_tone_t *tone;          /**< Tone curve from the next frame start, RT_NULL = none */
+    const bf30a2_tone_t *frame_tone;    /**< Tone curve of the frame being assembled */
+
+    /* Change detection */
+    bf30a2_core_change_t change;        /**< Fingerprints, reference and counters */
+
+    /* Statistics */
+    rt_uint32_t frame_count;            /**< Total frame count */
+    rt_uint32_t complete_frames;        /**< Complete frames count */
+    rt_uint32_t frame_start_count;      /**< Frame start count */
+    rt_uint32_t frame_end_count;        /**< Frame end count */
+    rt_uint32_t line_count;             /**< Total line count */
+    rt_uint32_t errors;                 /**< Error count */
+
+    /* Timestamps (bf30a2_port_cycles()) */
+    rt_uint32_t wake_stamp;             /**< Current DMA wakeup, set by the feeder */
+    rt_uint32_t frame_stamp;            /**< Wakeup that parsed this frame's header */
+    rt_uint32_t done_stamp;             /**< Last line of this frame converted, 0 = not yet */
+    rt_uint32_t pub_stamp;              /**< frame_stamp of the last published frame */
+    rt_uint32_t pub_done_stamp;         /**< done_stamp of the last published frame */
+    bf30a2_core_interval_t ival;        /**< Frame interval statistics */
+
+    /* Output level (bf30a2_level_t) */
+    rt_uint8_t level;                   /**< Requested level, latched at each frame start */
+    rt_uint8_t frame_level;             /**< Level of the frame being assembled */
+    rt_uint8_t frame_skip;              /**< Lines are parsed header-only, nothing is published */
+    rt_uint8_t skip_phase;              /**< Alternates per frame while skipping */
+    rt_uint8_t pub_level;               /**< Level of the last published frame */
+    rt_uint32_t skipped_frames;         /**< Frames skipped by level */
+    rt_uint32_t bp_dropped;             /**< Frames dropped for want of a free buffer */
+
+    /* Stream protocol variant, RT_NULL = BF30A2 until bf30a2_core_reset() */
+    const bf30a2_proto_t *proto;        /**< Packet type codes */
+
+    /* Hooks */
+    bf30a2_core_frame_hook_t on_frame;  /**< Frame published hook */
+    bf30a2_core_line_hook_t on_line;    /**< Line accepted hook (optional) */
+    bf30a2_core_acquire_hook_t on_acquire;  /**< Frame buffer hook (optional) */
+    bf30a2_core_line_dst_hook_t on_line_dst;    /**< Line destination hook (optional) */
+    void *hook_ctx;                     /**< Hook context */
+};
+
+/**
+ * @brief Packet type codes of the BF30A2 stream
+ */
+extern const bf30a2_proto_t bf30a2_proto_default;
+
+/**
+ * @brief Reset the parse state machine (statistics are kept)
+ *
+ * A core without a protocol variant gets bf30a2_proto_default.
+ */
+void bf30a2_core_reset(bf30a2_core_t *core);
+
+/**
+ * @brief Clear all statistics counters
+ */
+void bf30a2_core_reset_stats(bf30a2_core_t *core);
+
+/**
+ * @brief Fill the frame rate and interval fields of a status structure
+ */
+void bf30a2_core_get_intervals(const bf30a2_core_t *core, bf30a2_status_info_t *status);
+
+/**
+ * @brief Output geometry of a level for a width x height sensor frame
+ *
+ * Fills width, height, frame_size and format of info; other fields are
+ * left untouched.
+ */
+void bf30a2_core_level_geometry(rt_uint8_t level, rt_uint16_t width, rt_uint16_t height,
+                                bf30a2_info_t *info);
+
+/**
+ * @brief Output geometry of a secondary plane, filled like the level's
+ */
+void bf30a2_core_plane_geometry(const bf30a2_core_t *core, rt_uint8_t plane,
+                                rt_uint16_t width, rt_uint16_t height, bf30a2_info_t *info);
+
+/**
+ * @brief Resolve a pipeline for a width x height frame at a level
+ *
+ * @param pipeline  RT_NULL for none
+ * @param tone      Tone curve, RT_NULL for none
+ * @param info      Receives the frame output geometry, filled as by
+ *                  bf30a2_core_level_geometry()
+ */
+void bf30a2_core_pipe_resolve(const bf30a2_pipeline_t *pipeline, const bf30a2_tone_t *tone,
+                              rt_uint8_t level, rt_uint16_t width, rt_uint16_t height,
+                              bf30a2_core_pipe_t *pipe, bf30a2_info_t *info);
+
+/**
+ * @brief Frame output geometry of a level through a pipeline (RT_NULL for none)
+ */
+void bf30a2_core_output_geometry(const bf30a2_pipeline_t *pipeline, rt_uint8_t level,
+                                 rt_uint16_t width, rt_uint16_t height, bf30a2_info_t *info);
+
+/**
+ * @brief Stream bytes still to come for the frame being received
+ *
+ * Counted from the highest line received, in the frame's own geometry, so
+ * it is an estimate while a line is part way in; 0 between frames.
+ */
+rt_uint32_t bf30a2_core_frame_remaining(const bf30a2_core_t *core);
+
+/**
+ * @brief Parse a contiguous block of received bytes
+ */
+void bf30a2_core_feed(bf30a2_core_t *core, const rt_uint8_t *data, rt_uint32_t len);
+
+/**
+ * @brief Rebuild the byte stream of a dual-lane (2-bit) capture
+ *
+ * Each SPI clock carries two bits: lane 1 bits 7, 5, 3, 1 and lane 0
+ * bits 6, 4, 2, 0 of a sensor byte. Captured one lane per byte stream,
+ * every lane byte holds half of two consecutive sensor bytes, so n bytes
+ * of each lane give 2 * n stream bytes.
+ */
+void bf30a2_lanes_deinterleave(const rt_uint8_t *lane0, const rt_uint8_t *lane1,
+                               rt_uint8_t *out, rt_uint32_t n);
+
+/**
+ * @brief Parse n bytes of each lane of a dual-lane capture
+ *
+ * De-interleaved in short chunks on the stack ahead of bf30a2_core_feed().
+ */
+void bf30a2_core_feed_lanes(bf30a2_core_t *core, const rt_uint8_t *lane0,
+                            const rt_uint8_t *lane1, rt_uint32_t n);
+
+/**
+ * @brief Parse the bytes of a circular DMA buffer between two positions
+ *
+ * @param ring  Ring base address
+ * @param size  Ring size in bytes
+ * @param rd    Position of the first unparsed byte
+ * @param wr    Current DMA write position
+ *
+ * @return New read position (always wr)
+ */
+rt_uint32_t bf30a2_core_feed_ring(bf30a2_core_t *core, const rt_uint8_t *ring,
+                                  rt_uint32_t size, rt_uint32_t rd, rt_uint32_t wr);
+
+/**
+ * @brief Convert one packed YUV422 (Y0 Cb Y1 Cr) line to little-endian RGB565
+ */
+void bf30a2_yuv_line_to_rgb565(const rt_uint8_t *yuv, rt_uint8_t *rgb, int width);
+
+/**
+ * @brief Convert one YUV422 line to width / 2 RGB565 pixels (Y0 of each pair)
+ */
+void bf30a2_yuv_line_to_rgb565_half(const rt_uint8_t *yuv, rt_uint8_t *rgb, int width);
+
+/**
+ * @brief Convert one YUV422 line to RGB565 and extract its luma in the same pass
+ */
+void bf30a2_yuv_line_to_rgb565_y8(const rt_uint8_t *yuv, rt_uint8_t *rgb, rt_uint8_t *y8,
+                                  int width);
+
+/**
+ * @brief Extract the width luma bytes of one YUV422 line
+ */
+void bf30a2_yuv_line_to_y8(const rt_uint8_t *yuv, rt_uint8_t *y8, int width);
+
+/**
+ * @brief Extract width / 2 luma bytes (Y0 of each pair) from one YUV422 line
+ */
+void bf30a2_yuv_line_to_y8_half(const rt_uint8_t *yuv, rt_uint8_t *y8, int width);
+
+/**
+ * @brief Convert a stored YUV422 frame to the output of a level
+ *
+ * The frame is width x height, packed lines of width * 2 bytes; dst gets
+ * what the core would have assembled at that level through the pipeline
+ * and tone curve (RT_NULL for none) from the same lines. Statistics are
+ * not taken.
+ */
+void bf30a2_yuv_frame_to_level(const bf30a2_pipeline_t *pipeline, const bf30a2_tone_t *tone,
+                               const rt_uint8_t *yuv, rt_uint8_t level, rt_uint16_t width,
+                               rt_uint16_t height, rt_uint8_t *dst);
+
+/**
+ * @brief Convert a stored YUV422 frame to a BF30A2_PLANE_Y8 or BF30A2_PLANE_HALF plane
+ */
+void bf30a2_yuv_frame_to_plane(const rt_uint8_t *yuv, rt_uint8_t plane, rt_uint16_t width,
+                               rt_uint16_t height, rt_uint8_t *dst);
+
+/**
+ * @brief Add one YUV422 line to the column sums of a thumbnail row
+ *
+ * acc[0] receives the sum of the scale luma samples of each of the
+ * width / scale columns, acc[1] and acc[2] (with chroma set) the sum of
+ * the scale / 2 Cb and Cr samples. first starts a new row.
+ */
+void bf30a2_thumb_accumulate(const rt_uint8_t *yuv, rt_uint16_t acc[3][IMG_WIDTH / 2],
+                             int width, int scale, int chroma, int first);
+
+/**
+ * @brief Average the column sums of rows lines into one thumbnail row
+ */
+void bf30a2_thumb_emit(const rt_uint16_t acc[3][IMG_WIDTH / 2], rt_uint8_t *dst, int cols,
+                       int scale, int rows, rt_uint8_t format);
+
+/**
+ * @brief Encode bytes as upper-case hex for the UART exports
+ *
+ * dst receives 2 * len characters and a terminating NUL.
+ */
+void bf30a2_hex_encode(const rt_uint8_t *src, rt_uint32_t len, char *dst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BF30A2_CORE_H__ */
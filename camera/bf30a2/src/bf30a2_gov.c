@@ -0,0 +1,180 @@
+/**
+ * @file    bf30a2_gov.c
+ * @brief   BF30A2 CPU and ring budget governor
+ *
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <rtthread.h>
+#include <string.h>
+
+#include "bf30a2_gov.h"
+
+#ifdef BF30A2_USING_GOVERNOR
+
+#include "bf30a2_port.h"
+
+/*============================================================================*/
+/*                     CONFIGURATION                                          */
+/*============================================================================*/
+
+void bf30a2_gov_init(bf30a2_gov_t *gov)
+{
+    rt_memset(gov, 0, sizeof(*gov));
+    gov->cfg.enable = 1;
+    gov->cfg.level = BF30A2_LEVEL_FULL;
+    gov->cfg.max_level = BF30A2_GOV_MAX_LEVEL;
+    gov->cfg.cpu_budget = BF30A2_GOV_CPU_BUDGET;
+    gov->cfg.ring_budget = BF30A2_GOV_RING_BUDGET;
+    gov->cfg.window_ms = BF30A2_GOV_WINDOW_MS;
+    gov->level = BF30A2_LEVEL_FULL;
+}
+
+rt_err_t bf30a2_gov_configure(bf30a2_gov_t *gov, const bf30a2_gov_cfg_t *cfg)
+{
+    if ((cfg->level >= BF30A2_LEVELS) || (cfg->max_level >= BF30A2_LEVELS) ||
+        (cfg->cpu_budget == 0) || (cfg->cpu_budget > 100) ||
+        (cfg->ring_budget < BF30A2_GOV_RING_MIN) || (cfg->ring_budget > 100) ||
+        (cfg->window_ms < 50) || (cfg->window_ms > 2000))
+    {
+        return -RT_EINVAL;
+    }
+
+    gov->cfg = *cfg;
+    gov->calm = 0;
+    if (!cfg->enable)
+    {
+        gov->level = cfg->level;
+    }
+    else if (gov->level > cfg->max_level)
+    {
+        gov->level = cfg->max_level;
+    }
+
+    return RT_EOK;
+}
+
+void bf30a2_gov_restart(bf30a2_gov_t *gov)
+{
+    gov->started = 0;
+    gov->calm = 0;
+    gov->busy = 0;
+    gov->ring_sum = 0;
+    gov->ring_count = 0;
+    gov->ring_peak = 0;
+    gov->win_laps = 0;
+}
+
+/*============================================================================*/
+/*                     ACCOUNTING                                             */
+/*============================================================================*/
+
+rt_uint32_t bf30a2_gov_backlog(rt_uint32_t size, rt_uint32_t rd, rt_uint32_t wr,
+                               rt_uint32_t irqs)
+{
+    rt_uint32_t half = size / 2;
+    rt_uint32_t backlog = (wr + size - rd) % size;
+    rt_uint32_t marks = (rd + backlog) / half - rd / half;
+
+    /*
+     * Every lap of the ring adds two interrupts to the half-ring marks the
+     * backlog crossed. One more is tolerated: the interrupt for a mark can
+     * land just after the previous wakeup read the DMA position.
+     */
+    if (irqs > marks + 1)
+    {
+        backlog += ((irqs - marks) / 2) * size;
+    }
+
+    return backlog;
+}
+
+static void evaluate(bf30a2_gov_t *gov, rt_uint32_t elapsed)
+{
+    const bf30a2_gov_cfg_t *cfg = &gov->cfg;
+
+    gov->cpu_pct = (rt_uint32_t)((rt_uint64_t)gov->busy * 100 / elapsed);
+    gov->ring_pct = (gov->ring_count != 0) ? (gov->ring_sum / gov->ring_count) : 0;
+    gov->ring_peak_pct = gov->ring_peak;
+    gov->laps = gov->win_laps;
+
+    if (!cfg->enable)
+    {
+        gov->level = cfg->level;
+        return;
+    }
+
+    /*
+     * A single late wakeup reads well over half the ring without any harm,
+     * so the average over the window decides, unless the ring was lapped
+     * at more than one wakeup.
+     */
+    if ((gov->cpu_pct > cfg->cpu_budget) || (gov->ring_pct > cfg->ring_budget) ||
+        (gov->laps >= BF30A2_GOV_OVERRUN_WAKEUPS))
+    {
+        gov->calm = 0;
+        if (gov->level < cfg->max_level)
+        {
+            gov->level++;
+            gov->step_downs++;
+        }
+    }
+    else if ((gov->cpu_pct * 2 < cfg->cpu_budget) &&
+             (gov->ring_pct + BF30A2_GOV_RING_MARGIN <= cfg->ring_budget) &&
+             (gov->laps == 0))
+    {
+        if ((gov->level > BF30A2_LEVEL_FULL) && (++gov->calm >= BF30A2_GOV_CALM_WINDOWS))
+        {
+            gov->calm = 0;
+            gov->level--;
+            gov->step_ups++;
+        }
+    }
+    else
+    {
+        gov->calm = 0;
+    }
+}
+
+rt_uint8_t bf30a2_gov_account(bf30a2_gov_t *gov, rt_uint32_t wake, rt_uint32_t done,
+                              rt_uint32_t ring_pct)
+{
+    rt_uint32_t window = gov->cfg.window_ms * (bf30a2_port_cycles_hz() / 1000UL);
+    rt_uint32_t elapsed;
+
+    if (!gov->started)
+    {
+        gov->started = 1;
+        gov->win_start = wake;
+    }
+
+    gov->busy += done - wake;
+    gov->ring_sum += ring_pct;
+    gov->ring_count++;
+    if (ring_pct > 100)
+    {
+        gov->win_laps++;
+    }
+    if (ring_pct > gov->ring_peak)
+    {
+        gov->ring_peak = ring_pct;
+    }
+
+    elapsed = done - gov->win_start;
+    if (elapsed >= window)
+    {
+        evaluate(gov, elapsed);
+        gov->win_start = done;
+        gov->busy = 0;
+        gov->ring_sum = 0;
+        gov->ring_count = 0;
+        gov->ring_peak = 0;
+        gov->win_laps = 0;
+    }
+
+    return gov->level;
+}
+
+#endif /* BF30A2_USING_GOVERNOR */
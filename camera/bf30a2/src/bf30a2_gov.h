@@ -0,0 +1,130 @@
+/**
+ * @file    bf30a2_gov.h
+ * @brief   BF30A2 CPU and ring budget governor (internal)
+ *
+ * The capture thread reports, for every DMA wakeup, how long it was busy
+ * parsing (frame callbacks included) and how far the DMA was ahead of it.
+ * Once per window the governor compares the busy share of the window and
+ * the average ring backlog against their budgets: over either budget, or
+ * with the ring lapped at more than one wakeup, the output level steps
+ * down by one (bf30a2_level_t), and after BF30A2_GOV_CALM_WINDOWS windows
+ * well under both it steps back up.
+ * Only the capture thread calls bf30a2_gov_account(); configuration
+ * changes are single field writes picked up at the next wakeup.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_GOV_H__
+#define __BF30A2_GOV_H__
+
+#include <rtthread.h>
+#include "drv_bf30a2.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef BF30A2_USING_GOVERNOR
+
+#ifndef BF30A2_GOV_CPU_BUDGET
+#define BF30A2_GOV_CPU_BUDGET       50
+#endif
+
+#ifndef BF30A2_GOV_RING_BUDGET
+#define BF30A2_GOV_RING_BUDGET      75
+#endif
+
+#ifndef BF30A2_GOV_WINDOW_MS
+#define BF30A2_GOV_WINDOW_MS        500
+#endif
+
+#ifndef BF30A2_GOV_MAX_LEVEL
+#define BF30A2_GOV_MAX_LEVEL        BF30A2_LEVEL_Y8
+#endif
+
+/* Consecutive calm windows before stepping up */
+#define BF30A2_GOV_CALM_WINDOWS     4
+
+/*
+ * A window is calm when the CPU share is under half its budget and the
+ * average ring backlog at least this many points under its budget.
+ * Wakeups come at every half ring, so the backlog averages a little over
+ * 50 %; the smallest ring budget keeps that level calm.
+ */
+#define BF30A2_GOV_RING_MARGIN      10
+#define BF30A2_GOV_RING_MIN         70
+
+/* Wakeups in a window that found the ring lapped before stepping down */
+#define BF30A2_GOV_OVERRUN_WAKEUPS  2
+
+/**
+ * @brief Governor state
+ */
+typedef struct bf30a2_gov
+{
+    bf30a2_gov_cfg_t cfg;           /**< Configuration */
+    rt_uint8_t level;               /**< Current level */
+    rt_uint8_t calm;                /**< Consecutive calm windows */
+    rt_uint8_t started;             /**< win_start is valid */
+    rt_uint32_t win_start;          /**< Window start, cycles */
+    rt_uint32_t busy;               /**< Busy cycles in the window */
+    rt_uint32_t ring_sum;           /**< Backlog readings in the window, percent */
+    rt_uint32_t ring_count;         /**< Number of readings in ring_sum */
+    rt_uint32_t ring_peak;          /**< Peak backlog in the window, percent */
+    rt_uint32_t win_laps;           /**< Wakeups in the window that found the ring lapped */
+    rt_uint32_t cpu_pct;            /**< Busy share of the last window */
+    rt_uint32_t ring_pct;           /**< Average backlog of the last window */
+    rt_uint32_t ring_peak_pct;      /**< Peak backlog of the last window */
+    rt_uint32_t laps;               /**< Lapped wakeups of the last window */
+    rt_uint32_t step_downs;         /**< Level increases */
+    rt_uint32_t step_ups;           /**< Level decreases */
+} bf30a2_gov_t;
+
+/**
+ * @brief Initialize with the Kconfig defaults, at BF30A2_LEVEL_FULL
+ */
+void bf30a2_gov_init(bf30a2_gov_t *gov);
+
+/**
+ * @brief Apply a configuration
+ *
+ * @return -RT_EINVAL for an out of range field, RT_EOK otherwise
+ */
+rt_err_t bf30a2_gov_configure(bf30a2_gov_t *gov, const bf30a2_gov_cfg_t *cfg);
+
+/**
+ * @brief Start a new window, e.g. at capture start (the level is kept)
+ */
+void bf30a2_gov_restart(bf30a2_gov_t *gov);
+
+/**
+ * @brief Bytes the DMA is ahead of the reader
+ *
+ * The ring position alone cannot tell a backlog from a backlog plus a
+ * whole ring; irqs, the half/full interrupts since the previous wakeup,
+ * adds the laps it cannot see. Above size means the ring has overrun.
+ */
+rt_uint32_t bf30a2_gov_backlog(rt_uint32_t size, rt_uint32_t rd, rt_uint32_t wr,
+                               rt_uint32_t irqs);
+
+/**
+ * @brief Account one capture thread wakeup
+ *
+ * @param wake      Cycles at wakeup
+ * @param done      Cycles when the wakeup's bytes were parsed
+ * @param ring_pct  Backlog at wakeup, percent of the ring
+ *
+ * @return Level to apply to the next frame
+ */
+rt_uint8_t bf30a2_gov_account(bf30a2_gov_t *gov, rt_uint32_t wake, rt_uint32_t done,
+                              rt_uint32_t ring_pct);
+
+#endif /* BF30A2_USING_GOVERNOR */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BF30A2_GOV_H__ */
@@ -0,0 +1,148 @@
+/**
+ * @file    bf30a2_latency.c
+ * @brief   BF30A2 frame latency histograms
+ *
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <rtthread.h>
+#include <string.h>
+
+#include "bf30a2_latency.h"
+
+#ifdef BF30A2_USING_LATENCY
+
+#include "bf30a2_port.h"
+
+/*============================================================================*/
+/*                     BUCKETS                                                */
+/*============================================================================*/
+
+static int msb32(rt_uint32_t v)
+{
+    int n = 0;
+
+    while (v >>= 1)
+    {
+        n++;
+    }
+    return n;
+}
+
+static rt_uint32_t bucket_of(rt_uint32_t us)
+{
+    int msb;
+
+    if (us < BF30A2_LAT_LINEAR)
+    {
+        return us;
+    }
+
+    msb = msb32(us);
+    if (msb > BF30A2_LAT_MAX_MSB)
+    {
+        return BF30A2_LAT_BUCKETS - 1;
+    }
+
+    return BF30A2_LAT_LINEAR + (msb - 3) * BF30A2_LAT_SUB +
+           ((us >> (msb - 2)) & (BF30A2_LAT_SUB - 1));
+}
+
+/**
+ * @brief Middle of a bucket, the value reported for its percentiles
+ */
+static rt_uint32_t bucket_mid(rt_uint32_t idx)
+{
+    rt_uint32_t octave, sub, shift;
+
+    if (idx < BF30A2_LAT_LINEAR)
+    {
+        return idx;
+    }
+
+    octave = (idx - BF30A2_LAT_LINEAR) / BF30A2_LAT_SUB;
+    sub = (idx - BF30A2_LAT_LINEAR) % BF30A2_LAT_SUB;
+    shift = octave + 1;
+
+    return ((BF30A2_LAT_SUB + sub) << shift) + ((1UL << shift) >> 1);
+}
+
+/*============================================================================*/
+/*                     RECORDING                                              */
+/*============================================================================*/
+
+void bf30a2_lat_reset(bf30a2_lat_hist_t *hist)
+{
+    rt_memset(hist, 0, sizeof(*hist));
+}
+
+void bf30a2_lat_record_us(bf30a2_lat_hist_t *hist, rt_uint32_t us)
+{
+    if ((hist->count == 0) || (us < hist->min_us))
+    {
+        hist->min_us = us;
+    }
+    if (us > hist->max_us)
+    {
+        hist->max_us = us;
+    }
+    hist->bucket[bucket_of(us)]++;
+    hist->count++;
+}
+
+void bf30a2_lat_record(bf30a2_lat_hist_t *hist, rt_uint32_t from, rt_uint32_t to)
+{
+    bf30a2_lat_record_us(hist, (to - from) / (bf30a2_port_cycles_hz() / 1000000UL));
+}
+
+/*============================================================================*/
+/*                     SUMMARY                                                */
+/*============================================================================*/
+
+static rt_uint32_t percentile(const bf30a2_lat_hist_t *hist, rt_uint32_t pct)
+{
+    rt_uint32_t rank = (rt_uint32_t)(((rt_uint64_t)hist->count * pct + 99) / 100);
+    rt_uint32_t seen = 0;
+    rt_uint32_t i, v;
+
+    for (i = 0; i < BF30A2_LAT_BUCKETS; i++)
+    {
+        seen += hist->bucket[i];
+        if (seen >= rank)
+        {
+            break;
+        }
+    }
+
+    /* The bucket middle can lie outside the samples actually seen */
+    v = bucket_mid(i);
+    if (v < hist->min_us)
+    {
+        v = hist->min_us;
+    }
+    if (v > hist->max_us)
+    {
+        v = hist->max_us;
+    }
+    return v;
+}
+
+void bf30a2_lat_summary(const bf30a2_lat_hist_t *hist, bf30a2_lat_stats_t *stats)
+{
+    rt_memset(stats, 0, sizeof(*stats));
+    if (hist->count == 0)
+    {
+        return;
+    }
+
+    stats->count = hist->count;
+    stats->min_us = hist->min_us;
+    stats->p50_us = percentile(hist, 50);
+    stats->p90_us = percentile(hist, 90);
+    stats->p99_us = percentile(hist, 99);
+    stats->max_us = hist->max_us;
+}
+
+#endif /* BF30A2_USING_LATENCY */
@@ -0,0 +1,75 @@
+/**
+ * @file    bf30a2_latency.h
+ * @brief   BF30A2 frame latency histograms (internal)
+ *
+ * One log-linear histogram per measurement point. Each point is recorded
+ * by a single context (capture thread for ASSEMBLED/CALLBACK, the reader
+ * for WAIT/READ, the panel completion for PANEL), so recording takes no
+ * lock; a summary read while frames arrive may be off by the frames
+ * recorded during the read.
+ * With BF30A2_USING_LATENCY disabled every record point compiles to nothing.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_LATENCY_H__
+#define __BF30A2_LATENCY_H__
+
+#include <rtthread.h>
+#include "drv_bf30a2.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef BF30A2_USING_LATENCY
+
+/*
+ * Values below 8 us get one bucket each, then four buckets per octave up
+ * to 2^27 us (about two minutes); larger values land in the last bucket.
+ */
+#define BF30A2_LAT_LINEAR           8
+#define BF30A2_LAT_SUB              4
+#define BF30A2_LAT_MAX_MSB          26
+#define BF30A2_LAT_BUCKETS          (BF30A2_LAT_LINEAR + \
+                                     (BF30A2_LAT_MAX_MSB - 2) * BF30A2_LAT_SUB)
+
+/**
+ * @brief Histogram of one measurement point
+ */
+typedef struct bf30a2_lat_hist
+{
+    rt_uint32_t count;                          /**< Samples recorded */
+    rt_uint32_t min_us;                         /**< Smallest sample */
+    rt_uint32_t max_us;                         /**< Largest sample */
+    rt_uint32_t bucket[BF30A2_LAT_BUCKETS];     /**< Sample counts */
+} bf30a2_lat_hist_t;
+
+void bf30a2_lat_reset(bf30a2_lat_hist_t *hist);
+
+/**
+ * @brief Record the time between two bf30a2_port_cycles() stamps
+ */
+void bf30a2_lat_record(bf30a2_lat_hist_t *hist, rt_uint32_t from, rt_uint32_t to);
+
+/**
+ * @brief Record a latency in microseconds
+ */
+void bf30a2_lat_record_us(bf30a2_lat_hist_t *hist, rt_uint32_t us);
+
+void bf30a2_lat_summary(const bf30a2_lat_hist_t *hist, bf30a2_lat_stats_t *stats);
+
+#define BF30A2_LAT_RECORD(hist, from, to)   bf30a2_lat_record((hist), (from), (to))
+
+#else
+
+#define BF30A2_LAT_RECORD(hist, from, to)   do { } while (0)
+
+#endif /* BF30A2_USING_LATENCY */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BF30A2_LATENCY_H__ */
@@ -0,0 +1,154 @@
+/**
+ * @file    bf30a2_lvgl.c
+ * @brief   BF30A2 zero-copy LVGL image source
+ *
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <rtthread.h>
+#include <string.h>
+
+#include "bf30a2_lvgl.h"
+
+#ifdef BF30A2_USING_LVGL
+
+#if !LV_VERSION_CHECK(9, 1, 0)
+#error "BF30A2_USING_LVGL needs LVGL 9.1 or later"
+#endif
+
+/*============================================================================*/
+/*                     LEASES                                                 */
+/*============================================================================*/
+
+static void bf30a2_lv_release(bf30a2_lv_src_t *src, bf30a2_buffer_t *buf)
+{
+    if (buf->data != RT_NULL)
+    {
+        rt_device_control(src->dev, BF30A2_CMD_RELEASE_FRAME, buf);
+        buf->data = RT_NULL;
+    }
+}
+
+/**
+ * @brief Describe a leased frame to LVGL, in place
+ *
+ * The driver writes RGB565 little endian, LVGL's native RGB565 layout.
+ */
+static void bf30a2_lv_fill_dsc(lv_image_dsc_t *dsc, const bf30a2_buffer_t *frame)
+{
+    rt_uint8_t y8 = (frame->format == BF30A2_FORMAT_Y8);
+
+    rt_memset(dsc, 0, sizeof(*dsc));
+    dsc->header.magic = LV_IMAGE_HEADER_MAGIC;
+    dsc->header.cf = y8 ? LV_COLOR_FORMAT_L8 : LV_COLOR_FORMAT_RGB565;
+    dsc->header.w = frame->width;
+    dsc->header.h = frame->height;
+    dsc->header.stride = frame->width * (y8 ? 1 : 2);
+    dsc->data_size = frame->size;
+    dsc->data = frame->data;
+}
+
+/*============================================================================*/
+/*                     LVGL CALLBACKS                                         */
+/*============================================================================*/
+
+/**
+ * @brief Display rendered: the replaced frame is no longer read
+ */
+static void bf30a2_lv_render_ready(lv_event_t *e)
+{
+    bf30a2_lv_src_t *src = (bf30a2_lv_src_t *)lv_event_get_user_data(e);
+
+    bf30a2_lv_release(src, &src->retired);
+}
+
+/**
+ * @brief Poll timer: swap the newest frame in
+ */
+static void bf30a2_lv_poll(lv_timer_t *timer)
+{
+    bf30a2_lv_src_t *src = (bf30a2_lv_src_t *)lv_timer_get_user_data(timer);
+    bf30a2_wait_cfg_t wait;
+    bf30a2_buffer_t frame;
+
+    /* A hidden image is not drawn, so nothing waits for a render */
+    if ((src->retired.data != RT_NULL) && !lv_obj_is_visible(src->img))
+    {
+        bf30a2_lv_release(src, &src->retired);
+    }
+    if (src->retired.data != RT_NULL)
+    {
+        src->deferred++;
+        return;
+    }
+
+    wait.timeout_ms = 0;
+    wait.buffer = &frame;
+    if (rt_device_control(src->dev, BF30A2_CMD_LEASE_FRAME, &wait) != RT_EOK)
+    {
+        return;
+    }
+
+    src->retired = src->shown;
+    src->shown = frame;
+
+    /* Same descriptor, new pixels: the decoder cache must not keep the old ones */
+    lv_image_cache_drop(&src->dsc);
+    bf30a2_lv_fill_dsc(&src->dsc, &frame);
+    lv_image_set_src(src->img, &src->dsc);
+    src->frames++;
+}
+
+/*============================================================================*/
+/*                     PUBLIC API                                             */
+/*============================================================================*/
+
+rt_err_t bf30a2_lv_src_attach(bf30a2_lv_src_t *src, rt_device_t dev, lv_obj_t *img,
+                              rt_uint32_t period_ms)
+{
+    if ((src == RT_NULL) || (dev == RT_NULL) || (img == RT_NULL))
+    {
+        return -RT_EINVAL;
+    }
+
+    rt_memset(src, 0, sizeof(*src));
+    src->dev = dev;
+    src->img = img;
+    src->disp = lv_obj_get_display(img);
+    if (src->disp == RT_NULL)
+    {
+        return -RT_EINVAL;
+    }
+
+    src->timer = lv_timer_create(bf30a2_lv_poll,
+                                 (period_ms != 0) ? period_ms : BF30A2_LV_PERIOD_MS, src);
+    if (src->timer == RT_NULL)
+    {
+        return -RT_ENOMEM;
+    }
+    lv_display_add_event_cb(src->disp, bf30a2_lv_render_ready, LV_EVENT_RENDER_READY, src);
+
+    return RT_EOK;
+}
+
+void bf30a2_lv_src_detach(bf30a2_lv_src_t *src)
+{
+    if ((src == RT_NULL) || (src->timer == RT_NULL))
+    {
+        return;
+    }
+
+    lv_timer_delete(src->timer);
+    src->timer = RT_NULL;
+    lv_display_remove_event_cb_with_user_data(src->disp, bf30a2_lv_render_ready, src);
+
+    /* Nothing renders from here on: both frames can go back at once */
+    lv_image_set_src(src->img, RT_NULL);
+    lv_image_cache_drop(&src->dsc);
+    bf30a2_lv_release(src, &src->retired);
+    bf30a2_lv_release(src, &src->shown);
+}
+
+#endif /* BF30A2_USING_LVGL */
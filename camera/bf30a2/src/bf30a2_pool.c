@@ -0,0 +1,548 @@
+/**
+ * @file    bf30a2_pool.c
+ * @brief   BF30A2 frame buffer pool with consumer leases
+ *
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <rtthread.h>
+#include <rthw.h>
+#include <string.h>
+
+#include "bf30a2_pool.h"
+
+#ifdef BF30A2_USING_LAZY_CONVERT
+/*============================================================================*/
+/*                     CONVERSION                                             */
+/*============================================================================*/
+
+/**
+ * @brief Event bit of an output of a slot, set once it is converted
+ */
+static rt_uint32_t pool_event_bit(const bf30a2_pool_t *pool, const bf30a2_pool_slot_t *slot,
+                                  rt_int8_t plane)
+{
+    int out = (plane < 0) ? BF30A2_PLANES : plane;
+
+    return 1UL << (BF30A2_POOL_EVENT_SHIFT + (slot - pool->slot) * BF30A2_POOL_EVENT_BITS + out);
+}
+
+/**
+ * @brief Event bits of every output of a slot
+ */
+static rt_uint32_t pool_event_slot(const bf30a2_pool_t *pool, const bf30a2_pool_slot_t *slot)
+{
+    return ((1UL << BF30A2_POOL_EVENT_BITS) - 1) <<
+           (BF30A2_POOL_EVENT_SHIFT + (slot - pool->slot) * BF30A2_POOL_EVENT_BITS);
+}
+
+/**
+ * @brief Convert an output unless another reader has, waiting for it if asked
+ *
+ * @return RT_FALSE when another reader is converting it and wait is not set
+ */
+static rt_bool_t pool_convert(bf30a2_pool_t *pool, bf30a2_pool_slot_t *slot, rt_int8_t plane,
+                              rt_bool_t wait)
+{
+    rt_uint8_t bit = (plane < 0) ? BF30A2_POOL_CONVERTED_FRAME : (rt_uint8_t)(1U << plane);
+    volatile rt_uint8_t *converted;
+    rt_base_t level;
+    rt_bool_t claimed;
+
+    /* The thumbnail is summed while capturing */
+    if ((slot == RT_NULL) || (slot->converted & bit) || (plane == BF30A2_PLANE_THUMB) ||
+        ((plane >= 0) && !(slot->planes & bit)))
+    {
+        return RT_TRUE;
+    }
+
+    /* One reader converts, the others wait for its result */
+    level = rt_hw_interrupt_disable();
+    claimed = !(slot->converted & bit) && !(slot->converting & bit);
+    if (claimed)
+    {
+        slot->converting |= bit;
+    }
+    rt_hw_interrupt_enable(level);
+
+    if (!claimed)
+    {
+        if (!wait)
+        {
+            return RT_FALSE;
+        }
+        /* The bit stays set until the slot is acquired again, which the lease holds off */
+        converted = &slot->converted;
+        while (!(*converted & bit))
+        {
+            rt_event_recv(pool->done, pool_event_bit(pool, slot, plane), RT_EVENT_FLAG_OR,
+                          RT_WAITING_FOREVER, RT_NULL);
+        }
+        return RT_TRUE;
+    }
+
+    if (plane < 0)
+    {
+        bf30a2_yuv_frame_to_level(&pool->core->pipeline, slot->tone, slot->raw,
+                                  slot->level, slot->width, slot->height, slot->data);
+    }
+    else
+    {
+        bf30a2_yuv_frame_to_plane(slot->raw, (rt_uint8_t)plane, slot->width, slot->height,
+                                  slot->plane[plane]);
+    }
+
+    level = rt_hw_interrupt_disable();
+    slot->converted |= bit;
+    slot->converting &= ~bit;
+    if (plane < 0)
+    {
+        pool->conversions++;
+    }
+    rt_hw_interrupt_enable(level);
+    rt_event_send(pool->done, pool_event_bit(pool, slot, plane));
+
+    return RT_TRUE;
+}
+#endif
+
+/*============================================================================*/
+/*                     ALLOCATION                                             */
+/*============================================================================*/
+
+rt_err_t bf30a2_pool_alloc(bf30a2_pool_t *pool, rt_uint32_t size)
+{
+    rt_uint32_t plane_size[BF30A2_PLANES];
+    rt_uint32_t conversions = pool->conversions;
+#ifdef BF30A2_USING_LAZY_CONVERT
+    const bf30a2_core_t *core = pool->core;
+    rt_event_t done = pool->done;
+#endif
+    int i, p;
+
+    rt_memcpy(plane_size, pool->plane_size, sizeof(plane_size));
+    rt_memset(pool, 0, sizeof(*pool));
+    pool->conversions = conversions;
+#ifdef BF30A2_USING_LAZY_CONVERT
+    pool->core = core;
+    pool->done = done;
+#endif
+    pool->filling = -1;
+    pool->latest = -1;
+    pool->frame_size = size;
+
+    for (i = 0; i < BF30A2_FRAME_BUFFERS; i++)
+    {
+        pool->slot[i].data = rt_malloc(size);
+        if (pool->slot[i].data == RT_NULL)
+        {
+            bf30a2_pool_free(pool);
+            return -RT_ENOMEM;
+        }
+        pool->count++;
+#ifdef BF30A2_USING_LAZY_CONVERT
+        pool->slot[i].raw = rt_malloc(size);
+        if (pool->slot[i].raw == RT_NULL)
+        {
+            bf30a2_pool_free(pool);
+            return -RT_ENOMEM;
+        }
+#endif
+    }
+
+    for (p = 0; p < BF30A2_PLANES; p++)
+    {
+        if ((plane_size[p] != 0) && (bf30a2_pool_alloc_plane(pool, p, plane_size[p]) != RT_EOK))
+        {
+            bf30a2_pool_free(pool);
+            return -RT_ENOMEM;
+        }
+    }
+
+    return RT_EOK;
+}
+
+void bf30a2_pool_place(bf30a2_pool_t *pool, rt_uint8_t *storage, rt_uint32_t size)
+{
+#ifdef BF30A2_USING_LAZY_CONVERT
+    const bf30a2_core_t *core = pool->core;
+    rt_event_t done = pool->done;
+#endif
+    int i;
+
+    rt_memset(pool, 0, sizeof(*pool));
+#ifdef BF30A2_USING_LAZY_CONVERT
+    pool->core = core;
+    pool->done = done;
+#endif
+    pool->filling = -1;
+    pool->latest = -1;
+    pool->placed = 1;
+    pool->frame_size = size;
+
+    for (i = 0; i < BF30A2_FRAME_BUFFERS; i++)
+    {
+        pool->slot[i].data = storage + i * size * BF30A2_POOL_FRAME_COPIES;
+#ifdef BF30A2_USING_LAZY_CONVERT
+        pool->slot[i].raw = pool->slot[i].data + size;
+#endif
+        pool->count++;
+    }
+}
+
+void bf30a2_pool_free(bf30a2_pool_t *pool)
+{
+    bf30a2_pool_slot_t slot[BF30A2_POOL_SLOTS];
+    rt_base_t level;
+    int count, i, p;
+
+    /* Out of the consumers' sight before anything is freed */
+    level = rt_hw_interrupt_disable();
+    count = pool->count;
+    rt_memcpy(slot, pool->slot, sizeof(slot));
+    rt_memset(pool->slot, 0, sizeof(pool->slot));
+    pool->count = 0;
+    pool->filling = -1;
+    pool->latest = -1;
+    rt_hw_interrupt_enable(level);
+
+    for (i = 0; i < count; i++)
+    {
+        if (!pool->placed)
+        {
+            rt_free(slot[i].data);
+#ifdef BF30A2_USING_LAZY_CONVERT
+            rt_free(slot[i].raw);
+#endif
+        }
+        for (p = 0; p < BF30A2_PLANES; p++)
+        {
+            rt_free(slot[i].plane[p]);
+        }
+    }
+}
+
+rt_uint32_t bf30a2_pool_bytes(const bf30a2_pool_t *pool)
+{
+    rt_uint32_t bytes = 0;
+    int i, p;
+
+    for (i = 0; i < pool->count; i++)
+    {
+        bytes += pool->frame_size * BF30A2_POOL_FRAME_COPIES;
+        for (p = 0; p < BF30A2_PLANES; p++)
+        {
+            if (pool->slot[i].plane[p] != RT_NULL)
+            {
+                bytes += pool->plane_size[p];
+            }
+        }
+    }
+
+    return bytes;
+}
+
+rt_bool_t bf30a2_pool_busy(const bf30a2_pool_t *pool)
+{
+    int i;
+
+    for (i = 0; i < pool->count; i++)
+    {
+        if (pool->slot[i].refs > 0)
+        {
+            return RT_TRUE;
+        }
+    }
+
+    return RT_FALSE;
+}
+
+rt_err_t bf30a2_pool_alloc_plane(bf30a2_pool_t *pool, rt_uint8_t plane, rt_uint32_t size)
+{
+    int i;
+
+    pool->plane_size[plane] = size;
+    for (i = 0; i < pool->count; i++)
+    {
+        if (pool->slot[i].plane[plane] == RT_NULL)
+        {
+            pool->slot[i].plane[plane] = rt_malloc(size);
+            if (pool->slot[i].plane[plane] == RT_NULL)
+            {
+                return -RT_ENOMEM;
+            }
+        }
+    }
+
+    return RT_EOK;
+}
+
+rt_err_t bf30a2_pool_free_plane(bf30a2_pool_t *pool, rt_uint8_t plane)
+{
+    int i;
+
+    if (bf30a2_pool_busy(pool))
+    {
+        return -RT_EBUSY;
+    }
+    pool->plane_size[plane] = 0;
+    for (i = 0; i < pool->count; i++)
+    {
+        rt_free(pool->slot[i].plane[plane]);
+        pool->slot[i].plane[plane] = RT_NULL;
+        pool->slot[i].planes &= ~(1U << plane);
+    }
+
+    return RT_EOK;
+}
+
+void bf30a2_pool_reset(bf30a2_pool_t *pool)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+
+    pool->filling = -1;
+    pool->latest = -1;
+    rt_hw_interrupt_enable(level);
+}
+
+/*============================================================================*/
+/*                     CAPTURE SIDE                                           */
+/*============================================================================*/
+
+rt_uint8_t *bf30a2_pool_acquire(bf30a2_pool_t *pool)
+{
+    rt_base_t level;
+    int i, pick = -1;
+
+    level = rt_hw_interrupt_disable();
+
+    /* Any free buffer but the latest frame, which a consumer may be about to lease */
+    for (i = 0; i < pool->count; i++)
+    {
+        if ((pool->slot[i].refs == 0) && (i != pool->latest))
+        {
+            pick = i;
+            break;
+        }
+    }
+
+    /* A single buffer is reused unless leased, as without a pool */
+    if ((pick < 0) && (pool->count == 1) && (pool->slot[0].refs == 0))
+    {
+        pick = 0;
+        pool->latest = -1;
+    }
+    pool->filling = (rt_int8_t)pick;
+
+    rt_hw_interrupt_enable(level);
+
+    if (pick < 0)
+    {
+        return RT_NULL;
+    }
+#ifdef BF30A2_USING_LAZY_CONVERT
+    /* The lines go to the raw frame; nothing of the new frame is converted yet */
+    pool->slot[pick].converted = 0;
+    pool->slot[pick].converting = 0;
+    pool->slot[pick].tone = RT_NULL;
+    rt_event_recv(pool->done, pool_event_slot(pool, &pool->slot[pick]),
+                  RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR, RT_WAITING_NO, RT_NULL);
+    return pool->slot[pick].raw;
+#else
+    return pool->slot[pick].data;
+#endif
+}
+
+bf30a2_pool_slot_t *bf30a2_pool_filling(bf30a2_pool_t *pool)
+{
+    return (pool->filling >= 0) ? &pool->slot[pool->filling] : RT_NULL;
+}
+
+bf30a2_pool_slot_t *bf30a2_pool_publish(bf30a2_pool_t *pool, rt_uint32_t frame_num,
+                                        rt_uint8_t level, rt_uint16_t width,
+                                        rt_uint16_t height, rt_uint32_t stamp,
+                                        rt_uint8_t unchanged, const bf30a2_tone_t *tone,
+                                        rt_uint8_t convert)
+{
+    bf30a2_pool_slot_t *slot;
+    rt_base_t irq;
+#ifdef BF30A2_USING_LAZY_CONVERT
+    int p;
+#endif
+
+    if (pool->filling < 0)
+    {
+        return RT_NULL;
+    }
+
+    slot = &pool->slot[pool->filling];
+    slot->frame_num = frame_num;
+    slot->level = level;
+    slot->width = width;
+    slot->height = height;
+    slot->stamp = stamp;
+    slot->unchanged = unchanged;
+#ifdef BF30A2_USING_LAZY_CONVERT
+    slot->tone = tone;
+
+    /* No consumer sees the frame yet, so none can hold these up */
+    if (convert & BF30A2_POOL_CONVERTED_FRAME)
+    {
+        pool_convert(pool, slot, -1, RT_TRUE);
+    }
+    for (p = 0; p < BF30A2_PLANES; p++)
+    {
+        if (convert & (1U << p))
+        {
+            pool_convert(pool, slot, (rt_int8_t)p, RT_TRUE);
+        }
+    }
+#else
+    (void)convert;
+#endif
+
+    irq = rt_hw_interrupt_disable();
+    pool->latest = pool->filling;
+    pool->filling = -1;
+    rt_hw_interrupt_enable(irq);
+
+    return slot;
+}
+
+/*============================================================================*/
+/*                     CONSUMER SIDE                                          */
+/*============================================================================*/
+
+bf30a2_pool_slot_t *bf30a2_pool_lease(bf30a2_pool_t *pool)
+{
+    bf30a2_pool_slot_t *slot = RT_NULL;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    if (pool->latest >= 0)
+    {
+        slot = &pool->slot[pool->latest];
+        slot->refs++;
+    }
+    rt_hw_interrupt_enable(level);
+
+    return slot;
+}
+
+void bf30a2_pool_hold(bf30a2_pool_t *pool, bf30a2_pool_slot_t *slot)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+
+    slot->refs++;
+    rt_hw_interrupt_enable(level);
+}
+
+/**
+ * @brief The frame or one of its planes starts at data
+ */
+static rt_bool_t pool_slot_owns(const bf30a2_pool_slot_t *slot, const rt_uint8_t *data)
+{
+    int p;
+
+    if (slot->data == data)
+    {
+        return RT_TRUE;
+    }
+    for (p = 0; p < BF30A2_PLANES; p++)
+    {
+        if ((slot->plane[p] != RT_NULL) && (slot->plane[p] == data))
+        {
+            return RT_TRUE;
+        }
+    }
+    return RT_FALSE;
+}
+
+rt_err_t bf30a2_pool_release(bf30a2_pool_t *pool, const rt_uint8_t *data)
+{
+    rt_err_t ret = -RT_EINVAL;
+    rt_base_t level;
+    int i;
+
+    if (data == RT_NULL)
+    {
+        return ret;
+    }
+
+    level = rt_hw_interrupt_disable();
+    for (i = 0; i < pool->count; i++)
+    {
+        if ((pool->slot[i].refs > 0) && pool_slot_owns(&pool->slot[i], data))
+        {
+            pool->slot[i].refs--;
+            ret = RT_EOK;
+            break;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+
+    return ret;
+}
+
+bf30a2_pool_slot_t *bf30a2_pool_leased(bf30a2_pool_t *pool, const rt_uint8_t *data)
+{
+    bf30a2_pool_slot_t *slot = RT_NULL;
+    rt_base_t level;
+    int i;
+
+    if (data == RT_NULL)
+    {
+        return RT_NULL;
+    }
+
+    level = rt_hw_interrupt_disable();
+    for (i = 0; i < pool->count; i++)
+    {
+        if ((pool->slot[i].refs > 0) && pool_slot_owns(&pool->slot[i], data))
+        {
+            slot = &pool->slot[i];
+            break;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+
+    return slot;
+}
+
+bf30a2_pool_slot_t *bf30a2_pool_latest(bf30a2_pool_t *pool)
+{
+    rt_int8_t latest = pool->latest;
+
+    return (latest >= 0) ? &pool->slot[latest] : RT_NULL;
+}
+
+#ifdef BF30A2_USING_LAZY_CONVERT
+void bf30a2_pool_convert(bf30a2_pool_t *pool, bf30a2_pool_slot_t *slot, rt_int8_t plane)
+{
+    pool_convert(pool, slot, plane, RT_TRUE);
+}
+
+rt_bool_t bf30a2_pool_convert_nowait(bf30a2_pool_t *pool, bf30a2_pool_slot_t *slot,
+                                     rt_int8_t plane)
+{
+    return pool_convert(pool, slot, plane, RT_FALSE);
+}
+
+rt_bool_t bf30a2_pool_tone_busy(const bf30a2_pool_t *pool, const bf30a2_tone_t *tone)
+{
+    int i;
+
+    for (i = 0; i < pool->count; i++)
+    {
+        if ((pool->slot[i].tone == tone) &&
+            !(pool->slot[i].converted & BF30A2_POOL_CONVERTED_FRAME))
+        {
+            return RT_TRUE;
+        }
+    }
+
+    return RT_FALSE;
+}
+#endif
@@ -0,0 +1,267 @@
+/**
+ * @file    bf30a2_pool.h
+ * @brief   BF30A2 frame buffer pool with consumer leases (internal)
+ *
+ * The capture thread acquires a buffer at every frame header and
+ * publishes it at the frame end; consumers lease the latest published
+ * buffer and release it when done. A leased buffer is never handed to
+ * the capture thread, so a frame is never overwritten while it is read.
+ * When every other buffer is leased, acquire fails and the frame is
+ * dropped before any conversion work: the latest frame is kept for the
+ * consumer to lease next rather than overwritten by a frame it could not
+ * take either. Only a pool of one buffer overwrites its unleased frame.
+ *
+ * A slot may also carry secondary planes (bf30a2_plane_t), converted
+ * from the same lines when some consumer asks for them; they are leased
+ * and released together with the frame. The pool remembers the planes
+ * asked for, so storage freed while the camera is off (bf30a2_pool_free)
+ * comes back with them at the next bf30a2_pool_alloc().
+ *
+ * With BF30A2_USING_LAZY_CONVERT each slot also holds the frame as
+ * received (YUV422): the capture thread only copies lines into it, and
+ * the frame output and the Y8 and half planes are converted from it by
+ * bf30a2_pool_convert() when a consumer first reads them. What has been
+ * converted is remembered per slot until the slot is acquired again, so
+ * a second reader of the same frame pays nothing; a frame nobody reads
+ * is never converted. The thumbnail is still made while capturing. The
+ * conversions follow the frame output pipeline of the pool's core and
+ * the tone curve the frame was assembled with, kept in the slot; the
+ * core, like the counter, is kept when the storage is allocated or
+ * placed. bf30a2_pool_tone_busy() tells which curves a frame output may
+ * still be converted with.
+ *
+ * A reader finding an output being converted by another waits on the
+ * owner's event for its bit; the capture thread never does. What it
+ * hands out itself is converted at publish time, before any consumer can
+ * lease the frame, and bf30a2_pool_convert_nowait() lets it skip an
+ * output a consumer got to first.
+ *
+ * The slot bookkeeping is a few loads and stores, done with interrupts
+ * disabled so the capture thread and consumers of any priority can share
+ * it without a mutex.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_POOL_H__
+#define __BF30A2_POOL_H__
+
+#include <rtthread.h>
+#include "drv_bf30a2.h"
+#include "bf30a2_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef BF30A2_FRAME_BUFFERS
+#define BF30A2_FRAME_BUFFERS        1
+#endif
+
+/* A viewfinder-only build may have no frame buffer; keep the array legal */
+#define BF30A2_POOL_SLOTS           ((BF30A2_FRAME_BUFFERS > 0) ? BF30A2_FRAME_BUFFERS : 1)
+
+/* Frame sized buffers per slot: the output, and with lazy conversion the raw frame */
+#ifdef BF30A2_USING_LAZY_CONVERT
+#define BF30A2_POOL_FRAME_COPIES    2
+#else
+#define BF30A2_POOL_FRAME_COPIES    1
+#endif
+
+/* bf30a2_pool_slot_t.converted bit of the frame output, above the plane bits */
+#define BF30A2_POOL_CONVERTED_FRAME (1U << 7)
+
+/* Conversion event bits: one per output (planes, then the frame) and slot, above the owner's */
+#define BF30A2_POOL_EVENT_SHIFT     8
+#define BF30A2_POOL_EVENT_BITS      (BF30A2_PLANES + 1)
+
+/**
+ * @brief One frame buffer
+ */
+typedef struct bf30a2_pool_slot
+{
+    rt_uint8_t *data;               /**< Frame storage */
+    rt_uint8_t *plane[BF30A2_PLANES];   /**< Secondary planes, RT_NULL = not allocated */
+    rt_uint8_t planes;              /**< Planes converted for this frame, bit per plane */
+#ifdef BF30A2_USING_LAZY_CONVERT
+    rt_uint8_t *raw;                /**< Frame as received, YUV422 */
+    const bf30a2_tone_t *tone;      /**< Tone curve of the frame, RT_NULL = none */
+    rt_uint8_t converted;           /**< Outputs converted from raw, plane bits and _FRAME */
+    rt_uint8_t converting;          /**< Outputs a reader is converting, bits as converted */
+#endif
+    rt_uint8_t refs;                /**< Consumer leases */
+    rt_uint8_t level;               /**< Output level of the frame (bf30a2_level_t) */
+    rt_uint16_t width;              /**< Sensor geometry of the frame, pixels */
+    rt_uint16_t height;             /**< Sensor geometry of the frame, rows */
+    rt_uint32_t frame_num;          /**< Sequence number of the frame */
+    rt_uint32_t stamp;              /**< Header wakeup of the frame, cycles */
+    rt_uint8_t unchanged;           /**< Found unchanged by change detection */
+} bf30a2_pool_slot_t;
+
+/**
+ * @brief Frame buffer pool
+ */
+typedef struct bf30a2_pool
+{
+    bf30a2_pool_slot_t slot[BF30A2_POOL_SLOTS];     /**< Buffers */
+    rt_uint8_t count;               /**< Allocated buffers */
+    rt_uint8_t placed;              /**< Frame storage is the caller's, not freed */
+    rt_uint32_t frame_size;         /**< Bytes per frame buffer */
+    rt_uint32_t plane_size[BF30A2_PLANES];  /**< Bytes per plane asked for, 0 = none */
+    rt_int8_t filling;              /**< Slot the capture thread writes, -1 = none */
+    rt_int8_t latest;               /**< Last published slot, -1 = none */
+    rt_uint32_t conversions;        /**< Frame outputs converted on demand */
+#ifdef BF30A2_USING_LAZY_CONVERT
+    const bf30a2_core_t *core;      /**< Core whose pipeline and tone curve conversions use */
+    rt_event_t done;                /**< Owner's event, conversion bits from BF30A2_POOL_EVENT_SHIFT */
+#endif
+} bf30a2_pool_t;
+
+/**
+ * @brief Allocate BF30A2_FRAME_BUFFERS buffers of size bytes
+ *
+ * Planes asked for before, even while the pool had no storage, are
+ * allocated with them.
+ */
+rt_err_t bf30a2_pool_alloc(bf30a2_pool_t *pool, rt_uint32_t size);
+
+/**
+ * @brief Use BF30A2_FRAME_BUFFERS consecutive buffers of size bytes at storage
+ *
+ * storage holds BF30A2_POOL_FRAME_COPIES buffers per slot. For static
+ * allocation: bf30a2_pool_free() leaves the storage alone.
+ */
+void bf30a2_pool_place(bf30a2_pool_t *pool, rt_uint8_t *storage, rt_uint32_t size);
+
+/**
+ * @brief Free the buffers and planes; the planes asked for are remembered
+ *
+ * Only while the capture thread is stopped and nothing is leased.
+ */
+void bf30a2_pool_free(bf30a2_pool_t *pool);
+
+/**
+ * @brief Frame buffer and plane bytes the pool holds
+ */
+rt_uint32_t bf30a2_pool_bytes(const bf30a2_pool_t *pool);
+
+/**
+ * @brief Any frame leased
+ */
+rt_bool_t bf30a2_pool_busy(const bf30a2_pool_t *pool);
+
+/**
+ * @brief Give every slot a secondary plane of size bytes, if not done yet
+ *
+ * Without storage only the request is recorded, for bf30a2_pool_alloc().
+ * Safe while capturing: a slot's plane pointer is set once and freed
+ * only by bf30a2_pool_free().
+ */
+rt_err_t bf30a2_pool_alloc_plane(bf30a2_pool_t *pool, rt_uint8_t plane, rt_uint32_t size);
+
+/**
+ * @brief Free a secondary plane of every slot and forget it, e.g. to change its size
+ *
+ * Only while the capture thread is stopped.
+ *
+ * @return -RT_EBUSY while any frame is leased
+ */
+rt_err_t bf30a2_pool_free_plane(bf30a2_pool_t *pool, rt_uint8_t plane);
+
+/**
+ * @brief Forget the published frame, e.g. at capture start (leases are kept)
+ */
+void bf30a2_pool_reset(bf30a2_pool_t *pool);
+
+/**
+ * @brief Take a buffer for the frame starting now (capture thread)
+ *
+ * @return Buffer, or RT_NULL when every buffer but the latest is leased
+ */
+rt_uint8_t *bf30a2_pool_acquire(bf30a2_pool_t *pool);
+
+/**
+ * @brief Slot of the acquired buffer, RT_NULL if none (capture thread)
+ */
+bf30a2_pool_slot_t *bf30a2_pool_filling(bf30a2_pool_t *pool);
+
+/**
+ * @brief Make the acquired buffer the latest frame (capture thread)
+ *
+ * With lazy conversion, the outputs in convert (bits as
+ * bf30a2_pool_slot_t.converted) are converted first, while the frame is
+ * still the capture thread's own; it is ignored otherwise.
+ *
+ * @return Published slot
+ */
+bf30a2_pool_slot_t *bf30a2_pool_publish(bf30a2_pool_t *pool, rt_uint32_t frame_num,
+                                        rt_uint8_t level, rt_uint16_t width,
+                                        rt_uint16_t height, rt_uint32_t stamp,
+                                        rt_uint8_t unchanged, const bf30a2_tone_t *tone,
+                                        rt_uint8_t convert);
+
+/**
+ * @brief Lease the latest frame
+ *
+ * @return Slot, or RT_NULL when no frame has been published
+ */
+bf30a2_pool_slot_t *bf30a2_pool_lease(bf30a2_pool_t *pool);
+
+/**
+ * @brief Add a lease to a published slot, e.g. for a queued delivery
+ */
+void bf30a2_pool_hold(bf30a2_pool_t *pool, bf30a2_pool_slot_t *slot);
+
+/**
+ * @brief Return a lease by the address of the frame or one of its planes
+ *
+ * @return -RT_EINVAL if data is not a leased buffer of the pool
+ */
+rt_err_t bf30a2_pool_release(bf30a2_pool_t *pool, const rt_uint8_t *data);
+
+/**
+ * @brief Leased slot of a frame or plane address, RT_NULL if none
+ */
+bf30a2_pool_slot_t *bf30a2_pool_leased(bf30a2_pool_t *pool, const rt_uint8_t *data);
+
+/**
+ * @brief Latest published slot without leasing it, RT_NULL if none
+ */
+bf30a2_pool_slot_t *bf30a2_pool_latest(bf30a2_pool_t *pool);
+
+#ifdef BF30A2_USING_LAZY_CONVERT
+/**
+ * @brief Convert the frame output (plane < 0) or a plane of a slot, if not done yet
+ *
+ * The slot must be leased. The first reader of an output claims and
+ * converts it; a reader racing with it blocks on the pool's event until
+ * it is done rather than converting into the same buffer again. The
+ * capture thread uses bf30a2_pool_convert_nowait() instead.
+ */
+void bf30a2_pool_convert(bf30a2_pool_t *pool, bf30a2_pool_slot_t *slot, rt_int8_t plane);
+
+/**
+ * @brief Convert an output for the capture thread, which must not wait for a consumer
+ *
+ * @return RT_FALSE when a consumer is converting it, RT_TRUE once it is converted
+ */
+rt_bool_t bf30a2_pool_convert_nowait(bf30a2_pool_t *pool, bf30a2_pool_slot_t *slot,
+                                     rt_int8_t plane);
+
+/**
+ * @brief A published frame output not converted yet uses tone
+ *
+ * Call with interrupts disabled; a curve found unused may be rewritten.
+ */
+rt_bool_t bf30a2_pool_tone_busy(const bf30a2_pool_t *pool, const bf30a2_tone_t *tone);
+#else
+#define bf30a2_pool_convert(pool, slot, plane)  do { (void)(plane); } while (0)
+#define bf30a2_pool_convert_nowait(pool, slot, plane)   ((void)(plane), RT_TRUE)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BF30A2_POOL_H__ */
@@ -0,0 +1,79 @@
+/**
+ * @file    bf30a2_port.h
+ * @brief   BF30A2 driver platform helpers (internal)
+ *
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_PORT_H__
+#define __BF30A2_PORT_H__
+
+#include <rtthread.h>
+
+#ifdef BF30A2_HOST
+#include <time.h>
+#else
+#include "bf0_hal.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef BF30A2_HOST
+
+/* Host builds (tools/host) count nanoseconds of CLOCK_MONOTONIC instead */
+
+static inline void bf30a2_port_cycles_init(void)
+{
+}
+
+static inline rt_uint32_t bf30a2_port_cycles(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (rt_uint32_t)((rt_uint64_t)ts.tv_sec * 1000000000ULL + (rt_uint64_t)ts.tv_nsec);
+}
+
+static inline rt_uint32_t bf30a2_port_cycles_hz(void)
+{
+    return 1000000000UL;
+}
+
+#else
+
+/**
+ * @brief Enable the free-running core cycle counter (DWT CYCCNT)
+ */
+static inline void bf30a2_port_cycles_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief Read the core cycle counter (wraps every 2^32 cycles)
+ */
+static inline rt_uint32_t bf30a2_port_cycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief Cycle counter frequency in Hz
+ */
+static inline rt_uint32_t bf30a2_port_cycles_hz(void)
+{
+    return SystemCoreClock;
+}
+
+#endif /* BF30A2_HOST */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BF30A2_PORT_H__ */
@@ -0,0 +1,341 @@
+/**
+ * @file    bf30a2_rawcap.c
+ * @brief   BF30A2 raw SPI stream capture
+ *
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <rtthread.h>
+#include <string.h>
+
+#include "bf30a2_rawcap.h"
+
+#ifdef BF30A2_USING_RAW_CAPTURE
+
+#include "bf30a2_port.h"
+
+#ifdef RT_USING_DFS
+#include <dfs_posix.h>
+#endif
+
+#define DBG_TAG "drv.bf30a2"
+#define DBG_LVL DBG_LOG
+#include <rtdbg.h>
+
+/* Bytes per line in the UART hex dump */
+#define RAWCAP_HEX_PER_LINE         32
+
+/*============================================================================*/
+/*                     SINK OUTPUT                                            */
+/*============================================================================*/
+
+static rt_err_t sink_write(bf30a2_rawcap_t *cap, const void *data, rt_uint32_t len)
+{
+    if (len == 0)
+    {
+        return RT_EOK;
+    }
+
+    if (cap->sink == BF30A2_RAWCAP_SINK_MEMORY)
+    {
+        rt_memcpy(cap->buf + cap->used, data, len);
+    }
+#ifdef RT_USING_DFS
+    else if (write(cap->fd, data, len) != (int)len)
+    {
+        return -RT_EIO;
+    }
+#else
+    else
+    {
+        return -RT_ENOSYS;
+    }
+#endif
+
+    cap->used += len;
+    return RT_EOK;
+}
+
+static void sink_close(bf30a2_rawcap_t *cap)
+{
+#ifdef RT_USING_DFS
+    if (cap->fd >= 0)
+    {
+        close(cap->fd);
+    }
+#endif
+    cap->fd = -1;
+}
+
+/*============================================================================*/
+/*                     CAPTURE CONTROL                                        */
+/*============================================================================*/
+
+void bf30a2_rawcap_init(bf30a2_rawcap_t *cap)
+{
+    rt_memset(cap, 0, sizeof(*cap));
+    cap->fd = -1;
+}
+
+rt_err_t bf30a2_rawcap_start(bf30a2_rawcap_t *cap, const bf30a2_rawcap_cfg_t *cfg,
+                             rt_uint32_t dma_size)
+{
+    bf30a2_rawcap_header_t hdr;
+    rt_uint32_t min_size = sizeof(hdr) + sizeof(bf30a2_rawcap_record_t);
+
+    if (cap->active)
+    {
+        return -RT_EBUSY;
+    }
+
+    sink_close(cap);
+    cap->sink = cfg->sink;
+    cap->used = 0;
+    cap->seq = 0;
+    cap->bytes = 0;
+    cap->dropped = 0;
+    cap->no_decode = cfg->no_decode;
+
+    if (cfg->sink == BF30A2_RAWCAP_SINK_MEMORY)
+    {
+        if (cfg->size < min_size)
+        {
+            return -RT_EINVAL;
+        }
+
+        if (cfg->buffer != RT_NULL)
+        {
+            bf30a2_rawcap_release(cap);
+            cap->buf = cfg->buffer;
+        }
+        else if (!cap->owns_buffer || (cap->size < cfg->size))
+        {
+            bf30a2_rawcap_release(cap);
+            cap->buf = rt_malloc(cfg->size);
+            if (cap->buf == RT_NULL)
+            {
+                LOG_E("Alloc capture buffer failed (%d bytes)", cfg->size);
+                return -RT_ENOMEM;
+            }
+            cap->owns_buffer = 1;
+        }
+        cap->size = cfg->size;
+    }
+    else
+    {
+#ifdef RT_USING_DFS
+        if (cfg->path == RT_NULL)
+        {
+            return -RT_EINVAL;
+        }
+        cap->fd = open(cfg->path, O_WRONLY | O_CREAT | O_TRUNC, 0);
+        if (cap->fd < 0)
+        {
+            LOG_E("Open capture file '%s' failed", cfg->path);
+            return -RT_EIO;
+        }
+#else
+        return -RT_ENOSYS;
+#endif
+    }
+
+    hdr.magic = BF30A2_RAWCAP_MAGIC;
+    hdr.version = BF30A2_RAWCAP_VERSION;
+    hdr.header_size = sizeof(hdr);
+    hdr.dma_size = dma_size;
+    hdr.clock_hz = bf30a2_port_cycles_hz();
+    if (sink_write(cap, &hdr, sizeof(hdr)) != RT_EOK)
+    {
+        sink_close(cap);
+        return -RT_EIO;
+    }
+
+    cap->active = 1;
+    LOG_I("Raw capture started (%s)",
+          cfg->sink == BF30A2_RAWCAP_SINK_MEMORY ? "memory" : cfg->path);
+
+    return RT_EOK;
+}
+
+void bf30a2_rawcap_stop(bf30a2_rawcap_t *cap)
+{
+    cap->active = 0;
+
+    /* Let an append in progress on the capture thread finish */
+    while (cap->busy)
+    {
+        rt_thread_mdelay(1);
+    }
+
+    sink_close(cap);
+}
+
+void bf30a2_rawcap_release(bf30a2_rawcap_t *cap)
+{
+    if (cap->active)
+    {
+        return;
+    }
+
+    if (cap->owns_buffer && (cap->buf != RT_NULL))
+    {
+        rt_free(cap->buf);
+    }
+    cap->buf = RT_NULL;
+    cap->size = 0;
+    cap->used = 0;
+    cap->owns_buffer = 0;
+}
+
+/*============================================================================*/
+/*                     CAPTURE THREAD SIDE                                    */
+/*============================================================================*/
+
+/**
+ * @brief Append the ring bytes [rd, wr) as one wakeup record
+ *
+ * Called from the capture thread before the bytes are parsed. A memory
+ * sink that cannot hold the whole record ends the capture, so the stream
+ * stays contiguous up to the last record.
+ */
+void bf30a2_rawcap_append(bf30a2_rawcap_t *cap, const rt_uint8_t *ring, rt_uint32_t size,
+                          rt_uint32_t rd, rt_uint32_t wr, rt_uint32_t rx_count)
+{
+    bf30a2_rawcap_record_t rec;
+    rt_uint32_t seg1, seg2;
+
+    cap->busy = 1;
+    if (!cap->active || (rd == wr))
+    {
+        cap->busy = 0;
+        return;
+    }
+
+    seg1 = (wr < rd) ? (size - rd) : (wr - rd);
+    seg2 = (wr < rd) ? wr : 0;
+
+    rec.magic = BF30A2_RAWCAP_REC_MAGIC;
+    rec.seq = cap->seq++;
+    rec.timestamp = bf30a2_port_cycles();
+    rec.rx_count = rx_count;
+    rec.rd_pos = (rt_uint16_t)rd;
+    rec.wr_pos = (rt_uint16_t)wr;
+    rec.len = seg1 + seg2;
+
+    if ((cap->sink == BF30A2_RAWCAP_SINK_MEMORY) &&
+        (cap->used + sizeof(rec) + rec.len > cap->size))
+    {
+        cap->dropped += rec.len;
+        cap->active = 0;
+    }
+    else if ((sink_write(cap, &rec, sizeof(rec)) != RT_EOK) ||
+             (sink_write(cap, ring + rd, seg1) != RT_EOK) ||
+             (sink_write(cap, ring, seg2) != RT_EOK))
+    {
+        cap->dropped += rec.len;
+        cap->active = 0;
+    }
+    else
+    {
+        cap->bytes += rec.len;
+    }
+
+    cap->busy = 0;
+}
+
+/*============================================================================*/
+/*                     EXPORT                                                 */
+/*============================================================================*/
+
+void bf30a2_rawcap_get_status(bf30a2_rawcap_t *cap, bf30a2_rawcap_status_t *status)
+{
+    status->active = cap->active;
+    status->sink = cap->sink;
+    status->records = cap->seq;
+    status->bytes = cap->bytes;
+    status->used = cap->used;
+    status->dropped = cap->dropped;
+}
+
+/**
+ * @brief Hex dump the memory capture; tools/bf30a2_rawcap_extract.py rebuilds the file
+ */
+rt_err_t bf30a2_rawcap_export_uart(bf30a2_rawcap_t *cap)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    char line[RAWCAP_HEX_PER_LINE * 2 + 1];
+    rt_uint32_t i;
+    int pos = 0;
+
+    if (cap->active || (cap->sink != BF30A2_RAWCAP_SINK_MEMORY) || (cap->buf == RT_NULL) ||
+        (cap->used == 0))
+    {
+        return -RT_ERROR;
+    }
+
+    rt_kprintf("\n===RAWCAP_START===\n");
+    rt_kprintf("SIZE:%u\n", cap->used);
+    rt_kprintf("===DATA_BEGIN===\n");
+
+    for (i = 0; i < cap->used; i++)
+    {
+        line[pos++] = hex[cap->buf[i] >> 4];
+        line[pos++] = hex[cap->buf[i] & 0x0F];
+
+        if (((i + 1) % RAWCAP_HEX_PER_LINE == 0) || (i + 1 == cap->used))
+        {
+            line[pos] = '\0';
+            rt_kprintf("%s\n", line);
+            pos = 0;
+
+            if ((i + 1) % 1024 == 0)
+            {
+                rt_thread_mdelay(5);
+            }
+        }
+    }
+
+    rt_kprintf("===DATA_END===\n");
+    rt_kprintf("===RAWCAP_END===\n\n");
+
+    return RT_EOK;
+}
+
+rt_err_t bf30a2_rawcap_save(bf30a2_rawcap_t *cap, const char *path)
+{
+#ifdef RT_USING_DFS
+    int fd;
+    int ok;
+
+    if (cap->active || (cap->sink != BF30A2_RAWCAP_SINK_MEMORY) || (cap->buf == RT_NULL) ||
+        (cap->used == 0) || (path == RT_NULL))
+    {
+        return -RT_ERROR;
+    }
+
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0);
+    if (fd < 0)
+    {
+        LOG_E("Open '%s' failed", path);
+        return -RT_EIO;
+    }
+
+    ok = (write(fd, cap->buf, cap->used) == (int)cap->used);
+    close(fd);
+
+    if (!ok)
+    {
+        LOG_E("Write '%s' failed", path);
+        return -RT_EIO;
+    }
+
+    LOG_I("Saved %d capture bytes to %s", cap->used, path);
+    return RT_EOK;
+#else
+    return -RT_ENOSYS;
+#endif
+}
+
+#endif /* BF30A2_USING_RAW_CAPTURE */
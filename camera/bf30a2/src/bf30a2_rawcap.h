@@ -0,0 +1,64 @@
+/**
+ * @file    bf30a2_rawcap.h
+ * @brief   BF30A2 raw SPI stream capture (internal)
+ *
+ * The capture thread appends every chunk of the DMA ring it is about to
+ * parse, undecoded, together with a record of the wakeup (sequence,
+ * timestamp, DMA interrupt count and ring positions). The resulting
+ * stream is replayed bit-exactly by tools/host/bf30a2_replay.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_RAWCAP_H__
+#define __BF30A2_RAWCAP_H__
+
+#include <rtthread.h>
+#include "drv_bf30a2.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef BF30A2_USING_RAW_CAPTURE
+
+/**
+ * @brief Raw capture state
+ */
+typedef struct bf30a2_rawcap
+{
+    volatile rt_uint8_t active;         /**< Capture thread appends while set */
+    volatile rt_uint8_t busy;           /**< Capture thread is inside append */
+    rt_uint8_t no_decode;               /**< Skip the parser while capturing */
+    rt_uint8_t owns_buffer;             /**< buf was allocated by the driver */
+    bf30a2_rawcap_sink_t sink;          /**< Current sink */
+
+    rt_uint8_t *buf;                    /**< Memory sink storage */
+    rt_uint32_t size;                   /**< Memory sink size */
+    rt_uint32_t used;                   /**< Bytes written including headers */
+    int fd;                             /**< File sink descriptor */
+
+    rt_uint32_t seq;                    /**< Next record sequence number */
+    rt_uint32_t bytes;                  /**< Stream bytes captured */
+    rt_uint32_t dropped;                /**< Stream bytes lost to a full sink */
+} bf30a2_rawcap_t;
+
+void bf30a2_rawcap_init(bf30a2_rawcap_t *cap);
+rt_err_t bf30a2_rawcap_start(bf30a2_rawcap_t *cap, const bf30a2_rawcap_cfg_t *cfg,
+                             rt_uint32_t dma_size);
+void bf30a2_rawcap_stop(bf30a2_rawcap_t *cap);
+void bf30a2_rawcap_release(bf30a2_rawcap_t *cap);
+void bf30a2_rawcap_append(bf30a2_rawcap_t *cap, const rt_uint8_t *ring, rt_uint32_t size,
+                          rt_uint32_t rd, rt_uint32_t wr, rt_uint32_t rx_count);
+void bf30a2_rawcap_get_status(bf30a2_rawcap_t *cap, bf30a2_rawcap_status_t *status);
+rt_err_t bf30a2_rawcap_export_uart(bf30a2_rawcap_t *cap);
+rt_err_t bf30a2_rawcap_save(bf30a2_rawcap_t *cap, const char *path);
+
+#endif /* BF30A2_USING_RAW_CAPTURE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BF30A2_RAWCAP_H__ */
@@ -0,0 +1,178 @@
+/**
+ * @file    bf30a2_sensor.c
+ * @brief   BF30A2 sensor descriptor: chip ID, init sequence, geometry, window
+ *
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <rtthread.h>
+
+#include "drv_bf30a2.h"
+
+/*============================================================================*/
+/*                     REGISTER CONFIGURATION                                 */
+/*============================================================================*/
+
+/**
+ * @brief BF30A2 SPI initialization register sequence
+ */
+static const bf30a2_reg_t bf30a2_init_regs[] =
+{
+    {0xf2, 0x01},
+    {BF30A2_REG_DLY, 10},
+    {0xcf, 0xf0},
+    {0x12, 0x40},
+    {0x15, 0x80},
+    {0x6b, 0x71},
+    {0x00, 0x40},
+    {0x04, 0x00},
+    {0x06, 0x26},
+    {0x08, 0x07},
+    {0x1c, 0x12},
+    {0x20, 0x20},
+    {0x21, 0x20},
+    {0x34, 0x02},
+    {0x35, 0x02},
+    {0x36, 0x21},
+    {0x37, 0x13},
+    {0xca, 0x23},
+    {0xcb, 0x22},
+    {0xcc, 0x89},
+    {0xcd, 0x4c},
+    {0xce, 0x6b},
+    {0xa0, 0x8e},
+    {0x01, 0x1b},
+    {0x02, 0x1d},
+    {0x13, 0x08},
+    {0x87, 0x13},
+    {0x8b, 0x08},
+    {0x70, 0x17},
+    {0x71, 0x43},
+    {0x72, 0x0a},
+    {0x73, 0x62},
+    {0x74, 0xa2},
+    {0x75, 0xbf},
+    {0x76, 0x00},
+    {0x77, 0xcc},
+    {0x40, 0x32},
+    {0x41, 0x28},
+    {0x42, 0x26},
+    {0x43, 0x1d},
+    {0x44, 0x1a},
+    {0x45, 0x14},
+    {0x46, 0x11},
+    {0x47, 0x0f},
+    {0x48, 0x0e},
+    {0x49, 0x0d},
+    {0x4B, 0x0c},
+    {0x4C, 0x0b},
+    {0x4E, 0x0a},
+    {0x4F, 0x09},
+    {0x50, 0x09},
+    {0x24, 0x30},
+    {0x25, 0x36},
+    {0x80, 0x00},
+    {0x81, 0x20},
+    {0x82, 0x40},
+    {0x83, 0x30},
+    {0x84, 0x50},
+    {0x85, 0x30},
+    {0x86, 0xd8},
+    {0x89, 0x45},
+    {0x8a, 0x33},
+    {0x8f, 0x81},
+    {0x91, 0xff},
+    {0x92, 0x08},
+    {0x94, 0x82},
+    {0x95, 0xfd},
+    {0x9a, 0x20},
+    {0x9e, 0xbc},
+    {0xf0, 0x8f},
+    {0x51, 0x06},
+    {0x52, 0x25},
+    {0x53, 0x2b},
+    {0x54, 0x0f},
+    {0x57, 0x2a},
+    {0x58, 0x22},
+    {0x59, 0x2c},
+    {0x23, 0x33},
+    {0xa1, 0x93},
+    {0xa2, 0x0f},
+    {0xa3, 0x2a},
+    {0xa4, 0x08},
+    {0xa5, 0x26},
+    {0xa7, 0x80},
+    {0xa8, 0x80},
+    {0xa9, 0x1e},
+    {0xaa, 0x19},
+    {0xab, 0x18},
+    {0xae, 0x50},
+    {0xaf, 0x04},
+    {0xc8, 0x10},
+    {0xc9, 0x15},
+    {0xd3, 0x0c},
+    {0xd4, 0x16},
+    {0xee, 0x06},
+    {0xef, 0x04},
+    {0x55, 0x34},
+    {0x56, 0x9c},
+    {0xb1, 0x98},
+    {0xb2, 0x98},
+    {0xb3, 0xc4},
+    {0xb4, 0x0c},
+    {0xa0, 0x8f},
+    {0x13, 0x07},
+    {BF30A2_REGLIST_TAIL, 0x00}
+};
+
+/**
+ * @brief Leave the power-down state the init sequence may have left set
+ */
+static rt_err_t bf30a2_post_init(const bf30a2_sensor_io_t *io)
+{
+    rt_uint8_t pda_val;
+
+    if ((io->read(io->ctx, 0xCF, &pda_val) == RT_EOK) && (pda_val & 0x01))
+    {
+        io->write(io->ctx, 0xCF, 0xB0);
+        rt_thread_mdelay(10);
+    }
+
+    return RT_EOK;
+}
+
+/*============================================================================*/
+/*                     DESCRIPTOR                                             */
+/*============================================================================*/
+
+/*
+ * Output window registers: start and stop in units of 2 pixels or lines
+ * of the array (stop exclusive); subsampling keeps every other pixel and
+ * line of the window. Latched by the sensor at the next frame start.
+ */
+const bf30a2_sensor_desc_t bf30a2_sensor_bf30a2 =
+{
+    "BF30A2",
+    0x6E,                           /* i2c_addr */
+    0xFC,                           /* id_reg_h */
+    0xFD,                           /* id_reg_l */
+    0x3B02,                         /* chip_id */
+    bf30a2_init_regs,
+    bf30a2_post_init,
+
+    BF30A2_DEFAULT_WIDTH,           /* array_width */
+    BF30A2_DEFAULT_HEIGHT,          /* array_height */
+
+    2,                              /* win_unit */
+    0x17,                           /* win_hstart */
+    0x18,                           /* win_hstop */
+    0x19,                           /* win_vstart */
+    0x1A,                           /* win_vstop */
+    0x1B,                           /* win_subsample */
+    0x01,                           /* win_subsample_2 */
+
+    /* frame_start, line_start, frame_end, data_type */
+    { 0x01, 0x02, 0x00, 0x40 },
+};
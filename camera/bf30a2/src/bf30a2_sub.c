@@ -0,0 +1,349 @@
+/**
+ * @file    bf30a2_sub.c
+ * @brief   BF30A2 frame subscribers: per-consumer format and rate
+ *
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <rtthread.h>
+#include <rthw.h>
+#include <string.h>
+
+#include "bf30a2_sub.h"
+
+#ifdef BF30A2_USING_SUBSCRIBE
+
+/* Secondary plane of each bf30a2_sub_format_t, -1 = the frame buffer */
+static const rt_int8_t sub_format_plane[BF30A2_SUB_FORMATS] =
+{
+    -1,                             /* BF30A2_SUB_RGB565 */
+    BF30A2_PLANE_Y8,                /* BF30A2_SUB_Y8 */
+    BF30A2_PLANE_HALF,              /* BF30A2_SUB_RGB565_HALF */
+    BF30A2_PLANE_THUMB,             /* BF30A2_SUB_THUMB */
+};
+
+/*============================================================================*/
+/*                     HELPERS                                                */
+/*============================================================================*/
+
+static bf30a2_sub_entry_t *sub_entry(bf30a2_subs_t *subs, int handle)
+{
+    if ((handle < 0) || (handle >= BF30A2_MAX_SUBSCRIBERS) || !subs->entry[handle].used)
+    {
+        return RT_NULL;
+    }
+    return &subs->entry[handle];
+}
+
+/**
+ * @brief Describe a subscriber's output of a published frame
+ */
+static void sub_describe(const bf30a2_core_t *core, const bf30a2_pool_slot_t *slot,
+                         rt_int8_t plane, bf30a2_buffer_t *buf)
+{
+    bf30a2_info_t geo;
+
+    if (plane < 0)
+    {
+        bf30a2_core_output_geometry(&core->pipeline, slot->level, slot->width, slot->height,
+                                    &geo);
+        buf->data = slot->data;
+    }
+    else
+    {
+        bf30a2_core_plane_geometry(core, plane, slot->width, slot->height, &geo);
+        buf->data = slot->plane[plane];
+    }
+    buf->size = geo.frame_size;
+    buf->frame_num = slot->frame_num;
+    buf->timestamp = rt_tick_get();
+    buf->width = geo.width;
+    buf->height = geo.height;
+    buf->format = geo.format;
+    buf->unchanged = slot->unchanged;
+}
+
+/*============================================================================*/
+/*                     CONTROL                                                */
+/*============================================================================*/
+
+void bf30a2_sub_init(bf30a2_subs_t *subs)
+{
+    rt_memset(subs, 0, sizeof(*subs));
+}
+
+int bf30a2_sub_add(bf30a2_subs_t *subs, bf30a2_pool_t *pool, const bf30a2_core_t *core,
+                   const bf30a2_sub_cfg_t *cfg)
+{
+    bf30a2_info_t geo;
+    rt_base_t level;
+    rt_int8_t plane;
+    int i;
+
+    if ((cfg->format >= BF30A2_SUB_FORMATS) || (cfg->mode > BF30A2_SUB_QUEUE) ||
+        ((cfg->mode == BF30A2_SUB_CALLBACK) && (cfg->callback == RT_NULL)) ||
+        (BF30A2_FRAME_BUFFERS == 0) ||
+        ((cfg->mode == BF30A2_SUB_QUEUE) && (BF30A2_FRAME_BUFFERS < BF30A2_SUB_QUEUE_MIN_BUFFERS)) ||
+        ((cfg->format == BF30A2_SUB_THUMB) && (core->thumb_scale == 0)))
+    {
+        return -RT_EINVAL;
+    }
+
+    /* Planes are kept once allocated, at the largest geometry: a later subscriber reuses them */
+    plane = sub_format_plane[cfg->format];
+    if ((plane >= 0) && (plane != BF30A2_PLANE_THUMB))
+    {
+        bf30a2_core_plane_geometry(core, plane, IMG_WIDTH, IMG_HEIGHT, &geo);
+        if (bf30a2_pool_alloc_plane(pool, plane, geo.frame_size) != RT_EOK)
+        {
+            return -RT_ENOMEM;
+        }
+    }
+
+    level = rt_hw_interrupt_disable();
+    for (i = 0; i < BF30A2_MAX_SUBSCRIBERS; i++)
+    {
+        if (!subs->entry[i].used)
+        {
+            rt_memset(&subs->entry[i], 0, sizeof(subs->entry[i]));
+            subs->entry[i].cfg = *cfg;
+            subs->entry[i].cfg.handle = i;
+            subs->entry[i].countdown = 1;
+            subs->entry[i].used = 1;
+            break;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+
+    return (i < BF30A2_MAX_SUBSCRIBERS) ? i : -RT_EFULL;
+}
+
+rt_err_t bf30a2_sub_remove(bf30a2_subs_t *subs, bf30a2_pool_t *pool, int handle)
+{
+    bf30a2_buffer_t queue[BF30A2_SUB_QUEUE_DEPTH];
+    bf30a2_sub_entry_t *e;
+    rt_base_t level;
+    rt_uint8_t head, count, i;
+
+    level = rt_hw_interrupt_disable();
+    e = sub_entry(subs, handle);
+    if (e == RT_NULL)
+    {
+        rt_hw_interrupt_enable(level);
+        return -RT_EINVAL;
+    }
+    rt_memcpy(queue, e->queue, sizeof(queue));
+    head = e->head;
+    count = e->count;
+    e->count = 0;
+    e->used = 0;
+    rt_hw_interrupt_enable(level);
+
+    /* Frames still queued were never seen by the subscriber */
+    for (i = 0; i < count; i++)
+    {
+        bf30a2_pool_release(pool, queue[(head + i) % BF30A2_SUB_QUEUE_DEPTH].data);
+    }
+
+    return RT_EOK;
+}
+
+rt_err_t bf30a2_sub_take(bf30a2_subs_t *subs, bf30a2_pool_t *pool, int handle,
+                         bf30a2_buffer_t *buf)
+{
+    bf30a2_sub_entry_t *e;
+    rt_err_t ret = RT_EOK;
+    rt_int8_t plane = -1;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    e = sub_entry(subs, handle);
+    if ((e == RT_NULL) || (e->cfg.mode != BF30A2_SUB_QUEUE))
+    {
+        ret = -RT_EINVAL;
+    }
+    else if (e->count == 0)
+    {
+        ret = -RT_EEMPTY;
+    }
+    else
+    {
+        *buf = e->queue[e->head];
+        e->head = (e->head + 1) % BF30A2_SUB_QUEUE_DEPTH;
+        e->count--;
+        plane = sub_format_plane[e->cfg.format];
+    }
+    rt_hw_interrupt_enable(level);
+
+    /* A queued frame is converted when taken, not when queued */
+    if (ret == RT_EOK)
+    {
+        bf30a2_pool_convert(pool, bf30a2_pool_leased(pool, buf->data), plane);
+    }
+
+    return ret;
+}
+
+rt_err_t bf30a2_sub_get_status(const bf30a2_subs_t *subs, bf30a2_sub_status_t *status)
+{
+    const bf30a2_sub_entry_t *e;
+    int handle = status->handle;
+
+    if ((handle < 0) || (handle >= BF30A2_MAX_SUBSCRIBERS) || !subs->entry[handle].used)
+    {
+        return -RT_EINVAL;
+    }
+
+    e = &subs->entry[handle];
+    rt_memset(status, 0, sizeof(*status));
+    status->handle = handle;
+    status->cfg = e->cfg;
+    status->delivered = e->delivered;
+    status->dropped = e->dropped;
+    status->queued = e->count;
+
+    return RT_EOK;
+}
+
+/*============================================================================*/
+/*                     CAPTURE THREAD                                         */
+/*============================================================================*/
+
+rt_uint8_t bf30a2_sub_plan(const bf30a2_subs_t *subs, const bf30a2_pool_slot_t *slot)
+{
+    const bf30a2_sub_entry_t *e;
+    rt_uint8_t mask = 0;
+    rt_int8_t plane;
+    int i;
+
+    for (i = 0; i < BF30A2_MAX_SUBSCRIBERS; i++)
+    {
+        e = &subs->entry[i];
+        if (!e->used || (e->countdown > 1))
+        {
+            continue;
+        }
+        plane = sub_format_plane[e->cfg.format];
+        if ((plane >= 0) && (slot->plane[plane] != RT_NULL))
+        {
+            mask |= (rt_uint8_t)(1U << plane);
+        }
+    }
+
+    return mask;
+}
+
+#ifdef BF30A2_USING_LAZY_CONVERT
+rt_uint8_t bf30a2_sub_callback_outputs(const bf30a2_subs_t *subs,
+                                       const bf30a2_pool_slot_t *slot)
+{
+    const bf30a2_sub_entry_t *e;
+    rt_uint8_t mask = 0;
+    rt_int8_t plane;
+    int i;
+
+    for (i = 0; i < BF30A2_MAX_SUBSCRIBERS; i++)
+    {
+        e = &subs->entry[i];
+        if (!e->used || (e->countdown > 1) || (e->cfg.mode != BF30A2_SUB_CALLBACK))
+        {
+            continue;
+        }
+        plane = sub_format_plane[e->cfg.format];
+        if (plane < 0)
+        {
+            mask |= BF30A2_POOL_CONVERTED_FRAME;
+        }
+        else if (slot->planes & (1U << plane))
+        {
+            mask |= (rt_uint8_t)(1U << plane);
+        }
+    }
+
+    return mask;
+}
+#endif
+
+void bf30a2_sub_publish(bf30a2_subs_t *subs, bf30a2_pool_t *pool, const bf30a2_core_t *core,
+                        bf30a2_pool_slot_t *slot, rt_device_t dev)
+{
+    bf30a2_sub_entry_t *e;
+    bf30a2_sub_cfg_t cfg;
+    bf30a2_buffer_t buf;
+    const rt_uint8_t *oldest;
+    rt_base_t level;
+    rt_int8_t plane;
+    int i;
+
+    for (i = 0; i < BF30A2_MAX_SUBSCRIBERS; i++)
+    {
+        e = &subs->entry[i];
+        oldest = RT_NULL;
+
+        level = rt_hw_interrupt_disable();
+        if (!e->used)
+        {
+            rt_hw_interrupt_enable(level);
+            continue;
+        }
+        if (e->countdown > 1)
+        {
+            e->countdown--;
+            rt_hw_interrupt_enable(level);
+            continue;
+        }
+
+        /* Subscribed after the frame header: its plane comes with the next frame */
+        plane = sub_format_plane[e->cfg.format];
+        if ((plane >= 0) && !(slot->planes & (1U << plane)))
+        {
+            rt_hw_interrupt_enable(level);
+            continue;
+        }
+
+        e->countdown = (e->cfg.divisor > 1) ? e->cfg.divisor : 1;
+        cfg = e->cfg;
+        sub_describe(core, slot, plane, &buf);
+
+        if (cfg.mode == BF30A2_SUB_QUEUE)
+        {
+            /* A full queue makes room by giving back its oldest frame */
+            if (e->count == BF30A2_SUB_QUEUE_DEPTH)
+            {
+                oldest = e->queue[e->head].data;
+                e->head = (e->head + 1) % BF30A2_SUB_QUEUE_DEPTH;
+                e->count--;
+                e->dropped++;
+            }
+            e->queue[(e->head + e->count) % BF30A2_SUB_QUEUE_DEPTH] = buf;
+            e->count++;
+            bf30a2_pool_hold(pool, slot);
+            e->delivered++;
+            rt_hw_interrupt_enable(level);
+
+            if (oldest != RT_NULL)
+            {
+                bf30a2_pool_release(pool, oldest);
+            }
+            continue;
+        }
+
+        rt_hw_interrupt_enable(level);
+
+        /*
+         * The frame cannot be reacquired before this thread's next header.
+         * Its output was converted at publish; one a consumer got to first
+         * (a subscriber added since) is skipped rather than waited for.
+         */
+        if (!bf30a2_pool_convert_nowait(pool, slot, plane))
+        {
+            continue;
+        }
+        e->delivered++;
+        cfg.callback(dev, &buf, cfg.user_data);
+    }
+}
+
+#endif /* BF30A2_USING_SUBSCRIBE */
@@ -0,0 +1,137 @@
+/**
+ * @file    bf30a2_sub.h
+ * @brief   BF30A2 frame subscribers: per-consumer format and rate (internal)
+ *
+ * Each subscriber names an output (the frame buffer, full resolution luma,
+ * a half size RGB565 image or the configured thumbnail), a rate divisor
+ * and a delivery mode. At every frame header the subscribers due on that
+ * frame decide which secondary planes the core fills; the core then
+ * writes all of them from the one pass it makes over each YUV line, so an
+ * output wanted by three subscribers is still converted once. A plane
+ * nobody is due for costs nothing.
+ *
+ * At the frame end a callback subscriber is called in the capture thread;
+ * a queue subscriber gets a lease on the frame pushed into its queue and
+ * returns it with BF30A2_CMD_RELEASE_FRAME. A full queue gives back its
+ * oldest frame to take the new one, so a subscriber that falls behind
+ * sees the latest frames and never pins more than its queue depth; queue
+ * subscribers need BF30A2_SUB_QUEUE_MIN_BUFFERS frame buffers, enough to
+ * leave the latest frame and a buffer to fill beside a full queue. With lazy conversion a callback's
+ * output is converted just before the call, a queued one when taken.
+ *
+ * The table is changed by consumers and read by the capture thread; the
+ * few stores that change it are done with interrupts disabled.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_SUB_H__
+#define __BF30A2_SUB_H__
+
+#include <rtthread.h>
+#include "drv_bf30a2.h"
+#include "bf30a2_core.h"
+#include "bf30a2_pool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef BF30A2_USING_SUBSCRIBE
+
+#ifndef BF30A2_MAX_SUBSCRIBERS
+#define BF30A2_MAX_SUBSCRIBERS      4
+#endif
+
+/* Leases one queue subscriber holds before its oldest frame is given back */
+#define BF30A2_SUB_QUEUE_DEPTH      2
+
+/* Frame buffers a queue subscriber needs: its queue, the latest frame, one to fill */
+#define BF30A2_SUB_QUEUE_MIN_BUFFERS    (BF30A2_SUB_QUEUE_DEPTH + 2)
+
+/**
+ * @brief One subscriber
+ */
+typedef struct bf30a2_sub_entry
+{
+    rt_uint8_t used;                /**< Slot in use */
+    rt_uint8_t countdown;           /**< Published frames until the next delivery */
+    rt_uint8_t head;                /**< Oldest queued frame */
+    rt_uint8_t count;               /**< Queued frames */
+    bf30a2_sub_cfg_t cfg;           /**< Configuration */
+    bf30a2_buffer_t queue[BF30A2_SUB_QUEUE_DEPTH];  /**< Leased frames, BF30A2_SUB_QUEUE */
+    rt_uint32_t delivered;          /**< Frames called back or queued */
+    rt_uint32_t dropped;            /**< Queued frames given back untaken for newer ones */
+} bf30a2_sub_entry_t;
+
+/**
+ * @brief Subscriber table
+ */
+typedef struct bf30a2_subs
+{
+    bf30a2_sub_entry_t entry[BF30A2_MAX_SUBSCRIBERS];   /**< Handle = index */
+} bf30a2_subs_t;
+
+void bf30a2_sub_init(bf30a2_subs_t *subs);
+
+/**
+ * @brief Add a subscriber, allocating its plane in every pool slot
+ *
+ * The thumbnail plane is the driver's, allocated when it is configured.
+ *
+ * @return Handle (>= 0), -RT_EINVAL for a bad configuration, a
+ *         thumbnail that is off or a queue with fewer than
+ *         BF30A2_SUB_QUEUE_MIN_BUFFERS frame buffers, -RT_EFULL, -RT_ENOMEM
+ */
+int bf30a2_sub_add(bf30a2_subs_t *subs, bf30a2_pool_t *pool, const bf30a2_core_t *core,
+                   const bf30a2_sub_cfg_t *cfg);
+
+/**
+ * @brief Remove a subscriber and release the frames in its queue
+ */
+rt_err_t bf30a2_sub_remove(bf30a2_subs_t *subs, bf30a2_pool_t *pool, int handle);
+
+/**
+ * @brief Planes the subscribers due on the next published frame need
+ *
+ * @return Bit per bf30a2_plane_t, only planes the slot has
+ */
+rt_uint8_t bf30a2_sub_plan(const bf30a2_subs_t *subs, const bf30a2_pool_slot_t *slot);
+
+#ifdef BF30A2_USING_LAZY_CONVERT
+/**
+ * @brief Outputs the callback subscribers due on the frame being published read
+ *
+ * @return Bits as bf30a2_pool_slot_t.converted, for bf30a2_pool_publish()
+ */
+rt_uint8_t bf30a2_sub_callback_outputs(const bf30a2_subs_t *subs,
+                                       const bf30a2_pool_slot_t *slot);
+#endif
+
+/**
+ * @brief Deliver a published frame to the subscribers due (capture thread)
+ */
+void bf30a2_sub_publish(bf30a2_subs_t *subs, bf30a2_pool_t *pool, const bf30a2_core_t *core,
+                        bf30a2_pool_slot_t *slot, rt_device_t dev);
+
+/**
+ * @brief Take the oldest frame from a queue subscriber, without waiting
+ *
+ * @return -RT_EEMPTY when the queue is empty, -RT_EINVAL for a bad handle
+ */
+rt_err_t bf30a2_sub_take(bf30a2_subs_t *subs, bf30a2_pool_t *pool, int handle,
+                         bf30a2_buffer_t *buf);
+
+/**
+ * @brief Fill a subscriber report, status->handle selects the subscriber
+ */
+rt_err_t bf30a2_sub_get_status(const bf30a2_subs_t *subs, bf30a2_sub_status_t *status);
+
+#endif /* BF30A2_USING_SUBSCRIBE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BF30A2_SUB_H__ */
@@ -0,0 +1,97 @@
+/**
+ * @file    bf30a2_trace.c
+ * @brief   BF30A2 binary event trace ring
+ *
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <rtthread.h>
+#include <string.h>
+
+#include "bf30a2_trace.h"
+
+#ifdef BF30A2_USING_TRACE
+
+/* Events printed per line in the UART dump */
+#define TRACE_EVENTS_PER_LINE       4
+
+bf30a2_trace_ring_t bf30a2_trace_ring;
+
+void bf30a2_trace_clear(void)
+{
+    rt_memset(bf30a2_trace_ring.ev, 0, sizeof(bf30a2_trace_ring.ev));
+    bf30a2_trace_ring.head = 0;
+}
+
+/**
+ * @brief Copy the newest events into dump->events, oldest first
+ *
+ * The producer is not stopped; if it laps the reader the oldest copied
+ * events may already belong to the next ring generation.
+ */
+void bf30a2_trace_snapshot(bf30a2_trace_dump_t *dump)
+{
+    rt_uint32_t head = bf30a2_trace_ring.head;
+    rt_uint32_t avail = (head < BF30A2_TRACE_DEPTH) ? head : BF30A2_TRACE_DEPTH;
+    rt_uint32_t count = (avail < dump->max_events) ? avail : dump->max_events;
+    rt_uint32_t idx = head - count;
+    rt_uint32_t i;
+
+    for (i = 0; i < count; i++, idx++)
+    {
+        dump->events[i] = bf30a2_trace_ring.ev[idx & (BF30A2_TRACE_DEPTH - 1)];
+    }
+
+    dump->count = count;
+    dump->total = head;
+    dump->clock_hz = bf30a2_port_cycles_hz();
+}
+
+/**
+ * @brief Dump the ring as hex records, decoded by tools/bf30a2_trace_decode.py
+ */
+void bf30a2_trace_export_uart(void)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    char line[TRACE_EVENTS_PER_LINE * 16 + 1];
+    rt_uint32_t head = bf30a2_trace_ring.head;
+    rt_uint32_t count = (head < BF30A2_TRACE_DEPTH) ? head : BF30A2_TRACE_DEPTH;
+    rt_uint32_t idx = head - count;
+    rt_uint32_t i;
+    int pos = 0;
+
+    rt_kprintf("\n===TRACE_START===\n");
+    rt_kprintf("VERSION:%d\n", BF30A2_TRACE_VERSION);
+    rt_kprintf("CLOCK_HZ:%u\n", bf30a2_port_cycles_hz());
+    rt_kprintf("DEPTH:%d\n", BF30A2_TRACE_DEPTH);
+    rt_kprintf("TOTAL:%u\n", head);
+    rt_kprintf("COUNT:%u\n", count);
+    rt_kprintf("===DATA_BEGIN===\n");
+
+    for (i = 0; i < count; i++, idx++)
+    {
+        const rt_uint8_t *p = (const rt_uint8_t *)
+                              &bf30a2_trace_ring.ev[idx & (BF30A2_TRACE_DEPTH - 1)];
+        int k;
+
+        for (k = 0; k < (int)sizeof(bf30a2_trace_event_t); k++)
+        {
+            line[pos++] = hex[p[k] >> 4];
+            line[pos++] = hex[p[k] & 0x0F];
+        }
+
+        if (((i + 1) % TRACE_EVENTS_PER_LINE == 0) || (i + 1 == count))
+        {
+            line[pos] = '\0';
+            rt_kprintf("%s\n", line);
+            pos = 0;
+        }
+    }
+
+    rt_kprintf("===DATA_END===\n");
+    rt_kprintf("===TRACE_END===\n\n");
+}
+
+#endif /* BF30A2_USING_TRACE */
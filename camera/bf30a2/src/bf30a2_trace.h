@@ -0,0 +1,84 @@
+/**
+ * @file    bf30a2_trace.h
+ * @brief   BF30A2 binary event trace ring (internal)
+ *
+ * Fixed-size ring of 8-byte events stamped with the core cycle counter.
+ * All events are emitted from the capture thread, so the ring has a single
+ * producer and needs no lock. Readers take a best-effort snapshot.
+ * With BF30A2_USING_TRACE disabled every trace point compiles to nothing.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_TRACE_H__
+#define __BF30A2_TRACE_H__
+
+#include <rtthread.h>
+#include "drv_bf30a2.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef BF30A2_USING_TRACE
+
+#include "bf30a2_port.h"
+
+#ifndef BF30A2_TRACE_DEPTH
+#define BF30A2_TRACE_DEPTH          1024
+#endif
+
+#if (BF30A2_TRACE_DEPTH & (BF30A2_TRACE_DEPTH - 1)) != 0
+#error "BF30A2_TRACE_DEPTH must be a power of two"
+#endif
+
+/** @brief Trace dump format version */
+#define BF30A2_TRACE_VERSION        1
+
+/**
+ * @brief Trace ring storage
+ */
+typedef struct bf30a2_trace_ring
+{
+    volatile rt_uint32_t head;                      /**< Events emitted since clear */
+    bf30a2_trace_event_t ev[BF30A2_TRACE_DEPTH];    /**< Event slots */
+} bf30a2_trace_ring_t;
+
+extern bf30a2_trace_ring_t bf30a2_trace_ring;
+
+/**
+ * @brief Append one event to the ring (capture thread only)
+ */
+static inline void bf30a2_trace_emit(rt_uint8_t id, rt_uint8_t arg8, rt_uint16_t arg16)
+{
+    rt_uint32_t head = bf30a2_trace_ring.head;
+    bf30a2_trace_event_t *e = &bf30a2_trace_ring.ev[head & (BF30A2_TRACE_DEPTH - 1)];
+
+    e->timestamp = bf30a2_port_cycles();
+    e->id = id;
+    e->arg8 = arg8;
+    e->arg16 = arg16;
+    bf30a2_trace_ring.head = head + 1;
+}
+
+void bf30a2_trace_clear(void);
+void bf30a2_trace_snapshot(bf30a2_trace_dump_t *dump);
+void bf30a2_trace_export_uart(void);
+
+#define BF30A2_TRACE(id, arg8, arg16) \
+    bf30a2_trace_emit((rt_uint8_t)(id), (rt_uint8_t)(arg8), (rt_uint16_t)(arg16))
+
+#else
+
+/* Arguments are not evaluated, sizeof only keeps them referenced */
+#define BF30A2_TRACE(id, arg8, arg16) \
+    do { (void)sizeof(arg8); (void)sizeof(arg16); } while (0)
+
+#endif /* BF30A2_USING_TRACE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BF30A2_TRACE_H__ */
@@ -0,0 +1,322 @@
+/**
+ * @file    bf30a2_vf.c
+ * @brief   BF30A2 viewfinder: lines streamed to the LCD in strips
+ *
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <rtthread.h>
+#include <rthw.h>
+#include <rtdevice.h>
+#include <string.h>
+
+#include "bf30a2_vf.h"
+
+#ifdef BF30A2_USING_VIEWFINDER
+
+#include "bf30a2_port.h"
+
+#define DBG_TAG "drv.bf30a2"
+#define DBG_LVL DBG_LOG
+#include <rtdbg.h>
+
+#define VF_STRIP_SIZE               (BF30A2_VF_STRIP_ROWS * BYTES_PER_LINE)
+
+/* The panel completion carries no context; there is one camera */
+static bf30a2_vf_t *g_vf = RT_NULL;
+
+/*============================================================================*/
+/*                     PANEL COMPLETION                                       */
+/*============================================================================*/
+
+static rt_err_t vf_tx_complete(rt_device_t dev, void *buffer)
+{
+    bf30a2_vf_t *vf = g_vf;
+    rt_uint32_t now = bf30a2_port_cycles();
+    rt_uint32_t per_us = bf30a2_port_cycles_hz() / 1000000UL;
+
+    if (vf == RT_NULL)
+    {
+        return RT_EOK;
+    }
+
+    if (vf->closes)
+    {
+        vf->closes = 0;
+        vf->latency_us = (now - vf->stamp) / per_us;
+        if (vf->latency_us > vf->latency_max_us)
+        {
+            vf->latency_max_us = vf->latency_us;
+        }
+        BF30A2_LAT_RECORD(vf->lat, vf->stamp, now);
+
+        if (vf->have_prev)
+        {
+            vf->interval_sum_us += (now - vf->prev_done) / per_us;
+            vf->intervals++;
+        }
+        vf->prev_done = now;
+        vf->have_prev = 1;
+        vf->frames++;
+    }
+
+    vf->busy = 0;
+    rt_event_send(vf->done, 0x01);
+
+    return RT_EOK;
+}
+
+/*============================================================================*/
+/*                     STRIPS                                                 */
+/*============================================================================*/
+
+/**
+ * @brief Hand the filled strip to the panel and switch to the other buffer
+ */
+static void vf_send(bf30a2_vf_t *vf, const bf30a2_core_t *core)
+{
+    struct rt_device_graphic_ops *ops = rt_graphix_ops(vf->lcd);
+    rt_int32_t timeout = RT_TICK_PER_SECOND * BF30A2_VF_PANEL_TIMEOUT_MS / 1000;
+    rt_uint32_t recved;
+    int x0, y0, x1, y1;
+
+    /* The other buffer is still being read by the panel DMA */
+    if (vf->busy)
+    {
+        vf->stalls++;
+        while (vf->busy)
+        {
+            if (rt_event_recv(vf->done, 0x01, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR,
+                              timeout, &recved) != RT_EOK)
+            {
+                /* A lost completion must not stall every later strip */
+                vf->timeouts++;
+                vf->busy = 0;
+            }
+        }
+    }
+    rt_event_recv(vf->done, 0x01, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR, RT_WAITING_NO, &recved);
+
+    x0 = vf->x;
+    y0 = vf->y + vf->first;
+    x1 = x0 + vf->width - 1;
+    y1 = vf->y + vf->last;
+
+    vf->closes = (vf->last == vf->height - 1);
+    vf->stamp = core->frame_stamp;
+    vf->busy = 1;
+    ops->set_window(x0, y0, x1, y1);
+    ops->draw_rect_async((const char *)vf->strip[vf->fill], x0, y0, x1, y1);
+
+    vf->strips++;
+    vf->fill ^= 1;
+    vf->first = -1;
+}
+
+rt_uint8_t *bf30a2_vf_line_dst(bf30a2_vf_t *vf, bf30a2_core_t *core)
+{
+    rt_uint8_t level = core->frame_level;
+    rt_uint8_t half = (level >= BF30A2_LEVEL_HALF);
+    rt_uint16_t width = half ? (core->width / 2) : core->width;
+    rt_uint16_t row;
+
+    /* 8-bit luma cannot go to an RGB565 panel; the driver caps the level */
+    if (level == BF30A2_LEVEL_Y8)
+    {
+        return RT_NULL;
+    }
+
+    row = half ? (core->line_num / 2) : core->line_num;
+
+    /* A line outside the strip (lost lines, a new frame or geometry): send what there is */
+    if ((vf->first >= 0) &&
+        ((row < vf->first) || (row >= vf->first + BF30A2_VF_STRIP_ROWS) ||
+         (level != vf->level) || (width != vf->width)))
+    {
+        vf_send(vf, core);
+    }
+
+    if (vf->first < 0)
+    {
+        vf->first = row - (row % BF30A2_VF_STRIP_ROWS);
+        vf->last = row;
+        vf->level = level;
+        vf->width = width;
+        vf->height = half ? (core->height / 2) : core->height;
+    }
+    else if (row > vf->last)
+    {
+        vf->last = row;
+    }
+
+    return vf->strip[vf->fill] + (row - vf->first) * width * 2;
+}
+
+void bf30a2_vf_line_done(bf30a2_vf_t *vf, bf30a2_core_t *core)
+{
+    if (vf->first < 0)
+    {
+        return;
+    }
+
+    if ((vf->last == vf->first + BF30A2_VF_STRIP_ROWS - 1) ||
+        (vf->last == vf->height - 1))
+    {
+        vf_send(vf, core);
+    }
+}
+
+/*============================================================================*/
+/*                     CONTROL                                                */
+/*============================================================================*/
+
+void bf30a2_vf_reset(bf30a2_vf_t *vf)
+{
+    vf->first = -1;
+    vf->last = 0;
+    vf->have_prev = 0;
+    vf->frames = 0;
+    vf->strips = 0;
+    vf->stalls = 0;
+    vf->timeouts = 0;
+    vf->latency_us = 0;
+    vf->latency_max_us = 0;
+    vf->interval_sum_us = 0;
+    vf->intervals = 0;
+}
+
+rt_err_t bf30a2_vf_start(bf30a2_vf_t *vf, const char *lcd_name, rt_uint16_t x, rt_uint16_t y)
+{
+    struct rt_device_graphic_info info;
+    struct rt_device_graphic_ops *ops;
+    rt_device_t lcd;
+    rt_bool_t parked;
+
+    lcd = rt_device_find(lcd_name);
+    if ((lcd == RT_NULL) || (lcd->type != RT_Device_Class_Graphic))
+    {
+        LOG_E("Viewfinder: no graphic device %s", lcd_name);
+        return -RT_EINVAL;
+    }
+    if (rt_device_open(lcd, RT_DEVICE_OFLAG_RDWR) != RT_EOK)
+    {
+        return -RT_EIO;
+    }
+
+    ops = rt_graphix_ops(lcd);
+    if ((rt_device_control(lcd, RTGRAPHIC_CTRL_GET_INFO, &info) != RT_EOK) ||
+        (ops == RT_NULL) || (ops->set_window == RT_NULL) || (ops->draw_rect_async == RT_NULL) ||
+        (info.bits_per_pixel != 16) ||
+        (x + IMG_WIDTH > info.width) || (y + IMG_HEIGHT > info.height))
+    {
+        LOG_E("Viewfinder: %s must be RGB565 with room for %dx%d at %d,%d",
+              lcd_name, IMG_WIDTH, IMG_HEIGHT, x, y);
+        rt_device_close(lcd);
+        return -RT_EINVAL;
+    }
+
+    /* Strips parked by a stop the panel never answered are used again */
+    parked = (vf->strip[0] != RT_NULL);
+    if (!parked)
+    {
+        vf->strip[0] = rt_malloc(VF_STRIP_SIZE);
+        vf->strip[1] = rt_malloc(VF_STRIP_SIZE);
+    }
+    vf->done = rt_event_create("bf30vf", RT_IPC_FLAG_FIFO);
+    if ((vf->strip[0] == RT_NULL) || (vf->strip[1] == RT_NULL) || (vf->done == RT_NULL))
+    {
+        LOG_E("Viewfinder: alloc strips failed (2 x %d bytes)", VF_STRIP_SIZE);
+        if (!parked)
+        {
+            rt_free(vf->strip[0]);
+            rt_free(vf->strip[1]);
+            vf->strip[0] = vf->strip[1] = RT_NULL;
+        }
+        if (vf->done != RT_NULL)
+        {
+            rt_event_delete(vf->done);
+            vf->done = RT_NULL;
+        }
+        rt_device_close(lcd);
+        return -RT_ENOMEM;
+    }
+
+    vf->x = x;
+    vf->y = y;
+    vf->fill = 0;
+    vf->busy = 0;
+    vf->closes = 0;
+    bf30a2_vf_reset(vf);
+
+    vf->saved_tx_complete = lcd->tx_complete;
+    g_vf = vf;
+    rt_device_set_tx_complete(lcd, vf_tx_complete);
+    vf->lcd = lcd;
+
+    LOG_I("Viewfinder on %s at %d,%d, strips 2 x %d bytes", lcd_name, x, y, VF_STRIP_SIZE);
+
+    return RT_EOK;
+}
+
+void bf30a2_vf_stop(bf30a2_vf_t *vf)
+{
+    rt_int32_t timeout = RT_TICK_PER_SECOND * BF30A2_VF_PANEL_TIMEOUT_MS / 1000;
+    rt_uint32_t recved;
+    rt_base_t level;
+    rt_uint8_t busy;
+
+    if (vf->lcd == RT_NULL)
+    {
+        return;
+    }
+
+    if (vf->busy)
+    {
+        rt_event_recv(vf->done, 0x01, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR, timeout, &recved);
+    }
+
+    /* No completion may reach vf once it is detached */
+    level = rt_hw_interrupt_disable();
+    g_vf = RT_NULL;
+    rt_device_set_tx_complete(vf->lcd, vf->saved_tx_complete);
+    busy = vf->busy;
+    rt_hw_interrupt_enable(level);
+
+    rt_device_close(vf->lcd);
+    vf->lcd = RT_NULL;
+    rt_event_delete(vf->done);
+    vf->done = RT_NULL;
+
+    /* The panel DMA may still read a strip it never reported done */
+    if (busy)
+    {
+        vf->timeouts++;
+        vf->busy = 0;
+        LOG_W("Viewfinder: panel did not finish, strips kept");
+        return;
+    }
+    rt_free(vf->strip[0]);
+    rt_free(vf->strip[1]);
+    vf->strip[0] = vf->strip[1] = RT_NULL;
+}
+
+void bf30a2_vf_get_status(const bf30a2_vf_t *vf, bf30a2_vf_status_t *status)
+{
+    rt_memset(status, 0, sizeof(*status));
+    status->enabled = (vf->lcd != RT_NULL);
+    status->frames = vf->frames;
+    status->latency_us = vf->latency_us;
+    status->latency_max_us = vf->latency_max_us;
+    status->strips = vf->strips;
+    status->stalls = vf->stalls;
+    status->timeouts = vf->timeouts;
+    if (vf->interval_sum_us != 0)
+    {
+        status->fps_milli = (rt_uint32_t)((rt_uint64_t)vf->intervals * 1000000000ULL /
+                                          vf->interval_sum_us);
+    }
+}
+
+#endif /* BF30A2_USING_VIEWFINDER */
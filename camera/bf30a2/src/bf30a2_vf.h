@@ -0,0 +1,128 @@
+/**
+ * @file    bf30a2_vf.h
+ * @brief   BF30A2 viewfinder: lines streamed to the LCD in strips (internal)
+ *
+ * Instead of assembling a frame, the core converts each line straight
+ * into one of two strip buffers (bf30a2_core_t.on_line_dst). A full strip
+ * is handed to the LCD device's draw_rect_async() and the next strip is
+ * converted into the other buffer while the panel DMA runs; only when
+ * the panel is still busy with the previous strip does the capture
+ * thread wait. A strip is sent when its last row is converted, when a
+ * line for another strip arrives, or at the last row of the frame.
+ *
+ * The panel completion (the LCD device's tx_complete, interrupt context)
+ * only clears the busy flag, wakes a waiting capture thread and, for the
+ * strip that closes a frame, records the frame latency and interval.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_VF_H__
+#define __BF30A2_VF_H__
+
+#include <rtthread.h>
+#include "drv_bf30a2.h"
+#include "bf30a2_core.h"
+#include "bf30a2_latency.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef BF30A2_USING_VIEWFINDER
+
+#ifndef BF30A2_VF_STRIP_ROWS
+#define BF30A2_VF_STRIP_ROWS        16
+#endif
+
+/* Longest wait for the panel to finish the previous strip */
+#define BF30A2_VF_PANEL_TIMEOUT_MS  100
+
+/**
+ * @brief Viewfinder state
+ */
+typedef struct bf30a2_vf
+{
+    rt_device_t lcd;                /**< Panel, RT_NULL when off */
+    rt_err_t (*saved_tx_complete)(rt_device_t dev, void *buffer);  /**< Restored when off */
+    rt_event_t done;                /**< Strip completion */
+    rt_uint8_t *strip[2];           /**< Strip buffers */
+    rt_uint16_t x;                  /**< Panel column of the image */
+    rt_uint16_t y;                  /**< Panel row of the image */
+
+    /* Capture thread */
+    rt_uint8_t fill;                /**< Strip being converted into */
+    rt_uint8_t level;               /**< Level of the strip being converted */
+    rt_uint16_t width;              /**< Image width of that strip's frame, pixels */
+    rt_uint16_t height;             /**< Image height of that strip's frame, rows */
+    rt_int16_t first;               /**< Image row of the strip's first row, -1 = empty */
+    rt_int16_t last;                /**< Image row of the strip's last row written */
+
+    /* Shared with the panel completion */
+    volatile rt_uint8_t busy;       /**< A strip is on its way to the panel */
+    rt_uint8_t closes;              /**< The strip in flight ends a frame */
+    rt_uint32_t stamp;              /**< Header wakeup of that frame, cycles */
+    rt_uint32_t prev_done;          /**< Completion of the previous frame, cycles */
+    rt_uint8_t have_prev;           /**< prev_done is valid */
+
+    /* Statistics */
+    rt_uint32_t frames;             /**< Frames completed on the panel */
+    rt_uint32_t strips;             /**< Strips sent */
+    rt_uint32_t stalls;             /**< Strips that waited for the panel */
+    rt_uint32_t timeouts;           /**< Panel completions that never came */
+    rt_uint32_t latency_us;         /**< Last frame: header wakeup to panel */
+    rt_uint32_t latency_max_us;     /**< Largest frame latency */
+    rt_uint64_t interval_sum_us;    /**< Sum of panel frame intervals */
+    rt_uint32_t intervals;          /**< Intervals summed */
+#ifdef BF30A2_USING_LATENCY
+    bf30a2_lat_hist_t *lat;         /**< BF30A2_LAT_PANEL histogram */
+#endif
+} bf30a2_vf_t;
+
+/**
+ * @brief Start streaming to a panel
+ *
+ * The panel must be 16 bpp (RGB565) and fit the largest image at x, y.
+ * Its tx_complete callback is taken over until bf30a2_vf_stop().
+ *
+ * @return -RT_EINVAL for an unknown or unsuitable panel, -RT_ENOMEM
+ */
+rt_err_t bf30a2_vf_start(bf30a2_vf_t *vf, const char *lcd_name, rt_uint16_t x, rt_uint16_t y);
+
+/**
+ * @brief Wait for the last strip, then give the panel back
+ *
+ * If the panel does not report the last strip done within
+ * BF30A2_VF_PANEL_TIMEOUT_MS, its DMA may still be reading it: the strips
+ * are kept rather than freed and reused by the next bf30a2_vf_start().
+ */
+void bf30a2_vf_stop(bf30a2_vf_t *vf);
+
+/**
+ * @brief Clear the statistics and forget a partly filled strip
+ */
+void bf30a2_vf_reset(bf30a2_vf_t *vf);
+
+/**
+ * @brief Core line destination hook body (capture thread)
+ */
+rt_uint8_t *bf30a2_vf_line_dst(bf30a2_vf_t *vf, bf30a2_core_t *core);
+
+/**
+ * @brief Core line hook body: send the strip if the line completed it
+ */
+void bf30a2_vf_line_done(bf30a2_vf_t *vf, bf30a2_core_t *core);
+
+/**
+ * @brief Fill the viewfinder part of a status report
+ */
+void bf30a2_vf_get_status(const bf30a2_vf_t *vf, bf30a2_vf_status_t *status);
+
+#endif /* BF30A2_USING_VIEWFINDER */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BF30A2_VF_H__ */
@@ -13,11 +13,24 @@
 
 #include <rtthread.h>
 #include <rtdevice.h>
+#include <rthw.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "drv_bf30a2.h"
 #include "bf0_hal.h"
 #include "drv_spi.h"
+#include "bf30a2_bench.h"
+#include "bf30a2_convert.h"
+#include "bf30a2_core.h"
+#include "bf30a2_gov.h"
+#include "bf30a2_latency.h"
+#include "bf30a2_pool.h"
+#include "bf30a2_port.h"
+#include "bf30a2_rawcap.h"
+#include "bf30a2_sub.h"
+#include "bf30a2_trace.h"
+#include "bf30a2_vf.h"
 
 #define DBG_TAG "drv.bf30a2"
 #define DBG_LVL DBG_LOG
@@ -83,20 +96,35 @@
 #define BF30A2_PWM_PAD              PAD_PA20
 #endif
 
-/* Image Parameters */
-#define IMG_WIDTH                   BF30A2_DEFAULT_WIDTH
-#define IMG_HEIGHT                  BF30A2_DEFAULT_HEIGHT
-#define BYTES_PER_LINE              (IMG_WIDTH * 2)
+/* Capture thread */
+#ifndef BF30A2_THREAD_STACK_SIZE
+#define BF30A2_THREAD_STACK_SIZE    2048
+#endif
+
+/* When the DMA ring and frame buffers are held, default from init on; placed ones always are */
+#ifdef BF30A2_USING_STATIC_ALLOC
+#undef BF30A2_BUFFERS_AT_OPEN
+#undef BF30A2_BUFFERS_AT_START
+#endif
+#if !defined(BF30A2_BUFFERS_AT_OPEN) && !defined(BF30A2_BUFFERS_AT_START)
+#define BF30A2_BUFFERS_AT_INIT
+#endif
 
-/* Protocol Frame Sizes */
-#define FRAME_HEADER_SIZE           9
-#define LINE_HEADER_SIZE            6
-#define DATA_HEADER_SIZE            6
-#define ONE_LINE_TOTAL              (LINE_HEADER_SIZE + DATA_HEADER_SIZE + BYTES_PER_LINE)
-#define ONE_FRAME_SIZE              (IMG_WIDTH * IMG_HEIGHT * 2)
+/*
+ * Tone curve banks: the pending curve and the frame being assembled, plus,
+ * with lazy conversion, one per frame buffer whose output is still to
+ * be converted
+ */
+#ifdef BF30A2_USING_LAZY_CONVERT
+#define BF30A2_TONE_BANKS           (BF30A2_POOL_SLOTS + 2)
+#else
+#define BF30A2_TONE_BANKS           2
+#endif
 
-/* DMA Configuration */
-#define DMA_BUFFER_SIZE             (ONE_LINE_TOTAL * 16)
+/* Newer kernels spell it rt_align() */
+#ifndef ALIGN
+#define ALIGN(n)                    rt_align(n)
+#endif
 
 /*============================================================================*/
 /*                          EXTERNAL DECLARATIONS                             */
@@ -109,29 +137,6 @@ extern void camera_stop_dma(SPI_HandleTypeDef *hspi);
 /*                            TYPE DEFINITIONS                                */
 /*============================================================================*/
 
-/**
- * @brief Parse state machine states
- */
-typedef enum
-{
-    STATE_FIND_SYNC,
-    STATE_GET_TYPE,
-    STATE_FRAME_FORMAT,
-    STATE_FRAME_WIDTH_H,
-    STATE_FRAME_WIDTH_L,
-    STATE_FRAME_HEIGHT_H,
-    STATE_FRAME_HEIGHT_L,
-    STATE_LINE_NUM_H,
-    STATE_LINE_NUM_L,
-    STATE_DATA_SYNC_1,
-    STATE_DATA_SYNC_2,
-    STATE_DATA_SYNC_3,
-    STATE_DATA_TYPE,
-    STATE_DATA_SIZE_H,
-    STATE_DATA_SIZE_L,
-    STATE_PIXEL_DATA,
-} parse_state_t;
-
 /**
  * @brief BF30A2 camera device structure (extends rt_device)
  */
@@ -150,38 +155,17 @@ typedef struct bf30a2_device
     rt_device_t gpio_device;            /**< GPIO device handle */
 
     /* DMA buffers */
-    rt_uint8_t *dma_buf;                /**< DMA receive buffer */
+    rt_uint8_t *dma_buf;                /**< DMA receive buffer, RT_NULL = buffers not held */
     rt_uint32_t dma_size;               /**< DMA buffer size */
+    rt_uint8_t buffers_deferred;        /**< Buffers to free once the last lease is returned */
 
-    /* Parse state machine */
-    parse_state_t state;                /**< Current parse state */
-    rt_uint8_t ff_count;                /**< 0xFF byte count */
-    rt_uint16_t frame_width;            /**< Detected frame width */
-    rt_uint16_t frame_height;           /**< Detected frame height */
-    rt_uint16_t line_num;               /**< Current line number */
-    rt_uint16_t data_size;              /**< Data size for current line */
-    rt_uint16_t data_pos;               /**< Position in line data */
-
-    /* Frame buffers */
-    rt_uint8_t *frame_rgb565;           /**< RGB565 frame buffer */
-    rt_uint8_t line_yuv[BYTES_PER_LINE];/**< YUV line buffer */
-    rt_uint16_t lines_received;         /**< Lines received in current frame */
-    rt_uint16_t max_line_seen;          /**< Maximum line number seen */
-    rt_uint8_t frame_ready;             /**< Frame ready flag */
-    rt_uint8_t in_frame;                /**< Currently receiving frame flag */
+    /* Parser, frame assembly and parser statistics */
+    bf30a2_core_t core;                 /**< Protocol/conversion core */
+    bf30a2_pool_t pool;                 /**< Frame buffers */
 
     /* Statistics */
-    rt_uint32_t frame_count;            /**< Total frame count */
-    rt_uint32_t complete_frames;        /**< Complete frames count */
-    rt_uint32_t frame_start_count;      /**< Frame start count */
-    rt_uint32_t frame_end_count;        /**< Frame end count */
-    rt_uint32_t line_count;             /**< Total line count */
-    rt_uint32_t errors;                 /**< Error count */
-    rt_uint32_t rx_count;               /**< DMA receive count */
+    volatile rt_uint32_t rx_count;      /**< DMA receive count */
     rt_uint32_t total_bytes;            /**< Total bytes received */
-    rt_uint32_t last_time;              /**< Last FPS calculation time */
-    rt_uint32_t last_frames;            /**< Last frame count */
-    float fps;                          /**< Current FPS */
 
     /* Thread management */
     rt_thread_t thread;                 /**< Processing thread */
@@ -189,6 +173,41 @@ typedef struct bf30a2_device
     volatile rt_uint8_t running;        /**< Running flag */
     volatile rt_uint8_t stop_flag;      /**< Stop request flag */
 
+#ifdef BF30A2_USING_RAW_CAPTURE
+    /* Raw stream capture */
+    bf30a2_rawcap_t rawcap;             /**< Raw capture state */
+#endif
+
+#ifdef BF30A2_USING_LATENCY
+    /* Frame latency */
+    bf30a2_lat_hist_t lat[BF30A2_LAT_POINTS];   /**< Per bf30a2_lat_point_t */
+#endif
+
+#ifdef BF30A2_USING_GOVERNOR
+    /* CPU and ring budget governor */
+    bf30a2_gov_t gov;                   /**< Governor state */
+#endif
+
+#ifdef BF30A2_USING_VIEWFINDER
+    /* Lines straight to the LCD */
+    bf30a2_vf_t vf;                     /**< Viewfinder state */
+#endif
+
+#ifdef BF30A2_USING_SUBSCRIBE
+    /* Per-consumer outputs */
+    bf30a2_subs_t subs;                 /**< Frame subscribers */
+#endif
+
+    /* Sensor output window, written after the init sequence */
+    bf30a2_window_t window;             /**< Window set, width 0 = the whole array */
+
+    /* Frame output pipeline, set in core.pipeline */
+    bf30a2_frame_stats_t frame_stats;   /**< Statistics of the last published frame */
+#ifdef BF30A2_USING_TONE
+    bf30a2_tone_t tone[BF30A2_TONE_BANKS];  /**< Tone curve banks behind core.tone */
+    rt_uint32_t tone_installs;          /**< Curves installed, the last one's generation */
+#endif
+
     /* Callback */
     bf30a2_frame_callback_t callback;   /**< Frame callback function */
     void *user_data;                    /**< User callback context */
@@ -200,140 +219,41 @@ typedef struct bf30a2_device
 
     /* Mutex for thread safety */
     rt_mutex_t lock;                    /**< Device lock mutex */
+
+#ifdef BF30A2_USING_STATIC_ALLOC
+    /* Kernel objects behind thread, event and lock */
+    struct rt_thread thread_obj;        /**< Capture thread */
+    struct rt_event event_obj;          /**< Synchronization event */
+    struct rt_mutex lock_obj;           /**< Device lock */
+#endif
 } bf30a2_device_t;
 
 /*============================================================================*/
-/*                     REGISTER CONFIGURATION                                 */
+/*                          STATIC VARIABLES                                  */
 /*============================================================================*/
 
-/**
- * @brief Register address-value pair structure
- */
-typedef struct
-{
-    rt_uint16_t reg;
-    rt_uint8_t val;
-} bf30a2_reg_t;
-
-#define REGLIST_TAIL    0xFFFE
-#define REG_DLY         0xFFFF
+static bf30a2_device_t *g_bf30a2_dev = RT_NULL;
 
-/**
- * @brief BF30A2 SPI initialization register sequence
+#ifdef BF30A2_USING_STATIC_ALLOC
+/*
+ * Everything the capture path needs, sized at link time. A board places
+ * the large buffers with BF30A2_STATIC_SECTION, e.g. in internal SRAM.
  */
-static const bf30a2_reg_t bf30a2_init_regs[] =
-{
-    {0xf2, 0x01},
-    {0xcf, 0xf0},
-    {0x12, 0x40},
-    {0x15, 0x80},
-    {0x6b, 0x71},
-    {0x00, 0x40},
-    {0x04, 0x00},
-    {0x06, 0x26},
-    {0x08, 0x07},
-    {0x1c, 0x12},
-    {0x20, 0x20},
-    {0x21, 0x20},
-    {0x34, 0x02},
-    {0x35, 0x02},
-    {0x36, 0x21},
-    {0x37, 0x13},
-    {0xca, 0x23},
-    {0xcb, 0x22},
-    {0xcc, 0x89},
-    {0xcd, 0x4c},
-    {0xce, 0x6b},
-    {0xa0, 0x8e},
-    {0x01, 0x1b},
-    {0x02, 0x1d},
-    {0x13, 0x08},
-    {0x87, 0x13},
-    {0x8b, 0x08},
-    {0x70, 0x17},
-    {0x71, 0x43},
-    {0x72, 0x0a},
-    {0x73, 0x62},
-    {0x74, 0xa2},
-    {0x75, 0xbf},
-    {0x76, 0x00},
-    {0x77, 0xcc},
-    {0x40, 0x32},
-    {0x41, 0x28},
-    {0x42, 0x26},
-    {0x43, 0x1d},
-    {0x44, 0x1a},
-    {0x45, 0x14},
-    {0x46, 0x11},
-    {0x47, 0x0f},
-    {0x48, 0x0e},
-    {0x49, 0x0d},
-    {0x4B, 0x0c},
-    {0x4C, 0x0b},
-    {0x4E, 0x0a},
-    {0x4F, 0x09},
-    {0x50, 0x09},
-    {0x24, 0x30},
-    {0x25, 0x36},
-    {0x80, 0x00},
-    {0x81, 0x20},
-    {0x82, 0x40},
-    {0x83, 0x30},
-    {0x84, 0x50},
-    {0x85, 0x30},
-    {0x86, 0xd8},
-    {0x89, 0x45},
-    {0x8a, 0x33},
-    {0x8f, 0x81},
-    {0x91, 0xff},
-    {0x92, 0x08},
-    {0x94, 0x82},
-    {0x95, 0xfd},
-    {0x9a, 0x20},
-    {0x9e, 0xbc},
-    {0xf0, 0x8f},
-    {0x51, 0x06},
-    {0x52, 0x25},
-    {0x53, 0x2b},
-    {0x54, 0x0f},
-    {0x57, 0x2a},
-    {0x58, 0x22},
-    {0x59, 0x2c},
-    {0x23, 0x33},
-    {0xa1, 0x93},
-    {0xa2, 0x0f},
-    {0xa3, 0x2a},
-    {0xa4, 0x08},
-    {0xa5, 0x26},
-    {0xa7, 0x80},
-    {0xa8, 0x80},
-    {0xa9, 0x1e},
-    {0xaa, 0x19},
-    {0xab, 0x18},
-    {0xae, 0x50},
-    {0xaf, 0x04},
-    {0xc8, 0x10},
-    {0xc9, 0x15},
-    {0xd3, 0x0c},
-    {0xd4, 0x16},
-    {0xee, 0x06},
-    {0xef, 0x04},
-    {0x55, 0x34},
-    {0x56, 0x9c},
-    {0xb1, 0x98},
-    {0xb2, 0x98},
-    {0xb3, 0xc4},
-    {0xb4, 0x0c},
-    {0xa0, 0x8f},
-    {0x13, 0x07},
-    {REGLIST_TAIL, 0x00}
-};
-
-/*============================================================================*/
-/*                          STATIC VARIABLES                                  */
-/*============================================================================*/
+#ifndef BF30A2_STATIC_SECTION
+#define BF30A2_STATIC_SECTION
+#endif
 
-static bf30a2_device_t *g_bf30a2_dev = RT_NULL;
+static bf30a2_device_t g_bf30a2_static_dev;
+static rt_uint8_t g_bf30a2_stack[BF30A2_THREAD_STACK_SIZE] ALIGN(8);
+BF30A2_STATIC_SECTION static rt_uint8_t g_bf30a2_dma_ring[DMA_BUFFER_SIZE] ALIGN(32);
+#if BF30A2_FRAME_BUFFERS > 0
+BF30A2_STATIC_SECTION static rt_uint8_t g_bf30a2_frames[BF30A2_FRAME_BUFFERS * ONE_FRAME_SIZE *
+                                                        BF30A2_POOL_FRAME_COPIES];
+#define BF30A2_STATIC_FRAMES        g_bf30a2_frames
+#else
+#define BF30A2_STATIC_FRAMES        RT_NULL
+#endif
+#endif /* BF30A2_USING_STATIC_ALLOC */
 
 /*============================================================================*/
 /*                     FORWARD DECLARATIONS                                   */
@@ -370,287 +290,253 @@ void camera_rx_ind(rt_uint8_t *p)
 }
 
 /*============================================================================*/
-/*                     COLOR CONVERSION                                       */
+/*                     FRAME DELIVERY                                         */
 /*============================================================================*/
 
 /**
- * @brief Clamp integer value to 8-bit range
+ * @brief Point the core at the secondary planes the frame starting now needs
+ */
+static void bf30a2_plan_planes(bf30a2_device_t *dev, bf30a2_core_t *core,
+                               bf30a2_pool_slot_t *slot)
+{
+    rt_uint8_t mask = 0;
+    int i;
+
+    /* The thumbnail comes with every frame */
+    if ((core->thumb_scale != 0) && (slot->plane[BF30A2_PLANE_THUMB] != RT_NULL))
+    {
+        mask |= 1U << BF30A2_PLANE_THUMB;
+    }
+#ifdef BF30A2_USING_SUBSCRIBE
+    mask |= bf30a2_sub_plan(&dev->subs, slot);
+#endif
+
+    for (i = 0; i < BF30A2_PLANES; i++)
+    {
+#ifdef BF30A2_USING_LAZY_CONVERT
+        /* The others are converted from the raw frame when read */
+        if (i != BF30A2_PLANE_THUMB)
+        {
+            continue;
+        }
+#endif
+        if (mask & (1U << i))
+        {
+            core->frame_plane[i] = slot->plane[i];
+        }
+    }
+    slot->planes = mask;
+}
+
+/**
+ * @brief Core acquire hook: pick the buffer for the frame starting now
  */
-static inline rt_uint8_t clamp8(int v)
+static rt_uint8_t *bf30a2_acquire_hook(bf30a2_core_t *core, void *ctx)
 {
-    if (v < 0) return 0;
-    if (v > 255) return 255;
-    return (rt_uint8_t)v;
+    bf30a2_device_t *dev = (bf30a2_device_t *)ctx;
+    rt_uint8_t *buf = bf30a2_pool_acquire(&dev->pool);
+
+    /* A single buffer overwrites the frame it held */
+    if (bf30a2_pool_latest(&dev->pool) == RT_NULL)
+    {
+        core->frame_ready = 0;
+    }
+
+    if (buf != RT_NULL)
+    {
+        bf30a2_plan_planes(dev, core, bf30a2_pool_filling(&dev->pool));
+    }
+
+    return buf;
 }
 
 /**
- * @brief Convert YUV422 line to RGB565 format
+ * @brief Core frame hook: publish the frame and hand it to the user callback
  */
-static void yuv_line_to_rgb565(rt_uint8_t *yuv, rt_uint8_t *rgb, int width)
+static void bf30a2_frame_hook(bf30a2_core_t *core, void *ctx)
 {
-    int x;
-    int y0, cb, y1, cr;
-    int cb_off, cr_off;
-    int r0, g0, b0, r1, g1, b1;
-    rt_uint16_t p0, p1;
+    bf30a2_device_t *dev = (bf30a2_device_t *)ctx;
+    bf30a2_pool_slot_t *slot;
+    bf30a2_info_t geo;
+    rt_base_t level;
+    rt_uint8_t convert = 0;
 
-    for (x = 0; x < width; x += 2)
+#ifdef BF30A2_USING_LAZY_CONVERT
+    /* What this thread hands out is converted before a consumer can race it */
+    slot = bf30a2_pool_filling(&dev->pool);
+    if ((slot != RT_NULL) && (dev->callback != RT_NULL))
+    {
+        convert |= BF30A2_POOL_CONVERTED_FRAME;
+    }
+#ifdef BF30A2_USING_SUBSCRIBE
+    if (slot != RT_NULL)
     {
-        y0 = yuv[0];
-        cb = yuv[1];
-        y1 = yuv[2];
-        cr = yuv[3];
-        yuv += 4;
+        convert |= bf30a2_sub_callback_outputs(&dev->subs, slot);
+    }
+#endif
+#endif
 
-        cb_off = cb - 128;
-        cr_off = cr - 128;
+    slot = bf30a2_pool_publish(&dev->pool, core->frame_count, core->pub_level,
+                               core->pub_width, core->pub_height, core->pub_stamp,
+                               core->change.unchanged, core->frame_tone, convert);
+    BF30A2_LAT_RECORD(&dev->lat[BF30A2_LAT_ASSEMBLED], core->pub_stamp, core->pub_done_stamp);
 
-        r0 = clamp8(y0 + ((359 * cr_off) >> 8));
-        g0 = clamp8(y0 - ((88 * cb_off + 183 * cr_off) >> 8));
-        b0 = clamp8(y0 + ((454 * cb_off) >> 8));
+    /* Viewfinder frames have statistics too */
+    if (core->pipeline.stats)
+    {
+        level = rt_hw_interrupt_disable();
+        dev->frame_stats = core->stats;
+        rt_hw_interrupt_enable(level);
+    }
 
-        r1 = clamp8(y1 + ((359 * cr_off) >> 8));
-        g1 = clamp8(y1 - ((88 * cb_off + 183 * cr_off) >> 8));
-        b1 = clamp8(y1 + ((454 * cb_off) >> 8));
+    /* Viewfinder frames went to the panel, there is nothing to read */
+    if (slot == RT_NULL)
+    {
+        core->frame_ready = 0;
+    }
 
-        p0 = ((r0 & 0xF8) << 8) | ((g0 & 0xFC) << 3) | (b0 >> 3);
-        p1 = ((r1 & 0xF8) << 8) | ((g1 & 0xFC) << 3) | (b1 >> 3);
+    /* Converted at publish; one a consumer got to first is skipped, not waited for */
+    if ((dev->callback != RT_NULL) && (slot != RT_NULL) &&
+        bf30a2_pool_convert_nowait(&dev->pool, slot, -1))
+    {
+        BF30A2_LAT_RECORD(&dev->lat[BF30A2_LAT_CALLBACK], core->pub_stamp,
+                          bf30a2_port_cycles());
+        BF30A2_TRACE(BF30A2_TRACE_CB_ENTER, 0, core->frame_count);
+        bf30a2_core_output_geometry(&core->pipeline, slot->level, slot->width, slot->height,
+                                    &geo);
+        dev->callback(&dev->parent, core->frame_count,
+                     slot->data, geo.frame_size, dev->user_data);
+        BF30A2_TRACE(BF30A2_TRACE_CB_EXIT, 0, core->frame_count);
+    }
 
-        *rgb++ = p0 & 0xFF;
-        *rgb++ = p0 >> 8;
-        *rgb++ = p1 & 0xFF;
-        *rgb++ = p1 >> 8;
+#ifdef BF30A2_USING_SUBSCRIBE
+    if (slot != RT_NULL)
+    {
+        bf30a2_sub_publish(&dev->subs, &dev->pool, core, slot, &dev->parent);
     }
+#endif
 }
 
-/*============================================================================*/
-/*                     PARSE STATE MACHINE                                    */
-/*============================================================================*/
-
-static void reset_parse(bf30a2_device_t *dev)
+#ifdef BF30A2_USING_VIEWFINDER
+/**
+ * @brief Core line destination hook: the viewfinder strip row
+ */
+static rt_uint8_t *bf30a2_vf_dst_hook(bf30a2_core_t *core, void *ctx)
 {
-    dev->state = STATE_FIND_SYNC;
-    dev->ff_count = 0;
-    dev->lines_received = 0;
-    dev->max_line_seen = 0;
-    dev->data_pos = 0;
-    dev->in_frame = 0;
-    dev->frame_ready = 0;  /* 重要：重置frame_ready标志，确保重新启动时状态正确 */
+    return bf30a2_vf_line_dst(&((bf30a2_device_t *)ctx)->vf, core);
 }
 
-static void on_frame_start(bf30a2_device_t *dev)
+/**
+ * @brief Core line hook: send a completed viewfinder strip
+ */
+static void bf30a2_vf_line_hook(bf30a2_core_t *core, void *ctx)
 {
-    dev->frame_start_count++;
-    dev->in_frame = 1;
-    dev->lines_received = 0;
-    dev->max_line_seen = 0;
+    bf30a2_vf_line_done(&((bf30a2_device_t *)ctx)->vf, core);
 }
+#endif
 
-static void on_frame_end(bf30a2_device_t *dev)
+/**
+ * @brief Describe a published frame, RT_NULL data if there is none
+ */
+static void bf30a2_fill_buffer(bf30a2_device_t *dev, bf30a2_pool_slot_t *slot,
+                               bf30a2_buffer_t *buf)
 {
-    dev->frame_end_count++;
+    bf30a2_info_t geo;
 
-    if (dev->in_frame && (dev->lines_received >= (IMG_HEIGHT * 8 / 10)))
+    if (slot == RT_NULL)
     {
-        dev->frame_ready = 1;
-        dev->complete_frames++;
-
-        if (dev->callback != RT_NULL)
-        {
-            dev->callback(&dev->parent, dev->frame_count,
-                         dev->frame_rgb565, ONE_FRAME_SIZE, dev->user_data);
-        }
-        dev->frame_count++;
+        rt_memset(buf, 0, sizeof(*buf));
+        return;
     }
-
-    dev->in_frame = 0;
+    bf30a2_pool_convert(&dev->pool, slot, -1);
+
+    bf30a2_core_output_geometry(&dev->core.pipeline, slot->level, slot->width,
+                                slot->height, &geo);
+    buf->data = slot->data;
+    buf->size = geo.frame_size;
+    buf->frame_num = slot->frame_num;
+    buf->timestamp = rt_tick_get();
+    buf->width = geo.width;
+    buf->height = geo.height;
+    buf->format = geo.format;
+    buf->unchanged = slot->unchanged;
 }
 
-static void on_line_complete(bf30a2_device_t *dev)
+/**
+ * @brief Describe the latest frame without keeping a lease on it
+ *
+ * The frame is leased while it is converted and described, so that it is
+ * neither reacquired under the conversion nor taken for the next frame
+ * when its conversion is marked done.
+ */
+static void bf30a2_fill_latest(bf30a2_device_t *dev, bf30a2_buffer_t *buf)
 {
-    rt_uint16_t line = dev->line_num;
+    bf30a2_pool_slot_t *slot = bf30a2_pool_lease(&dev->pool);
 
-    dev->line_count++;
-
-    if ((line < IMG_HEIGHT) && (dev->frame_rgb565 != RT_NULL))
-    {
-        yuv_line_to_rgb565(dev->line_yuv,
-                          dev->frame_rgb565 + (line * BYTES_PER_LINE),
-                          IMG_WIDTH);
-        dev->lines_received++;
-        if (line > dev->max_line_seen)
-        {
-            dev->max_line_seen = line;
-        }
-    }
-    else
+    bf30a2_fill_buffer(dev, slot, buf);
+    if (slot != RT_NULL)
     {
-        dev->errors++;
+        bf30a2_pool_release(&dev->pool, slot->data);
     }
 }
 
-static void parse_byte(bf30a2_device_t *dev, rt_uint8_t b)
+/*============================================================================*/
+/*                     CAMERA THREAD                                          */
+/*============================================================================*/
+
+#ifdef BF30A2_USING_GOVERNOR
+/**
+ * @brief Level the core can apply in the current output mode
+ */
+static rt_uint8_t bf30a2_core_level_cap(bf30a2_device_t *dev, rt_uint8_t level)
 {
-    switch (dev->state)
+#ifdef BF30A2_USING_VIEWFINDER
+    /* The panel takes RGB565 only: half resolution is as far as it goes */
+    if ((dev->vf.lcd != RT_NULL) && (level > BF30A2_LEVEL_HALF))
     {
-    case STATE_FIND_SYNC:
-        if (b == 0xFF)
-        {
-            dev->ff_count++;
-            if (dev->ff_count >= 3)
-            {
-                dev->state = STATE_GET_TYPE;
-                dev->ff_count = 0;
-            }
-        }
-        else
-        {
-            dev->ff_count = 0;
-        }
-        break;
-
-    case STATE_GET_TYPE:
-        switch (b)
-        {
-        case 0x01:
-            dev->state = STATE_FRAME_FORMAT;
-            break;
-        case 0x02:
-            dev->state = STATE_LINE_NUM_H;
-            break;
-        case 0x00:
-            on_frame_end(dev);
-            dev->state = STATE_FIND_SYNC;
-            break;
-        case 0xFF:
-            dev->ff_count = 1;
-            break;
-        default:
-            dev->state = STATE_FIND_SYNC;
-            dev->ff_count = 0;
-            break;
-        }
-        break;
-
-    case STATE_FRAME_FORMAT:
-        if (b == 0x00)
-        {
-            dev->state = STATE_FRAME_WIDTH_H;
-        }
-        else
-        {
-            dev->state = STATE_FIND_SYNC;
-            dev->ff_count = 0;
-        }
-        break;
-
-    case STATE_FRAME_WIDTH_H:
-        dev->frame_width = (rt_uint16_t)b << 8;
-        dev->state = STATE_FRAME_WIDTH_L;
-        break;
-
-    case STATE_FRAME_WIDTH_L:
-        dev->frame_width |= b;
-        dev->state = STATE_FRAME_HEIGHT_H;
-        break;
-
-    case STATE_FRAME_HEIGHT_H:
-        dev->frame_height = (rt_uint16_t)b << 8;
-        dev->state = STATE_FRAME_HEIGHT_L;
-        break;
-
-    case STATE_FRAME_HEIGHT_L:
-        dev->frame_height |= b;
-        if ((dev->frame_width == IMG_WIDTH) && (dev->frame_height == IMG_HEIGHT))
-        {
-            on_frame_start(dev);
-        }
-        else
-        {
-            dev->errors++;
-        }
-        dev->state = STATE_FIND_SYNC;
-        dev->ff_count = 0;
-        break;
-
-    case STATE_LINE_NUM_H:
-        dev->line_num = (rt_uint16_t)b << 8;
-        dev->state = STATE_LINE_NUM_L;
-        break;
-
-    case STATE_LINE_NUM_L:
-        dev->line_num |= b;
-        dev->state = STATE_DATA_SYNC_1;
-        dev->ff_count = 0;
-        break;
-
-    case STATE_DATA_SYNC_1:
-        dev->state = (b == 0xFF) ? STATE_DATA_SYNC_2 : STATE_FIND_SYNC;
-        if (b != 0xFF) dev->ff_count = 0;
-        break;
-
-    case STATE_DATA_SYNC_2:
-        dev->state = (b == 0xFF) ? STATE_DATA_SYNC_3 : STATE_FIND_SYNC;
-        if (b != 0xFF) dev->ff_count = 0;
-        break;
-
-    case STATE_DATA_SYNC_3:
-        dev->state = (b == 0xFF) ? STATE_DATA_TYPE : STATE_FIND_SYNC;
-        if (b != 0xFF) dev->ff_count = 0;
-        break;
+        return BF30A2_LEVEL_HALF;
+    }
+#endif
+    return level;
+}
 
-    case STATE_DATA_TYPE:
-        if (b == 0x40)
-        {
-            dev->state = STATE_DATA_SIZE_H;
-        }
-        else
-        {
-            dev->state = STATE_FIND_SYNC;
-            dev->ff_count = 0;
-        }
-        break;
+/**
+ * @brief Account a parsed wakeup and apply the level it leads to
+ */
+static void bf30a2_gov_update(bf30a2_device_t *dev, rt_uint32_t backlog)
+{
+    rt_uint8_t old = dev->gov.level;
+    rt_uint8_t level;
 
-    case STATE_DATA_SIZE_H:
-        dev->data_size = (rt_uint16_t)b << 8;
-        dev->state = STATE_DATA_SIZE_L;
-        break;
+    level = bf30a2_gov_account(&dev->gov, dev->core.wake_stamp, bf30a2_port_cycles(),
+                               backlog * 100 / dev->dma_size);
+    dev->core.level = bf30a2_core_level_cap(dev, level);
+    if (level != old)
+    {
+        LOG_I("Governor: level %d -> %d (cpu %u%%, ring %u%%, peak %u%%)", old, level,
+              dev->gov.cpu_pct, dev->gov.ring_pct, dev->gov.ring_peak_pct);
+    }
+}
+#endif
 
-    case STATE_DATA_SIZE_L:
-        dev->data_size |= b;
-        if (dev->data_size == BYTES_PER_LINE)
-        {
-            dev->data_pos = 0;
-            dev->state = STATE_PIXEL_DATA;
-        }
-        else
-        {
-            dev->errors++;
-            dev->state = STATE_FIND_SYNC;
-            dev->ff_count = 0;
-        }
-        break;
+/**
+ * @brief Ring offset the DMA writes next
+ */
+static rt_uint32_t bf30a2_dma_pos(bf30a2_device_t *dev)
+{
+    rt_uint32_t pos = 0;
 
-    case STATE_PIXEL_DATA:
-        dev->line_yuv[dev->data_pos++] = b;
-        if (dev->data_pos >= BYTES_PER_LINE)
+    if ((dev->hspi != RT_NULL) && (dev->hspi->hdmarx != RT_NULL))
+    {
+        pos = dev->dma_size - dev->hspi->hdmarx->Instance->CNDTR;
+        if (pos >= dev->dma_size)
         {
-            on_line_complete(dev);
-            dev->state = STATE_FIND_SYNC;
-            dev->ff_count = 0;
+            pos = 0;
         }
-        break;
-
-    default:
-        dev->state = STATE_FIND_SYNC;
-        dev->ff_count = 0;
-        break;
     }
-}
 
-/*============================================================================*/
-/*                     CAMERA THREAD                                          */
-/*============================================================================*/
+    return pos;
+}
 
 static void cam_thread_entry(void *arg)
 {
@@ -659,65 +545,88 @@ static void cam_thread_entry(void *arg)
     rt_uint32_t last_pos;
     rt_uint32_t dma_pos;
     rt_uint32_t remain;
-    rt_uint32_t now;
+    rt_int32_t timeout;
+    rt_err_t got;
+#ifdef BF30A2_USING_GOVERNOR
+    rt_uint32_t last_rx;
+    rt_uint32_t rx;
+    rt_uint32_t backlog;
+#endif
 
     LOG_I("Camera thread started");
 
     /* 关键修复：启动时同步到当前DMA位置，跳过可能的旧数据 */
-    last_pos = 0;
-    if ((dev->hspi != RT_NULL) && (dev->hspi->hdmarx != RT_NULL))
+#ifdef BF30A2_USING_GOVERNOR
+    do
     {
-        remain = dev->hspi->hdmarx->Instance->CNDTR;
-        last_pos = dev->dma_size - remain;
-        if (last_pos >= dev->dma_size)
-        {
-            last_pos = 0;
-        }
-    }
+        last_rx = dev->rx_count;
+        last_pos = bf30a2_dma_pos(dev);
+    } while (last_rx != dev->rx_count);
+#else
+    last_pos = bf30a2_dma_pos(dev);
+#endif
     LOG_D("Thread sync: last_pos=%d, dma_size=%d", last_pos, dev->dma_size);
 
     while (!dev->stop_flag)
     {
-        rt_event_recv(dev->event, 0x01,
-                     RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR, 50, &evt);
+        /*
+         * The tail of a frame shorter than half the ring raises no DMA
+         * interrupt until the next frame; with a small window that is most
+         * of a ring, so poll for it.
+         */
+        remain = bf30a2_core_frame_remaining(&dev->core);
+        timeout = ((remain != 0) && (remain < dev->dma_size / 2)) ? 1 : 50;
+
+        got = rt_event_recv(dev->event, 0x01,
+                           RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR, timeout, &evt);
 
         if (dev->stop_flag)
         {
             break;
         }
-
-        /* Calculate current DMA position */
-        dma_pos = 0;
-        if ((dev->hspi != RT_NULL) && (dev->hspi->hdmarx != RT_NULL))
+        dev->core.wake_stamp = bf30a2_port_cycles();
+
+        /*
+         * Calculate current DMA position. With the governor the interrupt
+         * count has to match it: a mark crossed between the two reads
+         * would otherwise count as a lap of the ring.
+         */
+#ifdef BF30A2_USING_GOVERNOR
+        do
         {
-            remain = dev->hspi->hdmarx->Instance->CNDTR;
-            dma_pos = dev->dma_size - remain;
-            if (dma_pos >= dev->dma_size)
-            {
-                dma_pos = 0;
-            }
-        }
+            rx = dev->rx_count;
+            dma_pos = bf30a2_dma_pos(dev);
+        } while (rx != dev->rx_count);
+#else
+        dma_pos = bf30a2_dma_pos(dev);
+#endif
+
+        BF30A2_TRACE(BF30A2_TRACE_DMA_WAKEUP, got == RT_EOK,
+                     (dma_pos + dev->dma_size - last_pos) % dev->dma_size);
+
+#ifdef BF30A2_USING_GOVERNOR
+        backlog = bf30a2_gov_backlog(dev->dma_size, last_pos, dma_pos, rx - last_rx);
+        last_rx = rx;
+#endif
 
         /* Process received bytes */
-        while (last_pos != dma_pos)
+#ifdef BF30A2_USING_RAW_CAPTURE
+        bf30a2_rawcap_append(&dev->rawcap, dev->dma_buf, dev->dma_size,
+                             last_pos, dma_pos, dev->rx_count);
+        if (dev->rawcap.active && dev->rawcap.no_decode)
         {
-            parse_byte(dev, dev->dma_buf[last_pos]);
-            last_pos++;
-            if (last_pos >= dev->dma_size)
-            {
-                last_pos = 0;
-            }
+            last_pos = dma_pos;
         }
-
-        /* Calculate FPS every second */
-        now = rt_tick_get_millisecond();
-        if ((now - dev->last_time) >= 1000)
+        else
+#endif
         {
-            dev->fps = (dev->complete_frames - dev->last_frames) * 1000.0f /
-                      (now - dev->last_time);
-            dev->last_time = now;
-            dev->last_frames = dev->complete_frames;
+            last_pos = bf30a2_core_feed_ring(&dev->core, dev->dma_buf, dev->dma_size,
+                                             last_pos, dma_pos);
         }
+
+#ifdef BF30A2_USING_GOVERNOR
+        bf30a2_gov_update(dev, backlog);
+#endif
     }
 
     LOG_I("Camera thread exited");
@@ -989,13 +898,14 @@ static rt_err_t bf30a2_spi_init(bf30a2_device_t *dev)
 
 static rt_err_t bf30a2_sensor_check_id(bf30a2_device_t *dev)
 {
+    const bf30a2_sensor_desc_t *sensor = dev->hw_cfg.sensor;
     rt_uint8_t id_h, id_l;
 
-    if (bf30a2_i2c_read_reg(dev, 0xFC, &id_h) != RT_EOK)
+    if (bf30a2_i2c_read_reg(dev, sensor->id_reg_h, &id_h) != RT_EOK)
     {
         return -RT_ERROR;
     }
-    if (bf30a2_i2c_read_reg(dev, 0xFD, &id_l) != RT_EOK)
+    if (bf30a2_i2c_read_reg(dev, sensor->id_reg_l, &id_l) != RT_EOK)
     {
         return -RT_ERROR;
     }
@@ -1003,97 +913,205 @@ static rt_err_t bf30a2_sensor_check_id(bf30a2_device_t *dev)
     dev->chip_id = ((rt_uint16_t)id_h << 8) | id_l;
     LOG_I("Chip ID: 0x%04X", dev->chip_id);
 
-    if (id_h != 0x3B || id_l != 0x02)
+    if (dev->chip_id != sensor->chip_id)
     {
-        LOG_E("Unexpected Chip ID");
+        LOG_E("Unexpected Chip ID, %s is 0x%04X", sensor->name, sensor->chip_id);
         return -RT_ERROR;
     }
 
     return RT_EOK;
 }
 
-static rt_err_t bf30a2_sensor_load_config(bf30a2_device_t *dev)
+/**
+ * @brief Write a BF30A2_REGLIST_TAIL terminated register list
+ */
+static rt_err_t bf30a2_sensor_write_regs(bf30a2_device_t *dev, const bf30a2_reg_t *regs)
 {
-    rt_uint8_t pda_val;
     int i;
 
-    for (i = 0; bf30a2_init_regs[i].reg != REGLIST_TAIL; i++)
+    for (i = 0; regs[i].reg != BF30A2_REGLIST_TAIL; i++)
     {
-        if (bf30a2_init_regs[i].reg == REG_DLY)
+        if (regs[i].reg == BF30A2_REG_DLY)
         {
-            rt_thread_mdelay(bf30a2_init_regs[i].val);
+            rt_thread_mdelay(regs[i].val);
         }
-        else
+        else if (bf30a2_i2c_write_reg(dev, (rt_uint8_t)regs[i].reg, regs[i].val) != RT_EOK)
         {
-            if (bf30a2_i2c_write_reg(dev, bf30a2_init_regs[i].reg,
-                                     bf30a2_init_regs[i].val) != RT_EOK)
-            {
-                return -RT_ERROR;
-            }
-            if (bf30a2_init_regs[i].reg == 0xF2)
-            {
-                rt_thread_mdelay(10);
-            }
+            return -RT_ERROR;
         }
     }
 
-    bf30a2_i2c_read_reg(dev, 0xCF, &pda_val);
-    if (pda_val & 0x01)
-    {
-        bf30a2_i2c_write_reg(dev, 0xCF, 0xB0);
-        rt_thread_mdelay(10);
-    }
-
     return RT_EOK;
 }
 
-/*============================================================================*/
-/*                     UART EXPORT                                            */
-/*============================================================================*/
+static rt_err_t bf30a2_io_read(void *ctx, rt_uint8_t reg, rt_uint8_t *val)
+{
+    return bf30a2_i2c_read_reg((bf30a2_device_t *)ctx, reg, val);
+}
 
-static void bf30a2_export_uart(bf30a2_device_t *dev)
+static rt_err_t bf30a2_io_write(void *ctx, rt_uint8_t reg, rt_uint8_t val)
 {
-    rt_uint32_t i;
-    rt_uint8_t *data;
+    return bf30a2_i2c_write_reg((bf30a2_device_t *)ctx, reg, val);
+}
+
+static rt_err_t bf30a2_sensor_load_config(bf30a2_device_t *dev)
+{
+    const bf30a2_sensor_desc_t *sensor = dev->hw_cfg.sensor;
+    bf30a2_sensor_io_t io;
 
-    if (!dev->frame_rgb565 || !dev->frame_ready)
+    if (bf30a2_sensor_write_regs(dev, sensor->init_regs) != RT_EOK)
     {
-        LOG_E("No frame data to export");
-        return;
+        return -RT_ERROR;
     }
 
-    data = dev->frame_rgb565;
+    if (sensor->post_init != RT_NULL)
+    {
+        io.ctx = dev;
+        io.read = bf30a2_io_read;
+        io.write = bf30a2_io_write;
+        return sensor->post_init(&io);
+    }
 
-    LOG_I("========================================");
-    LOG_I("Exporting frame via UART...");
-    LOG_I("Format: RGB565, Size: %dx%d", IMG_WIDTH, IMG_HEIGHT);
-    LOG_I("Total bytes: %d", ONE_FRAME_SIZE);
-    LOG_I("========================================");
+    return RT_EOK;
+}
 
-    rt_kprintf("\n===PHOTO_START===\n");
-    rt_kprintf("WIDTH:%d\n", IMG_WIDTH);
-    rt_kprintf("HEIGHT:%d\n", IMG_HEIGHT);
-    rt_kprintf("FORMAT:RGB565\n");
-    rt_kprintf("SIZE:%d\n", ONE_FRAME_SIZE);
-    rt_kprintf("SOURCE:BF30A2\n");
+/**
+ * @brief Window in sensor array terms, whole array for width 0
+ *
+ * @return -RT_EINVAL for a misaligned window, one off the array, an
+ *         output outside the geometry limits or a sensor without one
+ */
+static rt_err_t bf30a2_window_resolve(const bf30a2_sensor_desc_t *sensor,
+                                      const bf30a2_window_t *in, bf30a2_window_t *win,
+                                      rt_uint16_t *out_width, rt_uint16_t *out_height)
+{
+    rt_uint16_t align;
+
+    *win = *in;
+    if (win->subsample == 0)
+    {
+        win->subsample = 1;
+    }
+    if (win->width == 0)
+    {
+        win->x = 0;
+        win->y = 0;
+        win->width = sensor->array_width;
+        win->height = sensor->array_height;
+    }
+
+    align = sensor->win_unit * win->subsample;
+    if ((sensor->win_unit == 0) || (win->subsample > 2) ||
+        (win->x % align) || (win->y % align) || (win->width % align) || (win->height % align) ||
+        (win->x + win->width > sensor->array_width) ||
+        (win->y + win->height > sensor->array_height))
+    {
+        return -RT_EINVAL;
+    }
+
+    *out_width = win->width / win->subsample;
+    *out_height = win->height / win->subsample;
+    if ((*out_width < BF30A2_MIN_WIDTH) || (*out_width > IMG_WIDTH) ||
+        (*out_height < BF30A2_MIN_HEIGHT) || (*out_height > IMG_HEIGHT))
+    {
+        return -RT_EINVAL;
+    }
+
+    return RT_EOK;
+}
+
+/**
+ * @brief Program the window set in dev->window (sensor powered)
+ */
+static rt_err_t bf30a2_window_apply(bf30a2_device_t *dev)
+{
+    const bf30a2_sensor_desc_t *sensor = dev->hw_cfg.sensor;
+    bf30a2_reg_t regs[6];
+    bf30a2_window_t win;
+    rt_uint16_t w, h;
+
+    if (bf30a2_window_resolve(sensor, &dev->window, &win, &w, &h) != RT_EOK)
+    {
+        return -RT_EINVAL;
+    }
+
+    regs[0].reg = sensor->win_hstart;
+    regs[0].val = (rt_uint8_t)(win.x / sensor->win_unit);
+    regs[1].reg = sensor->win_hstop;
+    regs[1].val = (rt_uint8_t)((win.x + win.width) / sensor->win_unit);
+    regs[2].reg = sensor->win_vstart;
+    regs[2].val = (rt_uint8_t)(win.y / sensor->win_unit);
+    regs[3].reg = sensor->win_vstop;
+    regs[3].val = (rt_uint8_t)((win.y + win.height) / sensor->win_unit);
+    regs[4].reg = sensor->win_subsample;
+    regs[4].val = (win.subsample == 2) ? sensor->win_subsample_2 : 0x00;
+    regs[5].reg = BF30A2_REGLIST_TAIL;
+    regs[5].val = 0x00;
+
+    return bf30a2_sensor_write_regs(dev, regs);
+}
+
+/*============================================================================*/
+/*                     UART EXPORT                                            */
+/*============================================================================*/
+
+static void bf30a2_export_uart(bf30a2_device_t *dev)
+{
+    char line[BF30A2_EXPORT_HEX_PER_LINE * 2 + 1];
+    const char *format;
+    bf30a2_pool_slot_t *slot;
+    bf30a2_info_t geo;
+    rt_uint32_t i, n;
+    rt_uint8_t *data;
+
+    /* Leased so that capture can go on without overwriting the export */
+    slot = dev->core.frame_ready ? bf30a2_pool_lease(&dev->pool) : RT_NULL;
+    if (slot == RT_NULL)
+    {
+        LOG_E("No frame data to export");
+        return;
+    }
+
+    bf30a2_pool_convert(&dev->pool, slot, -1);
+    data = slot->data;
+    bf30a2_core_output_geometry(&dev->core.pipeline, slot->level, slot->width,
+                                slot->height, &geo);
+    format = (geo.format == BF30A2_FORMAT_Y8) ? "Y8" : "RGB565";
+
+    LOG_I("========================================");
+    LOG_I("Exporting frame via UART...");
+    LOG_I("Format: %s, Size: %dx%d", format, geo.width, geo.height);
+    LOG_I("Total bytes: %d", geo.frame_size);
+    LOG_I("========================================");
+
+    rt_kprintf("\n===PHOTO_START===\n");
+    rt_kprintf("WIDTH:%d\n", geo.width);
+    rt_kprintf("HEIGHT:%d\n", geo.height);
+    rt_kprintf("FORMAT:%s\n", format);
+    rt_kprintf("SIZE:%d\n", geo.frame_size);
+    rt_kprintf("SOURCE:BF30A2\n");
     rt_kprintf("===DATA_BEGIN===\n");
 
-    for (i = 0; i < ONE_FRAME_SIZE; i++)
+    /* One formatted line per call instead of one rt_kprintf() per byte */
+    for (i = 0; i < geo.frame_size; i += BF30A2_EXPORT_HEX_PER_LINE)
     {
-        rt_kprintf("%02X", data[i]);
-        if ((i + 1) % 32 == 0)
+        n = geo.frame_size - i;
+        if (n > BF30A2_EXPORT_HEX_PER_LINE)
         {
-            rt_kprintf("\n");
-            if ((i + 1) % 1024 == 0)
-            {
-                rt_thread_mdelay(5);
-            }
+            n = BF30A2_EXPORT_HEX_PER_LINE;
+        }
+        bf30a2_hex_encode(data + i, n, line);
+        rt_kprintf("%s\n", line);
+        if ((i + BF30A2_EXPORT_HEX_PER_LINE) % 1024 == 0)
+        {
+            rt_thread_mdelay(5);
         }
     }
 
     rt_kprintf("\n===DATA_END===\n");
     rt_kprintf("===PHOTO_END===\n\n");
 
+    bf30a2_pool_release(&dev->pool, data);
     LOG_I("Export completed!");
 }
 
@@ -1114,21 +1132,108 @@ static const struct rt_device_ops bf30a2_ops =
 #endif
 
 /**
- * @brief Device init operation
+ * @brief Apply a thumbnail configuration, resizing its plane (capture stopped)
  */
-static rt_err_t bf30a2_dev_init(rt_device_t dev)
+static rt_err_t bf30a2_thumb_config(bf30a2_device_t *cam, rt_uint8_t scale, rt_uint8_t format)
 {
-    bf30a2_device_t *cam = (bf30a2_device_t *)dev;
+    bf30a2_info_t geo;
+    rt_err_t ret;
 
-    if (cam->hw_initialized)
+    /* Frames leased with the old thumbnail must not see it freed */
+    ret = bf30a2_pool_free_plane(&cam->pool, BF30A2_PLANE_THUMB);
+    if (ret != RT_EOK)
+    {
+        return ret;
+    }
+
+    cam->core.thumb_scale = scale;
+    cam->core.thumb_format = format;
+    if ((scale == 0) || (BF30A2_FRAME_BUFFERS == 0))
     {
         return RT_EOK;
     }
 
-    LOG_I("BF30A2 device initializing...");
+    bf30a2_core_plane_geometry(&cam->core, BF30A2_PLANE_THUMB, IMG_WIDTH, IMG_HEIGHT, &geo);
+    ret = bf30a2_pool_alloc_plane(&cam->pool, BF30A2_PLANE_THUMB, geo.frame_size);
+    if (ret != RT_EOK)
+    {
+        LOG_E("Alloc thumbnails failed (%d x %d bytes)", BF30A2_FRAME_BUFFERS, geo.frame_size);
+        bf30a2_pool_free_plane(&cam->pool, BF30A2_PLANE_THUMB);
+        cam->core.thumb_scale = 0;
+    }
+
+    return ret;
+}
+
+#ifdef BF30A2_USING_TONE
+/**
+ * @brief Install a tone curve, taken up at the next frame start (lock held)
+ *
+ * The capture thread reads the bank it latched at the frame start for the
+ * whole frame, and with lazy conversion a published frame keeps reading
+ * its bank until its output is converted, so the curve is written into a
+ * bank neither uses. A curve still waiting for its frame is withdrawn
+ * first: its bank is then free too. Each install numbers the bank anew,
+ * so change detection sees a new curve even in a bank it saw before.
+ */
+static void bf30a2_tone_install(bf30a2_device_t *cam, const bf30a2_tone_cfg_t *cfg)
+{
+    const rt_uint8_t *map[4] = { cfg->y, cfg->r, cfg->g, cfg->b };
+    bf30a2_tone_t *bank = RT_NULL;
+    rt_uint8_t *lut;
+    rt_base_t level;
+    int i, v;
+
+    level = rt_hw_interrupt_disable();
+    cam->core.tone = cam->core.frame_tone;
+    for (i = 0; (i < BF30A2_TONE_BANKS) && (bank == RT_NULL); i++)
+    {
+        if (&cam->tone[i] == cam->core.frame_tone)
+        {
+            continue;
+        }
+#ifdef BF30A2_USING_LAZY_CONVERT
+        if (bf30a2_pool_tone_busy(&cam->pool, &cam->tone[i]))
+        {
+            continue;
+        }
+#endif
+        bank = &cam->tone[i];
+    }
+    rt_hw_interrupt_enable(level);
+
+    for (i = 0; i < 4; i++)
+    {
+        lut = (i == 0) ? bank->y : bank->rgb[i - 1];
+        if (map[i] != RT_NULL)
+        {
+            rt_memcpy(lut, map[i], 256);
+            continue;
+        }
+        for (v = 0; v < 256; v++)
+        {
+            lut[v] = (rt_uint8_t)v;
+        }
+    }
+    bank->has_rgb = (cfg->r != RT_NULL) || (cfg->g != RT_NULL) || (cfg->b != RT_NULL);
+    bank->generation = ++cam->tone_installs;
+
+    cam->core.tone = bank;
+}
+#endif
+
+#ifndef BF30A2_USING_STATIC_ALLOC
+/**
+ * @brief Take the DMA ring and frame buffers, if not held
+ */
+static rt_err_t bf30a2_buffers_get(bf30a2_device_t *cam)
+{
+    cam->buffers_deferred = 0;
+    if (cam->dma_buf != RT_NULL)
+    {
+        return RT_EOK;
+    }
 
-    /* Allocate DMA buffer */
-    cam->dma_size = DMA_BUFFER_SIZE;
     cam->dma_buf = rt_malloc_align(cam->dma_size, 32);
     if (cam->dma_buf == RT_NULL)
     {
@@ -1136,25 +1241,99 @@ static rt_err_t bf30a2_dev_init(rt_device_t dev)
         return -RT_ENOMEM;
     }
 
-    /* Allocate frame buffer */
-    cam->frame_rgb565 = rt_malloc(ONE_FRAME_SIZE);
-    if (cam->frame_rgb565 == RT_NULL)
+    /* With the planes subscribers and the thumbnail asked for */
+    if (bf30a2_pool_alloc(&cam->pool, ONE_FRAME_SIZE) != RT_EOK)
     {
-        LOG_E("Alloc frame buffer failed (%d bytes)", ONE_FRAME_SIZE);
+        LOG_E("Alloc frame buffers failed (%d x %d bytes)", BF30A2_FRAME_BUFFERS, ONE_FRAME_SIZE);
         rt_free_align(cam->dma_buf);
         cam->dma_buf = RT_NULL;
         return -RT_ENOMEM;
     }
 
+    return RT_EOK;
+}
+#endif /* BF30A2_USING_STATIC_ALLOC */
+
+/**
+ * @brief Give the DMA ring and frame buffers back (capture stopped)
+ *
+ * With a frame still leased they are kept until its release.
+ */
+static void bf30a2_buffers_put(bf30a2_device_t *cam)
+{
+#ifndef BF30A2_USING_STATIC_ALLOC
+    if (cam->dma_buf == RT_NULL)
+    {
+        return;
+    }
+    if (bf30a2_pool_busy(&cam->pool))
+    {
+        cam->buffers_deferred = 1;
+        return;
+    }
+
+    cam->core.frame_ready = 0;
+    bf30a2_pool_free(&cam->pool);
+    rt_free_align(cam->dma_buf);
+    cam->dma_buf = RT_NULL;
+    cam->buffers_deferred = 0;
+#endif
+}
+
+/**
+ * @brief Free buffers kept past STOP or close once their last lease is back
+ */
+static void bf30a2_buffers_settle(bf30a2_device_t *cam)
+{
+    if (!cam->buffers_deferred)
+    {
+        return;
+    }
+
+    rt_mutex_take(cam->lock, RT_WAITING_FOREVER);
+    if (cam->buffers_deferred && !cam->running)
+    {
+        bf30a2_buffers_put(cam);
+    }
+    rt_mutex_release(cam->lock);
+}
+
+/**
+ * @brief Device init operation
+ */
+static rt_err_t bf30a2_dev_init(rt_device_t dev)
+{
+    bf30a2_device_t *cam = (bf30a2_device_t *)dev;
+
+    if (cam->hw_initialized)
+    {
+        return RT_EOK;
+    }
+
+    LOG_I("BF30A2 device initializing...");
+
+    cam->dma_size = DMA_BUFFER_SIZE;
+#ifdef BF30A2_USING_STATIC_ALLOC
+    cam->dma_buf = g_bf30a2_dma_ring;
+    bf30a2_pool_place(&cam->pool, BF30A2_STATIC_FRAMES, ONE_FRAME_SIZE);
+    rt_event_init(&cam->event_obj, "bf30a2", RT_IPC_FLAG_FIFO);
+    cam->event = &cam->event_obj;
+    rt_mutex_init(&cam->lock_obj, "bf30a2", RT_IPC_FLAG_PRIO);
+    cam->lock = &cam->lock_obj;
+#else
+#ifdef BF30A2_BUFFERS_AT_INIT
+    if (bf30a2_buffers_get(cam) != RT_EOK)
+    {
+        return -RT_ENOMEM;
+    }
+#endif
+
     /* Create event object */
     cam->event = rt_event_create("bf30a2", RT_IPC_FLAG_FIFO);
     if (cam->event == RT_NULL)
     {
         LOG_E("Create event failed");
-        rt_free(cam->frame_rgb565);
-        rt_free_align(cam->dma_buf);
-        cam->frame_rgb565 = RT_NULL;
-        cam->dma_buf = RT_NULL;
+        bf30a2_buffers_put(cam);
         return -RT_ENOMEM;
     }
 
@@ -1164,17 +1343,46 @@ static rt_err_t bf30a2_dev_init(rt_device_t dev)
     {
         LOG_E("Create mutex failed");
         rt_event_delete(cam->event);
-        rt_free(cam->frame_rgb565);
-        rt_free_align(cam->dma_buf);
+        bf30a2_buffers_put(cam);
         cam->event = RT_NULL;
-        cam->frame_rgb565 = RT_NULL;
-        cam->dma_buf = RT_NULL;
         return -RT_ENOMEM;
     }
+#endif /* BF30A2_USING_STATIC_ALLOC */
+
+#ifdef BF30A2_USING_LAZY_CONVERT
+    /* Readers waiting for a conversion share the event, above the wakeup bit */
+    cam->pool.done = cam->event;
+#endif
+
+    /* Until the first frame header, report the largest geometry */
+    cam->core.pub_width = IMG_WIDTH;
+    cam->core.pub_height = IMG_HEIGHT;
+
+    /* A thumbnail set up before init gets its plane now */
+    if (cam->core.thumb_scale != 0)
+    {
+        bf30a2_thumb_config(cam, cam->core.thumb_scale, cam->core.thumb_format);
+    }
+
+    /* Cycle counter used for trace and capture timestamps */
+    bf30a2_port_cycles_init();
 
     LOG_I("BF30A2 init OK");
     LOG_I("  DMA buffer: %d bytes", cam->dma_size);
-    LOG_I("  Frame buffer: %d bytes", ONE_FRAME_SIZE);
+    LOG_I("  Frame buffers: %d x %d bytes", BF30A2_FRAME_BUFFERS, ONE_FRAME_SIZE);
+#if defined(BF30A2_BUFFERS_AT_OPEN)
+    LOG_I("  Buffers held from open to close");
+#elif defined(BF30A2_BUFFERS_AT_START)
+    LOG_I("  Buffers held from START to STOP");
+#endif
+#ifdef BF30A2_USING_LAZY_CONVERT
+    LOG_I("  Lazy conversion: raw frames %d x %d bytes", BF30A2_FRAME_BUFFERS, ONE_FRAME_SIZE);
+#endif
+#ifdef BF30A2_USING_STATIC_ALLOC
+    LOG_I("  Static: %d bytes, no heap",
+          (int)(sizeof(g_bf30a2_static_dev) + sizeof(g_bf30a2_stack) + DMA_BUFFER_SIZE +
+                sizeof(g_bf30a2_frames)));
+#endif
 
     cam->hw_initialized = 1;
 
@@ -1182,28 +1390,17 @@ static rt_err_t bf30a2_dev_init(rt_device_t dev)
 }
 
 /**
- * @brief Device open operation
+ * @brief Power the sensor, configure it and attach the SPI bus
  */
-static rt_err_t bf30a2_dev_open(rt_device_t dev, rt_uint16_t oflag)
+static rt_err_t bf30a2_hw_open(bf30a2_device_t *cam)
 {
-    bf30a2_device_t *cam = (bf30a2_device_t *)dev;
     rt_err_t ret;
 
-    if (cam->opened)
-    {
-        return RT_EOK;
-    }
-
-    rt_mutex_take(cam->lock, RT_WAITING_FOREVER);
-
-    LOG_I("Opening BF30A2 device...");
-
     /* Step 1: Initialize GPIO for PWDN pin */
     ret = bf30a2_gpio_init(cam);
     if (ret != RT_EOK)
     {
         LOG_E("GPIO init failed");
-        rt_mutex_release(cam->lock);
         return ret;
     }
 
@@ -1212,7 +1409,6 @@ static rt_err_t bf30a2_dev_open(rt_device_t dev, rt_uint16_t oflag)
     if (ret != RT_EOK)
     {
         LOG_E("PWM init failed");
-        rt_mutex_release(cam->lock);
         return ret;
     }
     rt_thread_mdelay(10);
@@ -1228,7 +1424,6 @@ static rt_err_t bf30a2_dev_open(rt_device_t dev, rt_uint16_t oflag)
     if (ret != RT_EOK)
     {
         LOG_E("I2C init failed");
-        rt_mutex_release(cam->lock);
         return ret;
     }
 
@@ -1237,7 +1432,6 @@ static rt_err_t bf30a2_dev_open(rt_device_t dev, rt_uint16_t oflag)
     if (ret != RT_EOK)
     {
         LOG_E("Sensor check ID failed");
-        rt_mutex_release(cam->lock);
         return ret;
     }
 
@@ -1246,9 +1440,13 @@ static rt_err_t bf30a2_dev_open(rt_device_t dev, rt_uint16_t oflag)
     if (ret != RT_EOK)
     {
         LOG_E("Sensor config failed");
-        rt_mutex_release(cam->lock);
         return ret;
     }
+    if (((cam->window.width != 0) || (cam->window.subsample > 1)) &&
+        (bf30a2_window_apply(cam) != RT_EOK))
+    {
+        LOG_E("Sensor window failed, whole array");
+    }
     rt_thread_mdelay(100);
 
     /* Step 7: Initialize SPI for data capture */
@@ -1256,6 +1454,45 @@ static rt_err_t bf30a2_dev_open(rt_device_t dev, rt_uint16_t oflag)
     if (ret != RT_EOK)
     {
         LOG_E("SPI init failed");
+        return ret;
+    }
+
+    return RT_EOK;
+}
+
+/**
+ * @brief Device open operation
+ */
+static rt_err_t bf30a2_dev_open(rt_device_t dev, rt_uint16_t oflag)
+{
+    bf30a2_device_t *cam = (bf30a2_device_t *)dev;
+    rt_err_t ret;
+
+    if (cam->opened)
+    {
+        return RT_EOK;
+    }
+
+    rt_mutex_take(cam->lock, RT_WAITING_FOREVER);
+
+    LOG_I("Opening BF30A2 device...");
+
+#ifdef BF30A2_BUFFERS_AT_OPEN
+    ret = bf30a2_buffers_get(cam);
+    if (ret != RT_EOK)
+    {
+        rt_mutex_release(cam->lock);
+        return ret;
+    }
+#endif
+
+    ret = bf30a2_hw_open(cam);
+    if (ret != RT_EOK)
+    {
+        /* Not opened, so close() will not give them back */
+#ifdef BF30A2_BUFFERS_AT_OPEN
+        bf30a2_buffers_put(cam);
+#endif
         rt_mutex_release(cam->lock);
         return ret;
     }
@@ -1292,6 +1529,12 @@ static rt_err_t bf30a2_dev_close(rt_device_t dev)
         cam->running = 0;
     }
 
+#ifdef BF30A2_USING_RAW_CAPTURE
+    bf30a2_rawcap_stop(&cam->rawcap);
+#endif
+#ifdef BF30A2_USING_VIEWFINDER
+    bf30a2_vf_stop(&cam->vf);
+#endif
     /* Release SPI resources */
     if (cam->spi_dev != RT_NULL)
     {
@@ -1301,6 +1544,10 @@ static rt_err_t bf30a2_dev_close(rt_device_t dev)
         cam->spi_dev = RT_NULL;
     }
 
+#ifndef BF30A2_BUFFERS_AT_INIT
+    bf30a2_buffers_put(cam);
+#endif
+
     cam->opened = 0;
     LOG_I("BF30A2 device closed");
 
@@ -1315,18 +1562,31 @@ static rt_err_t bf30a2_dev_close(rt_device_t dev)
 static rt_size_t bf30a2_dev_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
 {
     bf30a2_device_t *cam = (bf30a2_device_t *)dev;
+    bf30a2_pool_slot_t *slot;
     rt_size_t copy_size;
+    bf30a2_info_t geo;
 
-    if ((cam->frame_rgb565 == RT_NULL) || (!cam->frame_ready) || (buffer == RT_NULL))
+    if ((!cam->core.frame_ready) || (buffer == RT_NULL))
     {
         return 0;
     }
 
     rt_mutex_take(cam->lock, RT_WAITING_FOREVER);
 
-    copy_size = (size < ONE_FRAME_SIZE) ? size : ONE_FRAME_SIZE;
-    rt_memcpy(buffer, cam->frame_rgb565, copy_size);
-    cam->frame_ready = 0;
+    slot = bf30a2_pool_lease(&cam->pool);
+    if (slot == RT_NULL)
+    {
+        rt_mutex_release(cam->lock);
+        return 0;
+    }
+    bf30a2_pool_convert(&cam->pool, slot, -1);
+    bf30a2_core_output_geometry(&cam->core.pipeline, slot->level, slot->width,
+                                slot->height, &geo);
+    copy_size = (size < geo.frame_size) ? size : geo.frame_size;
+    rt_memcpy(buffer, slot->data, copy_size);
+    bf30a2_pool_release(&cam->pool, slot->data);
+    cam->core.frame_ready = 0;
+    BF30A2_LAT_RECORD(&cam->lat[BF30A2_LAT_READ], cam->core.pub_stamp, bf30a2_port_cycles());
 
     rt_mutex_release(cam->lock);
 
@@ -1362,24 +1622,47 @@ static rt_err_t bf30a2_dev_control(rt_device_t dev, int cmd, void *args)
 
         rt_mutex_take(cam->lock, RT_WAITING_FOREVER);
 
+#ifdef BF30A2_USING_VIEWFINDER
+        /* Lines go to the panel strips instead of a frame buffer */
+        if (cam->vf.lcd != RT_NULL)
+        {
+            cam->core.on_acquire = RT_NULL;
+            cam->core.on_line_dst = bf30a2_vf_dst_hook;
+            cam->core.on_line = bf30a2_vf_line_hook;
+            bf30a2_vf_reset(&cam->vf);
+        }
+        else
+        {
+            cam->core.on_acquire = bf30a2_acquire_hook;
+            cam->core.on_line_dst = RT_NULL;
+            cam->core.on_line = RT_NULL;
+        }
+#endif
+
+#ifdef BF30A2_BUFFERS_AT_START
+        ret = bf30a2_buffers_get(cam);
+        if (ret != RT_EOK)
+        {
+            rt_mutex_release(cam->lock);
+            return ret;
+        }
+#endif
+
         /* Initialize buffers and state */
         rt_memset(cam->dma_buf, 0xAA, cam->dma_size);
-        reset_parse(cam);
+        bf30a2_core_reset(&cam->core);
+        bf30a2_pool_reset(&cam->pool);
 
         /* Reset statistics */
-        cam->frame_count = 0;
-        cam->complete_frames = 0;
-        cam->frame_start_count = 0;
-        cam->frame_end_count = 0;
-        cam->line_count = 0;
-        cam->errors = 0;
+        bf30a2_core_reset_stats(&cam->core);
+        cam->pool.conversions = 0;
         cam->rx_count = 0;
         cam->total_bytes = 0;
-        cam->last_time = rt_tick_get_millisecond();
-        cam->last_frames = 0;
-        cam->fps = 0;
+#ifdef BF30A2_USING_GOVERNOR
+        bf30a2_gov_restart(&cam->gov);
+#endif
         cam->stop_flag = 0;
-        cam->frame_ready = 0;  /* 确保frame_ready在启动时被重置 */
+        cam->core.frame_ready = 0;  /* 确保frame_ready在启动时被重置 */
         cam->running = 1;
 
         /* Start DMA reception */
@@ -1396,8 +1679,18 @@ static rt_err_t bf30a2_dev_control(rt_device_t dev, int cmd, void *args)
         rt_thread_mdelay(10);
 
         /* Create camera processing thread */
+#ifdef BF30A2_USING_STATIC_ALLOC
+        cam->thread = RT_NULL;
+        if (rt_thread_init(&cam->thread_obj, "bf30a2", cam_thread_entry, cam,
+                           g_bf30a2_stack, sizeof(g_bf30a2_stack),
+                           RT_THREAD_PRIORITY_HIGH, 10) == RT_EOK)
+        {
+            cam->thread = &cam->thread_obj;
+        }
+#else
         cam->thread = rt_thread_create("bf30a2", cam_thread_entry, cam,
-                                       2048, RT_THREAD_PRIORITY_HIGH, 10);
+                                       BF30A2_THREAD_STACK_SIZE, RT_THREAD_PRIORITY_HIGH, 10);
+#endif
         if (cam->thread != RT_NULL)
         {
             rt_thread_startup(cam->thread);
@@ -1411,6 +1704,7 @@ static rt_err_t bf30a2_dev_control(rt_device_t dev, int cmd, void *args)
             return -RT_ENOMEM;
         }
 
+        BF30A2_TRACE(BF30A2_TRACE_CAPTURE_START, 0, 0);
         LOG_I("Capture started");
         rt_mutex_release(cam->lock);
         break;
@@ -1435,12 +1729,21 @@ static rt_err_t bf30a2_dev_control(rt_device_t dev, int cmd, void *args)
         /* 停止DMA */
         camera_stop_dma(cam->hspi);
         cam->running = 0;
+        BF30A2_TRACE(BF30A2_TRACE_CAPTURE_STOP, 0, 0);
         
         /* 清理线程句柄 */
         cam->thread = RT_NULL;
 
+#ifdef BF30A2_BUFFERS_AT_START
+        bf30a2_buffers_put(cam);
+#endif
+
+#ifdef BF30A2_USING_RAW_CAPTURE
+        bf30a2_rawcap_stop(&cam->rawcap);
+#endif
+
         LOG_I("Stopped: %d complete frames, %d errors",
-              cam->complete_frames, cam->errors);
+              cam->core.complete_frames, cam->core.errors);
         rt_mutex_release(cam->lock);
         break;
     }
@@ -1450,10 +1753,8 @@ static rt_err_t bf30a2_dev_control(rt_device_t dev, int cmd, void *args)
         bf30a2_info_t *info = (bf30a2_info_t *)args;
         if (info != RT_NULL)
         {
-            info->width = IMG_WIDTH;
-            info->height = IMG_HEIGHT;
-            info->frame_size = ONE_FRAME_SIZE;
-            info->format = BF30A2_FORMAT_RGB565;
+            bf30a2_core_output_geometry(&cam->core.pipeline, cam->core.pub_level,
+                                        cam->core.pub_width, cam->core.pub_height, info);
             info->chip_id = cam->chip_id;
         }
         break;
@@ -1465,11 +1766,20 @@ static rt_err_t bf30a2_dev_control(rt_device_t dev, int cmd, void *args)
         if (status != RT_NULL)
         {
             status->state = cam->running ? BF30A2_STATUS_RUNNING : BF30A2_STATUS_IDLE;
-            status->frame_count = cam->frame_count;
-            status->complete_frames = cam->complete_frames;
-            status->error_count = cam->errors;
-            status->fps = cam->fps;
-            status->frame_ready = cam->frame_ready;
+            status->frame_count = cam->core.frame_count;
+            status->complete_frames = cam->core.complete_frames;
+            status->error_count = cam->core.errors;
+            status->frame_ready = cam->core.frame_ready;
+            bf30a2_core_get_intervals(&cam->core, status);
+            status->bp_dropped = cam->core.bp_dropped;
+            status->geometry_changes = cam->core.geometry_changes;
+            status->buffer_bytes = bf30a2_pool_bytes(&cam->pool) +
+                                   ((cam->dma_buf != RT_NULL) ? cam->dma_size : 0);
+#ifdef BF30A2_USING_LAZY_CONVERT
+            status->converted_frames = cam->pool.conversions;
+#else
+            status->converted_frames = cam->core.complete_frames;
+#endif
         }
         break;
     }
@@ -1477,9 +1787,12 @@ static rt_err_t bf30a2_dev_control(rt_device_t dev, int cmd, void *args)
     case BF30A2_CMD_GET_FPS:
     {
         float *fps = (float *)args;
+        bf30a2_status_info_t status;
+
         if (fps != RT_NULL)
         {
-            *fps = cam->fps;
+            bf30a2_core_get_intervals(&cam->core, &status);
+            *fps = status.fps;
         }
         break;
     }
@@ -1489,7 +1802,7 @@ static rt_err_t bf30a2_dev_control(rt_device_t dev, int cmd, void *args)
         rt_uint32_t *count = (rt_uint32_t *)args;
         if (count != RT_NULL)
         {
-            *count = cam->complete_frames;
+            *count = cam->core.complete_frames;
         }
         break;
     }
@@ -1512,10 +1825,8 @@ static rt_err_t bf30a2_dev_control(rt_device_t dev, int cmd, void *args)
         bf30a2_buffer_t *buf = (bf30a2_buffer_t *)args;
         if (buf != RT_NULL)
         {
-            buf->data = cam->frame_rgb565;
-            buf->size = ONE_FRAME_SIZE;
-            buf->frame_num = cam->frame_count;
-            buf->timestamp = rt_tick_get();
+            bf30a2_fill_latest(cam, buf);
+            bf30a2_buffers_settle(cam);
         }
         break;
     }
@@ -1526,7 +1837,7 @@ static rt_err_t bf30a2_dev_control(rt_device_t dev, int cmd, void *args)
         rt_uint32_t timeout = (cfg != RT_NULL) ? cfg->timeout_ms : 1000;
         rt_uint32_t start = rt_tick_get_millisecond();
 
-        while (!cam->frame_ready)
+        while (!cam->core.frame_ready)
         {
             rt_thread_mdelay(10);
             if ((rt_tick_get_millisecond() - start) > timeout)
@@ -1534,236 +1845,1403 @@ static rt_err_t bf30a2_dev_control(rt_device_t dev, int cmd, void *args)
                 return -RT_ETIMEOUT;
             }
         }
+        BF30A2_LAT_RECORD(&cam->lat[BF30A2_LAT_WAIT], cam->core.pub_stamp, bf30a2_port_cycles());
 
         if (cfg != RT_NULL && cfg->buffer != RT_NULL)
         {
-            cfg->buffer->data = cam->frame_rgb565;
-            cfg->buffer->size = ONE_FRAME_SIZE;
-            cfg->buffer->frame_num = cam->frame_count;
-            cfg->buffer->timestamp = rt_tick_get();
+            bf30a2_fill_latest(cam, cfg->buffer);
+            bf30a2_buffers_settle(cam);
         }
         break;
     }
 
-    case BF30A2_CMD_EXPORT_UART:
+    case BF30A2_CMD_LEASE_FRAME:
     {
-        bf30a2_export_uart(cam);
-        break;
-    }
+        bf30a2_wait_cfg_t *cfg = (bf30a2_wait_cfg_t *)args;
+        bf30a2_pool_slot_t *slot;
+        rt_uint32_t start = rt_tick_get_millisecond();
+
+        if ((cfg == RT_NULL) || (cfg->buffer == RT_NULL))
+        {
+            return -RT_EINVAL;
+        }
+
+        slot = RT_NULL;
+        while (!cam->core.frame_ready || ((slot = bf30a2_pool_lease(&cam->pool)) == RT_NULL))
+        {
+            /* A zero timeout polls, e.g. from a GUI timer */
+            if ((rt_tick_get_millisecond() - start) >= cfg->timeout_ms)
+            {
+                return -RT_ETIMEOUT;
+            }
+            rt_thread_mdelay(10);
+        }
+        cam->core.frame_ready = 0;
+        BF30A2_LAT_RECORD(&cam->lat[BF30A2_LAT_LEASE], slot->stamp, bf30a2_port_cycles());
+        bf30a2_fill_buffer(cam, slot, cfg->buffer);
+        break;
+    }
+
+    case BF30A2_CMD_RELEASE_FRAME:
+    {
+        bf30a2_buffer_t *buf = (bf30a2_buffer_t *)args;
+
+        if (buf == RT_NULL)
+        {
+            return -RT_EINVAL;
+        }
+        ret = bf30a2_pool_release(&cam->pool, buf->data);
+        bf30a2_buffers_settle(cam);
+        break;
+    }
+
+    case BF30A2_CMD_SET_VIEWFINDER:
+    {
+#ifdef BF30A2_USING_VIEWFINDER
+        bf30a2_vf_cfg_t *cfg = (bf30a2_vf_cfg_t *)args;
+
+        if (cfg == RT_NULL)
+        {
+            return -RT_EINVAL;
+        }
+        if (cam->running)
+        {
+            return -RT_EBUSY;
+        }
+        bf30a2_vf_stop(&cam->vf);
+        if (cfg->lcd_name != RT_NULL)
+        {
+            ret = bf30a2_vf_start(&cam->vf, cfg->lcd_name, cfg->x, cfg->y);
+        }
+#else
+        ret = -RT_ENOSYS;
+#endif
+        break;
+    }
+
+    case BF30A2_CMD_GET_VIEWFINDER:
+    {
+#ifdef BF30A2_USING_VIEWFINDER
+        bf30a2_vf_status_t *st = (bf30a2_vf_status_t *)args;
+
+        if (st == RT_NULL)
+        {
+            return -RT_EINVAL;
+        }
+        bf30a2_vf_get_status(&cam->vf, st);
+#else
+        ret = -RT_ENOSYS;
+#endif
+        break;
+    }
+
+    case BF30A2_CMD_SUBSCRIBE:
+    {
+#ifdef BF30A2_USING_SUBSCRIBE
+        bf30a2_sub_cfg_t *cfg = (bf30a2_sub_cfg_t *)args;
+        int handle;
+
+        if (cfg == RT_NULL)
+        {
+            return -RT_EINVAL;
+        }
+        rt_mutex_take(cam->lock, RT_WAITING_FOREVER);
+        handle = bf30a2_sub_add(&cam->subs, &cam->pool, &cam->core, cfg);
+        rt_mutex_release(cam->lock);
+        if (handle < 0)
+        {
+            return handle;
+        }
+        cfg->handle = handle;
+#else
+        ret = -RT_ENOSYS;
+#endif
+        break;
+    }
+
+    case BF30A2_CMD_UNSUBSCRIBE:
+    {
+#ifdef BF30A2_USING_SUBSCRIBE
+        if (args == RT_NULL)
+        {
+            return -RT_EINVAL;
+        }
+        ret = bf30a2_sub_remove(&cam->subs, &cam->pool, *(int *)args);
+        bf30a2_buffers_settle(cam);
+#else
+        ret = -RT_ENOSYS;
+#endif
+        break;
+    }
+
+    case BF30A2_CMD_SUB_RECEIVE:
+    {
+#ifdef BF30A2_USING_SUBSCRIBE
+        bf30a2_sub_wait_t *wait = (bf30a2_sub_wait_t *)args;
+        rt_uint32_t start = rt_tick_get_millisecond();
+
+        if ((wait == RT_NULL) || (wait->buffer == RT_NULL))
+        {
+            return -RT_EINVAL;
+        }
+        while ((ret = bf30a2_sub_take(&cam->subs, &cam->pool, wait->handle,
+                                       wait->buffer)) == -RT_EEMPTY)
+        {
+            if ((rt_tick_get_millisecond() - start) >= wait->timeout_ms)
+            {
+                return -RT_ETIMEOUT;
+            }
+            rt_thread_mdelay(10);
+        }
+#else
+        ret = -RT_ENOSYS;
+#endif
+        break;
+    }
+
+    case BF30A2_CMD_GET_SUBSCRIBER:
+    {
+#ifdef BF30A2_USING_SUBSCRIBE
+        if (args == RT_NULL)
+        {
+            return -RT_EINVAL;
+        }
+        ret = bf30a2_sub_get_status(&cam->subs, (bf30a2_sub_status_t *)args);
+#else
+        ret = -RT_ENOSYS;
+#endif
+        break;
+    }
+
+    case BF30A2_CMD_SET_THUMBNAIL:
+    {
+        bf30a2_thumb_cfg_t *cfg = (bf30a2_thumb_cfg_t *)args;
+
+        if ((cfg == RT_NULL) ||
+            ((cfg->scale != 0) && (cfg->scale != 2) && (cfg->scale != 4) && (cfg->scale != 8)) ||
+            ((cfg->format != BF30A2_FORMAT_RGB565) && (cfg->format != BF30A2_FORMAT_Y8)))
+        {
+            return -RT_EINVAL;
+        }
+        if (cam->running)
+        {
+            return -RT_EBUSY;
+        }
+
+        rt_mutex_take(cam->lock, RT_WAITING_FOREVER);
+        ret = bf30a2_thumb_config(cam, cfg->scale, cfg->format);
+        rt_mutex_release(cam->lock);
+        break;
+    }
+
+    case BF30A2_CMD_SET_WINDOW:
+    {
+        const bf30a2_sensor_desc_t *sensor = cam->hw_cfg.sensor;
+        bf30a2_window_t *win = (bf30a2_window_t *)args;
+        bf30a2_window_t resolved;
+        rt_uint16_t w, h;
+
+        if ((win == RT_NULL) || (bf30a2_window_resolve(sensor, win, &resolved, &w, &h) != RT_EOK))
+        {
+            return -RT_EINVAL;
+        }
+
+        /* Powered down the sensor keeps nothing: written again at open */
+        rt_mutex_take(cam->lock, RT_WAITING_FOREVER);
+        cam->window = *win;
+        if (cam->opened)
+        {
+            ret = bf30a2_window_apply(cam);
+        }
+        rt_mutex_release(cam->lock);
+
+        if (ret == RT_EOK)
+        {
+            LOG_I("Window %dx%d at %d,%d /%d: %dx%d, %d bytes per frame (saves %d)",
+                  resolved.width, resolved.height, resolved.x, resolved.y, resolved.subsample,
+                  w, h, FRAME_STREAM_SIZE(w, h),
+                  FRAME_STREAM_SIZE(sensor->array_width, sensor->array_height) -
+                  FRAME_STREAM_SIZE(w, h));
+        }
+        break;
+    }
+
+    case BF30A2_CMD_GET_WINDOW:
+    {
+        const bf30a2_sensor_desc_t *sensor = cam->hw_cfg.sensor;
+        bf30a2_window_status_t *st = (bf30a2_window_status_t *)args;
+
+        if (st == RT_NULL)
+        {
+            return -RT_EINVAL;
+        }
+        rt_memset(st, 0, sizeof(*st));
+        bf30a2_window_resolve(sensor, &cam->window, &st->window, &st->out_width, &st->out_height);
+        /* Before the first frame header, expect the window */
+        st->width = (cam->core.line_bytes != 0) ? cam->core.width : st->out_width;
+        st->height = (cam->core.line_bytes != 0) ? cam->core.height : st->out_height;
+        st->frame_bytes = FRAME_STREAM_SIZE(st->width, st->height);
+        st->saved_bytes = FRAME_STREAM_SIZE(sensor->array_width, sensor->array_height) -
+                          st->frame_bytes;
+        break;
+    }
+
+    case BF30A2_CMD_SET_PIPELINE:
+    {
+        bf30a2_pipeline_t *cfg = (bf30a2_pipeline_t *)args;
+
+        if ((cfg == RT_NULL) || (cfg->rotate > BF30A2_ROTATE_270) ||
+            ((cfg->crop_x | cfg->crop_y | cfg->crop_width | cfg->crop_height) & 1) ||
+            (cfg->crop_x + cfg->crop_width > IMG_WIDTH) ||
+            (cfg->crop_y + cfg->crop_height > IMG_HEIGHT))
+        {
+            return -RT_EINVAL;
+        }
+        if (cam->running)
+        {
+            return -RT_EBUSY;
+        }
+
+        /* Frames converted with the old pipeline must not be described with the new one */
+        rt_mutex_take(cam->lock, RT_WAITING_FOREVER);
+        if (bf30a2_pool_busy(&cam->pool))
+        {
+            ret = -RT_EBUSY;
+        }
+        else
+        {
+            cam->core.pipeline = *cfg;
+            bf30a2_pool_reset(&cam->pool);
+            cam->core.frame_ready = 0;
+            rt_memset(&cam->frame_stats, 0, sizeof(cam->frame_stats));
+        }
+        rt_mutex_release(cam->lock);
+        break;
+    }
+
+    case BF30A2_CMD_GET_FRAME_STATS:
+    {
+        bf30a2_frame_stats_t *st = (bf30a2_frame_stats_t *)args;
+        rt_base_t level;
+
+        if (st == RT_NULL)
+        {
+            return -RT_EINVAL;
+        }
+        if (!cam->core.pipeline.stats)
+        {
+            return -RT_EEMPTY;
+        }
+        level = rt_hw_interrupt_disable();
+        *st = cam->frame_stats;
+        rt_hw_interrupt_enable(level);
+        break;
+    }
+
+    case BF30A2_CMD_SET_TONE:
+    {
+#ifdef BF30A2_USING_TONE
+        bf30a2_tone_cfg_t *cfg = (bf30a2_tone_cfg_t *)args;
+
+        /* Taken while running: the frame being assembled keeps its curve */
+        rt_mutex_take(cam->lock, RT_WAITING_FOREVER);
+        if ((cfg == RT_NULL) ||
+            ((cfg->y == RT_NULL) && (cfg->r == RT_NULL) && (cfg->g == RT_NULL) &&
+             (cfg->b == RT_NULL)))
+        {
+            cam->core.tone = RT_NULL;
+        }
+        else
+        {
+            bf30a2_tone_install(cam, cfg);
+        }
+        rt_mutex_release(cam->lock);
+#else
+        ret = -RT_ENOSYS;
+#endif
+        break;
+    }
+
+    case BF30A2_CMD_SET_CHANGE:
+    {
+        bf30a2_change_cfg_t *cfg = (bf30a2_change_cfg_t *)args;
+        rt_base_t level;
+
+        if ((cfg == RT_NULL) || (cfg->mode > BF30A2_CHANGE_SUPPRESS))
+        {
+            return -RT_EINVAL;
+        }
+
+        /* Taken at the next frame start; the next frame compared is a change */
+        level = rt_hw_interrupt_disable();
+        cam->core.change.cfg = *cfg;
+        cam->core.change.ref_valid = 0;
+        rt_hw_interrupt_enable(level);
+        break;
+    }
+
+    case BF30A2_CMD_GET_CHANGE:
+    {
+        bf30a2_change_info_t *info = (bf30a2_change_info_t *)args;
+        rt_base_t level;
+
+        if (info == RT_NULL)
+        {
+            return -RT_EINVAL;
+        }
+        level = rt_hw_interrupt_disable();
+        *info = cam->core.change.info;
+        rt_hw_interrupt_enable(level);
+        break;
+    }
+
+    case BF30A2_CMD_GET_THUMBNAIL:
+    {
+        bf30a2_thumb_t *req = (bf30a2_thumb_t *)args;
+        bf30a2_pool_slot_t *slot;
+        bf30a2_info_t geo;
+
+        if ((req == RT_NULL) || (req->frame == RT_NULL) || (req->thumb == RT_NULL))
+        {
+            return -RT_EINVAL;
+        }
+        slot = bf30a2_pool_leased(&cam->pool, req->frame->data);
+        if (slot == RT_NULL)
+        {
+            return -RT_EINVAL;
+        }
+        if (!(slot->planes & (1U << BF30A2_PLANE_THUMB)))
+        {
+            return -RT_EEMPTY;
+        }
+
+        *req->thumb = *req->frame;
+        bf30a2_core_plane_geometry(&cam->core, BF30A2_PLANE_THUMB, slot->width, slot->height,
+                                   &geo);
+        req->thumb->data = slot->plane[BF30A2_PLANE_THUMB];
+        req->thumb->size = geo.frame_size;
+        req->thumb->width = geo.width;
+        req->thumb->height = geo.height;
+        req->thumb->format = geo.format;
+        break;
+    }
+
+    case BF30A2_CMD_EXPORT_UART:
+    {
+        bf30a2_export_uart(cam);
+        break;
+    }
+
+    case BF30A2_CMD_GET_TRACE:
+    {
+#ifdef BF30A2_USING_TRACE
+        bf30a2_trace_dump_t *dump = (bf30a2_trace_dump_t *)args;
+        if ((dump == RT_NULL) || (dump->events == RT_NULL))
+        {
+            return -RT_EINVAL;
+        }
+        bf30a2_trace_snapshot(dump);
+#else
+        ret = -RT_ENOSYS;
+#endif
+        break;
+    }
+
+    case BF30A2_CMD_EXPORT_TRACE:
+    {
+#ifdef BF30A2_USING_TRACE
+        bf30a2_trace_export_uart();
+#else
+        ret = -RT_ENOSYS;
+#endif
+        break;
+    }
+
+#ifdef BF30A2_USING_RAW_CAPTURE
+    case BF30A2_CMD_RAWCAP_START:
+    {
+        bf30a2_rawcap_cfg_t *cfg = (bf30a2_rawcap_cfg_t *)args;
+        if (cfg == RT_NULL)
+        {
+            return -RT_EINVAL;
+        }
+        ret = bf30a2_rawcap_start(&cam->rawcap, cfg, cam->dma_size);
+        break;
+    }
+
+    case BF30A2_CMD_RAWCAP_STOP:
+    {
+        bf30a2_rawcap_stop(&cam->rawcap);
+        break;
+    }
+
+    case BF30A2_CMD_RAWCAP_GET_STATUS:
+    {
+        bf30a2_rawcap_status_t *status = (bf30a2_rawcap_status_t *)args;
+        if (status != RT_NULL)
+        {
+            bf30a2_rawcap_get_status(&cam->rawcap, status);
+        }
+        break;
+    }
+
+    case BF30A2_CMD_RAWCAP_EXPORT_UART:
+    {
+        ret = bf30a2_rawcap_export_uart(&cam->rawcap);
+        break;
+    }
+
+    case BF30A2_CMD_RAWCAP_SAVE:
+    {
+        ret = bf30a2_rawcap_save(&cam->rawcap, (const char *)args);
+        break;
+    }
+
+    case BF30A2_CMD_RAWCAP_RELEASE:
+    {
+        if (cam->rawcap.active)
+        {
+            return -RT_EBUSY;
+        }
+        bf30a2_rawcap_release(&cam->rawcap);
+        break;
+    }
+#endif
+
+    case BF30A2_CMD_GET_LATENCY:
+    {
+#ifdef BF30A2_USING_LATENCY
+        bf30a2_latency_t *lat = (bf30a2_latency_t *)args;
+        int i;
+
+        if (lat == RT_NULL)
+        {
+            return -RT_EINVAL;
+        }
+        for (i = 0; i < BF30A2_LAT_POINTS; i++)
+        {
+            bf30a2_lat_summary(&cam->lat[i], &lat->point[i]);
+        }
+#else
+        ret = -RT_ENOSYS;
+#endif
+        break;
+    }
+
+    case BF30A2_CMD_RESET_LATENCY:
+    {
+#ifdef BF30A2_USING_LATENCY
+        int i;
+
+        for (i = 0; i < BF30A2_LAT_POINTS; i++)
+        {
+            bf30a2_lat_reset(&cam->lat[i]);
+        }
+#else
+        ret = -RT_ENOSYS;
+#endif
+        break;
+    }
+
+    case BF30A2_CMD_GET_GOVERNOR:
+    {
+#ifdef BF30A2_USING_GOVERNOR
+        bf30a2_gov_status_t *st = (bf30a2_gov_status_t *)args;
+
+        if (st == RT_NULL)
+        {
+            return -RT_EINVAL;
+        }
+        st->cfg = cam->gov.cfg;
+        st->level = (bf30a2_level_t)cam->gov.level;
+        st->cpu_pct = cam->gov.cpu_pct;
+        st->ring_pct = cam->gov.ring_pct;
+        st->ring_peak_pct = cam->gov.ring_peak_pct;
+        st->step_downs = cam->gov.step_downs;
+        st->step_ups = cam->gov.step_ups;
+        st->skipped_frames = cam->core.skipped_frames;
+#else
+        ret = -RT_ENOSYS;
+#endif
+        break;
+    }
+
+    case BF30A2_CMD_SET_GOVERNOR:
+    {
+#ifdef BF30A2_USING_GOVERNOR
+        bf30a2_gov_cfg_t *cfg = (bf30a2_gov_cfg_t *)args;
+
+        if (cfg == RT_NULL)
+        {
+            return -RT_EINVAL;
+        }
+        rt_mutex_take(cam->lock, RT_WAITING_FOREVER);
+        ret = bf30a2_gov_configure(&cam->gov, cfg);
+        if (ret == RT_EOK)
+        {
+            cam->core.level = bf30a2_core_level_cap(cam, cam->gov.level);
+        }
+        rt_mutex_release(cam->lock);
+#else
+        ret = -RT_ENOSYS;
+#endif
+        break;
+    }
 
     case BF30A2_CMD_RESET_STATS:
     {
-        rt_mutex_take(cam->lock, RT_WAITING_FOREVER);
-        cam->frame_count = 0;
-        cam->complete_frames = 0;
-        cam->errors = 0;
-        cam->line_count = 0;
-        cam->last_time = rt_tick_get_millisecond();
-        cam->last_frames = 0;
-        cam->fps = 0;
-        rt_mutex_release(cam->lock);
-        break;
+        rt_mutex_take(cam->lock, RT_WAITING_FOREVER);
+        bf30a2_core_reset_stats(&cam->core);
+        cam->pool.conversions = 0;
+        rt_mutex_release(cam->lock);
+        break;
+    }
+
+    default:
+        ret = -RT_EINVAL;
+        break;
+    }
+
+    return ret;
+}
+
+/*============================================================================*/
+/*                     PUBLIC API                                             */
+/*============================================================================*/
+
+void bf30a2_get_default_config(bf30a2_hw_cfg_t *cfg)
+{
+    if (cfg == RT_NULL)
+    {
+        return;
+    }
+
+    cfg->spi_bus_name = BF30A2_SPI_BUS;
+    cfg->i2c_bus_name = BF30A2_I2C_BUS;
+    cfg->pwm_dev_name = BF30A2_PWM_DEV;
+    cfg->i2c_addr = BF30A2_I2C_ADDR;
+    cfg->pwm_channel = BF30A2_PWM_CHANNEL;
+
+    cfg->pins.spi_clk_pad = BF30A2_SPI_CLK_PAD;
+    cfg->pins.spi_dio_pad = BF30A2_SPI_DIO_PAD;
+    cfg->pins.spi_cs_pad = BF30A2_SPI_CS_PAD;
+    cfg->pins.i2c_scl_pad = BF30A2_I2C_SCL_PAD;
+    cfg->pins.i2c_sda_pad = BF30A2_I2C_SDA_PAD;
+    cfg->pins.pwdn_pin = BF30A2_PWDN_PIN;
+    cfg->pins.pwm_pad = BF30A2_PWM_PAD;
+    cfg->sensor = &bf30a2_sensor_bf30a2;
+}
+
+rt_err_t bf30a2_device_register_with_config(const char *name, const bf30a2_hw_cfg_t *hw_cfg)
+{
+    bf30a2_device_t *dev;
+    rt_err_t ret;
+
+#ifdef BF30A2_USING_STATIC_ALLOC
+    /* One camera: its storage is the driver's */
+    if (g_bf30a2_dev != RT_NULL)
+    {
+        LOG_E("Static allocation supports one device");
+        return -RT_EFULL;
+    }
+    dev = &g_bf30a2_static_dev;
+#else
+    dev = rt_malloc(sizeof(bf30a2_device_t));
+    if (dev == RT_NULL)
+    {
+        LOG_E("Failed to allocate device structure");
+        return -RT_ENOMEM;
     }
+#endif
 
-    default:
-        ret = -RT_EINVAL;
-        break;
+    rt_memset(dev, 0, sizeof(bf30a2_device_t));
+
+    /* Copy hardware configuration */
+    if (hw_cfg != RT_NULL)
+    {
+        rt_memcpy(&dev->hw_cfg, hw_cfg, sizeof(bf30a2_hw_cfg_t));
+    }
+    else
+    {
+        bf30a2_get_default_config(&dev->hw_cfg);
+    }
+    if (dev->hw_cfg.sensor == RT_NULL)
+    {
+        dev->hw_cfg.sensor = &bf30a2_sensor_bf30a2;
+    }
+    if (dev->hw_cfg.i2c_addr == 0)
+    {
+        dev->hw_cfg.i2c_addr = dev->hw_cfg.sensor->i2c_addr;
     }
 
-    return ret;
+    /* Initialize device structure */
+    dev->parent.type = RT_Device_Class_Miscellaneous;
+
+#ifdef RT_USING_DEVICE_OPS
+    dev->parent.ops = &bf30a2_ops;
+#else
+    dev->parent.init    = bf30a2_dev_init;
+    dev->parent.open    = bf30a2_dev_open;
+    dev->parent.close   = bf30a2_dev_close;
+    dev->parent.read    = bf30a2_dev_read;
+    dev->parent.write   = RT_NULL;
+    dev->parent.control = bf30a2_dev_control;
+#endif
+
+    dev->parent.user_data = dev;
+#ifdef BF30A2_USING_RAW_CAPTURE
+    bf30a2_rawcap_init(&dev->rawcap);
+#endif
+#ifdef BF30A2_USING_GOVERNOR
+    bf30a2_gov_init(&dev->gov);
+#endif
+#ifdef BF30A2_USING_SUBSCRIBE
+    bf30a2_sub_init(&dev->subs);
+#endif
+#if defined(BF30A2_USING_VIEWFINDER) && defined(BF30A2_USING_LATENCY)
+    dev->vf.lat = &dev->lat[BF30A2_LAT_PANEL];
+#endif
+    dev->core.proto = &dev->hw_cfg.sensor->proto;
+#ifdef BF30A2_USING_LAZY_CONVERT
+    dev->core.keep_raw = 1;
+    dev->pool.core = &dev->core;
+#endif
+    dev->core.on_frame = bf30a2_frame_hook;
+    dev->core.on_acquire = bf30a2_acquire_hook;
+    dev->core.hook_ctx = dev;
+
+    /* Register device */
+    ret = rt_device_register(&dev->parent, name,
+                            RT_DEVICE_FLAG_RDONLY | RT_DEVICE_FLAG_STANDALONE);
+    if (ret != RT_EOK)
+    {
+        LOG_E("Failed to register device");
+#ifndef BF30A2_USING_STATIC_ALLOC
+        rt_free(dev);
+#endif
+        return ret;
+    }
+
+    /* Save global pointer for DMA callback */
+    g_bf30a2_dev = dev;
+
+    LOG_I("BF30A2 device '%s' registered, sensor %s", name, dev->hw_cfg.sensor->name);
+
+    return RT_EOK;
+}
+
+rt_err_t bf30a2_device_register(void)
+{
+    return bf30a2_device_register_with_config(BF30A2_DEVICE_NAME, RT_NULL);
 }
 
 /*============================================================================*/
-/*                     PUBLIC API                                             */
+/*                     SHELL COMMANDS                                         */
 /*============================================================================*/
 
-void bf30a2_get_default_config(bf30a2_hw_cfg_t *cfg)
+static void cmd_bf30a2_init(int argc, char **argv)
 {
-    if (cfg == RT_NULL)
+    rt_device_t dev = rt_device_find(BF30A2_DEVICE_NAME);
+    if (dev == RT_NULL)
+    {
+        bf30a2_device_register();
+        dev = rt_device_find(BF30A2_DEVICE_NAME);
+    }
+    if (dev != RT_NULL)
+    {
+        rt_device_init(dev);
+    }
+}
+MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_init, bf30a2_init, Init BF30A2 camera device);
+
+static void cmd_bf30a2_open(int argc, char **argv)
+{
+    rt_device_t dev = rt_device_find(BF30A2_DEVICE_NAME);
+    if (dev != RT_NULL)
+    {
+        rt_device_open(dev, RT_DEVICE_FLAG_RDONLY);
+    }
+    else
+    {
+        rt_kprintf("Device not found, run bf30a2_init first\n");
+    }
+}
+MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_open, bf30a2_open, Open BF30A2 camera device);
+
+static void cmd_bf30a2_start(int argc, char **argv)
+{
+    rt_device_t dev = rt_device_find(BF30A2_DEVICE_NAME);
+    if (dev != RT_NULL)
+    {
+        rt_device_control(dev, BF30A2_CMD_START, RT_NULL);
+    }
+    else
+    {
+        rt_kprintf("Device not found\n");
+    }
+}
+MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_start, bf30a2_start, Start capture);
+
+static void cmd_bf30a2_stop(int argc, char **argv)
+{
+    rt_device_t dev = rt_device_find(BF30A2_DEVICE_NAME);
+    if (dev != RT_NULL)
+    {
+        rt_device_control(dev, BF30A2_CMD_STOP, RT_NULL);
+    }
+    else
+    {
+        rt_kprintf("Device not found\n");
+    }
+}
+MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_stop, bf30a2_stop, Stop capture);
+
+static void cmd_bf30a2_status(int argc, char **argv)
+{
+    rt_device_t dev = rt_device_find(BF30A2_DEVICE_NAME);
+    if (dev != RT_NULL)
+    {
+        bf30a2_status_info_t status;
+        bf30a2_info_t info;
+
+        rt_device_control(dev, BF30A2_CMD_GET_INFO, &info);
+        rt_device_control(dev, BF30A2_CMD_GET_STATUS, &status);
+
+        rt_kprintf("=== BF30A2 Status ===\n");
+        rt_kprintf("Chip ID: 0x%04X\n", info.chip_id);
+        rt_kprintf("Resolution: %dx%d %s\n", info.width, info.height,
+                   info.format == BF30A2_FORMAT_Y8 ? "Y8" : "RGB565");
+        rt_kprintf("State: %s\n", status.state == BF30A2_STATUS_RUNNING ? "Running" : "Idle");
+        rt_kprintf("Frames: %d complete\n", status.complete_frames);
+        rt_kprintf("Errors: %d\n", status.error_count);
+        rt_kprintf("FPS: %u.%03u\n", status.fps_milli / 1000, status.fps_milli % 1000);
+        rt_kprintf("Interval: last %u avg %u min %u max %u stddev %u us\n",
+                   status.interval_us, status.interval_avg_us, status.interval_min_us,
+                   status.interval_max_us, status.interval_stddev_us);
+        rt_kprintf("Late intervals: %u, sequence gaps: %u\n",
+                   status.late_intervals, status.seq_gaps);
+        rt_kprintf("Dropped (no free buffer): %u\n", status.bp_dropped);
+        rt_kprintf("Geometry changes: %u\n", status.geometry_changes);
+        rt_kprintf("Buffers held: %u bytes\n", status.buffer_bytes);
+        rt_kprintf("Converted: %u of %u frames\n", status.converted_frames,
+                   status.complete_frames);
+        rt_kprintf("Frame ready: %d\n", status.frame_ready);
+        rt_kprintf("=====================\n");
+    }
+    else
+    {
+        rt_kprintf("Device not found\n");
+    }
+}
+MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_status, bf30a2_status, Show camera status);
+
+static void cmd_bf30a2_export(int argc, char **argv)
+{
+    rt_device_t dev = rt_device_find(BF30A2_DEVICE_NAME);
+    if (dev != RT_NULL)
+    {
+        rt_device_control(dev, BF30A2_CMD_EXPORT_UART, RT_NULL);
+    }
+    else
+    {
+        rt_kprintf("Device not found\n");
+    }
+}
+MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_export, bf30a2_export, Export frame via UART);
+
+#ifdef BF30A2_USING_TRACE
+static void cmd_bf30a2_trace(int argc, char **argv)
+{
+    if ((argc > 1) && (strcmp(argv[1], "clear") == 0))
+    {
+        bf30a2_trace_clear();
+        rt_kprintf("Trace cleared\n");
+        return;
+    }
+
+    bf30a2_trace_export_uart();
+}
+MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_trace, bf30a2_trace, Dump event trace [clear]);
+#endif
+
+#ifdef BF30A2_USING_RAW_CAPTURE
+static void cmd_bf30a2_rawcap(int argc, char **argv)
+{
+    rt_device_t dev = rt_device_find(BF30A2_DEVICE_NAME);
+    rt_err_t ret = RT_EOK;
+
+    if (dev == RT_NULL)
+    {
+        rt_kprintf("Device not found\n");
+        return;
+    }
+
+    if ((argc >= 3) && (strcmp(argv[1], "start") == 0))
+    {
+        bf30a2_rawcap_cfg_t cfg = {0};
+
+        /* A number selects a memory sink of that size, anything else a file path */
+        if ((argv[2][0] >= '0') && (argv[2][0] <= '9'))
+        {
+            cfg.sink = BF30A2_RAWCAP_SINK_MEMORY;
+            cfg.size = strtoul(argv[2], RT_NULL, 0);
+        }
+        else
+        {
+            cfg.sink = BF30A2_RAWCAP_SINK_FILE;
+            cfg.path = argv[2];
+        }
+        cfg.no_decode = (argc >= 4) && (strcmp(argv[3], "raw") == 0);
+        ret = rt_device_control(dev, BF30A2_CMD_RAWCAP_START, &cfg);
+    }
+    else if ((argc >= 2) && (strcmp(argv[1], "stop") == 0))
+    {
+        ret = rt_device_control(dev, BF30A2_CMD_RAWCAP_STOP, RT_NULL);
+    }
+    else if ((argc >= 2) && (strcmp(argv[1], "export") == 0))
+    {
+        ret = rt_device_control(dev, BF30A2_CMD_RAWCAP_EXPORT_UART, RT_NULL);
+    }
+    else if ((argc >= 3) && (strcmp(argv[1], "save") == 0))
+    {
+        ret = rt_device_control(dev, BF30A2_CMD_RAWCAP_SAVE, argv[2]);
+    }
+    else if ((argc >= 2) && (strcmp(argv[1], "release") == 0))
+    {
+        ret = rt_device_control(dev, BF30A2_CMD_RAWCAP_RELEASE, RT_NULL);
+    }
+    else if ((argc >= 2) && (strcmp(argv[1], "status") == 0))
+    {
+        bf30a2_rawcap_status_t st;
+
+        rt_device_control(dev, BF30A2_CMD_RAWCAP_GET_STATUS, &st);
+        rt_kprintf("=== BF30A2 Raw Capture ===\n");
+        rt_kprintf("Active: %d (%s)\n", st.active,
+                   st.sink == BF30A2_RAWCAP_SINK_MEMORY ? "memory" : "file");
+        rt_kprintf("Records: %u\n", st.records);
+        rt_kprintf("Stream bytes: %u\n", st.bytes);
+        rt_kprintf("Capture size: %u\n", st.used);
+        rt_kprintf("Dropped bytes: %u\n", st.dropped);
+        rt_kprintf("==========================\n");
+    }
+    else
+    {
+        rt_kprintf("Usage: bf30a2_rawcap start <bytes|path> [raw]\n");
+        rt_kprintf("       bf30a2_rawcap stop|status|export|release\n");
+        rt_kprintf("       bf30a2_rawcap save <path>\n");
+        return;
+    }
+
+    if (ret != RT_EOK)
+    {
+        rt_kprintf("Failed: %d\n", ret);
+    }
+}
+MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_rawcap, bf30a2_rawcap, Raw SPI stream capture);
+#endif
+
+#ifdef BF30A2_USING_LATENCY
+static void cmd_bf30a2_latency(int argc, char **argv)
+{
+    static const char *const names[BF30A2_LAT_POINTS] =
+    {
+        "assembled", "callback", "wait", "read", "lease", "panel"
+    };
+    rt_device_t dev = rt_device_find(BF30A2_DEVICE_NAME);
+    bf30a2_latency_t lat;
+    int i;
+
+    if (dev == RT_NULL)
+    {
+        rt_kprintf("Device not found\n");
+        return;
+    }
+
+    if ((argc >= 2) && (strcmp(argv[1], "reset") == 0))
+    {
+        rt_device_control(dev, BF30A2_CMD_RESET_LATENCY, RT_NULL);
+        return;
+    }
+
+    rt_device_control(dev, BF30A2_CMD_GET_LATENCY, &lat);
+    rt_kprintf("=== BF30A2 Latency (us from header wakeup) ===\n");
+    rt_kprintf("%-10s %8s %8s %8s %8s %8s %8s\n", "point", "count", "min", "p50", "p90", "p99", "max");
+    for (i = 0; i < BF30A2_LAT_POINTS; i++)
+    {
+        rt_kprintf("%-10s %8u %8u %8u %8u %8u %8u\n", names[i],
+                   lat.point[i].count, lat.point[i].min_us, lat.point[i].p50_us,
+                   lat.point[i].p90_us, lat.point[i].p99_us, lat.point[i].max_us);
+    }
+}
+MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_latency, bf30a2_latency, Frame latency percentiles [reset]);
+#endif
+
+#ifdef BF30A2_USING_GOVERNOR
+static void cmd_bf30a2_gov(int argc, char **argv)
+{
+    static const char *const names[BF30A2_LEVELS] =
+    {
+        "full", "skip", "half", "y8"
+    };
+    rt_device_t dev = rt_device_find(BF30A2_DEVICE_NAME);
+    bf30a2_gov_status_t st;
+    rt_err_t ret = RT_EOK;
+
+    if (dev == RT_NULL)
+    {
+        rt_kprintf("Device not found\n");
+        return;
+    }
+
+    rt_device_control(dev, BF30A2_CMD_GET_GOVERNOR, &st);
+
+    if ((argc >= 2) && (strcmp(argv[1], "auto") == 0))
+    {
+        st.cfg.enable = 1;
+        ret = rt_device_control(dev, BF30A2_CMD_SET_GOVERNOR, &st.cfg);
+    }
+    else if ((argc >= 3) && (strcmp(argv[1], "fix") == 0))
+    {
+        st.cfg.enable = 0;
+        st.cfg.level = (rt_uint8_t)strtoul(argv[2], RT_NULL, 0);
+        ret = rt_device_control(dev, BF30A2_CMD_SET_GOVERNOR, &st.cfg);
+    }
+    else if ((argc >= 4) && (strcmp(argv[1], "budget") == 0))
+    {
+        st.cfg.cpu_budget = (rt_uint8_t)strtoul(argv[2], RT_NULL, 0);
+        st.cfg.ring_budget = (rt_uint8_t)strtoul(argv[3], RT_NULL, 0);
+        ret = rt_device_control(dev, BF30A2_CMD_SET_GOVERNOR, &st.cfg);
+    }
+    else if ((argc >= 3) && (strcmp(argv[1], "max") == 0))
+    {
+        st.cfg.max_level = (rt_uint8_t)strtoul(argv[2], RT_NULL, 0);
+        ret = rt_device_control(dev, BF30A2_CMD_SET_GOVERNOR, &st.cfg);
+    }
+    else if (argc >= 2)
     {
+        rt_kprintf("Usage: bf30a2_gov [auto | fix <level> | max <level> | budget <cpu%%> <ring%%>]\n");
+        return;
+    }
+    else
+    {
+        rt_kprintf("=== BF30A2 Governor ===\n");
+        rt_kprintf("Mode: %s, level %d (%s), max %d\n", st.cfg.enable ? "auto" : "fixed",
+                   st.level, names[st.level], st.cfg.max_level);
+        rt_kprintf("Budget: cpu %u%%, ring %u%%, window %u ms\n",
+                   st.cfg.cpu_budget, st.cfg.ring_budget, st.cfg.window_ms);
+        rt_kprintf("Last window: cpu %u%%, ring %u%% (peak %u%%)\n",
+                   st.cpu_pct, st.ring_pct, st.ring_peak_pct);
+        rt_kprintf("Steps: %u down, %u up, %u frames skipped\n",
+                   st.step_downs, st.step_ups, st.skipped_frames);
+        rt_kprintf("=======================\n");
         return;
     }
 
-    cfg->spi_bus_name = BF30A2_SPI_BUS;
-    cfg->i2c_bus_name = BF30A2_I2C_BUS;
-    cfg->pwm_dev_name = BF30A2_PWM_DEV;
-    cfg->i2c_addr = BF30A2_I2C_ADDR;
-    cfg->pwm_channel = BF30A2_PWM_CHANNEL;
-
-    cfg->pins.spi_clk_pad = BF30A2_SPI_CLK_PAD;
-    cfg->pins.spi_dio_pad = BF30A2_SPI_DIO_PAD;
-    cfg->pins.spi_cs_pad = BF30A2_SPI_CS_PAD;
-    cfg->pins.i2c_scl_pad = BF30A2_I2C_SCL_PAD;
-    cfg->pins.i2c_sda_pad = BF30A2_I2C_SDA_PAD;
-    cfg->pins.pwdn_pin = BF30A2_PWDN_PIN;
-    cfg->pins.pwm_pad = BF30A2_PWM_PAD;
+    if (ret != RT_EOK)
+    {
+        rt_kprintf("Failed: %d\n", (int)ret);
+    }
 }
+MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_gov, bf30a2_gov, Load governor [auto|fix|max|budget]);
+#endif
 
-rt_err_t bf30a2_device_register_with_config(const char *name, const bf30a2_hw_cfg_t *hw_cfg)
+#ifdef BF30A2_USING_VIEWFINDER
+static void cmd_bf30a2_vf(int argc, char **argv)
 {
-    bf30a2_device_t *dev;
+    rt_device_t dev = rt_device_find(BF30A2_DEVICE_NAME);
+    bf30a2_status_info_t status;
+    bf30a2_vf_status_t st;
+    bf30a2_vf_cfg_t cfg;
     rt_err_t ret;
 
-    dev = rt_malloc(sizeof(bf30a2_device_t));
     if (dev == RT_NULL)
     {
-        LOG_E("Failed to allocate device structure");
-        return -RT_ENOMEM;
+        rt_kprintf("Device not found\n");
+        return;
     }
 
-    rt_memset(dev, 0, sizeof(bf30a2_device_t));
-
-    /* Copy hardware configuration */
-    if (hw_cfg != RT_NULL)
+    if ((argc >= 3) && (strcmp(argv[1], "on") == 0))
     {
-        rt_memcpy(&dev->hw_cfg, hw_cfg, sizeof(bf30a2_hw_cfg_t));
+        cfg.lcd_name = argv[2];
+        cfg.x = (argc >= 5) ? (rt_uint16_t)strtoul(argv[3], RT_NULL, 0) : 0;
+        cfg.y = (argc >= 5) ? (rt_uint16_t)strtoul(argv[4], RT_NULL, 0) : 0;
+    }
+    else if ((argc >= 2) && (strcmp(argv[1], "off") == 0))
+    {
+        cfg.lcd_name = RT_NULL;
+    }
+    else if (argc >= 2)
+    {
+        rt_kprintf("Usage: bf30a2_vf [on <lcd> [x y] | off]\n");
+        return;
     }
     else
     {
-        bf30a2_get_default_config(&dev->hw_cfg);
+        rt_device_control(dev, BF30A2_CMD_GET_VIEWFINDER, &st);
+        rt_kprintf("=== BF30A2 Viewfinder ===\n");
+        rt_kprintf("Enabled: %d\n", st.enabled);
+        rt_kprintf("Panel frames: %u, %u.%03u fps\n",
+                   st.frames, st.fps_milli / 1000, st.fps_milli % 1000);
+        rt_kprintf("Frame to panel: %u us (max %u us)\n", st.latency_us, st.latency_max_us);
+        rt_kprintf("Strips: %u, stalls %u, timeouts %u\n", st.strips, st.stalls, st.timeouts);
+        rt_kprintf("=========================\n");
+        return;
     }
 
-    /* Initialize device structure */
-    dev->parent.type = RT_Device_Class_Miscellaneous;
+    /* The panel can only be switched while stopped: restart around it */
+    rt_device_control(dev, BF30A2_CMD_GET_STATUS, &status);
+    if (status.state == BF30A2_STATUS_RUNNING)
+    {
+        bf30a2_stop(dev);
+    }
+    ret = rt_device_control(dev, BF30A2_CMD_SET_VIEWFINDER, &cfg);
+    if (status.state == BF30A2_STATUS_RUNNING)
+    {
+        bf30a2_start(dev);
+    }
 
-#ifdef RT_USING_DEVICE_OPS
-    dev->parent.ops = &bf30a2_ops;
-#else
-    dev->parent.init    = bf30a2_dev_init;
-    dev->parent.open    = bf30a2_dev_open;
-    dev->parent.close   = bf30a2_dev_close;
-    dev->parent.read    = bf30a2_dev_read;
-    dev->parent.write   = RT_NULL;
-    dev->parent.control = bf30a2_dev_control;
+    if (ret != RT_EOK)
+    {
+        rt_kprintf("Failed: %d\n", (int)ret);
+    }
+}
+MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_vf, bf30a2_vf, LCD viewfinder [on <lcd> [x y]|off]);
 #endif
 
-    dev->parent.user_data = dev;
+static void cmd_bf30a2_thumb(int argc, char **argv)
+{
+    rt_device_t dev = rt_device_find(BF30A2_DEVICE_NAME);
+    bf30a2_status_info_t status;
+    bf30a2_thumb_cfg_t cfg;
+    rt_err_t ret;
 
-    /* Register device */
-    ret = rt_device_register(&dev->parent, name,
-                            RT_DEVICE_FLAG_RDONLY | RT_DEVICE_FLAG_STANDALONE);
-    if (ret != RT_EOK)
+    if (dev == RT_NULL)
     {
-        LOG_E("Failed to register device");
-        rt_free(dev);
-        return ret;
+        rt_kprintf("Device not found\n");
+        return;
+    }
+    if (argc < 2)
+    {
+        rt_kprintf("Usage: bf30a2_thumb <off | 2|4|8 [y8|rgb565]>\n");
+        return;
     }
 
-    /* Save global pointer for DMA callback */
-    g_bf30a2_dev = dev;
-
-    LOG_I("BF30A2 device '%s' registered", name);
+    cfg.scale = (strcmp(argv[1], "off") == 0) ? 0 : (rt_uint8_t)strtoul(argv[1], RT_NULL, 0);
+    cfg.format = ((argc >= 3) && (strcmp(argv[2], "y8") == 0)) ?
+                 BF30A2_FORMAT_Y8 : BF30A2_FORMAT_RGB565;
 
-    return RT_EOK;
-}
+    /* Only while stopped: restart around it */
+    rt_device_control(dev, BF30A2_CMD_GET_STATUS, &status);
+    if (status.state == BF30A2_STATUS_RUNNING)
+    {
+        bf30a2_stop(dev);
+    }
+    ret = rt_device_control(dev, BF30A2_CMD_SET_THUMBNAIL, &cfg);
+    if (status.state == BF30A2_STATUS_RUNNING)
+    {
+        bf30a2_start(dev);
+    }
 
-rt_err_t bf30a2_device_register(void)
-{
-    return bf30a2_device_register_with_config(BF30A2_DEVICE_NAME, RT_NULL);
+    if (ret != RT_EOK)
+    {
+        rt_kprintf("Failed: %d\n", (int)ret);
+    }
+    else if (cfg.scale != 0)
+    {
+        rt_kprintf("Thumbnail 1/%d %s with every frame (%dx%d at %dx%d)\n", cfg.scale,
+                   (cfg.format == BF30A2_FORMAT_Y8) ? "Y8" : "RGB565",
+                   IMG_WIDTH / cfg.scale, IMG_HEIGHT / cfg.scale, IMG_WIDTH, IMG_HEIGHT);
+    }
 }
+MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_thumb, bf30a2_thumb, Thumbnail with every frame [off|2|4|8 [y8]]);
 
-/*============================================================================*/
-/*                     SHELL COMMANDS                                         */
-/*============================================================================*/
-
-static void cmd_bf30a2_init(int argc, char **argv)
+static void cmd_bf30a2_window(int argc, char **argv)
 {
     rt_device_t dev = rt_device_find(BF30A2_DEVICE_NAME);
+    bf30a2_window_status_t st;
+    bf30a2_window_t win;
+    rt_err_t ret;
+
     if (dev == RT_NULL)
     {
-        bf30a2_device_register();
-        dev = rt_device_find(BF30A2_DEVICE_NAME);
+        rt_kprintf("Device not found\n");
+        return;
     }
-    if (dev != RT_NULL)
+
+    rt_memset(&win, 0, sizeof(win));
+    if (argc == 2)
     {
-        rt_device_init(dev);
+        /* "off" is the whole array, "half" the whole array subsampled */
+        win.subsample = (strcmp(argv[1], "half") == 0) ? 2 : 1;
+        if ((win.subsample == 1) && (strcmp(argv[1], "off") != 0))
+        {
+            rt_kprintf("Usage: bf30a2_window [off | half | <x> <y> <w> <h> [2]]\n");
+            return;
+        }
+    }
+    else if (argc >= 5)
+    {
+        win.x = (rt_uint16_t)strtoul(argv[1], RT_NULL, 0);
+        win.y = (rt_uint16_t)strtoul(argv[2], RT_NULL, 0);
+        win.width = (rt_uint16_t)strtoul(argv[3], RT_NULL, 0);
+        win.height = (rt_uint16_t)strtoul(argv[4], RT_NULL, 0);
+        win.subsample = (argc >= 6) ? (rt_uint8_t)strtoul(argv[5], RT_NULL, 0) : 1;
+    }
+    else if (argc != 1)
+    {
+        rt_kprintf("Usage: bf30a2_window [off | half | <x> <y> <w> <h> [2]]\n");
+        return;
+    }
+
+    if (argc > 1)
+    {
+        ret = rt_device_control(dev, BF30A2_CMD_SET_WINDOW, &win);
+        if (ret != RT_EOK)
+        {
+            rt_kprintf("Failed: %d\n", (int)ret);
+            return;
+        }
     }
+
+    rt_device_control(dev, BF30A2_CMD_GET_WINDOW, &st);
+    rt_kprintf("Window: %dx%d at %d,%d /%d -> %dx%d\n", st.window.width, st.window.height,
+               st.window.x, st.window.y, st.window.subsample, st.out_width, st.out_height);
+    rt_kprintf("Stream: %dx%d, %u bytes per frame, %u saved\n", st.width, st.height,
+               st.frame_bytes, st.saved_bytes);
 }
-MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_init, bf30a2_init, Init BF30A2 camera device);
+MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_window, bf30a2_window, Sensor output window [off|half|x y w h [2]]);
 
-static void cmd_bf30a2_open(int argc, char **argv)
+static void cmd_bf30a2_pipe(int argc, char **argv)
 {
     rt_device_t dev = rt_device_find(BF30A2_DEVICE_NAME);
-    if (dev != RT_NULL)
+    bf30a2_status_info_t status;
+    bf30a2_frame_stats_t st;
+    bf30a2_pipeline_t cfg;
+    rt_err_t ret = RT_EOK;
+    int i;
+
+    if (dev == RT_NULL)
     {
-        rt_device_open(dev, RT_DEVICE_FLAG_RDONLY);
+        rt_kprintf("Device not found\n");
+        return;
     }
-    else
+
+    rt_memset(&cfg, 0, sizeof(cfg));
+    for (i = 1; i < argc; i++)
     {
-        rt_kprintf("Device not found, run bf30a2_init first\n");
+        if ((strcmp(argv[i], "crop") == 0) && (i + 4 < argc))
+        {
+            cfg.crop_x = (rt_uint16_t)strtoul(argv[i + 1], RT_NULL, 0);
+            cfg.crop_y = (rt_uint16_t)strtoul(argv[i + 2], RT_NULL, 0);
+            cfg.crop_width = (rt_uint16_t)strtoul(argv[i + 3], RT_NULL, 0);
+            cfg.crop_height = (rt_uint16_t)strtoul(argv[i + 4], RT_NULL, 0);
+            i += 4;
+        }
+        else if ((strcmp(argv[i], "rot") == 0) && (i + 1 < argc))
+        {
+            cfg.rotate = (rt_uint8_t)(strtoul(argv[++i], RT_NULL, 0) / 90);
+        }
+        else if (strcmp(argv[i], "mirror") == 0)
+        {
+            cfg.mirror = 1;
+        }
+        else if (strcmp(argv[i], "stats") == 0)
+        {
+            cfg.stats = 1;
+        }
+        else if (strcmp(argv[i], "off") != 0)
+        {
+            rt_kprintf("Usage: bf30a2_pipe [off | [crop <x> <y> <w> <h>] [rot <90|180|270>] "
+                       "[mirror] [stats]]\n");
+            return;
+        }
     }
-}
-MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_open, bf30a2_open, Open BF30A2 camera device);
 
-static void cmd_bf30a2_start(int argc, char **argv)
-{
-    rt_device_t dev = rt_device_find(BF30A2_DEVICE_NAME);
-    if (dev != RT_NULL)
+    if (argc > 1)
     {
-        rt_device_control(dev, BF30A2_CMD_START, RT_NULL);
+        /* Only while stopped: restart around it */
+        rt_device_control(dev, BF30A2_CMD_GET_STATUS, &status);
+        if (status.state == BF30A2_STATUS_RUNNING)
+        {
+            bf30a2_stop(dev);
+        }
+        ret = rt_device_control(dev, BF30A2_CMD_SET_PIPELINE, &cfg);
+        if (status.state == BF30A2_STATUS_RUNNING)
+        {
+            bf30a2_start(dev);
+        }
+        if (ret != RT_EOK)
+        {
+            rt_kprintf("Failed: %d\n", (int)ret);
+        }
+        return;
     }
-    else
+
+    if (rt_device_control(dev, BF30A2_CMD_GET_FRAME_STATS, &st) != RT_EOK)
     {
-        rt_kprintf("Device not found\n");
+        rt_kprintf("Statistics off\n");
+        return;
+    }
+    rt_kprintf("Frame %u: %u samples, mean %u, min %u, max %u\n", st.frame_num, st.pixels,
+               (st.pixels != 0) ? st.luma_sum / st.pixels : 0, st.luma_min, st.luma_max);
+    for (i = 0; i < BF30A2_STATS_BINS; i++)
+    {
+        rt_kprintf("  %3d-%3d: %u\n", i * 16, i * 16 + 15, st.hist[i]);
     }
 }
-MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_start, bf30a2_start, Start capture);
+MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_pipe, bf30a2_pipe, Frame output pipeline [off|crop x y w h|rot n|mirror|stats]);
 
-static void cmd_bf30a2_stop(int argc, char **argv)
+#ifdef BF30A2_USING_TONE
+static void cmd_bf30a2_tone(int argc, char **argv)
 {
     rt_device_t dev = rt_device_find(BF30A2_DEVICE_NAME);
-    if (dev != RT_NULL)
+    bf30a2_tone_cfg_t cfg = { RT_NULL, RT_NULL, RT_NULL, RT_NULL };
+    rt_uint8_t lut[256];
+    rt_err_t ret;
+
+    if (dev == RT_NULL)
     {
-        rt_device_control(dev, BF30A2_CMD_STOP, RT_NULL);
+        rt_kprintf("Device not found\n");
+        return;
     }
-    else
+
+    if ((argc >= 4) && (argc <= 5) && ((argc == 4) || (strcmp(argv[4], "rgb") == 0)))
     {
-        rt_kprintf("Device not found\n");
+        bf30a2_tone_curve(lut, (int)strtol(argv[1], RT_NULL, 0), (int)strtol(argv[2], RT_NULL, 0),
+                          (int)strtol(argv[3], RT_NULL, 0));
+        if (argc == 5)
+        {
+            /* The same curve on each channel of the converted pixel */
+            cfg.r = cfg.g = cfg.b = lut;
+        }
+        else
+        {
+            cfg.y = lut;
+        }
+    }
+    else if ((argc != 2) || (strcmp(argv[1], "off") != 0))
+    {
+        rt_kprintf("Usage: bf30a2_tone off | <brightness> <contrast %%> <gamma x100> [rgb]\n");
+        return;
+    }
+
+    ret = rt_device_control(dev, BF30A2_CMD_SET_TONE, &cfg);
+    if (ret != RT_EOK)
+    {
+        rt_kprintf("Failed: %d\n", (int)ret);
     }
 }
-MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_stop, bf30a2_stop, Stop capture);
+MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_tone, bf30a2_tone, Frame output tone curve [off|brightness contrast gamma [rgb]]);
+#endif
 
-static void cmd_bf30a2_status(int argc, char **argv)
+static void cmd_bf30a2_change(int argc, char **argv)
 {
     rt_device_t dev = rt_device_find(BF30A2_DEVICE_NAME);
-    if (dev != RT_NULL)
+    bf30a2_change_cfg_t cfg = { BF30A2_CHANGE_OFF, 4, 0 };
+    bf30a2_change_info_t info;
+    rt_err_t ret;
+
+    if (dev == RT_NULL)
     {
-        bf30a2_status_info_t status;
-        bf30a2_info_t info;
+        rt_kprintf("Device not found\n");
+        return;
+    }
 
-        rt_device_control(dev, BF30A2_CMD_GET_INFO, &info);
-        rt_device_control(dev, BF30A2_CMD_GET_STATUS, &status);
+    if (argc > 1)
+    {
+        if (strcmp(argv[1], "mark") == 0)
+        {
+            cfg.mode = BF30A2_CHANGE_MARK;
+        }
+        else if (strcmp(argv[1], "suppress") == 0)
+        {
+            cfg.mode = BF30A2_CHANGE_SUPPRESS;
+        }
+        else if ((strcmp(argv[1], "off") != 0) || (argc > 2))
+        {
+            rt_kprintf("Usage: bf30a2_change [off | mark|suppress [threshold] [blocks]]\n");
+            return;
+        }
+        if (argc > 2)
+        {
+            cfg.threshold = (rt_uint8_t)strtoul(argv[2], RT_NULL, 0);
+        }
+        if (argc > 3)
+        {
+            cfg.blocks = (rt_uint8_t)strtoul(argv[3], RT_NULL, 0);
+        }
 
-        rt_kprintf("=== BF30A2 Status ===\n");
-        rt_kprintf("Chip ID: 0x%04X\n", info.chip_id);
-        rt_kprintf("Resolution: %dx%d\n", info.width, info.height);
-        rt_kprintf("State: %s\n", status.state == BF30A2_STATUS_RUNNING ? "Running" : "Idle");
-        rt_kprintf("Frames: %d complete\n", status.complete_frames);
-        rt_kprintf("Errors: %d\n", status.error_count);
-        rt_kprintf("FPS: %.1f\n", status.fps);
-        rt_kprintf("Frame ready: %d\n", status.frame_ready);
-        rt_kprintf("=====================\n");
+        ret = rt_device_control(dev, BF30A2_CMD_SET_CHANGE, &cfg);
+        if (ret != RT_EOK)
+        {
+            rt_kprintf("Failed: %d\n", (int)ret);
+        }
+        return;
     }
-    else
+
+    rt_device_control(dev, BF30A2_CMD_GET_CHANGE, &info);
+    rt_kprintf("Compared %u, unchanged %u, suppressed %u\n", info.frames, info.unchanged,
+               info.suppressed);
+    rt_kprintf("Last: %s, %u blocks changed, max delta %u\n",
+               info.last_unchanged ? "unchanged" : "changed", info.last_blocks, info.last_delta);
+}
+MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_change, bf30a2_change, Change detection [off|mark|suppress [threshold] [blocks]]);
+
+#ifdef BF30A2_USING_SUBSCRIBE
+static void cmd_bf30a2_subs(int argc, char **argv)
+{
+    static const char *const formats[BF30A2_SUB_FORMATS] = { "rgb565", "y8", "rgb565/2", "thumb" };
+    rt_device_t dev = rt_device_find(BF30A2_DEVICE_NAME);
+    bf30a2_sub_status_t st;
+    int i;
+
+    if (dev == RT_NULL)
     {
         rt_kprintf("Device not found\n");
+        return;
+    }
+
+    rt_kprintf("=== BF30A2 Subscribers ===\n");
+    for (i = 0; i < BF30A2_MAX_SUBSCRIBERS; i++)
+    {
+        st.handle = i;
+        if (rt_device_control(dev, BF30A2_CMD_GET_SUBSCRIBER, &st) != RT_EOK)
+        {
+            continue;
+        }
+        rt_kprintf("[%d] %-8s /%u %-8s delivered %u, dropped %u, queued %u\n",
+                   i, formats[st.cfg.format], (st.cfg.divisor > 1) ? st.cfg.divisor : 1,
+                   (st.cfg.mode == BF30A2_SUB_QUEUE) ? "queue" : "callback",
+                   st.delivered, st.dropped, st.queued);
     }
+    rt_kprintf("==========================\n");
 }
-MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_status, bf30a2_status, Show camera status);
+MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_subs, bf30a2_subs, List frame subscribers);
+#endif
 
-static void cmd_bf30a2_export(int argc, char **argv)
+#ifdef BF30A2_USING_BENCH
+static void cmd_bf30a2_bench(int argc, char **argv)
 {
-    rt_device_t dev = rt_device_find(BF30A2_DEVICE_NAME);
-    if (dev != RT_NULL)
+    bf30a2_bench_result_t results[BF30A2_BENCH_MAX_RESULTS];
+    rt_uint32_t scale = 1;
+    int count;
+
+    if (argc >= 2)
     {
-        rt_device_control(dev, BF30A2_CMD_EXPORT_UART, RT_NULL);
+        scale = strtoul(argv[1], RT_NULL, 0);
     }
-    else
+
+    /* Uses private buffers, but shares the CPU with a running capture */
+    count = bf30a2_bench_run(scale, results, BF30A2_BENCH_MAX_RESULTS);
+    if (count < 0)
     {
-        rt_kprintf("Device not found\n");
+        rt_kprintf("bf30a2_bench failed: %d\n", count);
+        return;
     }
+    bf30a2_bench_print("target", results, count);
 }
-MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_export, bf30a2_export, Export frame via UART);
+MSH_CMD_EXPORT_ALIAS(cmd_bf30a2_bench, bf30a2_bench, Run pipeline benchmarks [scale]);
+#endif
 
 /*============================================================================*/
 /*                     AUTO INITIALIZATION                                    */
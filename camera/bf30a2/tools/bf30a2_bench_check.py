@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+# SPDX-License-Identifier: Apache-2.0
+"""Check BF30A2 benchmark results against a baseline.
+
+Usage:
+    bf30a2_bench_check.py [--strict] <baseline.json> <results> [<results> ...]
+    bf30a2_bench_check.py --update <baseline.json> <results> [<results> ...]
+
+Results are the JSON lines printed by `bf30a2_bench` (shell command or
+tools/host/bf30a2_bench) and `bf30a2_sim -j`; any other lines, such as the
+rest of a UART log, are ignored. Every value is lower-is-better.
+
+Timings of one machine say little about another, so a baseline entry
+holds the case's ratio to the reference case measured in the same run
+(`ref.loop`, a plain byte loop no driver change touches) with a relative
+tolerance, or an absolute limit:
+
+    {"reference": "ref.loop", "tolerance": 1.0,
+     "results": {"decode": {"ratio": 1.9},
+                 "e2e.callback_p99": {"max": 1500}}}
+
+An entry is flagged when its value exceeds ratio * reference * (1 +
+tolerance), with the reference taken from the same run, or max. Entries
+holding a plain "value" instead of a ratio are compared as they are, for
+baselines of a single board. --update rewrites
+the ratios (or values) from the results and keeps tolerances and limits.
+
+Exit status is 1 on a missing result; flagged regressions only fail the
+check with --strict, since timings on shared or different machines vary
+by more than any useful tolerance.
+"""
+
+import json
+import sys
+
+DEFAULT_TOLERANCE = 1.0
+DEFAULT_REFERENCE = "ref.loop"
+
+
+def load_results(paths):
+    results = {}
+    for path in paths:
+        with open(path, "r", errors="replace") as f:
+            for line in f:
+                start = line.find('{"bench":')
+                if start < 0:
+                    continue
+                try:
+                    rec = json.loads(line[start:])
+                except ValueError:
+                    continue
+                results[rec["bench"]] = rec
+    return results
+
+
+def reference_value(baseline, results):
+    rec = results.get(baseline.get("reference", DEFAULT_REFERENCE))
+    return rec["value"] if (rec is not None and rec["value"] > 0) else None
+
+
+def check(baseline, results):
+    tolerance = baseline.get("tolerance", DEFAULT_TOLERANCE)
+    reference = baseline.get("reference", DEFAULT_REFERENCE)
+    ref_value = reference_value(baseline, results)
+    missing = 0
+    flagged = 0
+    for name, ref in sorted(baseline.get("results", {}).items()):
+        rec = results.get(name)
+        if rec is None or ("ratio" in ref and ref_value is None):
+            print("MISSING  %-26s" % (name if rec is None else reference))
+            missing += 1
+            continue
+        value = rec["value"]
+        tol = ref.get("tolerance", tolerance)
+        if "max" in ref:
+            expected, limit = None, ref["max"]
+        elif "ratio" in ref:
+            # The reference of this run scales the expected value and the limit
+            expected = ref["ratio"] * ref_value
+            limit = expected * (1.0 + tol)
+        else:
+            expected = ref["value"]
+            limit = expected * (1.0 + tol)
+        delta = "%+6.1f%%" % ((value / expected - 1.0) * 100.0) if expected else ""
+        status = "ok" if value <= limit else "REGRESS"
+        if status != "ok":
+            flagged += 1
+        print("%-8s %-26s %12.3f %-9s limit %12.3f %s" % (status, name, value, rec["unit"],
+                                                         limit, delta))
+    if ref_value is not None:
+        print("ref      %-26s %12.3f %s" % (reference, ref_value, results[reference]["unit"]))
+    for name in sorted(set(results) - set(baseline.get("results", {})) - {reference}):
+        print("new      %-26s %12.3f %s" % (name, results[name]["value"], results[name]["unit"]))
+    return missing, flagged
+
+
+def update(baseline, results):
+    reference = baseline.setdefault("reference", DEFAULT_REFERENCE)
+    ref_value = reference_value(baseline, results)
+    entries = baseline.setdefault("results", {})
+    for name, rec in results.items():
+        if name == reference:
+            continue
+        ref = entries.setdefault(name, {})
+        if "max" in ref:
+            pass
+        elif "value" in ref or ref_value is None:
+            ref["value"] = rec["value"]
+        else:
+            ref["ratio"] = round(rec["value"] / ref_value, 4)
+        ref["unit"] = rec["unit"]
+    baseline["platform"] = sorted({rec.get("platform", "") for rec in results.values()})
+
+
+def main(argv):
+    args = argv[1:]
+    do_update = False
+    strict = False
+    while args and args[0] in ("--update", "--strict"):
+        do_update |= args[0] == "--update"
+        strict |= args[0] == "--strict"
+        args = args[1:]
+    if len(args) < 2:
+        sys.stderr.write(__doc__)
+        return 2
+
+    results = load_results(args[1:])
+    if not results:
+        sys.stderr.write("no benchmark results found\n")
+        return 1
+
+    try:
+        with open(args[0]) as f:
+            baseline = json.load(f)
+    except FileNotFoundError:
+        if not do_update:
+            raise
+        baseline = {"reference": DEFAULT_REFERENCE, "tolerance": DEFAULT_TOLERANCE,
+                    "results": {}}
+
+    if do_update:
+        update(baseline, results)
+        with open(args[0], "w") as f:
+            json.dump(baseline, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("updated %s (%d results)" % (args[0], len(results)))
+        return 0
+
+    missing, flagged = check(baseline, results)
+    if missing or (strict and flagged):
+        print("FAIL (%d missing, %d regressed)" % (missing, flagged))
+        return 1
+    if flagged:
+        print("PASS (%d flagged, not failing without --strict)" % flagged)
+    else:
+        print("PASS")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+# SPDX-License-Identifier: Apache-2.0
+"""Rebuild a BF30A2 raw capture file from a `bf30a2_rawcap export` UART log.
+
+Usage:
+    bf30a2_rawcap_extract.py <log file> <capture.bfrc>
+
+The output is byte-identical to what `bf30a2_rawcap save` writes and can be
+replayed with tools/host/bf30a2_replay.
+"""
+
+import struct
+import sys
+
+RAWCAP_MAGIC = 0x43524642
+
+
+def extract(lines):
+    size = None
+    data = []
+    stage = 0
+    for raw in lines:
+        line = raw.strip()
+        if stage == 0:
+            if line == "===RAWCAP_START===":
+                stage = 1
+        elif stage == 1:
+            if line == "===DATA_BEGIN===":
+                stage = 2
+            elif line.startswith("SIZE:"):
+                size = int(line[5:])
+        elif stage == 2:
+            if line == "===DATA_END===":
+                break
+            data.append(line)
+    if stage != 2:
+        raise ValueError("no complete RAWCAP block found")
+    blob = bytes.fromhex("".join(data))
+    if size is not None and len(blob) != size:
+        raise ValueError("size mismatch: header says %d, got %d bytes" % (size, len(blob)))
+    return blob
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+    with open(sys.argv[1], "r", errors="replace") as f:
+        blob = extract(f)
+    if len(blob) < 4 or struct.unpack_from("<I", blob)[0] != RAWCAP_MAGIC:
+        print("warning: capture magic not found", file=sys.stderr)
+    with open(sys.argv[2], "wb") as f:
+        f.write(blob)
+    print("wrote %d bytes to %s" % (len(blob), sys.argv[2]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
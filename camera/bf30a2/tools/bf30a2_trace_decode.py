@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+# SPDX-License-Identifier: Apache-2.0
+"""Decode a BF30A2 trace dump captured from the UART console.
+
+Usage:
+    bf30a2_trace_decode.py <log file> [--csv]
+
+The log may contain other console output; only the block between
+===TRACE_START=== and ===TRACE_END=== is decoded.
+"""
+
+import argparse
+import struct
+import sys
+
+EVENT_NAMES = [
+    "NONE",
+    "CAPTURE_START",
+    "CAPTURE_STOP",
+    "DMA_WAKEUP",
+    "FRAME_HEADER",
+    "FRAME_START",
+    "GEOMETRY_REJECT",
+    "FRAME_END",
+    "LINE",
+    "LINE_REJECT",
+    "SYNC_LOSS",
+    "SIZE_MISMATCH",
+    "CB_ENTER",
+    "CB_EXIT",
+    "FRAME_DROP",
+]
+
+STATE_NAMES = [
+    "FIND_SYNC", "GET_TYPE", "FRAME_FORMAT", "FRAME_WIDTH_H", "FRAME_WIDTH_L",
+    "FRAME_HEIGHT_H", "FRAME_HEIGHT_L", "LINE_NUM_H", "LINE_NUM_L",
+    "DATA_SYNC_1", "DATA_SYNC_2", "DATA_SYNC_3", "DATA_TYPE", "DATA_SIZE_H",
+    "DATA_SIZE_L", "PIXEL_DATA",
+]
+
+EVENT_SIZE = 8
+
+
+def parse_dump(lines):
+    header = {}
+    data = []
+    stage = 0
+    for raw in lines:
+        line = raw.strip()
+        if stage == 0:
+            if line == "===TRACE_START===":
+                stage = 1
+        elif stage == 1:
+            if line == "===DATA_BEGIN===":
+                stage = 2
+            elif ":" in line:
+                key, value = line.split(":", 1)
+                header[key] = int(value)
+        elif stage == 2:
+            if line == "===DATA_END===":
+                break
+            data.append(line)
+    if stage != 2:
+        raise ValueError("no complete trace block found")
+    blob = bytes.fromhex("".join(data))
+    return header, blob
+
+
+def describe(name, arg8, arg16):
+    if name == "SYNC_LOSS":
+        state = STATE_NAMES[arg8] if arg8 < len(STATE_NAMES) else str(arg8)
+        return "state=%s byte=0x%02X" % (state, arg16)
+    if name == "DMA_WAKEUP":
+        return "bytes=%d event=%d" % (arg16, arg8)
+    if name == "FRAME_END":
+        return "published=%d lines=%d" % (arg8, arg16)
+    if name in ("LINE", "LINE_REJECT"):
+        return "line=%d" % arg16
+    if name == "FRAME_HEADER":
+        return "width=%d" % arg16
+    if name in ("FRAME_START", "GEOMETRY_REJECT"):
+        return "height=%d" % arg16
+    if name == "SIZE_MISMATCH":
+        return "data_size=%d" % arg16
+    if name in ("CB_ENTER", "CB_EXIT"):
+        return "frame=%d" % arg16
+    if name == "FRAME_DROP":
+        return "started=%d" % arg16
+    return ""
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("log")
+    ap.add_argument("--csv", action="store_true", help="emit CSV instead of text")
+    args = ap.parse_args()
+
+    with open(args.log, "r", errors="replace") as f:
+        header, blob = parse_dump(f)
+
+    clock_hz = header.get("CLOCK_HZ", 1) or 1
+    total = header.get("TOTAL", 0)
+    count = len(blob) // EVENT_SIZE
+    first_seq = total - count
+
+    if args.csv:
+        print("seq,time_us,delta_us,event,arg8,arg16")
+    else:
+        print("# %d events (of %d emitted), clock %d Hz" % (count, total, clock_hz))
+
+    elapsed = 0
+    prev_ts = None
+    for i in range(count):
+        ts, ev, arg8, arg16 = struct.unpack_from("<IBBH", blob, i * EVENT_SIZE)
+        delta = 0 if prev_ts is None else (ts - prev_ts) & 0xFFFFFFFF
+        prev_ts = ts
+        elapsed += delta
+        name = EVENT_NAMES[ev] if ev < len(EVENT_NAMES) else "EVT_%d" % ev
+        t_us = elapsed * 1e6 / clock_hz
+        d_us = delta * 1e6 / clock_hz
+        if args.csv:
+            print("%d,%.3f,%.3f,%s,%d,%d" % (first_seq + i, t_us, d_us, name, arg8, arg16))
+        else:
+            print("%8d %12.3f us (+%9.3f) %-15s %s" %
+                  (first_seq + i, t_us, d_us, name, describe(name, arg8, arg16)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
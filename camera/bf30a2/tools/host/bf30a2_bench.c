@@ -0,0 +1,59 @@
+/**
+ * @file    bf30a2_bench.c
+ * @brief   Host runner for the BF30A2 pipeline benchmarks
+ *
+ * Runs the same cases as the bf30a2_bench shell command (src/bf30a2_bench.c)
+ * and prints JSON lines. End-to-end latency comes from bf30a2_sim -j; both
+ * outputs are checked against a baseline by tools/bf30a2_bench_check.py.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <rtthread.h>
+
+#include "bf30a2_bench.h"
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-s scale] [-p platform]\n"
+            "  -s <n>     iteration multiplier (default 20)\n"
+            "  -p <name>  platform tag in the output (default host)\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    bf30a2_bench_result_t results[BF30A2_BENCH_MAX_RESULTS];
+    const char *platform = "host";
+    rt_uint32_t scale = 20;
+    int count;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:p:")) != -1)
+    {
+        switch (opt)
+        {
+        case 's': scale = (rt_uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'p': platform = optarg; break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    count = bf30a2_bench_run(scale, results, BF30A2_BENCH_MAX_RESULTS);
+    if (count < 0)
+    {
+        fprintf(stderr, "bf30a2_bench_run failed: %d\n", count);
+        return 1;
+    }
+    bf30a2_bench_print(platform, results, count);
+
+    return 0;
+}
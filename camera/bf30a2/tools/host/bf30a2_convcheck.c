@@ -0,0 +1,347 @@
+/**
+ * @file    bf30a2_convcheck.c
+ * @brief   Check bf30a2_convert() and bf30a2_convert_box() against the capture path
+ *
+ * Random YUV422 frames are converted whole by the kernels the core
+ * assembles frames and thumbnails with (bf30a2_yuv_frame_to_level(),
+ * bf30a2_yuv_frame_to_plane(), the thumbnail column sums). The public API
+ * must then reproduce the matching part of that output byte for byte:
+ *
+ *  - a random rectangle, 1:1 to RGB565 and Y8, into a padded canvas whose
+ *    padding must stay untouched;
+ *  - the same rectangle with a negative destination stride and with a
+ *    negative source stride, both flipping it vertically;
+ *  - an even rectangle halved, against the half resolution levels;
+ *  - a box filter over two frames side by side (480 pixels, more than the
+ *    column sums hold at once), against each frame filtered alone.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bf30a2_core.h"
+#include "bf30a2_convert.h"
+#include "bf30a2_streamgen.h"
+
+#define W                           IMG_WIDTH
+#define H                           IMG_HEIGHT
+#define PAD                         6
+#define PAD_BYTE                    0xA5
+
+typedef struct
+{
+    rt_uint8_t *yuv[2];             /* Two source frames, W x H */
+    rt_uint8_t *rgb;                /* BF30A2_LEVEL_FULL of yuv[0] */
+    rt_uint8_t *y8;                 /* BF30A2_PLANE_Y8 of yuv[0] */
+    rt_uint8_t *rgb_half;           /* BF30A2_LEVEL_HALF of yuv[0] */
+    rt_uint8_t *y8_half;            /* BF30A2_LEVEL_Y8 of yuv[0] */
+    rt_uint8_t *wide;               /* yuv[0] and yuv[1] side by side, 2W x H */
+    rt_uint8_t *canvas;             /* Output with PAD bytes after every row */
+    rt_uint8_t *thumb;              /* Reference thumbnails of both frames, side by side */
+    rt_uint32_t checks;
+} check_ctx_t;
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -n <iters>   random frames and rectangles (default 100)\n"
+            "  -s <seed>    PRNG seed (default 1)\n",
+            prog);
+}
+
+/**
+ * @brief Report a mismatch: row and column of the first differing byte
+ */
+static int mismatch(const char *what, const bf30a2_rect_t *r, int row, int byte)
+{
+    fprintf(stderr, "%s: rect %ux%u at %u,%u differs at row %d byte %d\n",
+            what, r->width, r->height, r->x, r->y, row, byte);
+    return 0;
+}
+
+/**
+ * @brief Compare rows of the canvas against a reference image, padding included
+ *
+ * Canvas row i holds reference row ref_row + i * dir, from byte ref_col.
+ */
+static int compare_rows(check_ctx_t *ctx, const char *what, const bf30a2_rect_t *r,
+                        const rt_uint8_t *ref, rt_int32_t ref_pitch, int ref_row, int dir,
+                        int ref_col, int row_bytes, int rows)
+{
+    const rt_uint8_t *got, *want;
+    int i, b;
+
+    for (i = 0; i < rows; i++)
+    {
+        got = ctx->canvas + i * (row_bytes + PAD);
+        want = ref + (rt_int32_t)(ref_row + i * dir) * ref_pitch + ref_col;
+        for (b = 0; b < row_bytes; b++)
+        {
+            if (got[b] != want[b])
+            {
+                return mismatch(what, r, i, b);
+            }
+        }
+        for (b = row_bytes; b < row_bytes + PAD; b++)
+        {
+            if (got[b] != PAD_BYTE)
+            {
+                return mismatch(what, r, i, b);
+            }
+        }
+    }
+    ctx->checks++;
+    return 1;
+}
+
+/**
+ * @brief Convert a rectangle of yuv[0] into the canvas
+ *
+ * flip_dst walks the canvas bottom up, flip_src the source; half halves it.
+ */
+static rt_err_t convert_rect(check_ctx_t *ctx, const bf30a2_rect_t *r, bf30a2_format_t format,
+                             int half, int flip_dst, int flip_src, int *row_bytes, int *rows)
+{
+    bf30a2_image_t src = { ctx->yuv[0], W * 2, W, H, BF30A2_FORMAT_YUV422 };
+    bf30a2_image_t dst;
+    rt_int32_t stride;
+    int bpp = (format == BF30A2_FORMAT_Y8) ? 1 : 2;
+
+    dst.width = half ? r->width / 2 : r->width;
+    dst.height = half ? r->height / 2 : r->height;
+    dst.format = format;
+    *row_bytes = dst.width * bpp;
+    *rows = dst.height;
+    stride = *row_bytes + PAD;
+    memset(ctx->canvas, PAD_BYTE, (size_t)stride * H);
+
+    dst.data = ctx->canvas;
+    dst.stride = stride;
+    if (flip_dst)
+    {
+        dst.data = ctx->canvas + (rt_int32_t)(dst.height - 1) * stride;
+        dst.stride = -stride;
+    }
+    if (flip_src)
+    {
+        src.data = ctx->yuv[0] + (rt_int32_t)(H - 1) * W * 2;
+        src.stride = -W * 2;
+    }
+
+    return bf30a2_convert(&src, r, &dst);
+}
+
+/**
+ * @brief A rectangle 1:1, to RGB565 and Y8, straight and flipped either way
+ */
+static int check_rect(check_ctx_t *ctx, const bf30a2_rect_t *r)
+{
+    static const bf30a2_format_t formats[2] = { BF30A2_FORMAT_RGB565, BF30A2_FORMAT_Y8 };
+    const rt_uint8_t *ref;
+    int f, bpp, row_bytes, rows;
+
+    for (f = 0; f < 2; f++)
+    {
+        bpp = (formats[f] == BF30A2_FORMAT_Y8) ? 1 : 2;
+        ref = (formats[f] == BF30A2_FORMAT_Y8) ? ctx->y8 : ctx->rgb;
+
+        if ((convert_rect(ctx, r, formats[f], 0, 0, 0, &row_bytes, &rows) != RT_EOK) ||
+            !compare_rows(ctx, "rect", r, ref, W * bpp, r->y, 1, r->x * bpp, row_bytes, rows))
+        {
+            return 0;
+        }
+
+        /* Canvas row i is rectangle row h - 1 - i */
+        if ((convert_rect(ctx, r, formats[f], 0, 1, 0, &row_bytes, &rows) != RT_EOK) ||
+            !compare_rows(ctx, "negative dst stride", r, ref, W * bpp, r->y + r->height - 1, -1,
+                          r->x * bpp, row_bytes, rows))
+        {
+            return 0;
+        }
+
+        /* Row y of a bottom-up source is frame row H - 1 - y */
+        if ((convert_rect(ctx, r, formats[f], 0, 0, 1, &row_bytes, &rows) != RT_EOK) ||
+            !compare_rows(ctx, "negative src stride", r, ref, W * bpp, H - 1 - r->y, -1,
+                          r->x * bpp, row_bytes, rows))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief An even rectangle halved, against BF30A2_LEVEL_HALF and BF30A2_LEVEL_Y8
+ */
+static int check_half(check_ctx_t *ctx, const bf30a2_rect_t *r)
+{
+    int row_bytes, rows;
+
+    if ((convert_rect(ctx, r, BF30A2_FORMAT_RGB565, 1, 0, 0, &row_bytes, &rows) != RT_EOK) ||
+        !compare_rows(ctx, "half rgb565", r, ctx->rgb_half, W, r->y / 2, 1, r->x, row_bytes,
+                      rows))
+    {
+        return 0;
+    }
+    if ((convert_rect(ctx, r, BF30A2_FORMAT_Y8, 1, 0, 0, &row_bytes, &rows) != RT_EOK) ||
+        !compare_rows(ctx, "half y8", r, ctx->y8_half, W / 2, r->y / 2, 1, r->x / 2, row_bytes,
+                      rows))
+    {
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Thumbnail of one W x H frame as the capture path sums it, rows pitch bytes apart
+ */
+static void thumb_reference(const rt_uint8_t *yuv, int scale, bf30a2_format_t format,
+                            rt_uint8_t *dst, int pitch)
+{
+    rt_uint16_t acc[3][IMG_WIDTH / 2];
+    int bpp = (format == BF30A2_FORMAT_Y8) ? 1 : 2;
+    int row, i;
+
+    for (row = 0; row < H / scale; row++)
+    {
+        for (i = 0; i < scale; i++)
+        {
+            bf30a2_thumb_accumulate(yuv + (row * scale + i) * W * 2, acc, W, scale, bpp == 2,
+                                    i == 0);
+        }
+        bf30a2_thumb_emit(acc, dst + row * pitch, W / scale, scale, scale, format);
+    }
+}
+
+/**
+ * @brief The box filter over both frames side by side, each half against its frame
+ */
+static int check_box(check_ctx_t *ctx)
+{
+    static const bf30a2_format_t formats[2] = { BF30A2_FORMAT_RGB565, BF30A2_FORMAT_Y8 };
+    bf30a2_image_t src = { ctx->wide, 2 * W * 2, 2 * W, H, BF30A2_FORMAT_YUV422 };
+    bf30a2_rect_t all = { 0, 0, 2 * W, H };
+    bf30a2_image_t dst;
+    int scale, f, bpp, cols;
+
+    for (scale = 2; scale <= 8; scale *= 2)
+    {
+        for (f = 0; f < 2; f++)
+        {
+            bpp = (formats[f] == BF30A2_FORMAT_Y8) ? 1 : 2;
+            cols = W / scale;
+            dst.data = ctx->canvas;
+            dst.stride = 2 * cols * bpp + PAD;
+            dst.width = (rt_uint16_t)(2 * cols);
+            dst.height = (rt_uint16_t)(H / scale);
+            dst.format = formats[f];
+            memset(ctx->canvas, PAD_BYTE, (size_t)dst.stride * H);
+
+            if (bf30a2_convert_box(&src, RT_NULL, &dst) != RT_EOK)
+            {
+                fprintf(stderr, "box 1/%d: rejected\n", scale);
+                return 0;
+            }
+
+            thumb_reference(ctx->yuv[0], scale, formats[f], ctx->thumb, 2 * cols * bpp);
+            thumb_reference(ctx->yuv[1], scale, formats[f], ctx->thumb + cols * bpp,
+                            2 * cols * bpp);
+            if (!compare_rows(ctx, "box", &all, ctx->thumb, 2 * cols * bpp, 0, 1, 0,
+                              2 * cols * bpp, H / scale))
+            {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    check_ctx_t ctx;
+    bf30a2_rect_t r;
+    rt_uint32_t iters = 100, seed = 1, rng, it;
+    size_t i;
+    int opt, f;
+
+    while ((opt = getopt(argc, argv, "n:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': iters = (rt_uint32_t)strtoul(optarg, NULL, 0); break;
+        case 's': seed = (rt_uint32_t)strtoul(optarg, NULL, 0); break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    rng = seed ? seed : 1;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.yuv[0] = malloc(W * H * 2);
+    ctx.yuv[1] = malloc(W * H * 2);
+    ctx.rgb = malloc(W * H * 2);
+    ctx.y8 = malloc(W * H);
+    ctx.rgb_half = malloc(W * H / 2);
+    ctx.y8_half = malloc(W * H / 4);
+    ctx.wide = malloc(2 * W * H * 2);
+    ctx.canvas = malloc((2 * W * 2 + PAD) * H);
+    ctx.thumb = malloc(W * H);
+    if ((ctx.yuv[0] == NULL) || (ctx.yuv[1] == NULL) || (ctx.rgb == NULL) ||
+        (ctx.y8 == NULL) || (ctx.rgb_half == NULL) || (ctx.y8_half == NULL) ||
+        (ctx.wide == NULL) || (ctx.canvas == NULL) || (ctx.thumb == NULL))
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    for (it = 0; it < iters; it++)
+    {
+        for (f = 0; f < 2; f++)
+        {
+            for (i = 0; i < W * H * 2; i++)
+            {
+                ctx.yuv[f][i] = (rt_uint8_t)bf30a2_gen_rand(&rng);
+            }
+        }
+        for (i = 0; i < H; i++)
+        {
+            memcpy(ctx.wide + i * 4 * W, ctx.yuv[0] + i * 2 * W, 2 * W);
+            memcpy(ctx.wide + i * 4 * W + 2 * W, ctx.yuv[1] + i * 2 * W, 2 * W);
+        }
+        bf30a2_yuv_frame_to_level(RT_NULL, RT_NULL, ctx.yuv[0], BF30A2_LEVEL_FULL, W, H, ctx.rgb);
+        bf30a2_yuv_frame_to_plane(ctx.yuv[0], BF30A2_PLANE_Y8, W, H, ctx.y8);
+        bf30a2_yuv_frame_to_level(RT_NULL, RT_NULL, ctx.yuv[0], BF30A2_LEVEL_HALF, W, H,
+                                  ctx.rgb_half);
+        bf30a2_yuv_frame_to_level(RT_NULL, RT_NULL, ctx.yuv[0], BF30A2_LEVEL_Y8, W, H,
+                                  ctx.y8_half);
+
+        /* YUV422 rectangles start and end on whole pixel pairs */
+        r.x = (rt_uint16_t)((bf30a2_gen_rand(&rng) % (W / 2)) * 2);
+        r.width = (rt_uint16_t)((1 + bf30a2_gen_rand(&rng) % ((W - r.x) / 2)) * 2);
+        r.y = (rt_uint16_t)(bf30a2_gen_rand(&rng) % H);
+        r.height = (rt_uint16_t)(1 + bf30a2_gen_rand(&rng) % (H - r.y));
+        if (!check_rect(&ctx, &r))
+        {
+            return 1;
+        }
+
+        /* Halving keeps the even rows and columns of the frame */
+        r.y &= ~1U;
+        r.height = (rt_uint16_t)((r.height < 2) ? 2 : (r.height & ~1U));
+        if (!check_half(&ctx, &r) || !check_box(&ctx))
+        {
+            return 1;
+        }
+    }
+
+    printf("iters=%u checks=%u\n", iters, ctx.checks);
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,548 @@
+/**
+ * @file    bf30a2_fuzz.c
+ * @brief   Parser fuzz target and resync campaign for the BF30A2 core
+ *
+ * Two ways to drive bf30a2_core_feed():
+ *
+ *  - LLVMFuzzerTestOneInput() takes arbitrary bytes. Built with
+ *    -DBF30A2_LIBFUZZER it links against libFuzzer; otherwise any file
+ *    arguments are replayed through it as a corpus.
+ *  - Without file arguments a campaign runs: bf30a2_streamgen produces
+ *    streams with controlled corruption, every line the parser accepts is
+ *    checked against the generator's records, and the distance in bytes
+ *    from the end of each damaged region to the next correctly decoded
+ *    line header is reported as the recovery latency.
+ *
+ * After every chunk the parser invariants are checked: the payload cursor
+ * stays inside line_yuv, the state is valid, and guard bytes around the
+ * core and frame_rgb565 are intact. Build with the sanitizer flags in the
+ * Makefile so stray accesses are caught where they happen.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bf30a2_core.h"
+#include "bf30a2_streamgen.h"
+
+#define GUARD_SIZE                  64
+#define GUARD_BYTE                  0xA5
+
+/* Default resync bound: a truncated line can swallow the next line whole */
+#define DEFAULT_BOUND               (3 * ONE_LINE_TOTAL)
+
+typedef struct
+{
+    rt_uint8_t pre[GUARD_SIZE];
+    bf30a2_core_t core;
+    rt_uint8_t post[GUARD_SIZE];
+} guarded_core_t;
+
+typedef struct
+{
+    const bf30a2_gen_t *gen;
+    size_t lo;                      /* Stream offsets fed by the current chunk: (lo, hi] */
+    size_t hi;
+    size_t cursor;                  /* Next unmatched generator line */
+
+    size_t *good;                   /* hdr_start of correctly decoded lines */
+    size_t ngood;
+    size_t good_cap;
+
+    rt_uint32_t bad_accept;         /* Accepted lines that match no clean record */
+    rt_uint32_t failures;
+} check_ctx_t;
+
+static guarded_core_t g_core;
+static rt_uint8_t *g_frame_mem;
+
+/*============================================================================*/
+/*                     INVARIANTS                                             */
+/*============================================================================*/
+
+static int guard_ok(const rt_uint8_t *p)
+{
+    int i;
+
+    for (i = 0; i < GUARD_SIZE; i++)
+    {
+        if (p[i] != GUARD_BYTE)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void fail(const char *what)
+{
+    const bf30a2_core_t *core = &g_core.core;
+
+    fprintf(stderr, "invariant violated: %s (state=%d data_pos=%u line=%u)\n",
+            what, (int)core->state, core->data_pos, core->line_num);
+    abort();
+}
+
+static void check_invariants(void)
+{
+    const bf30a2_core_t *core = &g_core.core;
+
+    if (core->data_pos > BYTES_PER_LINE)
+    {
+        fail("data_pos beyond line_yuv");
+    }
+    if ((unsigned)core->state > STATE_PIXEL_DATA)
+    {
+        fail("unknown parser state");
+    }
+    if (core->ff_count >= 3)
+    {
+        fail("ff_count not consumed");
+    }
+    if ((core->width > IMG_WIDTH) || (core->height > IMG_HEIGHT) ||
+        (core->line_bytes != core->width * 2))
+    {
+        fail("geometry beyond the limits");
+    }
+    if (core->max_line_seen >= IMG_HEIGHT)
+    {
+        fail("max_line_seen beyond frame");
+    }
+    if (!guard_ok(g_core.pre) || !guard_ok(g_core.post))
+    {
+        fail("core guard overwritten");
+    }
+    if (!guard_ok(g_frame_mem) || !guard_ok(g_frame_mem + GUARD_SIZE + ONE_FRAME_SIZE))
+    {
+        fail("frame_rgb565 guard overwritten");
+    }
+}
+
+static void core_setup(bf30a2_core_line_hook_t on_line, void *ctx)
+{
+    if (g_frame_mem == NULL)
+    {
+        g_frame_mem = malloc(ONE_FRAME_SIZE + 2 * GUARD_SIZE);
+        if (g_frame_mem == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    memset(g_frame_mem, GUARD_BYTE, GUARD_SIZE);
+    memset(g_frame_mem + GUARD_SIZE + ONE_FRAME_SIZE, GUARD_BYTE, GUARD_SIZE);
+
+    memset(&g_core, 0, sizeof(g_core));
+    memset(g_core.pre, GUARD_BYTE, GUARD_SIZE);
+    memset(g_core.post, GUARD_BYTE, GUARD_SIZE);
+    g_core.core.frame_rgb565 = g_frame_mem + GUARD_SIZE;
+    g_core.core.on_line = on_line;
+    g_core.core.hook_ctx = ctx;
+    /* Fingerprint every frame of any geometry; marking keeps every frame published */
+    g_core.core.change.cfg.mode = BF30A2_CHANGE_MARK;
+    bf30a2_core_reset(&g_core.core);
+}
+
+/*============================================================================*/
+/*                     LIBFUZZER ENTRY                                        */
+/*============================================================================*/
+
+int LLVMFuzzerTestOneInput(const rt_uint8_t *data, size_t size)
+{
+    size_t off = 1;
+    size_t chunk;
+
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    core_setup(RT_NULL, RT_NULL);
+
+    /* First byte picks the wakeup size so both feed paths get exercised */
+    chunk = 1 + data[0] * 4;
+    while (off < size)
+    {
+        size_t n = (size - off < chunk) ? size - off : chunk;
+
+        bf30a2_core_feed(&g_core.core, data + off, (rt_uint32_t)n);
+        check_invariants();
+        off += n;
+    }
+
+    return 0;
+}
+
+#ifndef BF30A2_LIBFUZZER
+
+/*============================================================================*/
+/*                     GENERATOR CAMPAIGN                                     */
+/*============================================================================*/
+
+/**
+ * @brief Match an accepted line against the generator records
+ *
+ * A line is good when a clean record ends inside the current chunk with
+ * the same line number and payload hash. With one-byte chunks the end
+ * offset is exact, so a clean record ending there must match.
+ */
+static void on_line(bf30a2_core_t *core, void *arg)
+{
+    check_ctx_t *ctx = (check_ctx_t *)arg;
+    const bf30a2_gen_t *gen = ctx->gen;
+    size_t i;
+
+    for (i = ctx->cursor; (i < gen->nlines) && (gen->lines[i].end <= ctx->hi); i++)
+    {
+        const bf30a2_gen_line_t *rec = &gen->lines[i];
+
+        if ((rec->end <= ctx->lo) || rec->damaged)
+        {
+            continue;
+        }
+
+        if ((rec->line == core->line_num) &&
+            (rec->crc == bf30a2_gen_crc(core->line_yuv, core->line_bytes)))
+        {
+            if (ctx->ngood == ctx->good_cap)
+            {
+                ctx->good_cap = ctx->good_cap ? ctx->good_cap * 2 : 1024;
+                ctx->good = realloc(ctx->good, ctx->good_cap * sizeof(*ctx->good));
+                if (ctx->good == NULL)
+                {
+                    fprintf(stderr, "out of memory\n");
+                    exit(1);
+                }
+            }
+            ctx->good[ctx->ngood++] = rec->hdr_start;
+            ctx->cursor = i + 1;
+            return;
+        }
+
+        if (ctx->hi == ctx->lo + 1)
+        {
+            fprintf(stderr, "clean line %u (frame %u) decoded wrong at %zu\n",
+                    rec->line, rec->frame, rec->end);
+            ctx->failures++;
+            ctx->cursor = i + 1;
+            return;
+        }
+    }
+
+    ctx->bad_accept++;
+}
+
+static int cmp_size(const void *a, const void *b)
+{
+    size_t x = *(const size_t *)a;
+    size_t y = *(const size_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Every pair of stream bytes through the lane split and back
+ */
+static int lanes_selftest(void)
+{
+    rt_uint8_t in[2], l0, l1, out[2];
+    unsigned v;
+
+    for (v = 0; v < 0x10000; v++)
+    {
+        in[0] = (rt_uint8_t)(v >> 8);
+        in[1] = (rt_uint8_t)v;
+        bf30a2_gen_lanes(in, 2, &l0, &l1);
+        bf30a2_lanes_deinterleave(&l0, &l1, out, 1);
+        if ((out[0] != in[0]) || (out[1] != in[1]))
+        {
+            fprintf(stderr, "lanes: %02X %02X decoded as %02X %02X\n",
+                    in[0], in[1], out[0], out[1]);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [options] [corpus files...]\n"
+            "  -i <iters>   campaign iterations (default 200)\n"
+            "  -f <frames>  frames per iteration (default 2)\n"
+            "  -s <seed>    PRNG seed (default 1)\n"
+            "  -w <width>   frame width, taken from the header (default %d)\n"
+            "  -h <height>  frame height (default %d)\n"
+            "  -2           feed the streams as dual-lane captures through the de-interleaver\n"
+            "  -c <n|rand>  bytes per feed call (default 1)\n"
+            "  -b <bytes>   max allowed recovery latency (default %d)\n"
+            "  -d -x -t -D -R -F <ppm>  corruption rates, see bf30a2_gen\n"
+            "  -L <len>     0xFF run length (default 8)\n"
+            "File arguments are fed through LLVMFuzzerTestOneInput() instead.\n",
+            prog, IMG_WIDTH, IMG_HEIGHT, DEFAULT_BOUND);
+}
+
+int main(int argc, char **argv)
+{
+    bf30a2_gen_cfg_t cfg;
+    bf30a2_gen_t gen;
+    check_ctx_t ctx;
+    size_t *lat = NULL;
+    size_t nlat = 0, lat_cap = 0;
+    rt_uint64_t bytes = 0, lat_sum = 0;
+    rt_uint32_t clean = 0, lines = 0, marks = 0, pending = 0, over = 0;
+    rt_uint32_t iters = 200, frames = 2, chunk = 1;
+    rt_uint32_t rng;
+    size_t bound = DEFAULT_BOUND;
+    int random_chunk = 0;
+    int lanes = 0;
+    rt_uint8_t *lane0 = NULL, *lane1 = NULL;
+    rt_uint32_t it, f;
+    int opt;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.width = IMG_WIDTH;
+    cfg.height = IMG_HEIGHT;
+    cfg.seed = 1;
+    cfg.drop_ppm = 20;
+    cfg.flip_ppm = 20;
+    cfg.truncate_ppm = 2000;
+    cfg.duplicate_ppm = 2000;
+    cfg.reorder_ppm = 2000;
+    cfg.ff_run_ppm = 20000;
+    cfg.ff_run_len = 8;
+
+    while ((opt = getopt(argc, argv, "i:f:s:w:h:2c:b:d:x:t:D:R:F:L:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'i': iters = (rt_uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'f': frames = (rt_uint32_t)strtoul(optarg, NULL, 0); break;
+        case 's': cfg.seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case '2': lanes = 1; break;
+        case 'w': cfg.width = (uint16_t)strtoul(optarg, NULL, 0); break;
+        case 'h': cfg.height = (uint16_t)strtoul(optarg, NULL, 0); break;
+        case 'c':
+            if (strcmp(optarg, "rand") == 0)
+            {
+                random_chunk = 1;
+            }
+            else
+            {
+                chunk = (rt_uint32_t)strtoul(optarg, NULL, 0);
+            }
+            break;
+        case 'b': bound = (size_t)strtoul(optarg, NULL, 0); break;
+        case 'd': cfg.drop_ppm = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'x': cfg.flip_ppm = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 't': cfg.truncate_ppm = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'D': cfg.duplicate_ppm = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'R': cfg.reorder_ppm = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'F': cfg.ff_run_ppm = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'L': cfg.ff_run_len = (uint16_t)strtoul(optarg, NULL, 0); break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if ((cfg.width < BF30A2_MIN_WIDTH) || (cfg.width > IMG_WIDTH) || (cfg.width & 1) ||
+        (cfg.height < BF30A2_MIN_HEIGHT) || (cfg.height > IMG_HEIGHT) || (cfg.height & 1))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (optind < argc)
+    {
+        for (; optind < argc; optind++)
+        {
+            FILE *fp = fopen(argv[optind], "rb");
+            rt_uint8_t *buf;
+            long size;
+
+            if (fp == NULL)
+            {
+                perror(argv[optind]);
+                return 1;
+            }
+            fseek(fp, 0, SEEK_END);
+            size = ftell(fp);
+            fseek(fp, 0, SEEK_SET);
+            buf = malloc(size > 0 ? (size_t)size : 1);
+            if ((buf == NULL) || (fread(buf, 1, (size_t)size, fp) != (size_t)size))
+            {
+                fprintf(stderr, "%s: read failed\n", argv[optind]);
+                return 1;
+            }
+            fclose(fp);
+            LLVMFuzzerTestOneInput(buf, (size_t)size);
+            free(buf);
+        }
+        printf("corpus ok\n");
+        return 0;
+    }
+
+    if (chunk == 0)
+    {
+        chunk = 1;
+    }
+
+    if (lanes && !lanes_selftest())
+    {
+        return 1;
+    }
+
+    bf30a2_gen_init(&gen, &cfg);
+    rng = cfg.seed ^ 0x5A5A5A5Au;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.gen = &gen;
+
+    for (it = 0; it < iters; it++)
+    {
+        size_t off = 0;
+        size_t m, g;
+
+        bf30a2_gen_clear(&gen);
+        for (f = 0; f < frames; f++)
+        {
+            bf30a2_gen_frame(&gen);
+        }
+
+        if (lanes)
+        {
+            lane0 = realloc(lane0, gen.len / 2 + 1);
+            lane1 = realloc(lane1, gen.len / 2 + 1);
+            if ((lane0 == NULL) || (lane1 == NULL))
+            {
+                fprintf(stderr, "out of memory\n");
+                return 1;
+            }
+            bf30a2_gen_lanes(gen.data, gen.len, lane0, lane1);
+        }
+
+        core_setup(on_line, &ctx);
+        ctx.cursor = 0;
+        ctx.ngood = 0;
+
+        while (off < gen.len)
+        {
+            size_t n = random_chunk ? 1 + bf30a2_gen_rand(&rng) % (DMA_BUFFER_SIZE - 1) : chunk;
+
+            if (n > gen.len - off)
+            {
+                n = gen.len - off;
+            }
+            ctx.lo = off;
+            ctx.hi = off + n;
+            if (lanes)
+            {
+                /* Whole lane bytes: an odd tail is the padding byte */
+                n += n & 1;
+                ctx.hi = off + n;
+                bf30a2_core_feed_lanes(&g_core.core, lane0 + off / 2, lane1 + off / 2,
+                                       (rt_uint32_t)(n / 2));
+            }
+            else
+            {
+                bf30a2_core_feed(&g_core.core, gen.data + off, (rt_uint32_t)n);
+            }
+            check_invariants();
+            off += n;
+        }
+
+        /* An undamaged stream must decode every line and every frame */
+        for (m = 0; m < gen.nlines; m++)
+        {
+            clean += !gen.lines[m].damaged;
+        }
+        if ((gen.nmarks == 0) &&
+            ((ctx.ngood != gen.nlines) || (g_core.core.complete_frames != frames)))
+        {
+            fprintf(stderr, "iteration %u: clean stream lost data (%zu/%zu lines, %u/%u frames)\n",
+                    it, ctx.ngood, gen.nlines, g_core.core.complete_frames, frames);
+            ctx.failures++;
+        }
+
+        /* Recovery: from the last mark of each burst to the next good line header */
+        for (m = 0, g = 0; m < gen.nmarks; m++)
+        {
+            size_t end = gen.marks[m].end;
+            size_t l;
+
+            while ((g < ctx.ngood) && (ctx.good[g] < end))
+            {
+                g++;
+            }
+            if (g == ctx.ngood)
+            {
+                pending++;
+                continue;
+            }
+            if ((m + 1 < gen.nmarks) && (gen.marks[m + 1].end <= ctx.good[g]))
+            {
+                continue;
+            }
+
+            l = ctx.good[g] - end;
+            if (nlat == lat_cap)
+            {
+                lat_cap = lat_cap ? lat_cap * 2 : 1024;
+                lat = realloc(lat, lat_cap * sizeof(*lat));
+                if (lat == NULL)
+                {
+                    fprintf(stderr, "out of memory\n");
+                    return 1;
+                }
+            }
+            lat[nlat++] = l;
+            lat_sum += l;
+            if (l > bound)
+            {
+                fprintf(stderr, "iteration %u: recovery after offset %zu took %zu bytes\n",
+                        it, end, l);
+                over++;
+            }
+        }
+
+        bytes += gen.len;
+        lines += (rt_uint32_t)ctx.ngood;
+        marks += (rt_uint32_t)gen.nmarks;
+    }
+
+    if (nlat > 0)
+    {
+        qsort(lat, nlat, sizeof(*lat), cmp_size);
+    }
+    printf("iters=%u bytes=%llu lines=%u/%u clean marks=%u bad_accept=%u "
+           "recoveries=%zu pending=%u\n",
+           iters, (unsigned long long)bytes, lines, clean, marks, ctx.bad_accept,
+           nlat, pending);
+    if (nlat > 0)
+    {
+        printf("latency bytes: min=%zu avg=%llu p99=%zu max=%zu bound=%zu over=%u\n",
+               lat[0], (unsigned long long)(lat_sum / nlat), lat[(nlat - 1) * 99 / 100],
+               lat[nlat - 1], bound, over);
+    }
+
+    free(lat);
+    free(lane0);
+    free(lane1);
+    free(ctx.good);
+    bf30a2_gen_free(&gen);
+
+    if (ctx.failures || over)
+    {
+        printf("FAIL failures=%u over_bound=%u\n", ctx.failures, over);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
+
+#endif /* BF30A2_LIBFUZZER */
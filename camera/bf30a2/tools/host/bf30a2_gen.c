@@ -0,0 +1,120 @@
+/**
+ * @file    bf30a2_gen.c
+ * @brief   Write a synthetic BF30A2 SPI byte stream to a file
+ *
+ * The output can be fed to bf30a2_replay. Corruption is off by default;
+ * with -m the damaged regions are listed as "<start> <end> <kind>" lines.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bf30a2_core.h"
+#include "bf30a2_streamgen.h"
+
+static const char *const kind_name[] = { "drop", "flip", "truncate" };
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [options] -o <stream.bin>\n"
+            "  -w <width>   frame width (default %d)\n"
+            "  -h <height>  frame height (default %d)\n"
+            "  -n <frames>  number of frames (default 1)\n"
+            "  -s <seed>    PRNG seed (default 1)\n"
+            "  -d <ppm>     per byte: drop\n"
+            "  -x <ppm>     per byte: flip one bit\n"
+            "  -t <ppm>     per line: truncate payload\n"
+            "  -D <ppm>     per line: duplicate\n"
+            "  -R <ppm>     per line: swap with next line\n"
+            "  -F <ppm>     per line: insert a 0xFF run into the payload\n"
+            "  -L <len>     0xFF run length (default 8)\n"
+            "  -m <file>    write corruption marks to <file>\n",
+            prog, IMG_WIDTH, IMG_HEIGHT);
+}
+
+int main(int argc, char **argv)
+{
+    bf30a2_gen_cfg_t cfg;
+    bf30a2_gen_t gen;
+    const char *out = NULL;
+    const char *marks = NULL;
+    int frames = 1;
+    FILE *f;
+    size_t i;
+    int opt;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.width = IMG_WIDTH;
+    cfg.height = IMG_HEIGHT;
+    cfg.seed = 1;
+    cfg.ff_run_len = 8;
+
+    while ((opt = getopt(argc, argv, "w:h:n:s:d:x:t:D:R:F:L:o:m:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'w': cfg.width = (uint16_t)strtoul(optarg, NULL, 0); break;
+        case 'h': cfg.height = (uint16_t)strtoul(optarg, NULL, 0); break;
+        case 'n': frames = atoi(optarg); break;
+        case 's': cfg.seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'd': cfg.drop_ppm = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'x': cfg.flip_ppm = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 't': cfg.truncate_ppm = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'D': cfg.duplicate_ppm = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'R': cfg.reorder_ppm = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'F': cfg.ff_run_ppm = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'L': cfg.ff_run_len = (uint16_t)strtoul(optarg, NULL, 0); break;
+        case 'o': out = optarg; break;
+        case 'm': marks = optarg; break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if ((out == NULL) || (cfg.width == 0) || (cfg.width & 1) || (cfg.height == 0))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    bf30a2_gen_init(&gen, &cfg);
+    while (frames-- > 0)
+    {
+        bf30a2_gen_frame(&gen);
+    }
+
+    f = fopen(out, "wb");
+    if ((f == NULL) || (fwrite(gen.data, 1, gen.len, f) != gen.len))
+    {
+        perror(out);
+        return 1;
+    }
+    fclose(f);
+
+    if (marks != NULL)
+    {
+        f = fopen(marks, "w");
+        if (f == NULL)
+        {
+            perror(marks);
+            return 1;
+        }
+        for (i = 0; i < gen.nmarks; i++)
+        {
+            fprintf(f, "%zu %zu %s\n", gen.marks[i].start, gen.marks[i].end,
+                    kind_name[gen.marks[i].kind]);
+        }
+        fclose(f);
+    }
+
+    printf("bytes=%zu lines=%zu marks=%zu\n", gen.len, gen.nlines, gen.nmarks);
+    bf30a2_gen_free(&gen);
+    return 0;
+}
@@ -0,0 +1,893 @@
+/**
+ * @file    bf30a2_sim.c
+ * @brief   Run the unmodified BF30A2 driver against simulated hardware
+ *
+ * src/drv_bf30a2.c is compiled against the host shim and driven through
+ * the normal device lifecycle: register, init, open (PWDN, MCLK, I2C chip
+ * ID and register load, SPI), then START / WAIT_FRAME / read / STOP for a
+ * number of cycles, and close. bf30a2_simhw supplies the sensor and the
+ * SPI slave DMA ring. Reported:
+ *
+ *  - callback latency: last frame byte landing in the ring to the frame
+ *    callback, and to WAIT_FRAME returning (which polls every 10 ms);
+ *  - START, time to first frame, STOP, open and close durations;
+ *  - frames delivered against frames the DMA received whole, with an
+ *    optional sweep of simulated callback work (-S) to find the load at
+ *    which the ring overruns;
+ *  - the load governor level and its steps, with the callback work
+ *    optionally limited to the first frames of a cycle (-u) so both the
+ *    step down and the recovery show up. The sweep runs at a fixed full
+ *    level;
+ *  - with -l, a consumer that leases frames instead of reading them and
+ *    holds two at a time, so frames dropped for want of a free buffer
+ *    show up;
+ *  - with -p, the viewfinder streaming to a simulated LCD of the given
+ *    byte rate: panel frames, rate and frame-to-panel latency, strips
+ *    that waited for the panel, and strips changed while in flight;
+ *  - with -s, three frame subscribers next to the frame callback: a
+ *    full frame callback, a luma queue every third frame drained by the
+ *    consumer loop, and a thumbnail callback every fifteenth frame;
+ *  - with -T, a box-filtered Y8 thumbnail of the given scale with every
+ *    frame, checked on each leased frame and, with -s, by a fourth
+ *    subscriber;
+ *  - with -R, the frame output rotated through the pipeline with luma
+ *    statistics, and the statistics of the last frame;
+ *  - with -C, change detection suppressing frames whose blocks moved no
+ *    more than the threshold, but for the given number (the generated
+ *    scene brightens 4 levels a frame and wraps around in a few blocks),
+ *    and the frames compared, found unchanged and suppressed;
+ *  - the frames converted against those published, fewer with lazy
+ *    conversion (make LAZY=1) when some are never read;
+ *  - with -P, the sensor rate changed to the given fps halfway through
+ *    each cycle, and the frame rate the driver reports at its end, which
+ *    must have followed the step.
+ *
+ * Because the ring is far smaller than a frame, a callback can only be
+ * late by more than one frame time after the ring has already overrun,
+ * so pairing each callback with the most recent frame end is exact for
+ * the runs that matter.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rtthread.h>
+
+#include "drv_bf30a2.h"
+#include "bf30a2_bench.h"
+#include "bf30a2_core.h"
+#include "bf30a2_simhw.h"
+#include "bf30a2_sub.h"
+
+typedef struct
+{
+    rt_uint64_t *v;
+    size_t n;
+    size_t cap;
+} samples_t;
+
+typedef struct
+{
+    samples_t cb_lat;               /* ns, frame end to callback */
+    samples_t wait_lat;             /* ns, frame end to WAIT_FRAME return */
+    volatile rt_uint32_t cb_frames;
+    rt_uint32_t work_us;
+    rt_uint32_t work_frames;        /* Callbacks per cycle given work, 0 = all */
+    rt_uint32_t hold_ms;            /* Lease hold time, 0 = WAIT_FRAME and read */
+    rt_uint8_t vf;                  /* Frames go to the LCD, nothing to wait for */
+    int sub_queue;                  /* Queue subscriber handle, -1 = none */
+    rt_uint32_t sub_bad;            /* Subscriber frames of the wrong shape */
+    rt_uint8_t thumb_scale;         /* Thumbnail decimation, 0 = off */
+    rt_uint32_t thumbs;             /* Thumbnails found with leased frames */
+    rt_uint8_t no_cb;               /* No frame callback, frames counted from the status */
+    rt_uint32_t byte_rate;          /* Sensor byte rate */
+    rt_uint32_t fps;                /* Sensor frame rate at START */
+    rt_uint32_t step_fps;           /* Sensor frame rate from halfway through a cycle, 0 = none */
+} sim_ctx_t;
+
+typedef struct
+{
+    double start_ms;
+    double first_ms;
+    double stop_ms;
+    rt_uint32_t delivered;
+    rt_uint32_t whole;
+    rt_uint32_t errors;
+    rt_uint32_t timeouts;
+    rt_uint32_t irqs;
+    rt_uint32_t stalls;
+    rt_uint32_t skipped;
+    rt_uint32_t bp_dropped;
+    rt_uint32_t fps_milli;
+    rt_uint32_t late;
+    int level;
+    bf30a2_vf_status_t vf;
+    rt_uint32_t lcd_torn;
+} cycle_result_t;
+
+static void samples_add(samples_t *s, rt_uint64_t v)
+{
+    if (s->n == s->cap)
+    {
+        s->cap = s->cap ? s->cap * 2 : 256;
+        s->v = realloc(s->v, s->cap * sizeof(*s->v));
+        if (s->v == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    s->v[s->n++] = v;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    rt_uint64_t x = *(const rt_uint64_t *)a;
+    rt_uint64_t y = *(const rt_uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void samples_print(const char *name, samples_t *s)
+{
+    rt_uint64_t sum = 0;
+    size_t i;
+
+    if (s->n == 0)
+    {
+        printf("%s: no samples\n", name);
+        return;
+    }
+
+    qsort(s->v, s->n, sizeof(*s->v), cmp_u64);
+    for (i = 0; i < s->n; i++)
+    {
+        sum += s->v[i];
+    }
+    printf("%s us: n=%zu min=%.1f avg=%.1f p99=%.1f max=%.1f\n", name, s->n,
+           s->v[0] / 1e3, (double)sum / s->n / 1e3, s->v[(s->n - 1) * 99 / 100] / 1e3,
+           s->v[s->n - 1] / 1e3);
+}
+
+/** @brief Percentile of samples already sorted by samples_print() */
+static rt_uint64_t samples_pct(const samples_t *s, int pct)
+{
+    return (s->n == 0) ? 0 : s->v[(s->n - 1) * pct / 100];
+}
+
+static void bench_add(bf30a2_bench_result_t *r, int *count, const char *name,
+                      const char *unit, rt_uint32_t iters, double value)
+{
+    r[*count].name = name;
+    r[*count].unit = unit;
+    r[*count].iters = iters;
+    r[*count].value_milli = (rt_uint32_t)(value * 1000.0);
+    (*count)++;
+}
+
+static double ms_since(rt_uint64_t t0)
+{
+    return (bf30a2_simhw_now_ns() - t0) / 1e6;
+}
+
+/*============================================================================*/
+/*                     FRAME CALLBACK                                         */
+/*============================================================================*/
+
+static void frame_cb(rt_device_t dev, rt_uint32_t frame_num, rt_uint8_t *buffer,
+                     rt_uint32_t size, void *user_data)
+{
+    sim_ctx_t *ctx = (sim_ctx_t *)user_data;
+    bf30a2_simhw_stats_t st;
+    rt_uint64_t now = bf30a2_simhw_now_ns();
+
+    bf30a2_simhw_get_stats(&st);
+    if ((st.last_end_ns != 0) && (now >= st.last_end_ns))
+    {
+        samples_add(&ctx->cb_lat, now - st.last_end_ns);
+    }
+    ctx->cb_frames++;
+
+    /* Simulated application work in the capture thread */
+    if ((ctx->work_us != 0) && ((ctx->work_frames == 0) || (ctx->cb_frames <= ctx->work_frames)))
+    {
+        rt_uint64_t until = now + (rt_uint64_t)ctx->work_us * 1000;
+
+        while (bf30a2_simhw_now_ns() < until)
+        {
+        }
+    }
+}
+
+/**
+ * @brief Subscriber callback: check the frame is in the format subscribed
+ */
+static void sub_cb(rt_device_t dev, const bf30a2_buffer_t *frame, void *user_data)
+{
+    sim_ctx_t *ctx = (sim_ctx_t *)user_data;
+
+    if ((frame->data == RT_NULL) || (frame->size == 0) ||
+        (frame->size != (rt_uint32_t)frame->width * frame->height *
+                        ((frame->format == BF30A2_FORMAT_Y8) ? 1 : 2)))
+    {
+        ctx->sub_bad++;
+    }
+}
+
+/**
+ * @brief Take every queued subscriber frame and give it back
+ */
+static void sub_drain(rt_device_t dev, sim_ctx_t *ctx)
+{
+    bf30a2_buffer_t buf;
+    bf30a2_sub_wait_t wait = { ctx->sub_queue, 0, &buf };
+
+    while (rt_device_control(dev, BF30A2_CMD_SUB_RECEIVE, &wait) == RT_EOK)
+    {
+        if ((buf.format != BF30A2_FORMAT_Y8) || (buf.size != (rt_uint32_t)buf.width * buf.height))
+        {
+            ctx->sub_bad++;
+        }
+        rt_device_control(dev, BF30A2_CMD_RELEASE_FRAME, &buf);
+    }
+}
+
+/**
+ * @brief Subscribe the display, QR and telemetry consumers
+ */
+static int sub_setup(rt_device_t dev, sim_ctx_t *ctx)
+{
+    bf30a2_sub_cfg_t subs[4] =
+    {
+        { 1,  BF30A2_SUB_RGB565,      BF30A2_SUB_CALLBACK, sub_cb, RT_NULL, -1 },
+        { 3,  BF30A2_SUB_Y8,          BF30A2_SUB_QUEUE,    RT_NULL, RT_NULL, -1 },
+        { 15, BF30A2_SUB_RGB565_HALF, BF30A2_SUB_CALLBACK, sub_cb, RT_NULL, -1 },
+        { 5,  BF30A2_SUB_THUMB,       BF30A2_SUB_CALLBACK, sub_cb, RT_NULL, -1 },
+    };
+    int n = (ctx->thumb_scale != 0) ? 4 : 3;
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        subs[i].user_data = ctx;
+        if ((subs[i].mode == BF30A2_SUB_QUEUE) && (BF30A2_FRAME_BUFFERS < BF30A2_SUB_QUEUE_MIN_BUFFERS))
+        {
+            printf("queue subscriber needs %d frame buffers, skipped (make FRAMES=%d)\n",
+                   BF30A2_SUB_QUEUE_MIN_BUFFERS, BF30A2_SUB_QUEUE_MIN_BUFFERS);
+            continue;
+        }
+        if (rt_device_control(dev, BF30A2_CMD_SUBSCRIBE, &subs[i]) != RT_EOK)
+        {
+            return -1;
+        }
+    }
+    ctx->sub_queue = subs[1].handle;
+
+    return 0;
+}
+
+/*============================================================================*/
+/*                     CAPTURE CYCLE                                          */
+/*============================================================================*/
+
+static void run_cycle(rt_device_t dev, sim_ctx_t *ctx, rt_uint8_t *frame, double seconds,
+                      const char *msh_cmd, cycle_result_t *res)
+{
+    bf30a2_status_info_t status;
+    bf30a2_gov_status_t gov;
+    bf30a2_simhw_stats_t st;
+    bf30a2_wait_cfg_t wait = { 1000, RT_NULL };
+    bf30a2_buffer_t held[2];
+    rt_uint64_t t0, until, step_at;
+    rt_err_t ret;
+    int nheld = 0;
+
+    memset(res, 0, sizeof(*res));
+    memset(&gov, 0, sizeof(gov));
+    bf30a2_simhw_reset_stats();
+    ctx->cb_frames = 0;
+    if (ctx->step_fps != 0)
+    {
+        bf30a2_simhw_set_rate(ctx->byte_rate, ctx->fps);
+    }
+
+    t0 = bf30a2_simhw_now_ns();
+    rt_device_control(dev, BF30A2_CMD_START, RT_NULL);
+    res->start_ms = ms_since(t0);
+
+    res->first_ms = -1;
+    until = t0 + (rt_uint64_t)(seconds * 1e9);
+    step_at = (ctx->step_fps != 0) ? t0 + (rt_uint64_t)(seconds * 0.5e9) : 0;
+    while (bf30a2_simhw_now_ns() < until)
+    {
+        if ((step_at != 0) && (bf30a2_simhw_now_ns() >= step_at))
+        {
+            bf30a2_simhw_set_rate(ctx->byte_rate, ctx->step_fps);
+            step_at = 0;
+        }
+
+        if (ctx->sub_queue >= 0)
+        {
+            sub_drain(dev, ctx);
+        }
+
+        if (ctx->vf)
+        {
+            rt_thread_mdelay(10);
+            continue;
+        }
+
+        if (ctx->hold_ms != 0)
+        {
+            wait.buffer = &held[nheld];
+            ret = rt_device_control(dev, BF30A2_CMD_LEASE_FRAME, &wait);
+        }
+        else
+        {
+            ret = rt_device_control(dev, BF30A2_CMD_WAIT_FRAME, &wait);
+        }
+        if (ret != RT_EOK)
+        {
+            res->timeouts++;
+            continue;
+        }
+
+        bf30a2_simhw_get_stats(&st);
+        if (res->first_ms < 0)
+        {
+            res->first_ms = ms_since(t0);
+        }
+        else if (st.last_end_ns != 0)
+        {
+            samples_add(&ctx->wait_lat, bf30a2_simhw_now_ns() - st.last_end_ns);
+        }
+
+        if ((ctx->hold_ms != 0) && (ctx->thumb_scale != 0))
+        {
+            bf30a2_buffer_t thumb;
+            bf30a2_thumb_t req = { &held[nheld], &thumb };
+
+            if ((rt_device_control(dev, BF30A2_CMD_GET_THUMBNAIL, &req) == RT_EOK) &&
+                (thumb.width == held[nheld].width / ctx->thumb_scale) &&
+                (thumb.size == (rt_uint32_t)thumb.width * thumb.height))
+            {
+                ctx->thumbs++;
+            }
+        }
+
+        if (ctx->hold_ms != 0)
+        {
+            /* Two frames deep, e.g. one on screen and one being drawn */
+            nheld++;
+            rt_thread_mdelay(ctx->hold_ms);
+            if (nheld == 2)
+            {
+                rt_device_control(dev, BF30A2_CMD_RELEASE_FRAME, &held[0]);
+                held[0] = held[1];
+                nheld = 1;
+            }
+            continue;
+        }
+
+        /* Consume the frame so the next WAIT_FRAME blocks */
+        rt_device_read(dev, 0, frame, ONE_FRAME_SIZE);
+    }
+
+    while (nheld > 0)
+    {
+        rt_device_control(dev, BF30A2_CMD_RELEASE_FRAME, &held[--nheld]);
+    }
+    if (ctx->sub_queue >= 0)
+    {
+        sub_drain(dev, ctx);
+    }
+
+    if (msh_cmd != NULL)
+    {
+        rt_host_msh_exec(msh_cmd);
+    }
+
+    /*
+     * Count before STOP: the DMA keeps running through the 150 ms thread
+     * exit wait, and frames landing then are never meant to be delivered.
+     */
+    bf30a2_simhw_get_stats(&st);
+    res->delivered = ctx->cb_frames;
+    res->whole = st.dma_frames;
+    res->lcd_torn = st.lcd_torn;
+    if (ctx->vf)
+    {
+        rt_device_control(dev, BF30A2_CMD_GET_VIEWFINDER, &res->vf);
+        res->delivered = res->vf.frames;
+    }
+    res->irqs = st.irqs;
+    res->stalls = st.host_stalls;
+    rt_device_control(dev, BF30A2_CMD_GET_STATUS, &status);
+    res->bp_dropped = status.bp_dropped;
+    res->fps_milli = status.fps_milli;
+    res->late = status.late_intervals;
+    if (ctx->no_cb)
+    {
+        res->delivered = status.complete_frames;
+    }
+    res->level = -1;
+    if (rt_device_control(dev, BF30A2_CMD_GET_GOVERNOR, &gov) == RT_EOK)
+    {
+        res->level = gov.level;
+    }
+
+    t0 = bf30a2_simhw_now_ns();
+    rt_device_control(dev, BF30A2_CMD_STOP, RT_NULL);
+    res->stop_ms = ms_since(t0);
+
+    rt_device_control(dev, BF30A2_CMD_GET_STATUS, &status);
+    res->errors = status.error_count;
+
+    /*
+     * Skipped and backpressure dropped frames were received whole but never
+     * meant to be delivered
+     */
+    res->skipped = gov.skipped_frames;
+    if (res->whole >= res->skipped + res->bp_dropped)
+    {
+        res->whole -= res->skipped + res->bp_dropped;
+    }
+}
+
+static void print_cycle(const char *label, const cycle_result_t *r)
+{
+    printf("%s start=%.1fms first_frame=%.1fms stop=%.1fms frames=%u/%u errors=%u "
+           "timeouts=%u irqs=%u skipped=%u bp_dropped=%u level=%d host_stalls=%u\n",
+           label, r->start_ms, r->first_ms, r->stop_ms, r->delivered, r->whole, r->errors,
+           r->timeouts, r->irqs, r->skipped, r->bp_dropped, r->level, r->stalls);
+    if (r->vf.enabled)
+    {
+        printf("  panel fps=%u.%03u latency=%uus max=%uus strips=%u stalls=%u timeouts=%u "
+               "torn=%u\n", r->vf.fps_milli / 1000, r->vf.fps_milli % 1000, r->vf.latency_us,
+               r->vf.latency_max_us, r->vf.strips, r->vf.stalls, r->vf.timeouts, r->lcd_torn);
+    }
+}
+
+/*============================================================================*/
+/*                     MAIN                                                   */
+/*============================================================================*/
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -r <bytes/s>  SPI byte rate (default 3000000)\n"
+            "  -f <fps>      sensor frame rate, 0 = back to back (default 15)\n"
+            "  -t <us>       DMA model timer period (default 100)\n"
+            "  -d <sec>      capture time per cycle (default 2)\n"
+            "  -c <n>        START/STOP cycles (default 3)\n"
+            "  -w <us>       simulated work in the frame callback (default 0)\n"
+            "  -u <n>        apply -w to the first n callbacks of each cycle only\n"
+            "  -n            fix the load governor at the full level\n"
+            "  -l <ms>       lease frames and hold each for ms, two at a time\n"
+            "  -N            no frame callback: only the consumer loop reads frames\n"
+            "  -p <bytes/s>  viewfinder mode to a simulated 390x450 LCD of this rate\n"
+            "  -T <scale>    Y8 thumbnail of 1/scale with every frame (2, 4 or 8)\n"
+            "  -R <deg>      rotate the frame output (90, 180, 270) with luma statistics\n"
+            "  -C <levels>[,<blocks>]  suppress frames whose blocks moved at most this\n"
+            "                luma, but for the given number of blocks\n"
+            "  -s            add display, QR (queue) and telemetry frame subscribers\n"
+            "  -S            sweep callback work until frames are lost\n"
+            "  -e <ppm>      bit flip rate in the stream (default 0)\n"
+            "  -g <w>x<h>    sensor window sent in the frame headers (default %dx%d)\n"
+            "  -W <x,y,w,h[,2]>  program this sensor output window after open\n"
+            "  -x <cmd>      run an msh command before the last STOP\n"
+            "  -P <fps>      change the sensor rate to fps halfway through each cycle\n"
+            "  -F            fail a first open with the sensor unplugged and check the\n"
+            "                buffers it took are given back\n"
+            "  -j            also print end-to-end results as benchmark JSON lines\n"
+            "  -v            driver log output\n",
+            prog, IMG_WIDTH, IMG_HEIGHT);
+}
+
+int main(int argc, char **argv)
+{
+    static const rt_uint32_t sweep_us[] =
+    {
+        0, 250, 500, 1000, 1500, 2000, 2500, 3000, 4000, 6000, 8000, 12000, 16000
+    };
+    bf30a2_simhw_cfg_t cfg;
+    bf30a2_simhw_stats_t st;
+    bf30a2_callback_cfg_t cb;
+    bf30a2_gov_status_t gov;
+    bf30a2_info_t info;
+    sim_ctx_t ctx;
+    cycle_result_t res;
+    rt_device_t dev;
+    rt_uint8_t *frame;
+    rt_uint64_t t0;
+    cycle_result_t worst;
+    const char *msh_cmd = NULL;
+    double seconds = 2.0;
+    double open_ms, close_ms;
+    rt_uint32_t heap_setup, heap_capture;
+    rt_uint32_t held_stopped, held_closed;
+    bf30a2_status_info_t status;
+    int cycles = 3;
+    int sweep = 0;
+    int no_gov = 0;
+    int subs = 0;
+    int window = 0;
+    int rotate = 0;
+    bf30a2_window_t win;
+    bf30a2_pipeline_t pipe;
+    bf30a2_frame_stats_t fst;
+    bf30a2_change_cfg_t change = { BF30A2_CHANGE_OFF, 0, 0 };
+    bf30a2_change_info_t chi;
+    int json = 0;
+    int fail_open = 0;
+    int failed = 0;
+    int opt;
+    int i;
+
+    bf30a2_simhw_default_config(&cfg);
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.sub_queue = -1;
+    memset(&worst, 0, sizeof(worst));
+
+    while ((opt = getopt(argc, argv, "r:f:t:d:c:w:u:nl:Np:sT:R:C:Se:g:W:x:P:Fjv")) != -1)
+    {
+        switch (opt)
+        {
+        case 'r': cfg.byte_rate = (rt_uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'f': cfg.fps = (rt_uint32_t)strtoul(optarg, NULL, 0); break;
+        case 't': cfg.tick_us = (rt_uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'd': seconds = atof(optarg); break;
+        case 'c': cycles = atoi(optarg); break;
+        case 'w': ctx.work_us = (rt_uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'u': ctx.work_frames = (rt_uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'n': no_gov = 1; break;
+        case 'l': ctx.hold_ms = (rt_uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'N': ctx.no_cb = 1; break;
+        case 'p':
+            cfg.lcd_name = "lcd";
+            cfg.lcd_byte_rate = (rt_uint32_t)strtoul(optarg, NULL, 0);
+            ctx.vf = 1;
+            break;
+        case 's': subs = 1; break;
+        case 'T': ctx.thumb_scale = (rt_uint8_t)strtoul(optarg, NULL, 0); break;
+        case 'R':
+            memset(&pipe, 0, sizeof(pipe));
+            pipe.rotate = (rt_uint8_t)(strtoul(optarg, NULL, 0) / 90);
+            pipe.stats = 1;
+            rotate = 1;
+            break;
+        case 'C':
+            change.mode = BF30A2_CHANGE_SUPPRESS;
+            if (sscanf(optarg, "%hhu,%hhu", &change.threshold, &change.blocks) < 1)
+            {
+                usage(argv[0]);
+                return 2;
+            }
+            break;
+        case 'S': sweep = 1; break;
+        case 'e': cfg.gen.flip_ppm = (rt_uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'g':
+            if (sscanf(optarg, "%hux%hu", &cfg.gen.width, &cfg.gen.height) != 2)
+            {
+                usage(argv[0]);
+                return 2;
+            }
+            break;
+        case 'W':
+            memset(&win, 0, sizeof(win));
+            win.subsample = 1;
+            if (sscanf(optarg, "%hu,%hu,%hu,%hu,%hhu", &win.x, &win.y, &win.width, &win.height,
+                       &win.subsample) < 4)
+            {
+                usage(argv[0]);
+                return 2;
+            }
+            window = 1;
+            break;
+        case 'x': msh_cmd = optarg; break;
+        case 'P': ctx.step_fps = (rt_uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'F': fail_open = 1; break;
+        case 'j': json = 1; break;
+        case 'v': rt_host_log_level = 3; break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if ((cfg.byte_rate == 0) || (cycles <= 0) || (seconds <= 0))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+    ctx.byte_rate = cfg.byte_rate;
+    ctx.fps = cfg.fps;
+
+    frame = malloc(ONE_FRAME_SIZE);
+    if ((frame == NULL) || (bf30a2_simhw_init(&cfg) != RT_EOK) ||
+        (bf30a2_device_register() != RT_EOK))
+    {
+        fprintf(stderr, "simulation setup failed\n");
+        return 1;
+    }
+
+    dev = rt_device_find(BF30A2_DEVICE_NAME);
+    if ((dev == RT_NULL) || (rt_device_init(dev) != RT_EOK))
+    {
+        fprintf(stderr, "device init failed\n");
+        return 1;
+    }
+
+    /* A failed open keeps nothing: close() is not called for it */
+    if (fail_open)
+    {
+        rt_uint32_t held_before;
+
+        rt_device_control(dev, BF30A2_CMD_GET_STATUS, &status);
+        held_before = status.buffer_bytes;
+        bf30a2_simhw_set_absent(1);
+        if (rt_device_open(dev, RT_DEVICE_FLAG_RDONLY) == RT_EOK)
+        {
+            fprintf(stderr, "open without a sensor succeeded\n");
+            return 1;
+        }
+        bf30a2_simhw_set_absent(0);
+        rt_device_control(dev, BF30A2_CMD_GET_STATUS, &status);
+        printf("failed open: buffers held before=%uB after=%uB\n",
+               held_before, status.buffer_bytes);
+        failed |= (status.buffer_bytes != held_before);
+    }
+
+    t0 = bf30a2_simhw_now_ns();
+    if (rt_device_open(dev, RT_DEVICE_FLAG_RDONLY) != RT_EOK)
+    {
+        fprintf(stderr, "device open failed\n");
+        return 1;
+    }
+    open_ms = ms_since(t0);
+
+    rt_device_control(dev, BF30A2_CMD_GET_INFO, &info);
+    bf30a2_simhw_get_stats(&st);
+    printf("open=%.1fms chip_id=0x%04X mclk=%uHz i2c=%u/%u nak regs[0x13]=0x%02X\n",
+           open_ms, info.chip_id, st.mclk_hz, st.i2c_xfers, st.i2c_naks,
+           bf30a2_simhw_reg(0x13));
+    printf("rate=%uB/s fps=%u ring=%uB (%.2fms to fill) frame=%uB\n",
+           cfg.byte_rate, cfg.fps, DMA_BUFFER_SIZE, DMA_BUFFER_SIZE * 1e3 / cfg.byte_rate,
+           FRAME_STREAM_SIZE(cfg.gen.width, cfg.gen.height));
+
+    cb.callback = ctx.no_cb ? RT_NULL : frame_cb;
+    cb.user_data = &ctx;
+    rt_device_control(dev, BF30A2_CMD_SET_CALLBACK, &cb);
+
+    if (ctx.vf)
+    {
+        bf30a2_vf_cfg_t vf_cfg = { "lcd", 0, 0 };
+
+        if (rt_device_control(dev, BF30A2_CMD_SET_VIEWFINDER, &vf_cfg) != RT_EOK)
+        {
+            fprintf(stderr, "viewfinder setup failed\n");
+            return 1;
+        }
+        printf("viewfinder: lcd %ux%u at %uB/s (%.2fms per full frame)\n",
+               cfg.lcd_width, cfg.lcd_height, cfg.lcd_byte_rate,
+               cfg.gen.width * cfg.gen.height * 2 * 1e3 / cfg.lcd_byte_rate);
+    }
+
+    if (ctx.thumb_scale != 0)
+    {
+        bf30a2_thumb_cfg_t thumb_cfg = { ctx.thumb_scale, BF30A2_FORMAT_Y8 };
+
+        if (rt_device_control(dev, BF30A2_CMD_SET_THUMBNAIL, &thumb_cfg) != RT_EOK)
+        {
+            fprintf(stderr, "thumbnail setup failed\n");
+            return 1;
+        }
+    }
+
+    if (rotate)
+    {
+        if (rt_device_control(dev, BF30A2_CMD_SET_PIPELINE, &pipe) != RT_EOK)
+        {
+            fprintf(stderr, "pipeline setup failed\n");
+            return 1;
+        }
+        printf("pipeline: rotate %u, luma statistics\n", pipe.rotate * 90);
+    }
+
+    if (change.mode != BF30A2_CHANGE_OFF)
+    {
+        rt_device_control(dev, BF30A2_CMD_SET_CHANGE, &change);
+        printf("change detection: suppress at %u levels, %u blocks\n", change.threshold,
+               change.blocks);
+    }
+
+    if (window)
+    {
+        bf30a2_window_status_t wst;
+
+        if (rt_device_control(dev, BF30A2_CMD_SET_WINDOW, &win) != RT_EOK)
+        {
+            fprintf(stderr, "window setup failed\n");
+            return 1;
+        }
+        rt_device_control(dev, BF30A2_CMD_GET_WINDOW, &wst);
+        printf("window: %ux%u at %u,%u /%u -> %ux%u, %uB per frame (saves %uB)\n",
+               wst.window.width, wst.window.height, wst.window.x, wst.window.y,
+               wst.window.subsample, wst.out_width, wst.out_height,
+               (unsigned)FRAME_STREAM_SIZE(wst.out_width, wst.out_height),
+               (unsigned)(FRAME_STREAM_SIZE(BF30A2_DEFAULT_WIDTH, BF30A2_DEFAULT_HEIGHT) -
+                          FRAME_STREAM_SIZE(wst.out_width, wst.out_height)));
+    }
+
+    if (subs && (sub_setup(dev, &ctx) != 0))
+    {
+        fprintf(stderr, "subscriber setup failed\n");
+        return 1;
+    }
+
+    /* The sweep looks for the overrun the governor would otherwise hide */
+    if ((no_gov || sweep) &&
+        (rt_device_control(dev, BF30A2_CMD_GET_GOVERNOR, &gov) == RT_EOK))
+    {
+        gov.cfg.enable = 0;
+        gov.cfg.level = BF30A2_LEVEL_FULL;
+        rt_device_control(dev, BF30A2_CMD_SET_GOVERNOR, &gov.cfg);
+    }
+
+    /* Driver heap use up to here, then by the START/STOP cycles alone */
+    heap_setup = rt_host_heap_allocs;
+
+    if (sweep)
+    {
+        rt_uint32_t last_ok = 0;
+        int found = 0;
+
+        for (i = 0; i < (int)(sizeof(sweep_us) / sizeof(sweep_us[0])); i++)
+        {
+            char label[32];
+
+            ctx.work_us = sweep_us[i];
+            run_cycle(dev, &ctx, frame, seconds, NULL, &res);
+            snprintf(label, sizeof(label), "work=%uus", ctx.work_us);
+            print_cycle(label, &res);
+
+            /* The newest frame may still be waiting for its tail to be fed */
+            if ((res.delivered + 1 < res.whole) || (res.errors != 0))
+            {
+                printf("overrun threshold: callback work between %uus and %uus\n",
+                       last_ok, ctx.work_us);
+                found = 1;
+                break;
+            }
+            last_ok = ctx.work_us;
+        }
+        if (!found)
+        {
+            printf("no overrun up to %uus of callback work\n", last_ok);
+        }
+    }
+    else
+    {
+        for (i = 0; i < cycles; i++)
+        {
+            char label[32];
+
+            run_cycle(dev, &ctx, frame, seconds, (i == cycles - 1) ? msh_cmd : NULL, &res);
+            snprintf(label, sizeof(label), "cycle %d:", i + 1);
+            print_cycle(label, &res);
+            failed |= (res.delivered == 0);
+            if (ctx.step_fps != 0)
+            {
+                /* The reported rate has to follow the step within 10% */
+                printf("  rate step %u -> %u fps: driver fps=%u.%03u late=%u\n", ctx.fps,
+                       ctx.step_fps, res.fps_milli / 1000, res.fps_milli % 1000, res.late);
+                failed |= (res.fps_milli * 10 < ctx.step_fps * 9000) ||
+                          (res.fps_milli * 10 > ctx.step_fps * 11000);
+            }
+
+            worst.start_ms = (res.start_ms > worst.start_ms) ? res.start_ms : worst.start_ms;
+            worst.first_ms = (res.first_ms > worst.first_ms) ? res.first_ms : worst.first_ms;
+            worst.stop_ms = (res.stop_ms > worst.stop_ms) ? res.stop_ms : worst.stop_ms;
+        }
+    }
+
+    heap_capture = rt_host_heap_allocs - heap_setup;
+    rt_device_control(dev, BF30A2_CMD_GET_STATUS, &status);
+    held_stopped = status.buffer_bytes;
+
+    /* Subscriptions end with the close */
+    for (i = 0; subs && (i < BF30A2_MAX_SUBSCRIBERS); i++)
+    {
+        bf30a2_sub_status_t sub;
+
+        sub.handle = i;
+        if (rt_device_control(dev, BF30A2_CMD_GET_SUBSCRIBER, &sub) != RT_EOK)
+        {
+            continue;
+        }
+        printf("subscriber %d: format=%u divisor=%u mode=%s delivered=%u dropped=%u\n",
+               i, sub.cfg.format, sub.cfg.divisor,
+               (sub.cfg.mode == BF30A2_SUB_QUEUE) ? "queue" : "callback",
+               sub.delivered, sub.dropped);
+        failed |= (sub.delivered == 0) && !ctx.vf;
+    }
+    if (subs)
+    {
+        printf("subscriber frames of the wrong shape: %u\n", ctx.sub_bad);
+        failed |= (ctx.sub_bad != 0);
+    }
+    if ((ctx.thumb_scale != 0) && (ctx.hold_ms != 0))
+    {
+        printf("leased frames with a thumbnail: %u\n", ctx.thumbs);
+        failed |= (ctx.thumbs == 0);
+    }
+
+    if (rotate)
+    {
+        rt_device_control(dev, BF30A2_CMD_GET_INFO, &info);
+        rt_device_control(dev, BF30A2_CMD_GET_FRAME_STATS, &fst);
+        printf("frame output: %ux%u\n", info.width, info.height);
+        printf("frame stats: frame %u, %u samples, mean %u, min %u, max %u\n", fst.frame_num,
+               fst.pixels, (fst.pixels != 0) ? fst.luma_sum / fst.pixels : 0,
+               fst.luma_min, fst.luma_max);
+        failed |= (fst.pixels == 0);
+    }
+
+    if (change.mode != BF30A2_CHANGE_OFF)
+    {
+        rt_device_control(dev, BF30A2_CMD_GET_CHANGE, &chi);
+        printf("change detection: compared %u, unchanged %u, suppressed %u\n", chi.frames,
+               chi.unchanged, chi.suppressed);
+        failed |= (chi.unchanged == 0);
+    }
+
+    t0 = bf30a2_simhw_now_ns();
+    rt_device_close(dev);
+    close_ms = ms_since(t0);
+    printf("close=%.1fms\n", close_ms);
+    rt_device_control(dev, BF30A2_CMD_GET_STATUS, &status);
+    held_closed = status.buffer_bytes;
+    printf("heap allocations: setup=%u capture=%u\n", heap_setup, heap_capture);
+    printf("buffers held: stopped=%uB closed=%uB\n", held_stopped, held_closed);
+    printf("frames converted: %u of %u\n", status.converted_frames, status.complete_frames);
+
+    samples_print("callback latency", &ctx.cb_lat);
+    samples_print("wait_frame latency", &ctx.wait_lat);
+    if (rt_device_control(dev, BF30A2_CMD_GET_GOVERNOR, &gov) == RT_EOK)
+    {
+        printf("governor: level=%d steps down=%u up=%u last window cpu=%u%% ring=%u%% peak=%u%%\n",
+               gov.level, gov.step_downs, gov.step_ups, gov.cpu_pct, gov.ring_pct,
+               gov.ring_peak_pct);
+    }
+
+    /* Worst cycle for the lifecycle timings, lower is better throughout */
+    if (json && !sweep)
+    {
+        bf30a2_bench_result_t r[8];
+        int n = 0;
+
+        bench_add(r, &n, "e2e.callback_p50", "us/frame", ctx.cb_lat.n,
+                  samples_pct(&ctx.cb_lat, 50) / 1e3);
+        bench_add(r, &n, "e2e.callback_p99", "us/frame", ctx.cb_lat.n,
+                  samples_pct(&ctx.cb_lat, 99) / 1e3);
+        bench_add(r, &n, "e2e.open", "ms", 1, open_ms);
+        bench_add(r, &n, "e2e.start", "ms", cycles, worst.start_ms);
+        bench_add(r, &n, "e2e.first_frame", "ms", cycles, worst.first_ms);
+        bench_add(r, &n, "e2e.stop", "ms", cycles, worst.stop_ms);
+        bench_add(r, &n, "e2e.close", "ms", 1, close_ms);
+        bf30a2_bench_print("host-sim", r, n);
+    }
+
+    bf30a2_simhw_deinit();
+    free(ctx.cb_lat.v);
+    free(ctx.wait_lat.v);
+    free(frame);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,733 @@
+/**
+ * @file    bf30a2_simhw.c
+ * @brief   Simulated BF30A2 sensor, SPI slave DMA, I2C, PWM and PWDN pin (host)
+ *
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <rtthread.h>
+#include <rtdevice.h>
+
+#include "bf0_hal.h"
+#include "drv_spi.h"
+#include "drv_bf30a2.h"
+#include "bf30a2_simhw.h"
+
+/* Sensor ticks missed in a row that count as a host stall */
+#define BF30A2_SIMHW_STALL_TICKS    10
+
+/* Provided by the driver, called from the transfer "interrupt" */
+extern void camera_rx_ind(rt_uint8_t *p);
+
+/* Layout the driver assumes for the PWM device's user_data */
+struct bf0_pwm
+{
+    struct rt_device_pwm pwm_device;
+    GPT_HandleTypeDef tim_handle;
+    rt_uint8_t channel;
+    char *name;
+    void *pwm_cc_dma[4];
+    void *pwm_update_dma;
+};
+
+typedef struct
+{
+    bf30a2_simhw_cfg_t cfg;
+    pthread_mutex_t lock;
+    pthread_t thread;
+    volatile int quit;
+
+    /* Sensor */
+    rt_uint8_t regs[256];
+    int absent;
+    rt_uint8_t pwdn;
+    rt_uint8_t pwm_enabled;
+    rt_uint8_t gpt_running;
+    bf30a2_gen_t gen;
+    size_t frame_off;
+    rt_uint8_t frame_active;
+    rt_uint8_t frame_whole;         /* DMA ran since the frame started */
+    rt_uint64_t next_frame_ns;
+    rt_uint64_t last_ns;
+    rt_uint64_t last_cpu_ns;
+    double credit;
+
+    /* SPI slave RX DMA */
+    rt_uint8_t *ring;
+    rt_uint32_t ring_size;
+    rt_uint32_t ring_pos;
+    rt_uint8_t dma_running;
+
+    /* LCD panel */
+    const char *lcd_src;            /* Rectangle in flight, NULL = idle */
+    rt_uint8_t *lcd_copy;           /* Its pixels when it was started */
+    rt_uint32_t lcd_len;
+    rt_uint64_t lcd_done_ns;
+    int lcd_window[4];
+
+    bf30a2_simhw_stats_t stats;
+} simhw_t;
+
+static simhw_t g_sim;
+
+static struct rt_device g_pin_dev;
+static struct bf0_pwm g_pwm;
+static struct rt_i2c_bus_device g_i2c_bus;
+static DMA_Channel_TypeDef g_dma_ch;
+static struct sifli_spi g_spi;
+static struct rt_device g_lcd_dev;
+
+uint32_t SystemCoreClock = 240000000;
+GPT_TypeDef bf30a2_host_gptim1;
+GPT_TypeDef bf30a2_host_gptim2;
+
+rt_uint64_t bf30a2_simhw_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (rt_uint64_t)ts.tv_sec * 1000000000ULL + (rt_uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief CPU time of the whole process, all threads
+ */
+static rt_uint64_t process_cpu_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (rt_uint64_t)ts.tv_sec * 1000000000ULL + (rt_uint64_t)ts.tv_nsec;
+}
+
+static int sensor_clocked(void)
+{
+    return (g_sim.pwdn == 0) && g_sim.pwm_enabled && g_sim.gpt_running;
+}
+
+/*============================================================================*/
+/*                     HAL STUBS                                              */
+/*============================================================================*/
+
+int HAL_PIN_Set(int pad, int func, int flags, int core)
+{
+    return 0;
+}
+
+uint32_t HAL_RCC_GetPCLKFreq(int core, int is_pclk1)
+{
+    return 120000000;
+}
+
+HAL_StatusTypeDef HAL_GPT_PWM_Stop(GPT_HandleTypeDef *htim, uint32_t channel)
+{
+    pthread_mutex_lock(&g_sim.lock);
+    g_sim.gpt_running = 0;
+    pthread_mutex_unlock(&g_sim.lock);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_GPT_PWM_Start(GPT_HandleTypeDef *htim, uint32_t channel)
+{
+    pthread_mutex_lock(&g_sim.lock);
+    g_sim.gpt_running = 1;
+    pthread_mutex_unlock(&g_sim.lock);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_GPT_PWM_ConfigChannel(GPT_HandleTypeDef *htim,
+                                            GPT_OC_InitTypeDef *config, uint32_t channel)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_GPT_GenerateEvent(GPT_HandleTypeDef *htim, uint32_t source)
+{
+    return HAL_OK;
+}
+
+/*============================================================================*/
+/*                     PIN AND PWM DEVICES                                    */
+/*============================================================================*/
+
+static rt_err_t pin_control(rt_device_t dev, int cmd, void *args)
+{
+    return RT_EOK;
+}
+
+static rt_size_t pin_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+    const struct rt_device_pin_status *st = (const struct rt_device_pin_status *)buffer;
+
+    if ((st == RT_NULL) || (size < sizeof(*st)))
+    {
+        return 0;
+    }
+
+    if (st->pin == BF30A2_SIM_PWDN_PIN)
+    {
+        pthread_mutex_lock(&g_sim.lock);
+        g_sim.pwdn = st->status ? 1 : 0;
+        pthread_mutex_unlock(&g_sim.lock);
+    }
+    return size;
+}
+
+static rt_err_t pwm_control(rt_device_t dev, int cmd, void *args)
+{
+    pthread_mutex_lock(&g_sim.lock);
+    if (cmd == PWM_CMD_ENABLE)
+    {
+        g_sim.pwm_enabled = 1;
+        g_sim.gpt_running = 1;
+    }
+    else if (cmd == PWM_CMD_DISABLE)
+    {
+        g_sim.pwm_enabled = 0;
+    }
+    pthread_mutex_unlock(&g_sim.lock);
+    return RT_EOK;
+}
+
+/*============================================================================*/
+/*                     I2C REGISTER FILE                                      */
+/*============================================================================*/
+
+static void regs_reset(void)
+{
+    memset(g_sim.regs, 0, sizeof(g_sim.regs));
+    g_sim.regs[0xFC] = 0x3B;        /* Chip ID */
+    g_sim.regs[0xFD] = 0x02;
+}
+
+static void reg_write(rt_uint8_t reg, rt_uint8_t val)
+{
+    if ((reg == 0xFC) || (reg == 0xFD))
+    {
+        return;
+    }
+    if ((reg == 0xF2) && (val & 0x01))
+    {
+        regs_reset();               /* Soft reset, self clearing */
+        return;
+    }
+    g_sim.regs[reg] = val;
+}
+
+/**
+ * @brief Register pointer write followed by auto-incrementing data
+ *
+ * Like the sensor, nothing is acknowledged while it is powered down,
+ * without MCLK or while it is marked absent.
+ */
+static rt_size_t i2c_xfer(struct rt_i2c_bus_device *bus, struct rt_i2c_msg msgs[],
+                          rt_uint32_t num)
+{
+    rt_uint8_t ptr = 0;
+    rt_uint32_t i;
+    rt_uint16_t j;
+
+    pthread_mutex_lock(&g_sim.lock);
+
+    if (!sensor_clocked() || g_sim.absent)
+    {
+        g_sim.stats.i2c_naks++;
+        pthread_mutex_unlock(&g_sim.lock);
+        return 0;
+    }
+
+    for (i = 0; i < num; i++)
+    {
+        if (msgs[i].addr != BF30A2_SIM_I2C_ADDR)
+        {
+            g_sim.stats.i2c_naks++;
+            break;
+        }
+
+        if (msgs[i].flags & RT_I2C_RD)
+        {
+            for (j = 0; j < msgs[i].len; j++)
+            {
+                msgs[i].buf[j] = g_sim.regs[ptr++];
+            }
+        }
+        else if (msgs[i].len > 0)
+        {
+            ptr = msgs[i].buf[0];
+            for (j = 1; j < msgs[i].len; j++)
+            {
+                reg_write(ptr++, msgs[i].buf[j]);
+            }
+        }
+    }
+    g_sim.stats.i2c_xfers += (i == num);
+
+    pthread_mutex_unlock(&g_sim.lock);
+    return i;
+}
+
+static const struct rt_i2c_bus_device_ops g_i2c_ops =
+{
+    .master_xfer = i2c_xfer,
+};
+
+rt_uint8_t bf30a2_simhw_reg(rt_uint8_t reg)
+{
+    rt_uint8_t val;
+
+    pthread_mutex_lock(&g_sim.lock);
+    val = g_sim.regs[reg];
+    pthread_mutex_unlock(&g_sim.lock);
+    return val;
+}
+
+/*============================================================================*/
+/*                     SPI SLAVE DMA                                          */
+/*============================================================================*/
+
+rt_err_t rt_hw_spi_device_attach(const char *bus_name, const char *device_name)
+{
+    struct rt_spi_device *spi_dev;
+    rt_device_t bus = rt_device_find(bus_name);
+
+    if ((bus == RT_NULL) || (bus->type != RT_Device_Class_SPIBUS))
+    {
+        return -RT_ERROR;
+    }
+
+    spi_dev = calloc(1, sizeof(*spi_dev));
+    if (spi_dev == RT_NULL)
+    {
+        return -RT_ENOMEM;
+    }
+    spi_dev->bus = (struct rt_spi_bus *)bus;
+    spi_dev->parent.type = RT_Device_Class_SPIDevice;
+
+    return rt_device_register(&spi_dev->parent, device_name, RT_DEVICE_FLAG_RDWR);
+}
+
+int camera_start_dma(SPI_HandleTypeDef *hspi, uint8_t *buffer, uint32_t size)
+{
+    if ((hspi == RT_NULL) || (buffer == RT_NULL) || (size < 2))
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&g_sim.lock);
+    g_sim.ring = buffer;
+    g_sim.ring_size = size;
+    g_sim.ring_pos = 0;
+    g_dma_ch.CNDTR = size;
+    g_sim.dma_running = 1;
+    g_sim.frame_whole = 0;          /* A frame already on the wire is cut */
+    pthread_mutex_unlock(&g_sim.lock);
+
+    return 0;
+}
+
+void camera_stop_dma(SPI_HandleTypeDef *hspi)
+{
+    pthread_mutex_lock(&g_sim.lock);
+    g_sim.dma_running = 0;
+    pthread_mutex_unlock(&g_sim.lock);
+}
+
+/**
+ * @brief Circular DMA write with half/full transfer interrupts
+ */
+static void dma_write(const rt_uint8_t *data, size_t len)
+{
+    rt_uint32_t half = g_sim.ring_size / 2;
+
+    while (len > 0)
+    {
+        rt_uint32_t mark = (g_sim.ring_pos < half) ? half : g_sim.ring_size;
+        rt_uint32_t n = mark - g_sim.ring_pos;
+
+        if (n > len)
+        {
+            n = (rt_uint32_t)len;
+        }
+        memcpy(g_sim.ring + g_sim.ring_pos, data, n);
+        g_sim.ring_pos += n;
+        data += n;
+        len -= n;
+        g_sim.stats.dma_bytes += n;
+
+        if (g_sim.ring_pos == g_sim.ring_size)
+        {
+            g_sim.ring_pos = 0;     /* Circular mode reloads the counter */
+        }
+        g_dma_ch.CNDTR = g_sim.ring_size - g_sim.ring_pos;
+
+        if (g_sim.ring_pos == half || g_sim.ring_pos == 0)
+        {
+            g_sim.stats.irqs++;
+            camera_rx_ind(g_sim.ring);
+        }
+    }
+}
+
+/*============================================================================*/
+/*                     LCD PANEL                                              */
+/*============================================================================*/
+
+static rt_err_t lcd_control(rt_device_t dev, int cmd, void *args)
+{
+    struct rt_device_graphic_info *info = (struct rt_device_graphic_info *)args;
+
+    if ((cmd != RTGRAPHIC_CTRL_GET_INFO) || (info == RT_NULL))
+    {
+        return -RT_ENOSYS;
+    }
+
+    memset(info, 0, sizeof(*info));
+    info->pixel_format = RTGRAPHIC_PIXEL_FORMAT_RGB565;
+    info->bits_per_pixel = 16;
+    info->width = g_sim.cfg.lcd_width;
+    info->height = g_sim.cfg.lcd_height;
+    return RT_EOK;
+}
+
+static void lcd_set_window(int x0, int y0, int x1, int y1)
+{
+    pthread_mutex_lock(&g_sim.lock);
+    g_sim.lcd_window[0] = x0;
+    g_sim.lcd_window[1] = y0;
+    g_sim.lcd_window[2] = x1;
+    g_sim.lcd_window[3] = y1;
+    pthread_mutex_unlock(&g_sim.lock);
+}
+
+/**
+ * @brief Start a rectangle transfer; the panel reads the pixels until done
+ */
+static void lcd_draw_rect_async(const char *pixel, int x0, int y0, int x1, int y1)
+{
+    rt_uint32_t len = (rt_uint32_t)((x1 - x0 + 1) * (y1 - y0 + 1) * 2);
+    rt_uint64_t now = bf30a2_simhw_now_ns();
+
+    pthread_mutex_lock(&g_sim.lock);
+    if (g_sim.lcd_src != NULL)
+    {
+        g_sim.stats.lcd_overlaps++;
+    }
+
+    g_sim.lcd_copy = realloc(g_sim.lcd_copy, len);
+    memcpy(g_sim.lcd_copy, pixel, len);
+    g_sim.lcd_src = pixel;
+    g_sim.lcd_len = len;
+    g_sim.lcd_done_ns = now + (rt_uint64_t)len * 1000000000ULL / g_sim.cfg.lcd_byte_rate;
+    pthread_mutex_unlock(&g_sim.lock);
+}
+
+static struct rt_device_graphic_ops g_lcd_ops =
+{
+    .set_window = lcd_set_window,
+    .draw_rect_async = lcd_draw_rect_async,
+};
+
+/**
+ * @brief Complete the rectangle in flight, the panel "interrupt"
+ */
+static void lcd_step(rt_uint64_t now)
+{
+    const char *src = g_sim.lcd_src;
+
+    if ((src == NULL) || (now < g_sim.lcd_done_ns))
+    {
+        return;
+    }
+
+    if (memcmp(g_sim.lcd_copy, src, g_sim.lcd_len) != 0)
+    {
+        g_sim.stats.lcd_torn++;
+    }
+    g_sim.stats.lcd_rects++;
+    g_sim.stats.lcd_bytes += g_sim.lcd_len;
+    g_sim.lcd_src = NULL;
+
+    if (g_lcd_dev.tx_complete != RT_NULL)
+    {
+        g_lcd_dev.tx_complete(&g_lcd_dev, (void *)src);
+    }
+}
+
+/*============================================================================*/
+/*                     SENSOR THREAD                                          */
+/*============================================================================*/
+
+/**
+ * @brief Latch the output window registers at the frame start
+ *
+ * Start/stop 0x17..0x1A in units of 2, 0x1B bit 0 subsamples by 2. Until
+ * a window is written the sensor sends the configured geometry.
+ */
+static void sensor_window(void)
+{
+    int w = (g_sim.regs[0x18] - g_sim.regs[0x17]) * 2;
+    int h = (g_sim.regs[0x1A] - g_sim.regs[0x19]) * 2;
+    int sub = (g_sim.regs[0x1B] & 0x01) ? 2 : 1;
+
+    if ((g_sim.regs[0x18] == 0) || (w <= 0) || (h <= 0))
+    {
+        g_sim.gen.cfg.width = g_sim.cfg.gen.width;
+        g_sim.gen.cfg.height = g_sim.cfg.gen.height;
+        return;
+    }
+    g_sim.gen.cfg.width = (uint16_t)(w / sub);
+    g_sim.gen.cfg.height = (uint16_t)(h / sub);
+}
+
+static void sensor_step(rt_uint64_t now)
+{
+    double rate = (double)g_sim.cfg.byte_rate;
+    rt_uint64_t period = g_sim.cfg.fps ? 1000000000ULL / g_sim.cfg.fps : 0;
+    rt_uint64_t stall = (rt_uint64_t)g_sim.cfg.tick_us * 1000 * BF30A2_SIMHW_STALL_TICKS;
+    rt_uint64_t dt;
+    rt_uint64_t cpu;
+
+    if (!sensor_clocked())
+    {
+        g_sim.frame_active = 0;
+        g_sim.credit = 0;
+        g_sim.next_frame_ns = now;
+        g_sim.last_ns = now;
+        g_sim.last_cpu_ns = process_cpu_ns();
+        return;
+    }
+
+    /*
+     * A late tick during which the process hardly ran means the host
+     * descheduled all of it, the capture thread included. A real DMA would
+     * not burst the missed time into the ring at once, so the sensor clock
+     * stops for such a stall. A tick made late by a busy driver thread is
+     * kept: that is the load the driver has to cope with.
+     */
+    cpu = process_cpu_ns();
+    dt = now - g_sim.last_ns;
+    if ((dt > stall) && ((cpu - g_sim.last_cpu_ns) * 2 < dt))
+    {
+        g_sim.stats.host_stalls++;
+        dt = (rt_uint64_t)g_sim.cfg.tick_us * 1000;
+    }
+    g_sim.credit += (double)dt * rate / 1e9;
+    g_sim.last_ns = now;
+    g_sim.last_cpu_ns = cpu;
+
+    while (g_sim.credit >= 1.0)
+    {
+        size_t n;
+
+        if (!g_sim.frame_active)
+        {
+            if (now < g_sim.next_frame_ns)
+            {
+                g_sim.credit = 0;   /* Vertical blanking: SPI clock idle */
+                break;
+            }
+
+            sensor_window();
+            bf30a2_gen_clear(&g_sim.gen);
+            bf30a2_gen_frame(&g_sim.gen);
+            g_sim.frame_off = 0;
+            g_sim.frame_active = 1;
+            g_sim.frame_whole = g_sim.dma_running;
+            g_sim.next_frame_ns += period;
+            if (g_sim.next_frame_ns < now)
+            {
+                g_sim.next_frame_ns = now;
+            }
+        }
+
+        n = g_sim.gen.len - g_sim.frame_off;
+        if ((double)n > g_sim.credit)
+        {
+            n = (size_t)g_sim.credit;
+        }
+
+        if (g_sim.dma_running)
+        {
+            dma_write(g_sim.gen.data + g_sim.frame_off, n);
+        }
+        else
+        {
+            g_sim.frame_whole = 0;
+        }
+        g_sim.frame_off += n;
+        g_sim.credit -= (double)n;
+        g_sim.stats.sensor_bytes += n;
+
+        if (g_sim.frame_off == g_sim.gen.len)
+        {
+            g_sim.frame_active = 0;
+            g_sim.stats.sensor_frames++;
+            if (g_sim.frame_whole && g_sim.dma_running)
+            {
+                g_sim.stats.dma_frames++;
+                /* The last byte landed before the unspent credit accrued */
+                g_sim.stats.last_end_ns = now - (rt_uint64_t)(g_sim.credit * 1e9 / rate);
+            }
+        }
+    }
+}
+
+static void *sensor_thread(void *arg)
+{
+    struct timespec next;
+    rt_uint64_t tick_ns = (rt_uint64_t)g_sim.cfg.tick_us * 1000;
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (!g_sim.quit)
+    {
+        next.tv_nsec += (long)tick_ns;
+        while (next.tv_nsec >= 1000000000L)
+        {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
+        }
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR)
+        {
+        }
+
+        pthread_mutex_lock(&g_sim.lock);
+        sensor_step(bf30a2_simhw_now_ns());
+        lcd_step(bf30a2_simhw_now_ns());
+        pthread_mutex_unlock(&g_sim.lock);
+    }
+    return NULL;
+}
+
+/*============================================================================*/
+/*                     SETUP                                                  */
+/*============================================================================*/
+
+void bf30a2_simhw_default_config(bf30a2_simhw_cfg_t *cfg)
+{
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->spi_bus_name = "spi2";
+    cfg->i2c_bus_name = "i2c2";
+    cfg->pwm_dev_name = "pwm2";
+    cfg->byte_rate = 24000000 / 8;
+    cfg->fps = 15;
+    cfg->tick_us = 100;
+    cfg->gen.width = BF30A2_DEFAULT_WIDTH;
+    cfg->gen.height = BF30A2_DEFAULT_HEIGHT;
+    cfg->gen.seed = 1;
+    cfg->gen.ff_run_len = 8;
+    cfg->lcd_byte_rate = 20000000;
+    cfg->lcd_width = 390;
+    cfg->lcd_height = 450;
+}
+
+rt_err_t bf30a2_simhw_init(const bf30a2_simhw_cfg_t *cfg)
+{
+    memset(&g_sim, 0, sizeof(g_sim));
+    g_sim.cfg = *cfg;
+    if (g_sim.cfg.tick_us == 0)
+    {
+        g_sim.cfg.tick_us = 100;
+    }
+
+    pthread_mutex_init(&g_sim.lock, NULL);
+
+    regs_reset();
+    g_sim.pwdn = 1;
+    bf30a2_gen_init(&g_sim.gen, &g_sim.cfg.gen);
+
+    g_pin_dev.type = RT_Device_Class_Miscellaneous;
+    g_pin_dev.control = pin_control;
+    g_pin_dev.write = pin_write;
+
+    g_pwm.pwm_device.parent.type = RT_Device_Class_Miscellaneous;
+    g_pwm.pwm_device.parent.control = pwm_control;
+    g_pwm.pwm_device.parent.user_data = &g_pwm;
+    g_pwm.tim_handle.Instance = hwp_gptim1;
+
+    g_i2c_bus.parent.type = RT_Device_Class_I2CBUS;
+    g_i2c_bus.ops = &g_i2c_ops;
+
+    g_spi.dma_rx.Instance = &g_dma_ch;
+    g_spi.handle.hdmarx = &g_spi.dma_rx;
+    g_spi.spi_bus.parent.type = RT_Device_Class_SPIBUS;
+
+    if ((rt_device_register(&g_pin_dev, "pin", RT_DEVICE_FLAG_RDWR) != RT_EOK) ||
+        (rt_device_register(&g_pwm.pwm_device.parent, cfg->pwm_dev_name,
+                            RT_DEVICE_FLAG_RDWR) != RT_EOK) ||
+        (rt_device_register(&g_i2c_bus.parent, cfg->i2c_bus_name,
+                            RT_DEVICE_FLAG_RDWR) != RT_EOK) ||
+        (rt_device_register(&g_spi.spi_bus.parent, cfg->spi_bus_name,
+                            RT_DEVICE_FLAG_RDWR) != RT_EOK))
+    {
+        return -RT_ERROR;
+    }
+
+    if (cfg->lcd_name != NULL)
+    {
+        g_lcd_dev.type = RT_Device_Class_Graphic;
+        g_lcd_dev.control = lcd_control;
+        g_lcd_dev.user_data = &g_lcd_ops;
+        if ((g_sim.cfg.lcd_byte_rate == 0) ||
+            (rt_device_register(&g_lcd_dev, cfg->lcd_name, RT_DEVICE_FLAG_RDWR) != RT_EOK))
+        {
+            return -RT_ERROR;
+        }
+    }
+
+    if (pthread_create(&g_sim.thread, NULL, sensor_thread, NULL) != 0)
+    {
+        return -RT_ERROR;
+    }
+    return RT_EOK;
+}
+
+void bf30a2_simhw_deinit(void)
+{
+    g_sim.quit = 1;
+    pthread_join(g_sim.thread, NULL);
+    bf30a2_gen_free(&g_sim.gen);
+    free(g_sim.lcd_copy);
+}
+
+void bf30a2_simhw_set_rate(rt_uint32_t byte_rate, rt_uint32_t fps)
+{
+    pthread_mutex_lock(&g_sim.lock);
+    g_sim.cfg.byte_rate = byte_rate;
+    g_sim.cfg.fps = fps;
+    pthread_mutex_unlock(&g_sim.lock);
+}
+
+void bf30a2_simhw_set_absent(int absent)
+{
+    pthread_mutex_lock(&g_sim.lock);
+    g_sim.absent = absent;
+    pthread_mutex_unlock(&g_sim.lock);
+}
+
+void bf30a2_simhw_get_stats(bf30a2_simhw_stats_t *stats)
+{
+    GPT_TypeDef *tim = g_pwm.tim_handle.Instance;
+
+    pthread_mutex_lock(&g_sim.lock);
+    *stats = g_sim.stats;
+    stats->pwdn = g_sim.pwdn;
+    stats->dma_running = g_sim.dma_running;
+    stats->mclk_hz = (g_sim.pwm_enabled && g_sim.gpt_running) ?
+                     HAL_RCC_GetPCLKFreq(0, 1) / ((tim->PSC + 1) * (tim->ARR + 1)) : 0;
+    pthread_mutex_unlock(&g_sim.lock);
+}
+
+void bf30a2_simhw_reset_stats(void)
+{
+    pthread_mutex_lock(&g_sim.lock);
+    memset(&g_sim.stats, 0, sizeof(g_sim.stats));
+    pthread_mutex_unlock(&g_sim.lock);
+}
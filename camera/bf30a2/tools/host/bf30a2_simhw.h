@@ -0,0 +1,108 @@
+/**
+ * @file    bf30a2_simhw.h
+ * @brief   Simulated BF30A2 sensor, SPI slave DMA, I2C, PWM and PWDN pin (host)
+ *
+ * Registers the "pin", PWM, I2C bus and SPI bus devices the driver looks
+ * up, and provides camera_start_dma()/camera_stop_dma(). A sensor thread
+ * produces the SPI stream at a fixed byte rate while PWDN is low and MCLK
+ * runs; while the DMA is started the bytes land in the driver's ring, the
+ * channel counter (CNDTR) counts down, and camera_rx_ind() is called at
+ * the half and full marks just like the transfer interrupts.
+ *
+ * Optionally an RGB565 LCD graphic device is registered too: a rectangle
+ * given to draw_rect_async() takes its size over the panel byte rate to
+ * transfer, then tx_complete is called from the sensor thread. Writes to
+ * a rectangle's pixels before it completed are counted as tearing.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_SIMHW_H__
+#define __BF30A2_SIMHW_H__
+
+#include <rtthread.h>
+
+#include "bf30a2_streamgen.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Sensor I2C address and PWDN pin, matching the driver defaults */
+#define BF30A2_SIM_I2C_ADDR         0x6E
+#define BF30A2_SIM_PWDN_PIN         43
+
+/**
+ * @brief Simulation configuration
+ */
+typedef struct bf30a2_simhw_cfg
+{
+    const char *spi_bus_name;       /**< SPI bus to register ("spi2") */
+    const char *i2c_bus_name;       /**< I2C bus to register ("i2c2") */
+    const char *pwm_dev_name;       /**< PWM device to register ("pwm2") */
+
+    rt_uint32_t byte_rate;          /**< SPI bytes per second while a frame is sent */
+    rt_uint32_t fps;                /**< Frame start rate, 0 = back to back */
+    rt_uint32_t tick_us;            /**< DMA model timer period */
+    bf30a2_gen_cfg_t gen;           /**< Stream content and corruption */
+
+    const char *lcd_name;           /**< LCD device to register, NULL = none */
+    rt_uint32_t lcd_byte_rate;      /**< Panel transfer bytes per second */
+    rt_uint16_t lcd_width;          /**< Panel width */
+    rt_uint16_t lcd_height;         /**< Panel height */
+} bf30a2_simhw_cfg_t;
+
+/**
+ * @brief Simulation counters
+ */
+typedef struct bf30a2_simhw_stats
+{
+    rt_uint64_t sensor_bytes;       /**< Bytes put on the wire */
+    rt_uint64_t dma_bytes;          /**< Bytes written into the DMA ring */
+    rt_uint32_t sensor_frames;      /**< Frames sent */
+    rt_uint32_t dma_frames;         /**< Frames received whole while the DMA ran */
+    rt_uint32_t irqs;               /**< Half/full transfer callbacks */
+    rt_uint32_t host_stalls;        /**< Sensor ticks the host ran too late to keep real time */
+    rt_uint32_t i2c_xfers;          /**< I2C transfers acknowledged */
+    rt_uint32_t i2c_naks;           /**< I2C transfers not acknowledged */
+    rt_uint64_t last_end_ns;        /**< When the last whole frame finished landing in the ring */
+    rt_uint32_t mclk_hz;            /**< MCLK from the timer registers, 0 = off */
+    rt_uint8_t pwdn;                /**< PWDN pin level */
+    rt_uint8_t dma_running;         /**< camera_start_dma() active */
+
+    rt_uint32_t lcd_rects;          /**< Rectangles transferred to the panel */
+    rt_uint64_t lcd_bytes;          /**< Bytes transferred to the panel */
+    rt_uint32_t lcd_overlaps;       /**< Rectangles started while one was in flight */
+    rt_uint32_t lcd_torn;           /**< Rectangles whose pixels changed in flight */
+} bf30a2_simhw_stats_t;
+
+/** @brief Fill cfg with the driver's default names and a 24 MHz SPI clock, no LCD */
+void bf30a2_simhw_default_config(bf30a2_simhw_cfg_t *cfg);
+
+/** @brief Register the devices and start the sensor thread */
+rt_err_t bf30a2_simhw_init(const bf30a2_simhw_cfg_t *cfg);
+
+/** @brief Stop the sensor thread */
+void bf30a2_simhw_deinit(void);
+
+void bf30a2_simhw_get_stats(bf30a2_simhw_stats_t *stats);
+void bf30a2_simhw_reset_stats(void);
+
+/** @brief Change the byte and frame rate while running */
+void bf30a2_simhw_set_rate(rt_uint32_t byte_rate, rt_uint32_t fps);
+
+/** @brief Stop (1) or resume (0) acknowledging I2C, as if the sensor were unplugged */
+void bf30a2_simhw_set_absent(int absent);
+
+/** @brief Current register file content */
+rt_uint8_t bf30a2_simhw_reg(rt_uint8_t reg);
+
+/** @brief CLOCK_MONOTONIC in ns, the time base of the counters */
+rt_uint64_t bf30a2_simhw_now_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BF30A2_SIMHW_H__ */
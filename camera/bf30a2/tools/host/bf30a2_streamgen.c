@@ -0,0 +1,283 @@
+/**
+ * @file    bf30a2_streamgen.c
+ * @brief   Synthetic BF30A2 SPI protocol stream generator (host)
+ *
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bf30a2_streamgen.h"
+
+/*============================================================================*/
+/*                     HELPERS                                                */
+/*============================================================================*/
+
+uint32_t bf30a2_gen_rand(uint32_t *state)
+{
+    uint32_t x = *state ? *state : 0x9E3779B9u;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+uint32_t bf30a2_gen_crc(const uint8_t *data, size_t len)
+{
+    uint32_t h = 0x811C9DC5u;
+    size_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        h ^= data[i];
+        h *= 0x01000193u;
+    }
+    return h;
+}
+
+/**
+ * @brief Diagonal luma gradient with slowly varying chroma
+ */
+uint8_t bf30a2_gen_pixel(uint32_t frame, uint16_t line, uint32_t offset)
+{
+    uint32_t x = offset >> 1;
+
+    if ((offset & 1) == 0)
+    {
+        return (uint8_t)(x + line + frame * 4);
+    }
+    if ((offset & 3) == 1)
+    {
+        return (uint8_t)(96 + ((line >> 2) & 0x3F));
+    }
+    return (uint8_t)(96 + ((x >> 2) & 0x3F));
+}
+
+static int chance(bf30a2_gen_t *gen, uint32_t ppm)
+{
+    return (ppm != 0) && ((bf30a2_gen_rand(&gen->rng) % BF30A2_GEN_PPM) < ppm);
+}
+
+static void *grow(void *ptr, size_t *cap, size_t need, size_t elem)
+{
+    size_t n = *cap ? *cap : 64;
+
+    if (need <= *cap)
+    {
+        return ptr;
+    }
+    while (n < need)
+    {
+        n *= 2;
+    }
+    ptr = realloc(ptr, n * elem);
+    if (ptr == NULL)
+    {
+        fprintf(stderr, "streamgen: out of memory\n");
+        exit(1);
+    }
+    *cap = n;
+    return ptr;
+}
+
+static void add_mark(bf30a2_gen_t *gen, size_t start, size_t end, bf30a2_gen_kind_t kind)
+{
+    gen->marks = grow(gen->marks, &gen->marks_cap, gen->nmarks + 1, sizeof(*gen->marks));
+    gen->marks[gen->nmarks].start = start;
+    gen->marks[gen->nmarks].end = end;
+    gen->marks[gen->nmarks].kind = (uint8_t)kind;
+    gen->nmarks++;
+    gen->damage = 1;
+}
+
+/**
+ * @brief Append one byte, subject to byte-level corruption
+ */
+static void put(bf30a2_gen_t *gen, uint8_t b)
+{
+    if (chance(gen, gen->cfg.drop_ppm))
+    {
+        add_mark(gen, gen->len, gen->len, BF30A2_GEN_DROP);
+        return;
+    }
+    if (chance(gen, gen->cfg.flip_ppm))
+    {
+        b ^= (uint8_t)(1u << (bf30a2_gen_rand(&gen->rng) & 7));
+        add_mark(gen, gen->len, gen->len + 1, BF30A2_GEN_FLIP);
+    }
+
+    gen->data = grow(gen->data, &gen->cap, gen->len + 1, 1);
+    gen->data[gen->len++] = b;
+}
+
+static void put_sync(bf30a2_gen_t *gen, uint8_t type)
+{
+    put(gen, 0xFF);
+    put(gen, 0xFF);
+    put(gen, 0xFF);
+    put(gen, type);
+}
+
+/*============================================================================*/
+/*                     STREAM EMISSION                                        */
+/*============================================================================*/
+
+static void emit_line(bf30a2_gen_t *gen, uint32_t frame, uint16_t line)
+{
+    uint32_t size = (uint32_t)gen->cfg.width * 2;
+    uint32_t send = size;
+    size_t hdr_start = gen->len;
+    size_t payload_start;
+    bf30a2_gen_line_t *rec;
+    uint32_t run_at = size;
+    uint32_t i;
+
+    gen->damage = 0;
+
+    if (chance(gen, gen->cfg.ff_run_ppm) && (gen->cfg.ff_run_len > 0))
+    {
+        run_at = bf30a2_gen_rand(&gen->rng) % size;
+    }
+    if (chance(gen, gen->cfg.truncate_ppm))
+    {
+        send = bf30a2_gen_rand(&gen->rng) % size;
+    }
+
+    put_sync(gen, 0x02);
+    put(gen, (uint8_t)(line >> 8));
+    put(gen, (uint8_t)line);
+    put_sync(gen, 0x40);
+    put(gen, (uint8_t)(size >> 8));
+    put(gen, (uint8_t)size);
+
+    payload_start = gen->len;
+    for (i = 0; i < send; i++)
+    {
+        uint8_t b = bf30a2_gen_pixel(frame, line, i);
+
+        if ((i >= run_at) && (i < run_at + gen->cfg.ff_run_len))
+        {
+            b = 0xFF;
+        }
+        put(gen, b);
+    }
+    if (send < size)
+    {
+        add_mark(gen, gen->len, gen->len, BF30A2_GEN_TRUNCATE);
+    }
+
+    gen->lines = grow(gen->lines, &gen->lines_cap, gen->nlines + 1, sizeof(*gen->lines));
+    rec = &gen->lines[gen->nlines++];
+    rec->hdr_start = hdr_start;
+    rec->end = gen->len;
+    rec->frame = frame;
+    rec->line = line;
+    rec->crc = bf30a2_gen_crc(gen->data + payload_start, gen->len - payload_start);
+    rec->damaged = gen->damage;
+}
+
+void bf30a2_gen_frame(bf30a2_gen_t *gen)
+{
+    uint32_t frame = gen->frame++;
+    uint16_t h = gen->cfg.height;
+    uint16_t *order;
+    uint16_t i;
+
+    order = malloc((h ? h : 1) * sizeof(*order));
+    if (order == NULL)
+    {
+        fprintf(stderr, "streamgen: out of memory\n");
+        exit(1);
+    }
+    for (i = 0; i < h; i++)
+    {
+        order[i] = i;
+    }
+    for (i = 0; (i + 1) < h; i++)
+    {
+        if (chance(gen, gen->cfg.reorder_ppm))
+        {
+            uint16_t t = order[i];
+
+            order[i] = order[i + 1];
+            order[i + 1] = t;
+        }
+    }
+
+    put_sync(gen, 0x01);
+    put(gen, 0x00);
+    put(gen, (uint8_t)(gen->cfg.width >> 8));
+    put(gen, (uint8_t)gen->cfg.width);
+    put(gen, (uint8_t)(h >> 8));
+    put(gen, (uint8_t)h);
+
+    for (i = 0; i < h; i++)
+    {
+        emit_line(gen, frame, order[i]);
+        if (chance(gen, gen->cfg.duplicate_ppm))
+        {
+            emit_line(gen, frame, order[i]);
+        }
+    }
+
+    put_sync(gen, 0x00);
+    free(order);
+}
+
+void bf30a2_gen_lanes(const uint8_t *data, size_t len, uint8_t *lane0, uint8_t *lane1)
+{
+    size_t i;
+    int bit;
+
+    for (i = 0; i < len; i += 2)
+    {
+        uint8_t second = (i + 1 < len) ? data[i + 1] : 0x00;
+        uint8_t l0 = 0, l1 = 0;
+
+        /* Clock order: bits 7/6, 5/4, 3/2, 1/0 of the first byte, then the second */
+        for (bit = 7; bit >= 1; bit -= 2)
+        {
+            l1 = (uint8_t)((l1 << 1) | ((data[i] >> bit) & 1));
+            l0 = (uint8_t)((l0 << 1) | ((data[i] >> (bit - 1)) & 1));
+        }
+        for (bit = 7; bit >= 1; bit -= 2)
+        {
+            l1 = (uint8_t)((l1 << 1) | ((second >> bit) & 1));
+            l0 = (uint8_t)((l0 << 1) | ((second >> (bit - 1)) & 1));
+        }
+        lane0[i / 2] = l0;
+        lane1[i / 2] = l1;
+    }
+}
+
+/*============================================================================*/
+/*                     LIFECYCLE                                              */
+/*============================================================================*/
+
+void bf30a2_gen_init(bf30a2_gen_t *gen, const bf30a2_gen_cfg_t *cfg)
+{
+    memset(gen, 0, sizeof(*gen));
+    gen->cfg = *cfg;
+    gen->rng = cfg->seed ? cfg->seed : 1;
+}
+
+void bf30a2_gen_clear(bf30a2_gen_t *gen)
+{
+    gen->len = 0;
+    gen->nmarks = 0;
+    gen->nlines = 0;
+}
+
+void bf30a2_gen_free(bf30a2_gen_t *gen)
+{
+    free(gen->data);
+    free(gen->marks);
+    free(gen->lines);
+    memset(gen, 0, sizeof(*gen));
+}
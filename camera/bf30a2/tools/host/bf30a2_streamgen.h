@@ -0,0 +1,134 @@
+/**
+ * @file    bf30a2_streamgen.h
+ * @brief   Synthetic BF30A2 SPI protocol stream generator (host)
+ *
+ * Emits the stream parsed by bf30a2_core: 0xFF x3 sync followed by a type
+ * byte; type 0x01 frame header (format, width, height), type 0x02 line
+ * header (line number) followed by a 0xFF x3 0x40 data header with the
+ * payload size, and type 0x00 frame end. Optional controlled corruption
+ * is recorded so checkers know where the stream was damaged.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_STREAMGEN_H__
+#define __BF30A2_STREAMGEN_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Probabilities are given in parts per million */
+#define BF30A2_GEN_PPM              1000000U
+
+/**
+ * @brief Corruption kinds recorded in bf30a2_gen_mark_t
+ */
+typedef enum
+{
+    BF30A2_GEN_DROP = 0,            /**< One byte removed */
+    BF30A2_GEN_FLIP,                /**< One bit inverted */
+    BF30A2_GEN_TRUNCATE,            /**< Line payload cut short */
+} bf30a2_gen_kind_t;
+
+/**
+ * @brief Generator configuration
+ */
+typedef struct bf30a2_gen_cfg
+{
+    uint16_t width;                 /**< Frame width in pixels (even) */
+    uint16_t height;                /**< Frame height in lines */
+    uint32_t seed;                  /**< PRNG seed */
+
+    uint32_t drop_ppm;              /**< Per byte: drop the byte */
+    uint32_t flip_ppm;              /**< Per byte: flip one bit */
+    uint32_t truncate_ppm;          /**< Per line: cut the payload short */
+    uint32_t duplicate_ppm;         /**< Per line: send the line twice */
+    uint32_t reorder_ppm;           /**< Per line: swap with the next line */
+    uint32_t ff_run_ppm;            /**< Per line: put a 0xFF run in the payload */
+    uint16_t ff_run_len;            /**< Length of injected 0xFF runs */
+} bf30a2_gen_cfg_t;
+
+/**
+ * @brief A damaged region [start, end) of the output stream
+ */
+typedef struct bf30a2_gen_mark
+{
+    size_t start;
+    size_t end;
+    uint8_t kind;                   /**< bf30a2_gen_kind_t */
+} bf30a2_gen_mark_t;
+
+/**
+ * @brief One emitted line, with offsets into the output stream
+ */
+typedef struct bf30a2_gen_line
+{
+    size_t hdr_start;               /**< Offset of the line header sync */
+    size_t end;                     /**< Offset one past the last payload byte */
+    uint32_t frame;                 /**< Generated frame index */
+    uint16_t line;                  /**< Line number in the header */
+    uint32_t crc;                   /**< FNV-1a of the emitted payload */
+    uint8_t damaged;                /**< Header or payload was corrupted */
+} bf30a2_gen_line_t;
+
+/**
+ * @brief Generator state and output
+ */
+typedef struct bf30a2_gen
+{
+    bf30a2_gen_cfg_t cfg;
+    uint32_t rng;
+    uint32_t frame;                 /**< Next frame index */
+
+    uint8_t *data;                  /**< Output stream */
+    size_t len;
+    size_t cap;
+
+    bf30a2_gen_mark_t *marks;       /**< Corruption marks, in stream order */
+    size_t nmarks;
+    size_t marks_cap;
+
+    bf30a2_gen_line_t *lines;       /**< Emitted lines, in stream order */
+    size_t nlines;
+    size_t lines_cap;
+
+    uint8_t damage;                 /**< Damage seen since the last line record */
+} bf30a2_gen_t;
+
+void bf30a2_gen_init(bf30a2_gen_t *gen, const bf30a2_gen_cfg_t *cfg);
+void bf30a2_gen_free(bf30a2_gen_t *gen);
+
+/** @brief Drop the output and records, keep the configuration and PRNG state */
+void bf30a2_gen_clear(bf30a2_gen_t *gen);
+
+/** @brief Append one frame (header, lines, frame end) to the output */
+void bf30a2_gen_frame(bf30a2_gen_t *gen);
+
+/**
+ * @brief Split a stream into the lanes of a dual-lane (2-bit) sensor
+ *
+ * Lane 1 takes bits 7, 5, 3, 1 and lane 0 bits 6, 4, 2, 0 of each byte,
+ * most significant first; each lane gets (len + 1) / 2 bytes, an odd
+ * last byte paired with an idle 0x00.
+ */
+void bf30a2_gen_lanes(const uint8_t *data, size_t len, uint8_t *lane0, uint8_t *lane1);
+
+/** @brief Deterministic payload byte of a clean stream */
+uint8_t bf30a2_gen_pixel(uint32_t frame, uint16_t line, uint32_t offset);
+
+/** @brief FNV-1a hash used for line payload records */
+uint32_t bf30a2_gen_crc(const uint8_t *data, size_t len);
+
+/** @brief xorshift32 PRNG shared by the host tools */
+uint32_t bf30a2_gen_rand(uint32_t *state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BF30A2_STREAMGEN_H__ */
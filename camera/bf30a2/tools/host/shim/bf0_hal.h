@@ -0,0 +1,132 @@
+/**
+ * @file    bf0_hal.h
+ * @brief   SF32LB52 HAL shim for host builds
+ *
+ * Register blocks and HAL calls touched by the driver. The DMA channel
+ * counter (CNDTR) is advanced by the simulated SPI slave in
+ * bf30a2_simhw.c; PWM and pinmux calls only record their arguments.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_HOST_BF0_HAL_H__
+#define __BF30A2_HOST_BF0_HAL_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    HAL_OK = 0,
+    HAL_ERROR,
+    HAL_BUSY,
+    HAL_TIMEOUT,
+} HAL_StatusTypeDef;
+
+extern uint32_t SystemCoreClock;
+
+/*============================================================================*/
+/*                     PINMUX                                                 */
+/*============================================================================*/
+
+#define PAD_PA00                    0
+#define PAD_PA20                    20
+#define PAD_PA37                    37
+#define PAD_PA39                    39
+#define PAD_PA40                    40
+#define PAD_PA41                    41
+#define PAD_PA42                    42
+
+#define GPIO_A0                     0x100
+#define GPTIM1_CH2                  0x200
+#define I2C2_SCL                    0x300
+#define I2C2_SDA                    0x301
+#define SPI2_CLK                    0x400
+#define SPI2_DIO                    0x401
+#define SPI2_CS                     0x402
+
+#define PIN_NOPULL                  0x00
+#define PIN_PULLUP                  0x01
+#define PIN_PULLDOWN                0x02
+
+int HAL_PIN_Set(int pad, int func, int flags, int core);
+
+/*============================================================================*/
+/*                     DMA / SPI                                              */
+/*============================================================================*/
+
+typedef struct
+{
+    volatile uint32_t CCR;
+    volatile uint32_t CNDTR;        /* Transfers left before the ring wraps */
+    volatile uint32_t CPAR;
+    volatile uint32_t CM0AR;
+} DMA_Channel_TypeDef;
+
+typedef struct
+{
+    DMA_Channel_TypeDef *Instance;
+} DMA_HandleTypeDef;
+
+typedef struct
+{
+    void *Instance;
+    DMA_HandleTypeDef *hdmarx;
+} SPI_HandleTypeDef;
+
+/*============================================================================*/
+/*                     GPT / RCC                                              */
+/*============================================================================*/
+
+typedef struct
+{
+    volatile uint32_t PSC;
+    volatile uint32_t ARR;
+    volatile uint32_t CCR[4];
+} GPT_TypeDef;
+
+extern GPT_TypeDef bf30a2_host_gptim1;
+extern GPT_TypeDef bf30a2_host_gptim2;
+
+#define hwp_gptim1                  (&bf30a2_host_gptim1)
+#define hwp_gptim2                  (&bf30a2_host_gptim2)
+
+typedef struct
+{
+    GPT_TypeDef *Instance;
+    int core;
+} GPT_HandleTypeDef;
+
+typedef struct
+{
+    uint32_t OCMode;
+    uint32_t Pulse;
+    uint32_t OCPolarity;
+    uint32_t OCFastMode;
+} GPT_OC_InitTypeDef;
+
+#define GPT_OCMODE_PWM1             0x60
+#define GPT_OCPOLARITY_HIGH         0x00
+#define GPT_OCFAST_DISABLE          0x00
+#define GPT_EVENTSOURCE_UPDATE      0x01
+
+#define __HAL_GPT_SET_PRESCALER(h, v)       ((h)->Instance->PSC = (v))
+#define __HAL_GPT_SET_AUTORELOAD(h, v)      ((h)->Instance->ARR = (v))
+#define __HAL_GPT_SET_COMPARE(h, ch, v)     ((h)->Instance->CCR[((ch) / 4) & 3] = (v))
+
+uint32_t HAL_RCC_GetPCLKFreq(int core, int is_pclk1);
+HAL_StatusTypeDef HAL_GPT_PWM_Stop(GPT_HandleTypeDef *htim, uint32_t channel);
+HAL_StatusTypeDef HAL_GPT_PWM_Start(GPT_HandleTypeDef *htim, uint32_t channel);
+HAL_StatusTypeDef HAL_GPT_PWM_ConfigChannel(GPT_HandleTypeDef *htim,
+                                            GPT_OC_InitTypeDef *config, uint32_t channel);
+HAL_StatusTypeDef HAL_GPT_GenerateEvent(GPT_HandleTypeDef *htim, uint32_t source);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BF30A2_HOST_BF0_HAL_H__ */
@@ -0,0 +1,32 @@
+/**
+ * @file    drv_spi.h
+ * @brief   SiFli SPI bus driver shim for host builds
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_HOST_DRV_SPI_H__
+#define __BF30A2_HOST_DRV_SPI_H__
+
+#include <rtdevice.h>
+#include "bf0_hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sifli_spi
+{
+    SPI_HandleTypeDef handle;
+    DMA_HandleTypeDef dma_rx;
+    struct rt_spi_bus spi_bus;
+};
+
+rt_err_t rt_hw_spi_device_attach(const char *bus_name, const char *device_name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BF30A2_HOST_DRV_SPI_H__ */
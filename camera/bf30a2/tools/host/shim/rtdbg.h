@@ -0,0 +1,44 @@
+/**
+ * @file    rtdbg.h
+ * @brief   RT-Thread debug log shim for host builds
+ *
+ * Messages go through rt_host_log(), filtered at run time by
+ * rt_host_log_level in addition to the file's DBG_LVL.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_HOST_RTDBG_H__
+#define __BF30A2_HOST_RTDBG_H__
+
+#include <rtthread.h>
+
+#define DBG_ERROR                   0
+#define DBG_WARNING                 1
+#define DBG_INFO                    2
+#define DBG_LOG                     3
+
+#ifndef DBG_TAG
+#define DBG_TAG                     "DBG"
+#endif
+
+#ifndef DBG_LVL
+#define DBG_LVL                     DBG_WARNING
+#endif
+
+#define __RT_HOST_LOG(lvl, ...)                                                 \
+    do                                                                          \
+    {                                                                           \
+        if (DBG_LVL >= (lvl))                                                   \
+        {                                                                       \
+            rt_host_log((lvl), DBG_TAG, __VA_ARGS__);                           \
+        }                                                                       \
+    } while (0)
+
+#define LOG_E(...)                  __RT_HOST_LOG(DBG_ERROR, __VA_ARGS__)
+#define LOG_W(...)                  __RT_HOST_LOG(DBG_WARNING, __VA_ARGS__)
+#define LOG_I(...)                  __RT_HOST_LOG(DBG_INFO, __VA_ARGS__)
+#define LOG_D(...)                  __RT_HOST_LOG(DBG_LOG, __VA_ARGS__)
+
+#endif /* __BF30A2_HOST_RTDBG_H__ */
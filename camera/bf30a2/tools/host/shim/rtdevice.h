@@ -0,0 +1,195 @@
+/**
+ * @file    rtdevice.h
+ * @brief   RT-Thread device shim for host builds
+ *
+ * Pin, PWM, I2C, SPI and graphic device framework types as used by the driver.
+ * The framework calls are in shim/rtdevice_host.c; the devices behind
+ * them are provided by the simulated hardware (bf30a2_simhw.c).
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_HOST_RTDEVICE_H__
+#define __BF30A2_HOST_RTDEVICE_H__
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================================*/
+/*                     PIN                                                    */
+/*============================================================================*/
+
+#define PIN_LOW                     0x00
+#define PIN_HIGH                    0x01
+
+#define PIN_MODE_OUTPUT             0x00
+#define PIN_MODE_INPUT              0x01
+#define PIN_MODE_INPUT_PULLUP       0x02
+#define PIN_MODE_INPUT_PULLDOWN     0x03
+#define PIN_MODE_OUTPUT_OD          0x04
+
+struct rt_device_pin_mode
+{
+    rt_base_t pin;
+    rt_base_t mode;
+};
+
+struct rt_device_pin_status
+{
+    rt_base_t pin;
+    rt_base_t status;
+};
+
+/*============================================================================*/
+/*                     PWM                                                    */
+/*============================================================================*/
+
+#define PWM_CMD_ENABLE              (128 + 0)
+#define PWM_CMD_DISABLE             (128 + 1)
+#define PWM_CMD_SET                 (128 + 2)
+#define PWM_CMD_GET                 (128 + 3)
+
+struct rt_pwm_configuration
+{
+    rt_uint32_t channel;
+    rt_uint32_t period;             /* ns */
+    rt_uint32_t pulse;              /* ns */
+};
+
+/* Requests reach the PWM driver through parent.control() */
+struct rt_device_pwm
+{
+    struct rt_device parent;
+};
+
+rt_err_t rt_pwm_set(struct rt_device_pwm *device, int channel, rt_uint32_t period,
+                    rt_uint32_t pulse);
+rt_err_t rt_pwm_enable(struct rt_device_pwm *device, int channel);
+rt_err_t rt_pwm_disable(struct rt_device_pwm *device, int channel);
+
+/*============================================================================*/
+/*                     I2C                                                    */
+/*============================================================================*/
+
+#define RT_I2C_WR                   0x0000
+#define RT_I2C_RD                   (1u << 0)
+
+struct rt_i2c_msg
+{
+    rt_uint16_t addr;
+    rt_uint16_t flags;
+    rt_uint16_t len;
+    rt_uint8_t *buf;
+};
+
+struct rt_i2c_bus_device;
+
+struct rt_i2c_bus_device_ops
+{
+    rt_size_t (*master_xfer)(struct rt_i2c_bus_device *bus, struct rt_i2c_msg msgs[],
+                             rt_uint32_t num);
+};
+
+struct rt_i2c_bus_device
+{
+    struct rt_device parent;
+    const struct rt_i2c_bus_device_ops *ops;
+    void *priv;
+};
+
+/* SiFli extension: bus timing configuration */
+struct rt_i2c_configuration
+{
+    rt_uint32_t mode;
+    rt_uint16_t addr;
+    rt_uint32_t timeout;
+    rt_uint32_t max_hz;
+};
+
+struct rt_i2c_bus_device *rt_i2c_bus_device_find(const char *bus_name);
+rt_size_t rt_i2c_transfer(struct rt_i2c_bus_device *bus, struct rt_i2c_msg msgs[],
+                          rt_uint32_t num);
+rt_err_t rt_i2c_configure(struct rt_i2c_bus_device *bus, struct rt_i2c_configuration *cfg);
+
+/*============================================================================*/
+/*                     SPI                                                    */
+/*============================================================================*/
+
+#define RT_SPI_CPHA                 (1 << 0)
+#define RT_SPI_CPOL                 (1 << 1)
+#define RT_SPI_MODE_0               (0 | 0)
+#define RT_SPI_MSB                  (1 << 2)
+#define RT_SPI_SLAVE                (1 << 3)
+#define RT_SPI_3WIRE                (1 << 4)
+
+struct rt_spi_configuration
+{
+    rt_uint8_t mode;
+    rt_uint8_t data_width;
+    rt_uint16_t reserved;
+    rt_uint32_t max_hz;
+};
+
+struct rt_spi_device;
+
+struct rt_spi_bus
+{
+    struct rt_device parent;
+    struct rt_spi_device *owner;
+};
+
+struct rt_spi_device
+{
+    struct rt_device parent;
+    struct rt_spi_bus *bus;
+    struct rt_spi_configuration config;
+    void *user_data;
+};
+
+rt_err_t rt_spi_configure(struct rt_spi_device *device, struct rt_spi_configuration *cfg);
+rt_err_t rt_spi_take_bus(struct rt_spi_device *device);
+rt_err_t rt_spi_release_bus(struct rt_spi_device *device);
+rt_err_t rt_spi_release(struct rt_spi_device *device);
+
+/*============================================================================*/
+/*                     GRAPHIC (LCD)                                          */
+/*============================================================================*/
+
+#define RTGRAPHIC_CTRL_GET_INFO     3
+
+#define RTGRAPHIC_PIXEL_FORMAT_RGB565   8
+
+struct rt_device_graphic_info
+{
+    rt_uint8_t pixel_format;
+    rt_uint8_t bits_per_pixel;
+    rt_uint16_t reserved;
+    rt_uint16_t width;
+    rt_uint16_t height;
+    rt_uint8_t *framebuffer;
+};
+
+/* SiFli extension: window setup and asynchronous rectangle transfer */
+struct rt_device_graphic_ops
+{
+    void (*set_pixel)(const char *pixel, int x, int y);
+    void (*get_pixel)(char *pixel, int x, int y);
+    void (*draw_hline)(const char *pixel, int x1, int x2, int y);
+    void (*draw_vline)(const char *pixel, int x, int y1, int y2);
+    void (*blit_line)(const char *pixel, int x, int y, rt_size_t size);
+    void (*set_window)(int x0, int y0, int x1, int y1);
+    void (*draw_rect)(const char *pixel, int x0, int y0, int x1, int y1);
+    void (*draw_rect_async)(const char *pixel, int x0, int y0, int x1, int y1);
+};
+
+#define rt_graphix_ops(device)      ((struct rt_device_graphic_ops *)((device)->user_data))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BF30A2_HOST_RTDEVICE_H__ */
@@ -0,0 +1,120 @@
+/**
+ * @file    rtdevice_host.c
+ * @brief   RT-Thread PWM/I2C/SPI framework calls for host simulation
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+
+/*============================================================================*/
+/*                     PWM                                                    */
+/*============================================================================*/
+
+static rt_err_t pwm_request(struct rt_device_pwm *device, int cmd, int channel,
+                            rt_uint32_t period, rt_uint32_t pulse)
+{
+    struct rt_pwm_configuration cfg;
+
+    if (device == RT_NULL)
+    {
+        return -RT_EIO;
+    }
+
+    cfg.channel = (rt_uint32_t)channel;
+    cfg.period = period;
+    cfg.pulse = pulse;
+    return rt_device_control(&device->parent, cmd, &cfg);
+}
+
+rt_err_t rt_pwm_set(struct rt_device_pwm *device, int channel, rt_uint32_t period,
+                    rt_uint32_t pulse)
+{
+    return pwm_request(device, PWM_CMD_SET, channel, period, pulse);
+}
+
+rt_err_t rt_pwm_enable(struct rt_device_pwm *device, int channel)
+{
+    return pwm_request(device, PWM_CMD_ENABLE, channel, 0, 0);
+}
+
+rt_err_t rt_pwm_disable(struct rt_device_pwm *device, int channel)
+{
+    return pwm_request(device, PWM_CMD_DISABLE, channel, 0, 0);
+}
+
+/*============================================================================*/
+/*                     I2C                                                    */
+/*============================================================================*/
+
+struct rt_i2c_bus_device *rt_i2c_bus_device_find(const char *bus_name)
+{
+    rt_device_t dev = rt_device_find(bus_name);
+
+    if ((dev == RT_NULL) || (dev->type != RT_Device_Class_I2CBUS))
+    {
+        return RT_NULL;
+    }
+    return (struct rt_i2c_bus_device *)dev;
+}
+
+rt_size_t rt_i2c_transfer(struct rt_i2c_bus_device *bus, struct rt_i2c_msg msgs[],
+                          rt_uint32_t num)
+{
+    if ((bus == RT_NULL) || (bus->ops == RT_NULL) || (bus->ops->master_xfer == RT_NULL))
+    {
+        return 0;
+    }
+    return bus->ops->master_xfer(bus, msgs, num);
+}
+
+rt_err_t rt_i2c_configure(struct rt_i2c_bus_device *bus, struct rt_i2c_configuration *cfg)
+{
+    return (bus != RT_NULL) ? RT_EOK : -RT_EIO;
+}
+
+/*============================================================================*/
+/*                     SPI                                                    */
+/*============================================================================*/
+
+rt_err_t rt_spi_configure(struct rt_spi_device *device, struct rt_spi_configuration *cfg)
+{
+    if ((device == RT_NULL) || (cfg == RT_NULL))
+    {
+        return -RT_EINVAL;
+    }
+    device->config = *cfg;
+    return RT_EOK;
+}
+
+rt_err_t rt_spi_take_bus(struct rt_spi_device *device)
+{
+    if ((device == RT_NULL) || (device->bus == RT_NULL))
+    {
+        return -RT_EINVAL;
+    }
+    if ((device->bus->owner != RT_NULL) && (device->bus->owner != device))
+    {
+        return -RT_EBUSY;
+    }
+    device->bus->owner = device;
+    return RT_EOK;
+}
+
+rt_err_t rt_spi_release_bus(struct rt_spi_device *device)
+{
+    if ((device == RT_NULL) || (device->bus == RT_NULL) || (device->bus->owner != device))
+    {
+        return -RT_ERROR;
+    }
+    device->bus->owner = RT_NULL;
+    return RT_EOK;
+}
+
+rt_err_t rt_spi_release(struct rt_spi_device *device)
+{
+    /* Chip select is driven by the master (the sensor) */
+    return (device != RT_NULL) ? RT_EOK : -RT_EINVAL;
+}
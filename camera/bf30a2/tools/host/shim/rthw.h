@@ -0,0 +1,29 @@
+/**
+ * @file    rthw.h
+ * @brief   RT-Thread interrupt masking shim for host simulation
+ *
+ * There are no interrupts on the host: the pair is a process-wide
+ * recursive lock, which gives the same mutual exclusion between the
+ * capture thread, consumers and the simulated DMA callback.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_HOST_RTHW_H__
+#define __BF30A2_HOST_RTHW_H__
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+rt_base_t rt_hw_interrupt_disable(void);
+void rt_hw_interrupt_enable(rt_base_t level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BF30A2_HOST_RTHW_H__ */
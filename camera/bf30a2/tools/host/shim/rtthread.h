@@ -0,0 +1,277 @@
+/**
+ * @file    rtthread.h
+ * @brief   Minimal RT-Thread shim for building the BF30A2 driver on a host
+ *
+ * The types and helpers used by src/bf30a2_core.c and src/bf30a2_trace.c
+ * need no runtime. The kernel objects (threads, events, mutexes, ticks,
+ * device registry, msh/INIT tables) used by src/drv_bf30a2.c are backed
+ * by pthreads in shim/rtthread_host.c, which only the simulator links.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BF30A2_HOST_RTTHREAD_H__
+#define __BF30A2_HOST_RTTHREAD_H__
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int8_t                      rt_int8_t;
+typedef int16_t                     rt_int16_t;
+typedef int32_t                     rt_int32_t;
+typedef int64_t                     rt_int64_t;
+typedef uint8_t                     rt_uint8_t;
+typedef uint16_t                    rt_uint16_t;
+typedef uint32_t                    rt_uint32_t;
+typedef uint64_t                    rt_uint64_t;
+typedef int                         rt_bool_t;
+typedef long                        rt_base_t;
+typedef unsigned long               rt_ubase_t;
+typedef rt_base_t                   rt_err_t;
+typedef rt_ubase_t                  rt_size_t;
+typedef rt_base_t                   rt_off_t;
+typedef rt_uint32_t                 rt_tick_t;
+
+#define RT_NULL                     NULL
+#define RT_TRUE                     1
+#define RT_FALSE                    0
+
+#define RT_EOK                      0
+#define RT_ERROR                    1
+#define RT_ETIMEOUT                 2
+#define RT_EFULL                    3
+#define RT_EEMPTY                   4
+#define RT_ENOMEM                   5
+#define RT_ENOSYS                   6
+#define RT_EBUSY                    7
+#define RT_EIO                      8
+#define RT_EINTR                    9
+#define RT_EINVAL                   10
+
+#define rt_inline                   static inline
+
+#define rt_memset                   memset
+#define rt_memcpy                   memcpy
+#define rt_kprintf                  printf
+
+#define ALIGN(n)                    __attribute__((aligned(n)))
+
+#define rt_container_of(ptr, type, member) \
+    ((type *)((char *)(ptr) - offsetof(type, member)))
+
+/*============================================================================*/
+/*                     KERNEL OBJECTS                                         */
+/*============================================================================*/
+
+#define RT_NAME_MAX                 8
+#define RT_TICK_PER_SECOND          1000
+
+#define RT_WAITING_FOREVER          -1
+#define RT_WAITING_NO               0
+
+/* Thread priorities are accepted but not applied on the host */
+#define RT_THREAD_PRIORITY_MAX      32
+#define RT_THREAD_PRIORITY_HIGH     8
+
+#define RT_IPC_FLAG_FIFO            0x00
+#define RT_IPC_FLAG_PRIO            0x01
+
+#define RT_EVENT_FLAG_AND           0x01
+#define RT_EVENT_FLAG_OR            0x02
+#define RT_EVENT_FLAG_CLEAR         0x04
+
+/* Complete types, so the driver can embed them for rt_*_init() */
+struct rt_thread
+{
+    pthread_t tid;
+    char name[RT_NAME_MAX + 1];
+    void (*entry)(void *parameter);
+    void *parameter;
+    int is_static;                  /* rt_thread_init(): not freed at exit */
+};
+
+struct rt_event
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    rt_uint32_t set;
+};
+
+struct rt_mutex
+{
+    pthread_mutex_t lock;
+};
+
+typedef struct rt_thread *rt_thread_t;
+typedef struct rt_event *rt_event_t;
+typedef struct rt_mutex *rt_mutex_t;
+
+rt_thread_t rt_thread_create(const char *name, void (*entry)(void *parameter),
+                             void *parameter, rt_uint32_t stack_size,
+                             rt_uint8_t priority, rt_uint32_t tick);
+/* The stack is not used: the thread runs on a pthread stack */
+rt_err_t rt_thread_init(struct rt_thread *thread, const char *name,
+                        void (*entry)(void *parameter), void *parameter,
+                        void *stack_start, rt_uint32_t stack_size,
+                        rt_uint8_t priority, rt_uint32_t tick);
+rt_err_t rt_thread_startup(rt_thread_t thread);
+rt_err_t rt_thread_mdelay(rt_int32_t ms);
+
+rt_tick_t rt_tick_get(void);
+rt_tick_t rt_tick_get_millisecond(void);
+
+rt_event_t rt_event_create(const char *name, rt_uint8_t flag);
+rt_err_t rt_event_delete(rt_event_t event);
+rt_err_t rt_event_init(rt_event_t event, const char *name, rt_uint8_t flag);
+rt_err_t rt_event_detach(rt_event_t event);
+rt_err_t rt_event_send(rt_event_t event, rt_uint32_t set);
+rt_err_t rt_event_recv(rt_event_t event, rt_uint32_t set, rt_uint8_t option,
+                       rt_int32_t timeout, rt_uint32_t *recved);
+
+rt_mutex_t rt_mutex_create(const char *name, rt_uint8_t flag);
+rt_err_t rt_mutex_delete(rt_mutex_t mutex);
+rt_err_t rt_mutex_init(rt_mutex_t mutex, const char *name, rt_uint8_t flag);
+rt_err_t rt_mutex_detach(rt_mutex_t mutex);
+rt_err_t rt_mutex_take(rt_mutex_t mutex, rt_int32_t timeout);
+rt_err_t rt_mutex_release(rt_mutex_t mutex);
+
+void *rt_malloc(rt_size_t size);
+void rt_free(void *ptr);
+void *rt_malloc_align(rt_size_t size, rt_size_t align);
+void rt_free_align(void *ptr);
+
+/** @brief Heap allocations so far: rt_malloc*() and the rt_*_create() objects */
+extern rt_uint32_t rt_host_heap_allocs;
+
+/*============================================================================*/
+/*                     DEVICE MODEL                                           */
+/*============================================================================*/
+
+#define RT_DEVICE_FLAG_DEACTIVATE   0x000
+#define RT_DEVICE_FLAG_RDONLY       0x001
+#define RT_DEVICE_FLAG_WRONLY       0x002
+#define RT_DEVICE_FLAG_RDWR         0x003
+#define RT_DEVICE_FLAG_STANDALONE   0x008
+#define RT_DEVICE_FLAG_ACTIVATED    0x010
+#define RT_DEVICE_FLAG_INT_RX       0x100
+#define RT_DEVICE_FLAG_DMA_RX       0x200
+
+#define RT_DEVICE_OFLAG_CLOSE       0x000
+#define RT_DEVICE_OFLAG_RDONLY      0x001
+#define RT_DEVICE_OFLAG_WRONLY      0x002
+#define RT_DEVICE_OFLAG_RDWR        0x003
+#define RT_DEVICE_OFLAG_OPEN        0x008
+
+enum rt_device_class_type
+{
+    RT_Device_Class_Char = 0,
+    RT_Device_Class_Block,
+    RT_Device_Class_NetIf,
+    RT_Device_Class_MTD,
+    RT_Device_Class_CAN,
+    RT_Device_Class_RTC,
+    RT_Device_Class_Sound,
+    RT_Device_Class_Graphic,
+    RT_Device_Class_I2CBUS,
+    RT_Device_Class_USBDevice,
+    RT_Device_Class_USBHost,
+    RT_Device_Class_SPIBUS,
+    RT_Device_Class_SPIDevice,
+    RT_Device_Class_SDIO,
+    RT_Device_Class_PM,
+    RT_Device_Class_Pipe,
+    RT_Device_Class_Portal,
+    RT_Device_Class_Timer,
+    RT_Device_Class_Miscellaneous,
+    RT_Device_Class_Unknown
+};
+
+struct rt_device;
+typedef struct rt_device *rt_device_t;
+
+struct rt_device
+{
+    char name[RT_NAME_MAX + 1];
+    enum rt_device_class_type type;
+    rt_uint16_t flag;
+    rt_uint16_t open_flag;
+    rt_uint8_t ref_count;
+
+    rt_err_t  (*init)   (rt_device_t dev);
+    rt_err_t  (*open)   (rt_device_t dev, rt_uint16_t oflag);
+    rt_err_t  (*close)  (rt_device_t dev);
+    rt_size_t (*read)   (rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size);
+    rt_size_t (*write)  (rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size);
+    rt_err_t  (*control)(rt_device_t dev, int cmd, void *args);
+
+    rt_err_t  (*rx_indicate)(rt_device_t dev, rt_size_t size);
+    rt_err_t  (*tx_complete)(rt_device_t dev, void *buffer);
+
+    void *user_data;
+
+    struct rt_device *next;         /* Host registry link */
+};
+
+rt_err_t rt_device_register(rt_device_t dev, const char *name, rt_uint16_t flags);
+rt_device_t rt_device_find(const char *name);
+rt_err_t rt_device_init(rt_device_t dev);
+rt_err_t rt_device_open(rt_device_t dev, rt_uint16_t oflag);
+rt_err_t rt_device_close(rt_device_t dev);
+rt_size_t rt_device_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size);
+rt_size_t rt_device_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size);
+rt_err_t rt_device_control(rt_device_t dev, int cmd, void *arg);
+rt_err_t rt_device_set_tx_complete(rt_device_t dev,
+                                  rt_err_t (*tx_done)(rt_device_t dev, void *buffer));
+
+/*============================================================================*/
+/*                     COMMAND AND INIT TABLES                                */
+/*============================================================================*/
+
+/**
+ * @brief msh command table entry, collected in the "rtmsh" section
+ */
+struct rt_host_msh
+{
+    const char *name;
+    const char *desc;
+    void (*fn)(int argc, char **argv);
+};
+
+#define MSH_CMD_EXPORT_ALIAS(command, alias, desc)                              \
+    static const struct rt_host_msh __rt_msh_##alias                            \
+    __attribute__((used, section("rtmsh"), aligned(sizeof(void *)))) =         \
+        { #alias, #desc, command }
+
+#define MSH_CMD_EXPORT(command, desc)   MSH_CMD_EXPORT_ALIAS(command, command, desc)
+
+#define INIT_DEVICE_EXPORT(fn)                                                  \
+    static int (*const __rt_init_##fn)(void)                                    \
+    __attribute__((used, section("rtinit"), aligned(sizeof(void *)))) = fn
+
+#define INIT_APP_EXPORT(fn)         INIT_DEVICE_EXPORT(fn)
+
+/** @brief Run the INIT_*_EXPORT functions linked into the program */
+void rt_host_components_init(void);
+
+/** @brief Run one msh command line, returns -RT_ERROR if not found */
+int rt_host_msh_exec(const char *line);
+
+/** @brief Log threshold for rtdbg.h: 0 error, 1 warning, 2 info, 3 debug */
+extern int rt_host_log_level;
+
+/* Unchecked format, like rt_kprintf() which LOG_x expands to on the target */
+void rt_host_log(int level, const char *tag, const char *fmt, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BF30A2_HOST_RTTHREAD_H__ */
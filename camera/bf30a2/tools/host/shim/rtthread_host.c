@@ -0,0 +1,581 @@
+/**
+ * @file    rtthread_host.c
+ * @brief   pthread backed RT-Thread kernel objects for host simulation
+ *
+ * Covers what src/drv_bf30a2.c uses: threads, events, mutexes, interrupt
+ * masking, the tick, heap, the device registry, and the msh/INIT tables.
+ * Scheduling is left to the host, so priorities and time slices are ignored.
+ *
+ * SPDX-FileCopyrightText: 2026 SiFli Technologies(Nanjing) Co., Ltd
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <rtthread.h>
+#include <rthw.h>
+
+/* Errors and warnings by default */
+int rt_host_log_level = 1;
+
+rt_uint32_t rt_host_heap_allocs;
+
+static pthread_mutex_t g_dev_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t g_irq_lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static struct rt_device *g_dev_list;
+
+/*============================================================================*/
+/*                     TIME                                                   */
+/*============================================================================*/
+
+static rt_uint64_t now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (rt_uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+rt_tick_t rt_tick_get(void)
+{
+    return (rt_tick_t)now_ms();
+}
+
+rt_tick_t rt_tick_get_millisecond(void)
+{
+    return (rt_tick_t)now_ms();
+}
+
+rt_err_t rt_thread_mdelay(rt_int32_t ms)
+{
+    struct timespec ts;
+
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+    {
+    }
+    return RT_EOK;
+}
+
+/* Absolute CLOCK_MONOTONIC deadline timeout ticks from now */
+static void deadline(struct timespec *ts, rt_int32_t ticks)
+{
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec += ticks / RT_TICK_PER_SECOND;
+    ts->tv_nsec += (long)(ticks % RT_TICK_PER_SECOND) * (1000000000L / RT_TICK_PER_SECOND);
+    if (ts->tv_nsec >= 1000000000L)
+    {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+/*============================================================================*/
+/*                     THREADS                                                */
+/*============================================================================*/
+
+static void *thread_main(void *arg)
+{
+    rt_thread_t thread = (rt_thread_t)arg;
+
+    thread->entry(thread->parameter);
+
+    /* RT-Thread reclaims dynamic threads when the entry returns */
+    if (!thread->is_static)
+    {
+        free(thread);
+    }
+    return NULL;
+}
+
+rt_thread_t rt_thread_create(const char *name, void (*entry)(void *parameter),
+                             void *parameter, rt_uint32_t stack_size,
+                             rt_uint8_t priority, rt_uint32_t tick)
+{
+    rt_thread_t thread = calloc(1, sizeof(*thread));
+
+    if (thread == NULL)
+    {
+        return RT_NULL;
+    }
+    rt_host_heap_allocs++;
+    strncpy(thread->name, name, RT_NAME_MAX);
+    thread->entry = entry;
+    thread->parameter = parameter;
+    return thread;
+}
+
+rt_err_t rt_thread_init(struct rt_thread *thread, const char *name,
+                        void (*entry)(void *parameter), void *parameter,
+                        void *stack_start, rt_uint32_t stack_size,
+                        rt_uint8_t priority, rt_uint32_t tick)
+{
+    memset(thread, 0, sizeof(*thread));
+    strncpy(thread->name, name, RT_NAME_MAX);
+    thread->entry = entry;
+    thread->parameter = parameter;
+    thread->is_static = 1;
+    return RT_EOK;
+}
+
+rt_err_t rt_thread_startup(rt_thread_t thread)
+{
+    pthread_attr_t attr;
+    int ret;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    ret = pthread_create(&thread->tid, &attr, thread_main, thread);
+    pthread_attr_destroy(&attr);
+    if (ret != 0)
+    {
+        return -RT_ERROR;
+    }
+    pthread_setname_np(thread->tid, thread->name);
+    return RT_EOK;
+}
+
+/*============================================================================*/
+/*                     EVENTS                                                 */
+/*============================================================================*/
+
+rt_err_t rt_event_init(rt_event_t event, const char *name, rt_uint8_t flag)
+{
+    pthread_condattr_t attr;
+
+    memset(event, 0, sizeof(*event));
+    pthread_mutex_init(&event->lock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&event->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    return RT_EOK;
+}
+
+rt_err_t rt_event_detach(rt_event_t event)
+{
+    pthread_cond_destroy(&event->cond);
+    pthread_mutex_destroy(&event->lock);
+    return RT_EOK;
+}
+
+rt_event_t rt_event_create(const char *name, rt_uint8_t flag)
+{
+    rt_event_t event = malloc(sizeof(*event));
+
+    if (event == NULL)
+    {
+        return RT_NULL;
+    }
+    rt_host_heap_allocs++;
+    rt_event_init(event, name, flag);
+    return event;
+}
+
+rt_err_t rt_event_delete(rt_event_t event)
+{
+    rt_event_detach(event);
+    free(event);
+    return RT_EOK;
+}
+
+rt_err_t rt_event_send(rt_event_t event, rt_uint32_t set)
+{
+    pthread_mutex_lock(&event->lock);
+    event->set |= set;
+    pthread_cond_broadcast(&event->cond);
+    pthread_mutex_unlock(&event->lock);
+    return RT_EOK;
+}
+
+static int event_ready(rt_event_t event, rt_uint32_t set, rt_uint8_t option)
+{
+    if (option & RT_EVENT_FLAG_AND)
+    {
+        return (event->set & set) == set;
+    }
+    return (event->set & set) != 0;
+}
+
+rt_err_t rt_event_recv(rt_event_t event, rt_uint32_t set, rt_uint8_t option,
+                       rt_int32_t timeout, rt_uint32_t *recved)
+{
+    struct timespec ts;
+    rt_err_t ret = RT_EOK;
+
+    if (timeout > 0)
+    {
+        deadline(&ts, timeout);
+    }
+
+    pthread_mutex_lock(&event->lock);
+    while (!event_ready(event, set, option))
+    {
+        if (timeout == RT_WAITING_NO)
+        {
+            ret = -RT_ETIMEOUT;
+            break;
+        }
+        if (timeout < 0)
+        {
+            pthread_cond_wait(&event->cond, &event->lock);
+        }
+        else if (pthread_cond_timedwait(&event->cond, &event->lock, &ts) == ETIMEDOUT)
+        {
+            ret = -RT_ETIMEOUT;
+            break;
+        }
+    }
+
+    if (ret == RT_EOK)
+    {
+        if (recved != RT_NULL)
+        {
+            *recved = event->set & set;
+        }
+        if (option & RT_EVENT_FLAG_CLEAR)
+        {
+            event->set &= ~set;
+        }
+    }
+    pthread_mutex_unlock(&event->lock);
+
+    return ret;
+}
+
+/*============================================================================*/
+/*                     MUTEXES                                                */
+/*============================================================================*/
+
+rt_err_t rt_mutex_init(rt_mutex_t mutex, const char *name, rt_uint8_t flag)
+{
+    pthread_mutexattr_t attr;
+
+    /* RT-Thread mutexes are recursive for the owner */
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mutex->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return RT_EOK;
+}
+
+rt_err_t rt_mutex_detach(rt_mutex_t mutex)
+{
+    pthread_mutex_destroy(&mutex->lock);
+    return RT_EOK;
+}
+
+rt_mutex_t rt_mutex_create(const char *name, rt_uint8_t flag)
+{
+    rt_mutex_t mutex = malloc(sizeof(*mutex));
+
+    if (mutex == NULL)
+    {
+        return RT_NULL;
+    }
+    rt_host_heap_allocs++;
+    rt_mutex_init(mutex, name, flag);
+    return mutex;
+}
+
+rt_err_t rt_mutex_delete(rt_mutex_t mutex)
+{
+    rt_mutex_detach(mutex);
+    free(mutex);
+    return RT_EOK;
+}
+
+rt_err_t rt_mutex_take(rt_mutex_t mutex, rt_int32_t timeout)
+{
+    struct timespec ts;
+
+    if (timeout < 0)
+    {
+        return pthread_mutex_lock(&mutex->lock) == 0 ? RT_EOK : -RT_ERROR;
+    }
+    if (timeout == RT_WAITING_NO)
+    {
+        return pthread_mutex_trylock(&mutex->lock) == 0 ? RT_EOK : -RT_ETIMEOUT;
+    }
+
+    /* pthread_mutex_timedlock() only takes CLOCK_REALTIME deadlines */
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout / RT_TICK_PER_SECOND;
+    ts.tv_nsec += (long)(timeout % RT_TICK_PER_SECOND) * (1000000000L / RT_TICK_PER_SECOND);
+    if (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return pthread_mutex_timedlock(&mutex->lock, &ts) == 0 ? RT_EOK : -RT_ETIMEOUT;
+}
+
+rt_err_t rt_mutex_release(rt_mutex_t mutex)
+{
+    return pthread_mutex_unlock(&mutex->lock) == 0 ? RT_EOK : -RT_ERROR;
+}
+
+/*============================================================================*/
+/*                     INTERRUPT MASKING                                      */
+/*============================================================================*/
+
+rt_base_t rt_hw_interrupt_disable(void)
+{
+    pthread_mutex_lock(&g_irq_lock);
+    return 0;
+}
+
+void rt_hw_interrupt_enable(rt_base_t level)
+{
+    pthread_mutex_unlock(&g_irq_lock);
+}
+
+/*============================================================================*/
+/*                     HEAP                                                   */
+/*============================================================================*/
+
+void *rt_malloc(rt_size_t size)
+{
+    rt_host_heap_allocs++;
+    return malloc(size);
+}
+
+void rt_free(void *ptr)
+{
+    free(ptr);
+}
+
+void *rt_malloc_align(rt_size_t size, rt_size_t align)
+{
+    void *ptr = NULL;
+
+    if (align < sizeof(void *))
+    {
+        align = sizeof(void *);
+    }
+    rt_host_heap_allocs++;
+    return posix_memalign(&ptr, align, size) == 0 ? ptr : RT_NULL;
+}
+
+void rt_free_align(void *ptr)
+{
+    free(ptr);
+}
+
+/*============================================================================*/
+/*                     DEVICE REGISTRY                                        */
+/*============================================================================*/
+
+rt_err_t rt_device_register(rt_device_t dev, const char *name, rt_uint16_t flags)
+{
+    if ((dev == RT_NULL) || (rt_device_find(name) != RT_NULL))
+    {
+        return -RT_ERROR;
+    }
+
+    strncpy(dev->name, name, RT_NAME_MAX);
+    dev->name[RT_NAME_MAX] = '\0';
+    dev->flag = flags;
+    dev->open_flag = RT_DEVICE_OFLAG_CLOSE;
+    dev->ref_count = 0;
+
+    pthread_mutex_lock(&g_dev_lock);
+    dev->next = g_dev_list;
+    g_dev_list = dev;
+    pthread_mutex_unlock(&g_dev_lock);
+
+    return RT_EOK;
+}
+
+rt_device_t rt_device_find(const char *name)
+{
+    rt_device_t dev;
+
+    pthread_mutex_lock(&g_dev_lock);
+    for (dev = g_dev_list; dev != RT_NULL; dev = dev->next)
+    {
+        if (strncmp(dev->name, name, RT_NAME_MAX) == 0)
+        {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_dev_lock);
+
+    return dev;
+}
+
+rt_err_t rt_device_init(rt_device_t dev)
+{
+    rt_err_t ret = RT_EOK;
+
+    if ((dev->init != RT_NULL) && !(dev->flag & RT_DEVICE_FLAG_ACTIVATED))
+    {
+        ret = dev->init(dev);
+        if (ret == RT_EOK)
+        {
+            dev->flag |= RT_DEVICE_FLAG_ACTIVATED;
+        }
+    }
+    return ret;
+}
+
+rt_err_t rt_device_open(rt_device_t dev, rt_uint16_t oflag)
+{
+    rt_err_t ret = RT_EOK;
+
+    if (!(dev->flag & RT_DEVICE_FLAG_ACTIVATED))
+    {
+        ret = rt_device_init(dev);
+        if (ret != RT_EOK)
+        {
+            return ret;
+        }
+        dev->flag |= RT_DEVICE_FLAG_ACTIVATED;
+    }
+
+    /* Same rule as the kernel: a standalone device can be opened once */
+    if ((dev->flag & RT_DEVICE_FLAG_STANDALONE) && (dev->open_flag & RT_DEVICE_OFLAG_OPEN))
+    {
+        return -RT_EBUSY;
+    }
+
+    if (dev->open != RT_NULL)
+    {
+        ret = dev->open(dev, oflag);
+    }
+    if ((ret == RT_EOK) || (ret == -RT_ENOSYS))
+    {
+        dev->open_flag = oflag | RT_DEVICE_OFLAG_OPEN;
+        dev->ref_count++;
+        ret = RT_EOK;
+    }
+    return ret;
+}
+
+rt_err_t rt_device_close(rt_device_t dev)
+{
+    rt_err_t ret = RT_EOK;
+
+    if (dev->ref_count == 0)
+    {
+        return -RT_ERROR;
+    }
+
+    dev->ref_count--;
+    if (dev->ref_count != 0)
+    {
+        return RT_EOK;
+    }
+
+    if (dev->close != RT_NULL)
+    {
+        ret = dev->close(dev);
+    }
+    if ((ret == RT_EOK) || (ret == -RT_ENOSYS))
+    {
+        dev->open_flag = RT_DEVICE_OFLAG_CLOSE;
+        ret = RT_EOK;
+    }
+    return ret;
+}
+
+rt_size_t rt_device_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+    return (dev->read != RT_NULL) ? dev->read(dev, pos, buffer, size) : 0;
+}
+
+rt_size_t rt_device_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+    return (dev->write != RT_NULL) ? dev->write(dev, pos, buffer, size) : 0;
+}
+
+rt_err_t rt_device_control(rt_device_t dev, int cmd, void *arg)
+{
+    return (dev->control != RT_NULL) ? dev->control(dev, cmd, arg) : -RT_ENOSYS;
+}
+
+rt_err_t rt_device_set_tx_complete(rt_device_t dev,
+                                   rt_err_t (*tx_done)(rt_device_t dev, void *buffer))
+{
+    dev->tx_complete = tx_done;
+    return RT_EOK;
+}
+
+/*============================================================================*/
+/*                     MSH / INIT TABLES                                      */
+/*============================================================================*/
+
+extern const struct rt_host_msh __start_rtmsh[] __attribute__((weak));
+extern const struct rt_host_msh __stop_rtmsh[] __attribute__((weak));
+extern int (*const __start_rtinit[])(void) __attribute__((weak));
+extern int (*const __stop_rtinit[])(void) __attribute__((weak));
+
+void rt_host_components_init(void)
+{
+    int (*const *fn)(void);
+
+    for (fn = __start_rtinit; (fn != NULL) && (fn < __stop_rtinit); fn++)
+    {
+        (*fn)();
+    }
+}
+
+int rt_host_msh_exec(const char *line)
+{
+    const struct rt_host_msh *cmd;
+    char buf[256];
+    char *argv[16];
+    int argc = 0;
+    char *tok, *save;
+
+    strncpy(buf, line, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    for (tok = strtok_r(buf, " \t", &save); (tok != NULL) && (argc < 16);
+         tok = strtok_r(NULL, " \t", &save))
+    {
+        argv[argc++] = tok;
+    }
+    if (argc == 0)
+    {
+        return RT_EOK;
+    }
+
+    for (cmd = __start_rtmsh; (cmd != NULL) && (cmd < __stop_rtmsh); cmd++)
+    {
+        if (strcmp(cmd->name, argv[0]) == 0)
+        {
+            cmd->fn(argc, argv);
+            return RT_EOK;
+        }
+    }
+
+    rt_kprintf("%s: command not found\n", argv[0]);
+    return -RT_ERROR;
+}
+
+/*============================================================================*/
+/*                     LOGGING                                                */
+/*============================================================================*/
+
+void rt_host_log(int level, const char *tag, const char *fmt, ...)
+{
+    static const char lvl[] = "EWID";
+    va_list ap;
+
+    if (level > rt_host_log_level)
+    {
+        return;
+    }
+
+    fprintf(stderr, "[%c/%s] ", lvl[level & 3], tag);
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+}